@@ -9,7 +9,10 @@ sleep 1
 
 echo "Example..."
 cd example
+#The NF uses the packet I/O library, which must be in the context of the build
+cp -r ../packet_io packet_io
 sudo docker build --tag="localhost:5000/example" .
+rm -rf packet_io
 sudo docker push localhost:5000/example
 cd ..
 
@@ -5,84 +5,129 @@
 */
 
 #include <stdio.h>
-#include <pcap.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
+#include <pthread.h>
+
+#include "packet_io.h"
 
 #define FROM	"eth0"
 #define TO		"eth1"
 
 #define NAME	"example"
 
+#define BURST_SIZE	64
+#define MAX_THREADS	16
+
 #define likely(x)       ( __builtin_expect(!!(x), 1) )
 #define unlikely(x)     (  __builtin_expect(!!(x), 0) )
 
-int main(int argc, char *argv[])
+/**
+*	@brief: each thread has its own RX ring on FROM (the rings of the different
+*		threads are in the same fanout group), and its own TX ring on TO
+*/
+struct thread_t
 {
-	char errbuf[PCAP_ERRBUF_SIZE];
-	pcap_t *from, *to;
-	struct pcap_pkthdr *header;
-	const unsigned char *pkt_data;
-	unsigned char *new_pkt;
+	pthread_t thread;
+	unsigned int id;
+	struct pio_rx_t *from;
+	struct pio_tx_t *to;
+};
 
-	int res;
+void *do_nf(void *arg);
 
-	printf("[%s] I'm going to start\n",NAME);
+void *do_nf(void *arg)
+{
+	struct thread_t *t = (struct thread_t*)arg;
+	struct pio_packet_t pkts[BURST_SIZE];
+	unsigned int i, n;
+	unsigned char *new_pkt;
 
-	//Check for root privileges 
-	if(geteuid() != 0)
+	while(1)
 	{
-		fprintf(stderr,"[%s] Root permissions are required to run %s\n",NAME,argv[0]);	
-		exit(EXIT_FAILURE);	
+		if(!pio_rx_wait(t->from, -1))
+			continue;
+
+		while((n = pio_rx_burst(t->from, pkts, BURST_SIZE)) > 0)
+		{
+			for(i = 0; i < n; i++)
+			{
+				new_pkt = pkts[i].data;
+#ifdef ENABLE_LOG
+				fprintf(stdout,"[%s] *******************************************",NAME);
+				fprintf(stdout,"[%s] Packet received (thread %u):\n",NAME,t->id);
+				fprintf(stdout,"[%s] \tlength: %d bytes\n",NAME,pkts[i].len);
+				fprintf(stdout,"[%s] \t%x:%x:%x:%x:%x:%x -> %x:%x:%x:%x:%x:%x\n",NAME,new_pkt[6],new_pkt[7],new_pkt[8],new_pkt[9],new_pkt[10],new_pkt[11],new_pkt[0],new_pkt[1],new_pkt[2],new_pkt[3],new_pkt[4],new_pkt[5]);
+#endif
+
+				new_pkt[0] = new_pkt[1] = new_pkt[2] = new_pkt[3] = new_pkt[4] = new_pkt[5] = 0xa;
+
+#ifdef ENABLE_LOG
+				fprintf(stdout,"[%s] New packet:\n",NAME);
+				fprintf(stdout,"[%s] \t%x:%x:%x:%x:%x:%x -> %x:%x:%x:%x:%x:%x\n",NAME,new_pkt[6],new_pkt[7],new_pkt[8],new_pkt[9],new_pkt[10],new_pkt[11],new_pkt[0],new_pkt[1],new_pkt[2],new_pkt[3],new_pkt[4],new_pkt[5]);
+				fprintf(stdout,"[%s] *******************************************",NAME);
+				fprintf(stdout,"[%s]",NAME);
+#endif
+
+				if(unlikely(pio_tx_send(t->to, new_pkt, pkts[i].len) != 0))
+				{
+#ifdef ENABLE_LOG
+					fprintf(stdout,"[%s] Packet dropped\n",NAME);
+#endif
+				}
+			}
+			pio_tx_flush(t->to);
+		}
 	}
-	
+
+	return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+	struct thread_t threads[MAX_THREADS];
+	struct pio_config_t config;
+	unsigned int num_threads = 1, i;
+
 	printf("[%s] I'm going to start\n",NAME);
 
-	from = pcap_open_live(FROM, BUFSIZ, 1, 1000, errbuf);
-	if(from == NULL)
+	//Check for root privileges
+	if(geteuid() != 0)
 	{
-		fprintf(stderr,"[%s] %s\n", NAME, errbuf);
-		exit(EXIT_FAILURE);	
+		fprintf(stderr,"[%s] Root permissions are required to run %s\n",NAME,argv[0]);
+		exit(EXIT_FAILURE);
 	}
 
-	to = pcap_open_live(TO, BUFSIZ, 1, 1000, errbuf);
-	if(to == NULL)
+	if(argc > 1)
+		num_threads = atoi(argv[1]);
+	if(num_threads == 0 || num_threads > MAX_THREADS)
 	{
-		fprintf(stderr,"[%s] %s\n", NAME, errbuf);
-		exit(EXIT_FAILURE);	
+		fprintf(stderr,"[%s] Usage: %s [threads (1-%d)]\n",NAME,argv[0],MAX_THREADS);
+		exit(EXIT_FAILURE);
 	}
 
-	printf("[%s] Devices open!\n",NAME);
+	pio_config_default(&config);
+	if(num_threads > 1)
+		config.fanout_group = getpid() & 0xFFFF;
 
-	while ((res = pcap_next_ex(from, &header, &pkt_data)) >= 0)
+	for(i = 0; i < num_threads; i++)
 	{
-		if(unlikely(res>0)){
-#ifdef ENABLE_LOG
-			fprintf(stdout,"[%s] *******************************************",NAME);
-			fprintf(stdout,"[%s] Packet received:\n",NAME);
-			fprintf(stdout,"[%s] \tlength: %d bytes\n",NAME,header->caplen);
-			fprintf(stdout,"[%s] \t%x:%x:%x:%x:%x:%x -> %x:%x:%x:%x:%x:%x\n",NAME,pkt_data[6],pkt_data[7],pkt_data[8],pkt_data[9],pkt_data[10],pkt_data[11],pkt_data[0],pkt_data[1],pkt_data[2],pkt_data[3],pkt_data[4],pkt_data[5]);
-#endif			
-		
-			new_pkt = (unsigned char*)pkt_data;
-			new_pkt[0] = new_pkt[1] = new_pkt[2] = new_pkt[3] = new_pkt[4] = new_pkt[5] = 0xa;
+		threads[i].id = i;
+		threads[i].from = pio_rx_open(FROM, &config);
+		threads[i].to = pio_tx_open(TO, &config);
+		if(threads[i].from == NULL || threads[i].to == NULL)
+		{
+			fprintf(stderr,"[%s] Cannot open the devices\n", NAME);
+			exit(EXIT_FAILURE);
+		}
+	}
 
-#ifdef ENABLE_LOG
-			fprintf(stdout,"[%s] New packet:\n",NAME);
-			fprintf(stdout,"[%s] \t%x:%x:%x:%x:%x:%x -> %x:%x:%x:%x:%x:%x\n",NAME,new_pkt[6],new_pkt[7],new_pkt[8],new_pkt[9],new_pkt[10],new_pkt[11],new_pkt[0],new_pkt[1],new_pkt[2],new_pkt[3],new_pkt[4],new_pkt[5]);
-			fprintf(stdout,"[%s] *******************************************",NAME);
-			fprintf(stdout,"[%s]",NAME);
-#endif
+	printf("[%s] Devices open! (%u threads)\n",NAME,num_threads);
 
-			if (unlikely (pcap_sendpacket(to, new_pkt, header->caplen) != 0))
-			{
-				fprintf(stdout,"[%s] Error sending the packet: %s\n", NAME,pcap_geterr(to));
-				exit(EXIT_FAILURE);
-			}
+	for(i = 1; i < num_threads; i++)
+		pthread_create(&threads[i].thread, NULL, do_nf, &threads[i]);
+	do_nf(&threads[0]);
 
-		}
-	}
 	exit(EXIT_SUCCESS);
 }
-
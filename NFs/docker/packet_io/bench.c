@@ -0,0 +1,297 @@
+/**
+* @file bench.c
+*
+* @brief Benchmark of the packet I/O library: packets are sent on an interface
+* (e.g., an end of a veth pair) and received on another one (e.g., the other end
+* of the pair), either with the PACKET_MMAP rings or, for comparison, with
+* libpcap (one system call per packet).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <pcap.h>
+
+#include "packet_io.h"
+
+#define NAME			"bench"
+#define BURST_SIZE		64
+#define MAX_THREADS		64
+#define FLOWS			256
+
+struct receiver_t
+{
+	pthread_t thread;
+	const char *ifname;
+	unsigned int fanout_group;
+	uint64_t packets;
+	uint64_t bytes;
+	uint64_t drops;
+};
+
+static volatile int stop = 0;
+static volatile int ready = 0;
+static int use_pcap = 0;
+
+/**
+*	Private prototypes
+*/
+void usage(const char *prgname);
+double now(void);
+void *receive(void *arg);
+void pcap_count(unsigned char *user, const struct pcap_pkthdr *header, const unsigned char *data);
+uint64_t send_packets(const char *ifname, unsigned int size);
+void *timer(void *arg);
+void build_packet(unsigned char *pkt, unsigned int size, unsigned int flow);
+
+/**
+*	Implementations
+*/
+
+void usage(const char *prgname)
+{
+	fprintf(stderr,"Usage: %s [--pcap] [--t threads] tx_interface rx_interface seconds [packet_size]\n",prgname);
+	fprintf(stderr,"  --pcap       use libpcap instead of the PACKET_MMAP rings\n");
+	fprintf(stderr,"  --t threads  receive with several threads, in a fanout group (default: 1)\n");
+}
+
+double now(void)
+{
+	struct timeval tv;
+	gettimeofday(&tv,NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+void pcap_count(unsigned char *user, const struct pcap_pkthdr *header, const unsigned char *data)
+{
+	(void)data;
+	struct receiver_t *receiver = (struct receiver_t*)user;
+	receiver->packets++;
+	receiver->bytes += header->caplen;
+}
+
+void *receive(void *arg)
+{
+	struct receiver_t *receiver = (struct receiver_t*)arg;
+
+	if(use_pcap)
+	{
+		char errbuf[PCAP_ERRBUF_SIZE];
+		pcap_t *pcap = pcap_open_live(receiver->ifname, 65535, 1, 1, errbuf);
+		if(pcap == NULL)
+		{
+			fprintf(stderr,"[%s] %s\n",NAME,errbuf);
+			exit(EXIT_FAILURE);
+		}
+		__sync_fetch_and_add(&ready,1);
+
+		while(!stop)
+			pcap_dispatch(pcap, -1, pcap_count, (unsigned char*)receiver);
+
+		struct pcap_stat stats;
+		if(pcap_stats(pcap, &stats) == 0)
+			receiver->drops = stats.ps_drop;
+		pcap_close(pcap);
+		return NULL;
+	}
+
+	struct pio_config_t config;
+	struct pio_packet_t pkts[BURST_SIZE];
+	uint64_t packets, drops;
+	unsigned int i, n;
+
+	pio_config_default(&config);
+	config.fanout_group = receiver->fanout_group;
+	struct pio_rx_t *rx = pio_rx_open(receiver->ifname, &config);
+	if(rx == NULL)
+		exit(EXIT_FAILURE);
+	pio_rx_stats(rx, &packets, &drops);
+	__sync_fetch_and_add(&ready,1);
+
+	while(!stop)
+	{
+		if(!pio_rx_wait(rx, 100))
+			continue;
+
+		while((n = pio_rx_burst(rx, pkts, BURST_SIZE)) > 0)
+		{
+			receiver->packets += n;
+			for(i = 0; i < n; i++)
+				receiver->bytes += pkts[i].len;
+		}
+	}
+
+	pio_rx_stats(rx, &packets, &drops);
+	receiver->drops = drops;
+	pio_rx_close(rx);
+
+	return NULL;
+}
+
+/**
+*	@brief: build an IPv4/UDP packet of a given size, belonging to one of FLOWS
+*		flows (they differ in the UDP source port), so that the packets are spread
+*		among the threads of a fanout group
+*/
+void build_packet(unsigned char *pkt, unsigned int size, unsigned int flow)
+{
+	unsigned int ip_len = size - 14, i;
+	uint32_t csum = 0;
+
+	memset(pkt, 0, size);
+	//Locally administered MAC addresses
+	memcpy(pkt, "\x02\x00\x00\x00\x00\x02\x02\x00\x00\x00\x00\x01\x08\x00", 14);
+
+	unsigned char *ip = pkt + 14;
+	ip[0] = 0x45;
+	ip[2] = ip_len >> 8;
+	ip[3] = ip_len & 0xFF;
+	ip[8] = 64;
+	ip[9] = 17;
+	memcpy(ip + 12, "\x0a\x00\x00\x01\x0a\x00\x00\x02", 8);
+	for(i = 0; i < 20; i += 2)
+		csum += (ip[i] << 8) | ip[i + 1];
+	while(csum >> 16)
+		csum = (csum & 0xFFFF) + (csum >> 16);
+	ip[10] = ~csum >> 8;
+	ip[11] = ~csum & 0xFF;
+
+	unsigned char *udp = ip + 20;
+	udp[0] = (1024 + flow) >> 8;
+	udp[1] = (1024 + flow) & 0xFF;
+	udp[2] = 9;
+	udp[4] = (ip_len - 20) >> 8;
+	udp[5] = (ip_len - 20) & 0xFF;
+}
+
+/**
+*	@brief: send packets of a given size until the benchmark ends. Returns the
+*		number of packets sent
+*/
+uint64_t send_packets(const char *ifname, unsigned int size)
+{
+	uint64_t sent = 0;
+	unsigned char *pkts = (unsigned char*)malloc(FLOWS * size);
+	unsigned int flow = 0;
+
+	for(flow = 0; flow < FLOWS; flow++)
+		build_packet(pkts + flow * size, size, flow);
+
+	if(use_pcap)
+	{
+		char errbuf[PCAP_ERRBUF_SIZE];
+		pcap_t *pcap = pcap_open_live(ifname, 65535, 1, 1, errbuf);
+		if(pcap == NULL)
+		{
+			fprintf(stderr,"[%s] %s\n",NAME,errbuf);
+			exit(EXIT_FAILURE);
+		}
+
+		while(!stop)
+		{
+			if(pcap_sendpacket(pcap, pkts + (sent % FLOWS) * size, size) == 0)
+				sent++;
+		}
+		pcap_close(pcap);
+	}
+	else
+	{
+		struct pio_config_t config;
+		pio_config_default(&config);
+		struct pio_tx_t *tx = pio_tx_open(ifname, &config);
+		if(tx == NULL)
+			exit(EXIT_FAILURE);
+
+		while(!stop)
+		{
+			if(pio_tx_send(tx, pkts + (sent % FLOWS) * size, size) == 0)
+				sent++;
+		}
+		pio_tx_flush(tx);
+		pio_tx_close(tx);
+	}
+
+	free(pkts);
+	return sent;
+}
+
+void *timer(void *arg)
+{
+	sleep(*(unsigned int*)arg);
+	stop = 1;
+	return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+	struct receiver_t receivers[MAX_THREADS];
+	unsigned int threads = 1, seconds, size = 64, i;
+	int arg = 1;
+	pthread_t timer_thread;
+
+	while(arg < argc && argv[arg][0] == '-')
+	{
+		if(!strcmp(argv[arg], "--pcap"))
+			use_pcap = 1;
+		else if(!strcmp(argv[arg], "--t") && arg + 1 < argc)
+			threads = atoi(argv[++arg]);
+		else
+		{
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+		arg++;
+	}
+
+	if(argc - arg < 3 || threads == 0 || threads > MAX_THREADS || (use_pcap && threads > 1))
+	{
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	const char *tx_if = argv[arg];
+	const char *rx_if = argv[arg + 1];
+	seconds = atoi(argv[arg + 2]);
+	if(argc - arg > 3)
+		size = atoi(argv[arg + 3]);
+	if(size < 60)
+		size = 60;
+
+	memset(receivers, 0, sizeof(receivers));
+	for(i = 0; i < threads; i++)
+	{
+		receivers[i].ifname = rx_if;
+		receivers[i].fanout_group = (threads > 1)? (getpid() & 0xFFFF) : 0;
+		pthread_create(&receivers[i].thread, NULL, receive, &receivers[i]);
+	}
+	while(ready < (int)threads)
+		usleep(1000);
+
+	double start = now();
+	pthread_create(&timer_thread, NULL, timer, &seconds);
+	uint64_t sent = send_packets(tx_if, size);
+	double elapsed = now() - start;
+
+	uint64_t packets = 0, bytes = 0, drops = 0;
+	for(i = 0; i < threads; i++)
+	{
+		pthread_join(receivers[i].thread, NULL);
+		packets += receivers[i].packets;
+		bytes += receivers[i].bytes;
+		drops += receivers[i].drops;
+		if(threads > 1)
+			printf("[%s] Thread %u: %" PRIu64 " packets\n",NAME,i,receivers[i].packets);
+	}
+	pthread_join(timer_thread, NULL);
+
+	printf("[%s] %s, %u byte packets, %.1f s\n",NAME,use_pcap? "libpcap" : "PACKET_MMAP",size,elapsed);
+	printf("[%s] Sent:     %" PRIu64 " packets (%.3f Mpps)\n",NAME,sent,sent / elapsed / 1e6);
+	printf("[%s] Received: %" PRIu64 " packets (%.3f Mpps, %.3f Gbps), %" PRIu64 " dropped by the kernel\n",
+		NAME,packets,packets / elapsed / 1e6,bytes * 8 / elapsed / 1e9,drops);
+
+	return EXIT_SUCCESS;
+}
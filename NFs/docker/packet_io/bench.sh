@@ -0,0 +1,30 @@
+#!/bin/bash
+
+#Runs the benchmark of the packet I/O library on a veth pair, with the
+#PACKET_MMAP rings and with libpcap.
+#
+#Usage: sudo ./bench.sh [seconds] [threads]
+
+SECONDS_PER_RUN=${1:-5}
+THREADS=${2:-1}
+BENCH=./bench
+
+if [ ! -x $BENCH ]
+then
+	echo "$BENCH not found: build it with 'cmake . && make'"
+	exit 1
+fi
+
+ip link add pio0 type veth peer name pio1 || exit 1
+ip link set pio0 up
+ip link set pio1 up
+ip link set pio0 mtu 9000
+ip link set pio1 mtu 9000
+
+for size in 64 1500 9000
+do
+	$BENCH --t $THREADS pio0 pio1 $SECONDS_PER_RUN $size
+	$BENCH --pcap pio0 pio1 $SECONDS_PER_RUN $size
+done
+
+ip link del pio0
@@ -0,0 +1,443 @@
+/**
+* @file packet_io.c
+*
+* @brief Packet I/O based on the PACKET_MMAP rings (see packet_io.h).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+
+#include "packet_io.h"
+
+#define likely(x)       ( __builtin_expect(!!(x), 1) )
+#define unlikely(x)     (  __builtin_expect(!!(x), 0) )
+
+/**
+*	@brief: nominal size of a frame of the RX ring. With TPACKET_V3 the packets
+*		are stored in the blocks with their actual size, hence it does not limit
+*		the size of the packets
+*/
+#define RX_FRAME_SIZE		2048
+
+/**
+*	@brief: bytes added to the MTU in the frames of the TX ring (Ethernet header
+*		and VLAN tag)
+*/
+#define TX_L2_OVERHEAD		(ETH_HLEN + 4)
+
+struct pio_rx_t
+{
+	int fd;
+	uint8_t *ring;
+	size_t ring_size;
+	unsigned int block_size;
+	unsigned int blocks;
+
+	/**
+	*	@brief: block being read (owned by the NF if in_block is 1), next packet
+	*		to be read in the block, and packets not read yet
+	*/
+	unsigned int current;
+	int in_block;
+	struct tpacket3_hdr *next;
+	unsigned int left;
+};
+
+struct pio_tx_t
+{
+	int fd;
+	uint8_t *ring;
+	size_t ring_size;
+	unsigned int frame_size;
+	unsigned int frames;
+	unsigned int batch;
+
+	/**
+	*	@brief: the frames do not cross the blocks of the ring
+	*/
+	unsigned int block_size;
+	unsigned int frames_per_block;
+
+	/**
+	*	@brief: next frame to be filled, and frames filled and not sent yet
+	*/
+	unsigned int current;
+	unsigned int pending;
+};
+
+/**
+*	Private prototypes
+*/
+int open_socket(const char *ifname, int version, int *ifindex);
+int bind_socket(int fd, int ifindex, const char *ifname);
+void release_block(struct pio_rx_t *rx);
+
+/**
+*	Implementations
+*/
+
+void pio_config_default(struct pio_config_t *config)
+{
+	config->rx_block_size = 1 << 20;
+	config->rx_blocks = 16;
+	config->rx_timeout = 10;
+	config->tx_frames = 1024;
+	config->tx_batch = 64;
+	config->fanout_group = 0;
+}
+
+/**
+*	@brief: create a packet socket using a given version of the rings
+*/
+int open_socket(const char *ifname, int version, int *ifindex)
+{
+	int fd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+	if(fd < 0)
+	{
+		fprintf(stderr,"[packet_io] Cannot create a packet socket: %s\n",strerror(errno));
+		return -1;
+	}
+
+	if(setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0)
+	{
+		fprintf(stderr,"[packet_io] TPACKET_V%d is not supported: %s\n",version + 1,strerror(errno));
+		close(fd);
+		return -1;
+	}
+
+	*ifindex = if_nametoindex(ifname);
+	if(*ifindex == 0)
+	{
+		fprintf(stderr,"[packet_io] Interface '%s' not found\n",ifname);
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+int bind_socket(int fd, int ifindex, const char *ifname)
+{
+	struct sockaddr_ll addr;
+
+	memset(&addr,0,sizeof(addr));
+	addr.sll_family = AF_PACKET;
+	addr.sll_protocol = htons(ETH_P_ALL);
+	addr.sll_ifindex = ifindex;
+
+	if(bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+	{
+		fprintf(stderr,"[packet_io] Cannot bind to '%s': %s\n",ifname,strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
+struct pio_rx_t *pio_rx_open(const char *ifname, const struct pio_config_t *config)
+{
+	int ifindex;
+	int fd = open_socket(ifname, TPACKET_V3, &ifindex);
+	if(fd < 0)
+		return NULL;
+
+	struct tpacket_req3 req;
+	memset(&req,0,sizeof(req));
+	req.tp_block_size = config->rx_block_size;
+	req.tp_block_nr = config->rx_blocks;
+	req.tp_frame_size = RX_FRAME_SIZE;
+	req.tp_frame_nr = (config->rx_block_size / RX_FRAME_SIZE) * config->rx_blocks;
+	req.tp_retire_blk_tov = config->rx_timeout;
+	req.tp_feature_req_word = TP_FT_REQ_FILL_RXHASH;
+
+	if(setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) < 0)
+	{
+		fprintf(stderr,"[packet_io] Cannot create the RX ring on '%s': %s\n",ifname,strerror(errno));
+		close(fd);
+		return NULL;
+	}
+
+	size_t ring_size = (size_t)req.tp_block_size * req.tp_block_nr;
+	uint8_t *ring = (uint8_t*)mmap(NULL, ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+	if(ring == MAP_FAILED)
+	{
+		fprintf(stderr,"[packet_io] Cannot map the RX ring of '%s': %s\n",ifname,strerror(errno));
+		close(fd);
+		return NULL;
+	}
+
+	struct packet_mreq mreq;
+	memset(&mreq,0,sizeof(mreq));
+	mreq.mr_ifindex = ifindex;
+	mreq.mr_type = PACKET_MR_PROMISC;
+
+	if(bind_socket(fd, ifindex, ifname) < 0 || setsockopt(fd, SOL_PACKET, PACKET_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0)
+	{
+		munmap(ring, ring_size);
+		close(fd);
+		return NULL;
+	}
+
+	if(config->fanout_group != 0)
+	{
+		//The group must be joined after the bind
+		int fanout = (config->fanout_group & 0xFFFF) | ((PACKET_FANOUT_HASH | PACKET_FANOUT_FLAG_DEFRAG) << 16);
+		if(setsockopt(fd, SOL_PACKET, PACKET_FANOUT, &fanout, sizeof(fanout)) < 0)
+		{
+			fprintf(stderr,"[packet_io] Cannot join the fanout group %u on '%s': %s\n",config->fanout_group,ifname,strerror(errno));
+			munmap(ring, ring_size);
+			close(fd);
+			return NULL;
+		}
+	}
+
+	struct pio_rx_t *rx = (struct pio_rx_t*)calloc(1,sizeof(struct pio_rx_t));
+	rx->fd = fd;
+	rx->ring = ring;
+	rx->ring_size = ring_size;
+	rx->block_size = req.tp_block_size;
+	rx->blocks = req.tp_block_nr;
+
+	return rx;
+}
+
+int pio_rx_wait(struct pio_rx_t *rx, int timeout)
+{
+	if(rx->in_block)
+	{
+		if(rx->left > 0)
+			return 1;
+		//Otherwise the kernel would consider the ring readable, since the block is owned by the NF
+		release_block(rx);
+	}
+
+	struct tpacket_block_desc *desc = (struct tpacket_block_desc*)(rx->ring + (size_t)rx->current * rx->block_size);
+	if(desc->hdr.bh1.block_status & TP_STATUS_USER)
+		return 1;
+
+	struct pollfd pfd;
+	pfd.fd = rx->fd;
+	pfd.events = POLLIN | POLLERR;
+	pfd.revents = 0;
+
+	return (poll(&pfd, 1, timeout) > 0);
+}
+
+/**
+*	@brief: give the current block back to the kernel
+*/
+void release_block(struct pio_rx_t *rx)
+{
+	struct tpacket_block_desc *desc = (struct tpacket_block_desc*)(rx->ring + (size_t)rx->current * rx->block_size);
+
+	//The packets must be read before the block is given back
+	__sync_synchronize();
+	desc->hdr.bh1.block_status = TP_STATUS_KERNEL;
+
+	rx->current = (rx->current + 1) % rx->blocks;
+	rx->in_block = 0;
+}
+
+unsigned int pio_rx_burst(struct pio_rx_t *rx, struct pio_packet_t *pkts, unsigned int max)
+{
+	unsigned int n = 0;
+
+	//The packets returned by the previous call belong to the current block: a burst
+	//never crosses the end of a block, so that the block can be released here
+	if(rx->in_block && rx->left == 0)
+		release_block(rx);
+
+	if(!rx->in_block)
+	{
+		struct tpacket_block_desc *desc = (struct tpacket_block_desc*)(rx->ring + (size_t)rx->current * rx->block_size);
+		if(!(desc->hdr.bh1.block_status & TP_STATUS_USER))
+			return 0;
+
+		//The block must be read after its status
+		__sync_synchronize();
+		rx->in_block = 1;
+		rx->left = desc->hdr.bh1.num_pkts;
+		rx->next = (struct tpacket3_hdr*)((uint8_t*)desc + desc->hdr.bh1.offset_to_first_pkt);
+	}
+
+	while(rx->left > 0 && n < max)
+	{
+		struct tpacket3_hdr *hdr = rx->next;
+		struct sockaddr_ll *sll = (struct sockaddr_ll*)((uint8_t*)hdr + TPACKET_ALIGN(sizeof(struct tpacket3_hdr)));
+
+		//The packets sent on the interface (e.g., by the NF itself) are ignored
+		if(likely(sll->sll_pkttype != PACKET_OUTGOING))
+		{
+			pkts[n].data = (uint8_t*)hdr + hdr->tp_mac;
+			pkts[n].len = hdr->tp_snaplen;
+			n++;
+		}
+
+		rx->next = (struct tpacket3_hdr*)((uint8_t*)hdr + hdr->tp_next_offset);
+		rx->left--;
+	}
+
+	return n;
+}
+
+void pio_rx_stats(struct pio_rx_t *rx, uint64_t *packets, uint64_t *drops)
+{
+	struct tpacket_stats_v3 stats;
+	socklen_t len = sizeof(stats);
+
+	*packets = *drops = 0;
+	//The counters are reset by the kernel each time they are read
+	if(getsockopt(rx->fd, SOL_PACKET, PACKET_STATISTICS, &stats, &len) == 0)
+	{
+		*packets = stats.tp_packets;
+		*drops = stats.tp_drops;
+	}
+}
+
+void pio_rx_close(struct pio_rx_t *rx)
+{
+	munmap(rx->ring, rx->ring_size);
+	close(rx->fd);
+	free(rx);
+}
+
+struct pio_tx_t *pio_tx_open(const char *ifname, const struct pio_config_t *config)
+{
+	int ifindex, one = 1;
+	int fd = open_socket(ifname, TPACKET_V2, &ifindex);
+	if(fd < 0)
+		return NULL;
+
+	//The frames must contain the largest packet that can be sent on the interface
+	struct ifreq ifr;
+	memset(&ifr,0,sizeof(ifr));
+	strncpy(ifr.ifr_name, ifname, IFNAMSIZ - 1);
+	if(ioctl(fd, SIOCGIFMTU, &ifr) < 0)
+	{
+		fprintf(stderr,"[packet_io] Cannot read the MTU of '%s': %s\n",ifname,strerror(errno));
+		close(fd);
+		return NULL;
+	}
+
+	unsigned int frame_size = TPACKET_ALIGN(TPACKET2_HDRLEN + ifr.ifr_mtu + TX_L2_OVERHEAD);
+	unsigned int block_size = getpagesize();
+	while(block_size < frame_size)
+		block_size <<= 1;
+	unsigned int frames_per_block = block_size / frame_size;
+
+	struct tpacket_req req;
+	memset(&req,0,sizeof(req));
+	req.tp_frame_size = frame_size;
+	req.tp_block_size = block_size;
+	req.tp_block_nr = (config->tx_frames + frames_per_block - 1) / frames_per_block;
+	req.tp_frame_nr = req.tp_block_nr * frames_per_block;
+
+	//The malformed frames are discarded instead of blocking the ring, and the
+	//packets skip the qdisc (if supported by the kernel)
+	setsockopt(fd, SOL_PACKET, PACKET_LOSS, &one, sizeof(one));
+	setsockopt(fd, SOL_PACKET, PACKET_QDISC_BYPASS, &one, sizeof(one));
+
+	if(setsockopt(fd, SOL_PACKET, PACKET_TX_RING, &req, sizeof(req)) < 0)
+	{
+		fprintf(stderr,"[packet_io] Cannot create the TX ring on '%s': %s\n",ifname,strerror(errno));
+		close(fd);
+		return NULL;
+	}
+
+	size_t ring_size = (size_t)req.tp_block_size * req.tp_block_nr;
+	uint8_t *ring = (uint8_t*)mmap(NULL, ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+	if(ring == MAP_FAILED)
+	{
+		fprintf(stderr,"[packet_io] Cannot map the TX ring of '%s': %s\n",ifname,strerror(errno));
+		close(fd);
+		return NULL;
+	}
+
+	if(bind_socket(fd, ifindex, ifname) < 0)
+	{
+		munmap(ring, ring_size);
+		close(fd);
+		return NULL;
+	}
+
+	struct pio_tx_t *tx = (struct pio_tx_t*)calloc(1,sizeof(struct pio_tx_t));
+	tx->fd = fd;
+	tx->ring = ring;
+	tx->ring_size = ring_size;
+	tx->frame_size = frame_size;
+	tx->frames = req.tp_frame_nr;
+	tx->batch = (config->tx_batch < tx->frames)? config->tx_batch : tx->frames;
+	tx->block_size = block_size;
+	tx->frames_per_block = frames_per_block;
+
+	return tx;
+}
+
+/**
+*	@brief: frame of the TX ring
+*/
+static inline struct tpacket2_hdr *tx_frame(struct pio_tx_t *tx, unsigned int i)
+{
+	return (struct tpacket2_hdr*)(tx->ring + (size_t)(i / tx->frames_per_block) * tx->block_size + (size_t)(i % tx->frames_per_block) * tx->frame_size);
+}
+
+int pio_tx_send(struct pio_tx_t *tx, const uint8_t *data, uint32_t len)
+{
+	struct tpacket2_hdr *hdr = tx_frame(tx, tx->current);
+
+	if(unlikely(len > tx->frame_size - (TPACKET2_HDRLEN - sizeof(struct sockaddr_ll))))
+		return -1;
+
+	if(unlikely(hdr->tp_status != TP_STATUS_AVAILABLE))
+	{
+		//The kernel is still sending the frame: the pending frames are sent, which
+		//blocks until the ring has room
+		pio_tx_flush(tx);
+		if(hdr->tp_status != TP_STATUS_AVAILABLE)
+			return -1;
+	}
+
+	memcpy((uint8_t*)hdr + TPACKET2_HDRLEN - sizeof(struct sockaddr_ll), data, len);
+	hdr->tp_len = len;
+
+	//The frame must be written before its status
+	__sync_synchronize();
+	hdr->tp_status = TP_STATUS_SEND_REQUEST;
+
+	tx->current = (tx->current + 1) % tx->frames;
+	tx->pending++;
+	if(tx->pending >= tx->batch)
+		pio_tx_flush(tx);
+
+	return 0;
+}
+
+void pio_tx_flush(struct pio_tx_t *tx)
+{
+	if(tx->pending == 0)
+		return;
+
+	//Without MSG_DONTWAIT, the kernel returns when all the frames have been sent
+	if(sendto(tx->fd, NULL, 0, 0, NULL, 0) < 0 && errno != ENOBUFS && errno != EAGAIN)
+		fprintf(stderr,"[packet_io] Error sending the packets: %s\n",strerror(errno));
+	tx->pending = 0;
+}
+
+void pio_tx_close(struct pio_tx_t *tx)
+{
+	pio_tx_flush(tx);
+	munmap(tx->ring, tx->ring_size);
+	close(tx->fd);
+	free(tx);
+}
@@ -0,0 +1,119 @@
+/**
+* @file packet_io.h
+*
+* @brief Packet I/O for the NFs running in Docker containers, based on the
+* PACKET_MMAP rings of the Linux kernel. The packets are received through a
+* TPACKET_V3 RX ring: the kernel fills blocks of packets, and the NF processes a
+* block without any system call. The packets are sent through a TPACKET_V2 TX
+* ring: the NF copies a batch of packets in the ring, and the kernel sends the
+* batch with a single system call.
+*
+* An interface can be read by several threads, each one with its own RX ring in
+* the same fanout group: the kernel spreads the packets among the rings according
+* to the hash of their flow (PACKET_FANOUT_HASH).
+*/
+
+#ifndef _PACKET_IO_H_
+#define _PACKET_IO_H_ 1
+
+#pragma once
+
+#include <stdint.h>
+
+struct pio_config_t
+{
+	/**
+	*	@brief: blocks of the RX ring, and their size (a multiple of the page
+	*		size). A block is given to the NF when it is full, or after
+	*		rx_timeout milliseconds
+	*/
+	unsigned int rx_block_size;
+	unsigned int rx_blocks;
+	unsigned int rx_timeout;
+
+	/**
+	*	@brief: frames of the TX ring. The size of a frame is calculated from the
+	*		MTU of the interface, so that jumbo frames can be sent
+	*/
+	unsigned int tx_frames;
+
+	/**
+	*	@brief: packets enqueued in the TX ring after which they are sent
+	*/
+	unsigned int tx_batch;
+
+	/**
+	*	@brief: identifier of the fanout group of the RX rings of an interface
+	*		(0 if the interface is read by a single ring)
+	*/
+	unsigned int fanout_group;
+};
+
+/**
+*	@brief: packet received; the data belong to the RX ring, and are valid until
+*		the next call to pio_rx_burst on the same ring
+*/
+struct pio_packet_t
+{
+	uint8_t *data;
+	uint32_t len;
+};
+
+struct pio_rx_t;
+struct pio_tx_t;
+
+/**
+*	@brief: fill a configuration with the default values
+*/
+void pio_config_default(struct pio_config_t *config);
+
+/**
+*	@brief: create an RX ring on an interface, which is put in promiscuous mode.
+*		The packets sent on the interface are not received. Returns NULL in case
+*		of error (the reason is printed on stderr)
+*/
+struct pio_rx_t *pio_rx_open(const char *ifname, const struct pio_config_t *config);
+
+/**
+*	@brief: wait until packets are available, for at most timeout milliseconds
+*		(-1 means forever). Returns 1 if packets are available, 0 otherwise. If
+*		all the packets of the current block have been received, the packets
+*		received by the previous pio_rx_burst are given back to the kernel
+*/
+int pio_rx_wait(struct pio_rx_t *rx, int timeout);
+
+/**
+*	@brief: receive up to max packets, without any system call. Returns the number
+*		of packets received. The packets received by the previous call are given
+*		back to the kernel
+*/
+unsigned int pio_rx_burst(struct pio_rx_t *rx, struct pio_packet_t *pkts, unsigned int max);
+
+/**
+*	@brief: packets received, and dropped by the kernel because the ring was full,
+*		since the previous call
+*/
+void pio_rx_stats(struct pio_rx_t *rx, uint64_t *packets, uint64_t *drops);
+
+void pio_rx_close(struct pio_rx_t *rx);
+
+/**
+*	@brief: create a TX ring on an interface. Returns NULL in case of error
+*/
+struct pio_tx_t *pio_tx_open(const char *ifname, const struct pio_config_t *config);
+
+/**
+*	@brief: copy a packet in the TX ring. The packets are sent when tx_batch
+*		packets are in the ring, or when pio_tx_flush is called. Returns -1 if the
+*		packet cannot be sent (ring full, or packet longer than the MTU)
+*/
+int pio_tx_send(struct pio_tx_t *tx, const uint8_t *data, uint32_t len);
+
+/**
+*	@brief: send the packets in the TX ring
+*/
+void pio_tx_flush(struct pio_tx_t *tx);
+
+void pio_tx_close(struct pio_tx_t *tx);
+
+#endif //_PACKET_IO_H_
@@ -0,0 +1,308 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+* @file matcher_bench.c
+*
+* @brief Measures the throughput (on a single core) of the matcher used by the
+* DPI, without DPDK and without any NIC. The payloads are either read from a
+* pcap file (TCP payloads of IPv4 packets), or randomly generated with a fixed
+* size. The patterns are either read from a file, or randomly generated.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <sys/time.h>
+
+#include <pcap.h>
+
+#include "../matcher.h"
+
+#define NAME					"matcher_bench"
+
+#define NUM_SYNTHETIC_PAYLOADS	4096
+#define MAX_PAYLOADS			65536
+#define MIN_BYTES_PER_RUN		(1ULL << 28)	//256MB scanned for each measure
+
+#define MIN_PATTERN_LENGTH		4
+#define MAX_PATTERN_LENGTH		10
+
+/**
+*	Default configurations measured when no option is provided
+*/
+static const unsigned int default_sizes[] = {64, 512, 1500};
+static const unsigned int default_num_patterns[] = {10, 1000};
+
+typedef struct
+{
+	unsigned char **data;
+	unsigned int *len;
+	unsigned int num;
+	uint64_t total_bytes;
+}payloads_t;
+
+/**
+*	Private prototypes
+*/
+void usage(void);
+char random_char(void);
+struct matcher_t *random_matcher(unsigned int num_patterns);
+int load_pcap(const char *file_name, payloads_t *payloads);
+void synthetic_payloads(unsigned int size, payloads_t *payloads);
+void free_payloads(payloads_t *payloads);
+void run(struct matcher_t *matcher, payloads_t *payloads, const char *description);
+
+/**
+*	Implementations
+*/
+
+void usage(void)
+{
+	char message[]=	\
+
+	"Usage:                                                                                   \n" \
+	"  ./matcher_bench [--r pcap_file | --s payload_size] [--f patterns_file | --n number]    \n" \
+	"                                                                                         \n" \
+	"Options:                                                                                 \n" \
+	"  --r pcap_file                                                                          \n" \
+	"        Use the TCP payloads of the IPv4 packets in the pcap file.                       \n" \
+	"  --s payload_size                                                                       \n" \
+	"        Use random payloads of the given size (default: 64, 512 and 1500 bytes).         \n" \
+	"  --f patterns_file                                                                      \n" \
+	"        Use the patterns in the file, one per line.                                      \n" \
+	"  --n number                                                                             \n" \
+	"        Use the given number of random patterns (default: 10 and 1000).                  \n" \
+	"  --h                                                                                    \n" \
+	"        Print this help.                                                                 \n\n";
+
+	fprintf(stderr,"\n\n[%s] %s\n",NAME,message);
+}
+
+char random_char(void)
+{
+	return 'a' + (rand() % 26);
+}
+
+struct matcher_t *random_matcher(unsigned int num_patterns)
+{
+	unsigned int i, j;
+	char **patterns = (char**)malloc(num_patterns * sizeof(char*));
+
+	for(i = 0; i < num_patterns; i++)
+	{
+		unsigned int len = MIN_PATTERN_LENGTH + rand() % (MAX_PATTERN_LENGTH - MIN_PATTERN_LENGTH + 1);
+		patterns[i] = (char*)malloc(len + 1);
+		for(j = 0; j < len; j++)
+			patterns[i][j] = random_char();
+		patterns[i][len] = '\0';
+	}
+
+	struct matcher_t *matcher = matcher_create((const char**)patterns,num_patterns);
+
+	for(i = 0; i < num_patterns; i++)
+		free(patterns[i]);
+	free(patterns);
+
+	return matcher;
+}
+
+int load_pcap(const char *file_name, payloads_t *payloads)
+{
+	char errbuf[PCAP_ERRBUF_SIZE];
+	struct pcap_pkthdr *header;
+	const u_char *packet;
+
+	pcap_t *pcap = pcap_open_offline(file_name,errbuf);
+	if(pcap == NULL)
+	{
+		fprintf(stderr,"[%s] Cannot open '%s': %s\n",NAME,file_name,errbuf);
+		return 0;
+	}
+
+	payloads->data = (unsigned char**)malloc(MAX_PAYLOADS * sizeof(unsigned char*));
+	payloads->len = (unsigned int*)malloc(MAX_PAYLOADS * sizeof(unsigned int));
+	payloads->num = 0;
+	payloads->total_bytes = 0;
+
+	while(payloads->num < MAX_PAYLOADS && pcap_next_ex(pcap,&header,&packet) == 1)
+	{
+		unsigned int len = header->caplen;
+
+		//Ethernet + IPv4 + TCP, as in the DPI
+		if(len < 14 + 20 || packet[12] != 0x08 || packet[13] != 0x00)
+			continue;
+		const u_char *ip = &packet[14];
+		unsigned int hlen = (ip[0] & 0xF) * 4;
+		if(ip[9] != 6 || len < 14 + hlen + 20)
+			continue;
+		const u_char *tcp = &ip[hlen];
+		unsigned int data_offset = ((tcp[12] & 0xF0) >> 4) * 4;
+		if(len <= 14 + hlen + data_offset)
+			continue;
+
+		unsigned int payload_len = len - (14 + hlen + data_offset);
+		payloads->data[payloads->num] = (unsigned char*)malloc(payload_len);
+		memcpy(payloads->data[payloads->num],&tcp[data_offset],payload_len);
+		payloads->len[payloads->num] = payload_len;
+		payloads->total_bytes += payload_len;
+		payloads->num++;
+	}
+
+	pcap_close(pcap);
+
+	if(payloads->num == 0)
+	{
+		fprintf(stderr,"[%s] No TCP payload in '%s'\n",NAME,file_name);
+		return 0;
+	}
+
+	return 1;
+}
+
+void synthetic_payloads(unsigned int size, payloads_t *payloads)
+{
+	unsigned int i, j;
+
+	payloads->data = (unsigned char**)malloc(NUM_SYNTHETIC_PAYLOADS * sizeof(unsigned char*));
+	payloads->len = (unsigned int*)malloc(NUM_SYNTHETIC_PAYLOADS * sizeof(unsigned int));
+	payloads->num = NUM_SYNTHETIC_PAYLOADS;
+	payloads->total_bytes = (uint64_t)size * NUM_SYNTHETIC_PAYLOADS;
+
+	for(i = 0; i < NUM_SYNTHETIC_PAYLOADS; i++)
+	{
+		payloads->data[i] = (unsigned char*)malloc(size);
+		payloads->len[i] = size;
+		//Mostly text, as in HTTP, with some spaces and binary bytes
+		for(j = 0; j < size; j++)
+		{
+			int r = rand() % 16;
+			payloads->data[i][j] = (r == 0)? ' ' : ((r == 1)? (unsigned char)rand() : (unsigned char)random_char());
+		}
+	}
+}
+
+void free_payloads(payloads_t *payloads)
+{
+	unsigned int i;
+	for(i = 0; i < payloads->num; i++)
+		free(payloads->data[i]);
+	free(payloads->data);
+	free(payloads->len);
+}
+
+void run(struct matcher_t *matcher, payloads_t *payloads, const char *description)
+{
+	struct timeval start, end;
+	uint64_t bytes = 0, packets = 0, matches = 0;
+	unsigned int i;
+
+	gettimeofday(&start,NULL);
+	while(bytes < MIN_BYTES_PER_RUN)
+	{
+		for(i = 0; i < payloads->num; i++)
+		{
+			if(matcher_search(matcher,payloads->data[i],payloads->len[i]) >= 0)
+				matches++;
+		}
+		bytes += payloads->total_bytes;
+		packets += payloads->num;
+	}
+	gettimeofday(&end,NULL);
+
+	double seconds = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1000000.0;
+
+	printf("%-24s %6u patterns %6u states  %s  %7.2f Gbps  %7.2f Mpps  (%.1f%% payloads matched)\n",
+		description,matcher->num_patterns,matcher->num_states,(matcher->num_start_bytes != 0)? "prefilter" : "no prefilter",
+		(bytes * 8) / seconds / 1e9,packets / seconds / 1e6,(100.0 * matches) / packets);
+}
+
+int main(int argc, char *argv[])
+{
+	char *pcap_file = NULL, *patterns_file = NULL;
+	unsigned int size = 0, num_patterns = 0;
+	unsigned int s, n;
+	int i;
+
+	for(i = 1; i < argc; i++)
+	{
+		if(strcmp(argv[i],"--r") == 0 && i + 1 < argc)
+			pcap_file = argv[++i];
+		else if(strcmp(argv[i],"--s") == 0 && i + 1 < argc)
+			size = atoi(argv[++i]);
+		else if(strcmp(argv[i],"--f") == 0 && i + 1 < argc)
+			patterns_file = argv[++i];
+		else if(strcmp(argv[i],"--n") == 0 && i + 1 < argc)
+			num_patterns = atoi(argv[++i]);
+		else
+		{
+			usage();
+			return (strcmp(argv[i],"--h") == 0)? 0 : 1;
+		}
+	}
+
+	srand(1);
+
+	//Payloads to be used
+	unsigned int num_sizes = 1;
+	const unsigned int *sizes = &size;
+	if(pcap_file == NULL && size == 0)
+	{
+		sizes = default_sizes;
+		num_sizes = sizeof(default_sizes) / sizeof(default_sizes[0]);
+	}
+
+	//Matchers to be used
+	unsigned int num_matchers = 1;
+	struct matcher_t *matchers[sizeof(default_num_patterns) / sizeof(default_num_patterns[0])];
+	if(patterns_file != NULL)
+		matchers[0] = matcher_create_from_file(patterns_file);
+	else if(num_patterns != 0)
+		matchers[0] = random_matcher(num_patterns);
+	else
+	{
+		num_matchers = sizeof(default_num_patterns) / sizeof(default_num_patterns[0]);
+		for(n = 0; n < num_matchers; n++)
+			matchers[n] = random_matcher(default_num_patterns[n]);
+	}
+
+	for(n = 0; n < num_matchers; n++)
+	{
+		if(matchers[n] == NULL)
+		{
+			fprintf(stderr,"[%s] Unable to build the matcher\n",NAME);
+			return 1;
+		}
+	}
+
+	for(s = 0; s < num_sizes; s++)
+	{
+		payloads_t payloads;
+		char description[64];
+
+		if(pcap_file != NULL)
+		{
+			if(!load_pcap(pcap_file,&payloads))
+				return 1;
+			snprintf(description,sizeof(description),"pcap (%u payloads)",payloads.num);
+		}
+		else
+		{
+			synthetic_payloads(sizes[s],&payloads);
+			snprintf(description,sizeof(description),"%u bytes",sizes[s]);
+		}
+
+		for(n = 0; n < num_matchers; n++)
+			run(matchers[n],&payloads,description);
+
+		free_payloads(&payloads);
+	}
+
+	for(n = 0; n < num_matchers; n++)
+		matcher_destroy(matchers[n]);
+
+	return 0;
+}
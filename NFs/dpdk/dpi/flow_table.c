@@ -0,0 +1,251 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+* @file flow_table.c
+*
+* @brief Hash table of the TCP flows, with a timer wheel for the expiration.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "flow_table.h"
+
+#define TABLE_MASK	(FLOW_TABLE_SIZE - 1)
+
+/**
+*	Private prototypes
+*/
+static void timer_link(struct flow_table_t *table, uint32_t index);
+static void timer_unlink(struct flow_table_t *table, uint32_t index);
+static void timer_relocate(struct flow_table_t *table, uint32_t index);
+
+/**
+*	Implementations
+*/
+
+struct flow_table_t *flow_table_create(void)
+{
+	unsigned int i;
+	void *flows;
+
+	struct flow_table_t *table = (struct flow_table_t*)calloc(1,sizeof(struct flow_table_t));
+	if(table == NULL)
+		return NULL;
+
+	if(posix_memalign(&flows,64,FLOW_TABLE_SIZE * sizeof(struct flow_t)) != 0)
+	{
+		free(table);
+		return NULL;
+	}
+	memset(flows,0,FLOW_TABLE_SIZE * sizeof(struct flow_t));
+	table->flows = (struct flow_t*)flows;
+
+	for(i = 0; i < TIMER_WHEEL_SLOTS; i++)
+		table->wheel[i] = -1;
+
+	return table;
+}
+
+void flow_table_destroy(struct flow_table_t *table)
+{
+	unsigned int i;
+
+	if(table == NULL)
+		return;
+
+	for(i = 0; i < FLOW_TABLE_SIZE; i++)
+	{
+		if(table->flows[i].state != FLOW_EMPTY)
+			flow_free_segments(&table->flows[i]);
+	}
+	free(table->flows);
+	free(table);
+}
+
+uint32_t flow_hash(const struct flow_key_t *key)
+{
+	//Mix of the fields, followed by the finalizer of MurmurHash3
+	uint32_t h = key->src_ip * 0x9E3779B1;
+	h ^= key->dst_ip + 0x7F4A7C15 + (h << 6) + (h >> 2);
+	h ^= (((uint32_t)key->src_port << 16) | key->dst_port) + 0x2545F491 + (h << 6) + (h >> 2);
+
+	h ^= h >> 16;
+	h *= 0x85EBCA6B;
+	h ^= h >> 13;
+	h *= 0xC2B2AE35;
+	h ^= h >> 16;
+
+	return h;
+}
+
+struct flow_t *flow_table_lookup(struct flow_table_t *table, const struct flow_key_t *key, uint32_t hash)
+{
+	uint32_t i = hash & TABLE_MASK;
+
+	while(table->flows[i].state != FLOW_EMPTY)
+	{
+		struct flow_t *flow = &table->flows[i];
+		if(flow->hash == hash && memcmp(&flow->key,key,sizeof(struct flow_key_t)) == 0)
+			return flow;
+		i = (i + 1) & TABLE_MASK;
+	}
+
+	return NULL;
+}
+
+struct flow_t *flow_table_insert(struct flow_table_t *table, const struct flow_key_t *key, uint32_t hash)
+{
+	uint32_t i = hash & TABLE_MASK;
+
+	if(table->num_flows >= FLOW_TABLE_MAX_FLOWS)
+	{
+		table->full++;
+		return NULL;
+	}
+
+	while(table->flows[i].state != FLOW_EMPTY)
+		i = (i + 1) & TABLE_MASK;
+
+	struct flow_t *flow = &table->flows[i];
+	memset(flow,0,sizeof(struct flow_t));
+	flow->key = *key;
+	flow->hash = hash;
+	flow->state = FLOW_INSPECTING;
+	flow->expire = table->now + FLOW_TIMEOUT;
+	timer_link(table,i);
+
+	table->num_flows++;
+	table->inserted++;
+
+	return flow;
+}
+
+void flow_table_touch(struct flow_table_t *table, struct flow_t *flow)
+{
+	//The flow is moved in the right slot only when its current slot is visited
+	flow->expire = table->now + FLOW_TIMEOUT;
+}
+
+void flow_table_remove(struct flow_table_t *table, struct flow_t *flow)
+{
+	uint32_t hole = flow - table->flows;
+	uint32_t i = hole;
+
+	timer_unlink(table,hole);
+	flow_free_segments(flow);
+	flow->state = FLOW_EMPTY;
+	table->num_flows--;
+
+	/**
+	*	Backward shift: the following flows of the cluster are moved in the hole,
+	*	unless this would bring them before their home position
+	*/
+	while(1)
+	{
+		i = (i + 1) & TABLE_MASK;
+		if(table->flows[i].state == FLOW_EMPTY)
+			break;
+
+		uint32_t home = table->flows[i].hash & TABLE_MASK;
+		int stays = (hole <= i)? (hole < home && home <= i) : (hole < home || home <= i);
+		if(stays)
+			continue;
+
+		table->flows[hole] = table->flows[i];
+		timer_relocate(table,hole);
+		table->flows[i].state = FLOW_EMPTY;
+		hole = i;
+	}
+}
+
+void flow_table_expire(struct flow_table_t *table, uint32_t now)
+{
+	if(table->now == 0)
+		table->now = now;
+
+	while(table->now < now)
+	{
+		table->now++;
+		uint32_t slot = table->now % TIMER_WHEEL_SLOTS;
+
+		/**
+		*	Since FLOW_TIMEOUT < TIMER_WHEEL_SLOTS, a flow that did not expire is
+		*	always moved in another slot, and this loop terminates
+		*/
+		while(table->wheel[slot] != -1)
+		{
+			uint32_t index = table->wheel[slot];
+			struct flow_t *flow = &table->flows[index];
+
+			if(flow->expire <= table->now)
+			{
+				table->expired++;
+				flow_table_remove(table,flow);
+			}
+			else
+			{
+				timer_unlink(table,index);
+				timer_link(table,index);
+			}
+		}
+	}
+}
+
+/**
+*	@brief: insert a flow in the slot of its expiration time
+*/
+static void timer_link(struct flow_table_t *table, uint32_t index)
+{
+	struct flow_t *flow = &table->flows[index];
+
+	flow->slot = flow->expire % TIMER_WHEEL_SLOTS;
+	flow->timer_prev = -1;
+	flow->timer_next = table->wheel[flow->slot];
+	if(flow->timer_next != -1)
+		table->flows[flow->timer_next].timer_prev = index;
+	table->wheel[flow->slot] = index;
+}
+
+static void timer_unlink(struct flow_table_t *table, uint32_t index)
+{
+	struct flow_t *flow = &table->flows[index];
+
+	if(flow->timer_prev != -1)
+		table->flows[flow->timer_prev].timer_next = flow->timer_next;
+	else
+		table->wheel[flow->slot] = flow->timer_next;
+
+	if(flow->timer_next != -1)
+		table->flows[flow->timer_next].timer_prev = flow->timer_prev;
+}
+
+/**
+*	@brief: update the timer wheel after a flow has been moved in the table
+*/
+static void timer_relocate(struct flow_table_t *table, uint32_t index)
+{
+	struct flow_t *flow = &table->flows[index];
+
+	if(flow->timer_prev != -1)
+		table->flows[flow->timer_prev].timer_next = index;
+	else
+		table->wheel[flow->slot] = index;
+
+	if(flow->timer_next != -1)
+		table->flows[flow->timer_next].timer_prev = index;
+}
+
+void flow_free_segments(struct flow_t *flow)
+{
+	while(flow->ooo != NULL)
+	{
+		struct ooo_segment_t *next = flow->ooo->next;
+		free(flow->ooo);
+		flow->ooo = next;
+	}
+	flow->num_ooo = 0;
+	flow->ooo_bytes = 0;
+}
@@ -0,0 +1,193 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+* @file flow_table.h
+*
+* @brief Table of the TCP flows inspected by the DPI. The table is an open
+* addressing hash table (linear probing, with backward shift deletion) of
+* cache line sized entries, indexed by the 5-tuple of the flow. Idle flows are
+* removed through a timer wheel, which is advanced once per second.
+*
+* This file does not depend on DPDK.
+*/
+
+#ifndef _FLOW_TABLE_H_
+#define _FLOW_TABLE_H_ 1
+
+#pragma once
+
+#include <inttypes.h>
+
+/**
+*	@brief: number of entries of the table; it must be a power of 2
+*/
+#define FLOW_TABLE_SIZE			65536
+
+/**
+*	@brief: maximum number of flows in the table, to keep the probe sequences short
+*/
+#define FLOW_TABLE_MAX_FLOWS	(FLOW_TABLE_SIZE / 8 * 7)
+
+/**
+*	@brief: seconds after which an idle flow is removed
+*/
+#define FLOW_TIMEOUT			30
+
+/**
+*	@brief: number of slots of the timer wheel (one per second); it must be
+*		greater than FLOW_TIMEOUT
+*/
+#define TIMER_WHEEL_SLOTS		64
+
+typedef enum
+{
+	FLOW_EMPTY = 0,
+	FLOW_INSPECTING,	//The payload of the flow is being inspected
+	FLOW_ALLOWED,		//The flow does not contain forbidden words; its packets are forwarded
+	FLOW_DROPPED		//The flow contains a forbidden word; its packets are dropped
+}flow_state_t;
+
+struct flow_key_t
+{
+	uint32_t src_ip;
+	uint32_t dst_ip;
+	uint16_t src_port;
+	uint16_t dst_port;
+};
+
+/**
+*	@brief: TCP segment received out of order, waiting for the missing data
+*/
+struct ooo_segment_t
+{
+	uint32_t seq;
+	uint32_t len;
+	struct ooo_segment_t *next;
+	unsigned char data[];
+};
+
+struct flow_t
+{
+	struct flow_key_t key;
+	uint32_t hash;
+
+	/**
+	*	@brief: one of flow_state_t
+	*/
+	uint8_t state;
+
+	/**
+	*	@brief: slot of the timer wheel containing the flow
+	*/
+	uint8_t slot;
+
+	/**
+	*	@brief: number of segments (and of bytes) in the out of order queue
+	*/
+	uint16_t num_ooo;
+	uint32_t ooo_bytes;
+
+	/**
+	*	@brief: state of the matcher at the end of the data inspected so far
+	*/
+	int32_t matcher_row;
+
+	/**
+	*	@brief: sequence number of the next byte to be inspected
+	*/
+	uint32_t next_seq;
+
+	/**
+	*	@brief: number of bytes of the stream inspected so far
+	*/
+	uint32_t inspected;
+
+	/**
+	*	@brief: time (in seconds) after which the flow expires
+	*/
+	uint32_t expire;
+
+	/**
+	*	@brief: list of the flows in the same slot of the timer wheel (indexes in the table)
+	*/
+	int32_t timer_prev;
+	int32_t timer_next;
+
+	/**
+	*	@brief: out of order segments, sorted by sequence number
+	*/
+	struct ooo_segment_t *ooo;
+} __attribute__((aligned(64)));
+
+struct flow_table_t
+{
+	struct flow_t *flows;
+	uint32_t num_flows;
+
+	/**
+	*	@brief: first flow of each slot of the timer wheel, or -1
+	*/
+	int32_t wheel[TIMER_WHEEL_SLOTS];
+
+	/**
+	*	@brief: current time of the table (in seconds)
+	*/
+	uint32_t now;
+
+	/**
+	*	@brief: statistics
+	*/
+	uint64_t inserted;
+	uint64_t expired;
+	uint64_t full;
+};
+
+/**
+*	@brief: create an empty flow table
+*
+*	@return: the table, or NULL in case of error
+*/
+struct flow_table_t *flow_table_create(void);
+
+void flow_table_destroy(struct flow_table_t *table);
+
+uint32_t flow_hash(const struct flow_key_t *key);
+
+/**
+*	@brief: return the flow with the given key, or NULL. The pointer is valid
+*		until a flow is removed from the table
+*/
+struct flow_t *flow_table_lookup(struct flow_table_t *table, const struct flow_key_t *key, uint32_t hash);
+
+/**
+*	@brief: insert a new flow, in state FLOW_INSPECTING
+*
+*	@return: the new flow, or NULL if the table is full
+*/
+struct flow_t *flow_table_insert(struct flow_table_t *table, const struct flow_key_t *key, uint32_t hash);
+
+/**
+*	@brief: postpone the expiration of a flow that received a packet
+*/
+void flow_table_touch(struct flow_table_t *table, struct flow_t *flow);
+
+/**
+*	@brief: remove a flow from the table, and release its out of order segments
+*/
+void flow_table_remove(struct flow_table_t *table, struct flow_t *flow);
+
+/**
+*	@brief: release the out of order segments of a flow
+*/
+void flow_free_segments(struct flow_t *flow);
+
+/**
+*	@brief: advance the clock of the table, and remove the flows that expired
+*
+*	@param: now	Current time, in seconds
+*/
+void flow_table_expire(struct flow_table_t *table, uint32_t now);
+
+#endif //_FLOW_TABLE_H_
@@ -8,8 +8,10 @@
 *
 * @brief This NF implements a DPI on packets coming from its first interface.
 * It works with two interfaces, and implements a bridge between them.
-* By default, it drops the HTTP packets containing the words "porn" and "sex". 
-* You can add other words by exiting the file "runtime.c"
+* By default, it drops the HTTP flows containing the words "porn" and "sex". 
+* Other words can be provided through a file (option --f).
+* The payload of each flow is inspected as a stream (see stream.h), and each
+* flow is classified only once.
 */
 
 #ifndef _MAIN_H_
@@ -17,23 +19,20 @@
 
 #pragma once
 
-#ifdef ENABLE_SEMAPHORE
-	#include <semaphore.h>
-#endif	
-	
-#include <fcntl.h>
-#include <unistd.h>
-#include <stdio.h>
-
-#include <pcre.h>
+#include "nf.h"
+#include "matcher.h"
+#include "flow_table.h"
+#include "stream.h"
 
 #define NAME 					"DPI"
-#define PKT_TO_NF_THRESHOLD 	200
-#define NAME_LENGTH				100
 
 #define NUM_PORTS 				2
 
-#define OVECTSIZE 				15
+/**
+*	Forbidden words used when no file is provided
+*/
+#define DEFAULT_PATTERNS		{"porn", "sex"}
+#define NUM_DEFAULT_PATTERNS	2
 
 /**
 *	Constants used to parse the packet
@@ -42,84 +41,39 @@
 #define ETH_TYPE_IP					0x800
 #define IP_POSITION					14
 #define IP_PROTOCOL_POSITION		9
+#define IP_SRC_POSITION			12
+#define IP_DST_POSITION			16
 #define IP_HLEN_POSITION		0
 #define IP_PROTOCOL_TCP			6
+#define TCP_SRC_PORT_POSITION		0
 #define TCP_DST_PORT_POSITION		2
+#define TCP_SEQ_POSITION		4
 #define TCP_DST_PORT_HTTP		80
 #define TCP_DATA_OFFSET_POSITION	12
+#define TCP_FLAGS_POSITION		13
 
-extern FILE *logFile;
-
-typedef struct mbuf_array
+struct nf_params_t
 {
 	/**
-	*	@brief: packets received / to be sent
-	*/
-	struct rte_mbuf *array[PKT_TO_NF_THRESHOLD];
-	
-	/**
-	*	@brief: number of packets received / to be sent
-	*/
-	int n_mbufs;
-}mbuf_array_t;
-
-struct nf_port_t
-{
-	/**
-	*	@brief: queue used to receive packets
-	*/
-	struct rte_ring *to_nf_queue;
-	
-	/**
-	*	@brief: queue used to transmit packets
-	*/
-	struct rte_ring *to_xdpd_queue;
-	
-	/**
-	*	@brief: name of the port
-	*/
-	char *name;
-};// __rte_cache_aligned;
-
-struct nf_params_t 
-{	
-	/**
-	*	@brief: ports to be used to transmit/receive packets
+	*	@brief: file containing the forbidden words (option --f), or NULL
 	*/
-	struct nf_port_t *ports;
+	char *patterns_file;
 
-#ifdef ENABLE_SEMAPHORE
 	/**
-	*	@brief: name of the semaphore
+	*	@brief: matcher of the forbidden words in HTTP packets
 	*/
-	char *sem_name;
-
-	/**
-	*	@brief: semaphore used to implement a blocking model
-	*		and save CPU resources
-	*/
-	sem_t *semaphore;
-#endif
-	
-	/* mbuf pools */
-	//FIXME: currently it is not used - to be linked to the pool 
-	//used by xDPD in order to create new packets
-	struct rte_mempool *pool;
- 
-} __rte_cache_aligned;
+	struct matcher_t *matcher;
+};
 
 /**
 *	@brief: parameters used by the NF to work
 */
-struct nf_params_t nf_params;
-
-int do_nf(void*);
-
-#ifdef RTE_EXEC_ENV_BAREMETAL
-	#define MAIN _main
-#else
-	#define MAIN main
-#endif
+extern struct nf_params_t nf_params;
 
+int parse_option(const char *name, const char *arg);
+int init(void);
+void *init_worker(unsigned int worker_id);
+void process(struct rte_mbuf **pkts, unsigned int n, unsigned int in_port, struct nf_output_t *out, void *state);
+void poll_flows(void *state);
 
 #endif /* _MAIN_H_ */
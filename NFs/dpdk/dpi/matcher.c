@@ -0,0 +1,434 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+* @file matcher.c
+*
+* @brief Aho-Corasick multi-pattern matcher.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#if defined(__SSSE3__)
+	#include <tmmintrin.h>
+#elif defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
+
+#include "matcher.h"
+
+/**
+*	Private prototypes
+*/
+static int search_dfa(const struct matcher_t *matcher, int32_t *state, const unsigned char *data, unsigned int len);
+#if defined(__SSSE3__) || defined(__SSE2__)
+static int search_prefiltered(const struct matcher_t *matcher, int32_t *state, const unsigned char *data, unsigned int len);
+#endif
+static int add_state(struct matcher_t *matcher, unsigned int *capacity);
+static int build_automaton(struct matcher_t *matcher);
+static void build_prefilter(struct matcher_t *matcher);
+
+/**
+*	Implementations
+*/
+
+struct matcher_t *matcher_create(const char **patterns, unsigned int num_patterns)
+{
+	unsigned int i, j;
+
+	if(num_patterns == 0)
+		return NULL;
+
+	struct matcher_t *matcher = (struct matcher_t*)calloc(1,sizeof(struct matcher_t));
+	if(matcher == NULL)
+		return NULL;
+
+	matcher->patterns = (char**)calloc(num_patterns,sizeof(char*));
+	if(matcher->patterns == NULL)
+	{
+		free(matcher);
+		return NULL;
+	}
+
+	for(i = 0; i < num_patterns; i++)
+	{
+		if(strlen(patterns[i]) == 0)
+		{
+			fprintf(stderr,"[matcher] Empty patterns are not allowed\n");
+			matcher_destroy(matcher);
+			return NULL;
+		}
+		matcher->patterns[i] = strdup(patterns[i]);
+		matcher->num_patterns++;
+	}
+
+	//Build the equivalence classes of the bytes; class 0 is for bytes not used in the patterns
+	matcher->num_classes = 1;
+	for(i = 0; i < num_patterns; i++)
+	{
+		for(j = 0; patterns[i][j] != '\0'; j++)
+		{
+			unsigned char c = tolower((unsigned char)patterns[i][j]);
+			if(matcher->class_of[c] != 0)
+				continue;
+			if(matcher->num_classes == 256)
+			{
+				fprintf(stderr,"[matcher] Too many different characters in the patterns\n");
+				matcher_destroy(matcher);
+				return NULL;
+			}
+			matcher->class_of[c] = matcher->num_classes;
+			matcher->class_of[toupper(c)] = matcher->num_classes;
+			matcher->num_classes++;
+		}
+	}
+
+	if(!build_automaton(matcher))
+	{
+		matcher_destroy(matcher);
+		return NULL;
+	}
+
+	build_prefilter(matcher);
+
+	return matcher;
+}
+
+struct matcher_t *matcher_create_from_file(const char *file_name)
+{
+	//Room for the pattern, "\r\n" and the terminator
+	char line[MATCHER_MAX_PATTERN_LENGTH + 3];
+	char **patterns = NULL;
+	unsigned int num_patterns = 0, capacity = 0, line_number = 0, i;
+	int too_long = 0;
+
+	FILE *file = fopen(file_name,"r");
+	if(file == NULL)
+	{
+		fprintf(stderr,"[matcher] Cannot open file '%s'\n",file_name);
+		return NULL;
+	}
+
+	while(fgets(line,sizeof(line),file) != NULL)
+	{
+		size_t len = strlen(line);
+		line_number++;
+
+		//fgets splits a longer line, whose pieces would become different patterns
+		if(len > 0 && line[len-1] != '\n' && !feof(file))
+		{
+			too_long = 1;
+			break;
+		}
+
+		while(len > 0 && (line[len-1] == '\n' || line[len-1] == '\r'))
+			line[--len] = '\0';
+
+		if(len > MATCHER_MAX_PATTERN_LENGTH)
+		{
+			too_long = 1;
+			break;
+		}
+
+		if(len == 0 || line[0] == '#')
+			continue;
+
+		if(num_patterns == capacity)
+		{
+			capacity = (capacity == 0)? 16 : capacity * 2;
+			patterns = (char**)realloc(patterns,capacity * sizeof(char*));
+		}
+		patterns[num_patterns++] = strdup(line);
+	}
+	fclose(file);
+
+	struct matcher_t *matcher = NULL;
+	if(too_long)
+		fprintf(stderr,"[matcher] Line %u of file '%s' is longer than %d characters\n",line_number,file_name,MATCHER_MAX_PATTERN_LENGTH);
+	else
+		matcher = matcher_create((const char**)patterns,num_patterns);
+
+	for(i = 0; i < num_patterns; i++)
+		free(patterns[i]);
+	free(patterns);
+
+	return matcher;
+}
+
+int matcher_search(const struct matcher_t *matcher, const unsigned char *data, unsigned int len)
+{
+	int32_t row = 0;
+	return matcher_search_stream(matcher,&row,data,len);
+}
+
+int matcher_search_stream(const struct matcher_t *matcher, int32_t *row, const unsigned char *data, unsigned int len)
+{
+#if defined(__SSSE3__) || defined(__SSE2__)
+	if(matcher->num_start_bytes != 0)
+		return search_prefiltered(matcher,row,data,len);
+#endif
+	return search_dfa(matcher,row,data,len);
+}
+
+const char *matcher_get_pattern(const struct matcher_t *matcher, int index)
+{
+	if(index < 0 || (unsigned int)index >= matcher->num_patterns)
+		return NULL;
+	return matcher->patterns[index];
+}
+
+void matcher_destroy(struct matcher_t *matcher)
+{
+	unsigned int i;
+
+	if(matcher == NULL)
+		return;
+
+	for(i = 0; i < matcher->num_patterns; i++)
+		free(matcher->patterns[i]);
+	free(matcher->patterns);
+	free(matcher->delta);
+	free(matcher->output);
+	free(matcher);
+}
+
+/**
+*	@brief: scan the buffer with the DFA only
+*/
+static int search_dfa(const struct matcher_t *matcher, int32_t *state, const unsigned char *data, unsigned int len)
+{
+	unsigned int i;
+	int32_t row = *state;
+
+	for(i = 0; i < len; i++)
+	{
+		row = matcher->delta[row + matcher->class_of[data[i]]];
+		if(row < 0)
+			return matcher->output[-row - 1];
+	}
+
+	*state = row;
+	return -1;
+}
+
+#if defined(__SSSE3__) || defined(__SSE2__)
+/**
+*	@brief: scan the buffer with the DFA; in the root state, skip the blocks of
+*		16 bytes that do not contain any byte that could start a match
+*/
+static int search_prefiltered(const struct matcher_t *matcher, int32_t *state, const unsigned char *data, unsigned int len)
+{
+	unsigned int i = 0;
+	int32_t row = *state;
+
+#if defined(__SSSE3__)
+	const __m128i lo_table = _mm_loadu_si128((const __m128i*)matcher->start_lo);
+	const __m128i hi_table = _mm_loadu_si128((const __m128i*)matcher->start_hi);
+	const __m128i nibble_mask = _mm_set1_epi8(0x0f);
+	const __m128i zero = _mm_setzero_si128();
+#else
+	unsigned int k;
+	__m128i start[MATCHER_PREFILTER_MAX_BYTES];
+	for(k = 0; k < matcher->num_start_bytes; k++)
+		start[k] = _mm_set1_epi8((char)matcher->start_bytes[k]);
+#endif
+
+	while(i < len)
+	{
+		if(row == 0)
+		{
+			while(i + 16 <= len)
+			{
+				__m128i block = _mm_loadu_si128((const __m128i*)&data[i]);
+#if defined(__SSSE3__)
+				__m128i lo = _mm_and_si128(block,nibble_mask);
+				__m128i hi = _mm_and_si128(_mm_srli_epi16(block,4),nibble_mask);
+				__m128i candidates = _mm_and_si128(_mm_shuffle_epi8(lo_table,lo),_mm_shuffle_epi8(hi_table,hi));
+				int bits = ~_mm_movemask_epi8(_mm_cmpeq_epi8(candidates,zero)) & 0xffff;
+#else
+				__m128i eq = _mm_cmpeq_epi8(block,start[0]);
+				for(k = 1; k < matcher->num_start_bytes; k++)
+					eq = _mm_or_si128(eq,_mm_cmpeq_epi8(block,start[k]));
+				int bits = _mm_movemask_epi8(eq);
+#endif
+				if(bits != 0)
+				{
+					i += __builtin_ctz(bits);
+					break;
+				}
+				i += 16;
+			}
+			if(i >= len)
+				break;
+		}
+
+		row = matcher->delta[row + matcher->class_of[data[i]]];
+		if(row < 0)
+			return matcher->output[-row - 1];
+		i++;
+	}
+
+	*state = row;
+	return -1;
+}
+#endif
+
+/**
+*	@brief: add a new state to the automaton, with all the transitions undefined (-1)
+*
+*	@return: the new state, or -1 in case of error
+*/
+static int add_state(struct matcher_t *matcher, unsigned int *capacity)
+{
+	unsigned int c;
+
+	if(matcher->num_states == *capacity)
+	{
+		unsigned int new_capacity = (*capacity == 0)? 64 : *capacity * 2;
+		int32_t *delta = (int32_t*)realloc(matcher->delta,(size_t)new_capacity * matcher->num_classes * sizeof(int32_t));
+		int32_t *output = (int32_t*)realloc(matcher->output,(size_t)new_capacity * sizeof(int32_t));
+		if(delta != NULL)
+			matcher->delta = delta;
+		if(output != NULL)
+			matcher->output = output;
+		if(delta == NULL || output == NULL)
+			return -1;
+		*capacity = new_capacity;
+	}
+
+	for(c = 0; c < matcher->num_classes; c++)
+		matcher->delta[matcher->num_states * matcher->num_classes + c] = -1;
+	matcher->output[matcher->num_states] = -1;
+
+	return matcher->num_states++;
+}
+
+/**
+*	@brief: build the trie of the patterns, and then turn it into a DFA by
+*		computing the failure links in breadth-first order
+*/
+static int build_automaton(struct matcher_t *matcher)
+{
+	unsigned int capacity = 0, i, j, c;
+	unsigned int nc;
+	int32_t *fail, *queue;
+	unsigned int head = 0, tail = 0;
+
+	nc = matcher->num_classes;
+
+	if(add_state(matcher,&capacity) < 0)
+		return 0;
+
+	//1) Trie
+	for(i = 0; i < matcher->num_patterns; i++)
+	{
+		int32_t state = 0;
+		for(j = 0; matcher->patterns[i][j] != '\0'; j++)
+		{
+			unsigned int cl = matcher->class_of[(unsigned char)matcher->patterns[i][j]];
+			if(matcher->delta[state * nc + cl] < 0)
+			{
+				int32_t new_state = add_state(matcher,&capacity);
+				if(new_state < 0)
+					return 0;
+				matcher->delta[state * nc + cl] = new_state;
+			}
+			state = matcher->delta[state * nc + cl];
+		}
+		if(matcher->output[state] < 0)
+			matcher->output[state] = i;
+	}
+
+	//2) Failure links and complete transition function
+	fail = (int32_t*)malloc(matcher->num_states * sizeof(int32_t));
+	queue = (int32_t*)malloc(matcher->num_states * sizeof(int32_t));
+	if(fail == NULL || queue == NULL)
+	{
+		free(fail);
+		free(queue);
+		return 0;
+	}
+
+	fail[0] = 0;
+	for(c = 0; c < nc; c++)
+	{
+		int32_t next = matcher->delta[c];
+		if(next < 0)
+			matcher->delta[c] = 0;
+		else
+		{
+			fail[next] = 0;
+			queue[tail++] = next;
+		}
+	}
+
+	while(head < tail)
+	{
+		int32_t state = queue[head++];
+
+		//A state also matches the patterns matched by its failure state
+		if(matcher->output[state] < 0)
+			matcher->output[state] = matcher->output[fail[state]];
+
+		for(c = 0; c < nc; c++)
+		{
+			int32_t next = matcher->delta[state * nc + c];
+			if(next < 0)
+				matcher->delta[state * nc + c] = matcher->delta[fail[state] * nc + c];
+			else
+			{
+				fail[next] = matcher->delta[fail[state] * nc + c];
+				queue[tail++] = next;
+			}
+		}
+	}
+
+	free(fail);
+	free(queue);
+
+	//3) Store the transitions as offsets of the rows of the next states, so that no multiplication is
+	//needed while scanning. Transitions towards states matching a pattern are stored as -(state + 1)
+	for(i = 0; i < matcher->num_states * nc; i++)
+	{
+		int32_t next = matcher->delta[i];
+		matcher->delta[i] = (matcher->output[next] >= 0)? -(next + 1) : next * (int32_t)nc;
+	}
+
+	return 1;
+}
+
+/**
+*	@brief: collect the bytes that make the DFA leave the root state, and build
+*		the nibble tables used to check them. If they are too many, the prefilter
+*		is not used
+*/
+static void build_prefilter(struct matcher_t *matcher)
+{
+	unsigned int b;
+
+	matcher->num_start_bytes = 0;
+	memset(matcher->start_lo,0,sizeof(matcher->start_lo));
+	memset(matcher->start_hi,0,sizeof(matcher->start_hi));
+
+	for(b = 0; b < 256; b++)
+	{
+		if(matcher->delta[matcher->class_of[b]] == 0)
+			continue;
+
+		if(matcher->num_start_bytes == MATCHER_PREFILTER_MAX_BYTES)
+		{
+			matcher->num_start_bytes = 0;
+			return;
+		}
+		matcher->start_bytes[matcher->num_start_bytes++] = (uint8_t)b;
+
+		//Each high nibble is assigned to one of 8 groups
+		uint8_t group = 1 << ((b >> 4) & 0x7);
+		matcher->start_lo[b & 0xf] |= group;
+		matcher->start_hi[b >> 4] |= group;
+	}
+}
@@ -0,0 +1,132 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+* @file matcher.h
+*
+* @brief Multi-pattern (case insensitive) string matcher, based on the
+* Aho-Corasick algorithm. The patterns are compiled once in a DFA, so that
+* a payload is scanned in a single pass, independently of the number of
+* patterns. In the root state of the DFA, the bytes that cannot start a match
+* are skipped 16 at a time through SIMD instructions: the set of the bytes
+* starting a pattern is checked with two nibble lookups (pshufb) when SSSE3
+* is available, or with one comparison per byte of the set with SSE2.
+*
+* This file does not depend on DPDK, so that it can be used by the benchmark
+* as well.
+*/
+
+#ifndef _MATCHER_H_
+#define _MATCHER_H_ 1
+
+#pragma once
+
+#include <inttypes.h>
+
+/**
+*	@brief: maximum length of a line in the file of patterns
+*/
+#define MATCHER_MAX_PATTERN_LENGTH		256
+
+/**
+*	@brief: the SIMD prefilter is used only if the patterns start with at most
+*		this number of different bytes (both cases of a letter are counted).
+*		With more start bytes, most of the blocks of text contain a candidate, and
+*		the prefilter is slower than the DFA alone (see bench/matcher_bench)
+*/
+#define MATCHER_PREFILTER_MAX_BYTES		8
+
+struct matcher_t
+{
+	/**
+	*	@brief: patterns recognized by the matcher
+	*/
+	char **patterns;
+	unsigned int num_patterns;
+
+	/**
+	*	@brief: the bytes are mapped on equivalence classes, so that the DFA only
+	*		has a column for each (case insensitive) character used by the patterns.
+	*		Class 0 groups all the other characters
+	*/
+	uint8_t class_of[256];
+	unsigned int num_classes;
+
+	/**
+	*	@brief: transitions of the DFA, one row of num_classes entries for each state.
+	*		The transition from the row r with the byte c is delta[r + class_of[c]]; if
+	*		non negative, it is the offset of the row of the next state, otherwise the next
+	*		state s (whose row is s * num_classes) matches a pattern and the value is -(s + 1).
+	*		State 0 is the root
+	*/
+	int32_t *delta;
+	unsigned int num_states;
+
+	/**
+	*	@brief: for each state, the index of a pattern matched when the state is
+	*		reached, or -1
+	*/
+	int32_t *output;
+
+	/**
+	*	@brief: bytes that make the DFA leave the root state; used by the prefilter.
+	*		The prefilter is disabled if num_start_bytes is 0
+	*/
+	uint8_t start_bytes[MATCHER_PREFILTER_MAX_BYTES];
+	unsigned int num_start_bytes;
+
+	/**
+	*	@brief: the byte b belongs to the start bytes if
+	*		(start_lo[b & 0xf] & start_hi[b >> 4]) != 0
+	*		Each bit identifies a group of high nibbles, so false positives are possible
+	*		when there are more than 8 different high nibbles.
+	*/
+	uint8_t start_lo[16];
+	uint8_t start_hi[16];
+};
+
+/**
+*	@brief: build a matcher recognizing the given patterns
+*
+*	@param: patterns		Array of (non-empty) patterns
+*	@param: num_patterns	Number of patterns
+*	@return: the matcher, or NULL in case of error
+*/
+struct matcher_t *matcher_create(const char **patterns, unsigned int num_patterns);
+
+/**
+*	@brief: build a matcher recognizing the patterns written in a file, one per
+*		line. Empty lines and lines starting with '#' are ignored. A line longer
+*		than MATCHER_MAX_PATTERN_LENGTH is an error.
+*
+*	@return: the matcher, or NULL in case of error
+*/
+struct matcher_t *matcher_create_from_file(const char *file_name);
+
+/**
+*	@brief: scan a buffer
+*
+*	@return: the index of the first pattern found in the buffer, or -1
+*/
+int matcher_search(const struct matcher_t *matcher, const unsigned char *data, unsigned int len);
+
+/**
+*	@brief: scan a buffer that continues a stream (e.g., a TCP segment). The state of
+*		the automaton is carried from a call to the next one, so that a pattern split
+*		across two buffers is found as well.
+*
+*	@param: row		State of the automaton; it must be 0 at the beginning of the stream,
+*					and it is updated if no pattern is found
+*	@return: the index of the first pattern found in the buffer, or -1
+*/
+int matcher_search_stream(const struct matcher_t *matcher, int32_t *row, const unsigned char *data, unsigned int len);
+
+/**
+*	@brief: return the pattern with a given index
+*/
+const char *matcher_get_pattern(const struct matcher_t *matcher, int index);
+
+void matcher_destroy(struct matcher_t *matcher);
+
+#endif //_MATCHER_H_
@@ -0,0 +1,181 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+* @file stream.c
+*
+* @brief Bounded reassembly and inspection of the TCP streams.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "stream.h"
+
+/**
+*	@brief: comparison of sequence numbers, taking into account the wrap around
+*/
+#define SEQ_DIFF(a,b)	((int32_t)((a) - (b)))
+
+/**
+*	Private prototypes
+*/
+static int inspect(struct flow_t *flow, const struct matcher_t *matcher, const unsigned char *data, uint32_t len, int *pattern);
+static int enqueue(struct flow_t *flow, uint32_t seq, const unsigned char *data, uint32_t len);
+static int drain(struct flow_t *flow, const struct matcher_t *matcher, int *pattern);
+static void allow(struct flow_t *flow);
+
+/**
+*	Implementations
+*/
+
+void stream_init(struct flow_t *flow, uint32_t seq, uint8_t flags)
+{
+	//A flow seen for the first time in the middle of the connection is inspected
+	//from the current segment
+	flow->next_seq = (flags & TCP_FLAG_SYN)? seq + 1 : seq;
+	flow->matcher_row = 0;
+	flow->inspected = 0;
+}
+
+int stream_process(struct flow_t *flow, const struct matcher_t *matcher, uint32_t seq, uint8_t flags, const unsigned char *payload, uint32_t len, int *pattern)
+{
+	if(flow->state == FLOW_DROPPED)
+		return 1;
+	if(flow->state == FLOW_ALLOWED)
+		return 0;
+
+	if(flags & TCP_FLAG_SYN)
+	{
+		//The SYN consumes a sequence number
+		seq++;
+		if(flow->inspected == 0 && flow->ooo == NULL)
+			flow->next_seq = seq;
+	}
+
+	if(len == 0)
+		return 0;
+
+	int32_t diff = SEQ_DIFF(seq,flow->next_seq);
+	if(diff > 0)
+	{
+		//Some data is missing: the segment is forwarded, and inspected later
+		if(!enqueue(flow,seq,payload,len))
+			allow(flow);
+		return 0;
+	}
+
+	if(diff < 0)
+	{
+		//Retransmission: only the new data (if any) is inspected
+		if((uint32_t)(-diff) >= len)
+			return 0;
+		payload += -diff;
+		len -= -diff;
+	}
+
+	if(inspect(flow,matcher,payload,len,pattern))
+		return 1;
+
+	if(flow->ooo != NULL && drain(flow,matcher,pattern))
+	{
+		//The forbidden word was in segments already forwarded; the flow is
+		//dropped from the segment that completed it
+		return 1;
+	}
+
+	if(flow->inspected >= INSPECTION_DEPTH)
+		allow(flow);
+
+	return 0;
+}
+
+/**
+*	@brief: give in order data to the matcher
+*
+*	@return: 1 if a forbidden word has been found
+*/
+static int inspect(struct flow_t *flow, const struct matcher_t *matcher, const unsigned char *data, uint32_t len, int *pattern)
+{
+	*pattern = matcher_search_stream(matcher,&flow->matcher_row,data,len);
+	if(*pattern >= 0)
+	{
+		flow->state = FLOW_DROPPED;
+		flow_free_segments(flow);
+		return 1;
+	}
+
+	flow->next_seq += len;
+	flow->inspected += len;
+	return 0;
+}
+
+/**
+*	@brief: copy a segment in the out of order queue
+*
+*	@return: 0 if the queue is full
+*/
+static int enqueue(struct flow_t *flow, uint32_t seq, const unsigned char *data, uint32_t len)
+{
+	struct ooo_segment_t **prev = &flow->ooo;
+
+	while(*prev != NULL && SEQ_DIFF((*prev)->seq,seq) < 0)
+		prev = &(*prev)->next;
+
+	if(*prev != NULL && (*prev)->seq == seq && (*prev)->len >= len)
+		//Retransmission of a segment already queued
+		return 1;
+
+	if(flow->num_ooo >= MAX_OOO_SEGMENTS || flow->ooo_bytes + len > MAX_OOO_BYTES)
+		return 0;
+
+	struct ooo_segment_t *segment = (struct ooo_segment_t*)malloc(sizeof(struct ooo_segment_t) + len);
+	if(segment == NULL)
+		return 0;
+
+	segment->seq = seq;
+	segment->len = len;
+	memcpy(segment->data,data,len);
+	segment->next = *prev;
+	*prev = segment;
+
+	flow->num_ooo++;
+	flow->ooo_bytes += len;
+
+	return 1;
+}
+
+/**
+*	@brief: inspect the queued segments that are now in sequence
+*
+*	@return: 1 if a forbidden word has been found
+*/
+static int drain(struct flow_t *flow, const struct matcher_t *matcher, int *pattern)
+{
+	while(flow->ooo != NULL && SEQ_DIFF(flow->ooo->seq,flow->next_seq) <= 0)
+	{
+		struct ooo_segment_t *segment = flow->ooo;
+		uint32_t overlap = flow->next_seq - segment->seq;
+
+		flow->ooo = segment->next;
+		flow->num_ooo--;
+		flow->ooo_bytes -= segment->len;
+
+		int found = (overlap < segment->len) && inspect(flow,matcher,&segment->data[overlap],segment->len - overlap,pattern);
+		free(segment);
+		if(found)
+			return 1;
+	}
+
+	return 0;
+}
+
+/**
+*	@brief: stop the inspection of a flow
+*/
+static void allow(struct flow_t *flow)
+{
+	flow->state = FLOW_ALLOWED;
+	flow_free_segments(flow);
+}
@@ -0,0 +1,62 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+* @file stream.h
+*
+* @brief Inspection of the payload of a TCP flow as a stream. The segments are
+* given to the matcher in sequence order, and the state of the matcher is kept
+* between segments, so that a forbidden word split across two segments is
+* found. Segments received out of order are copied in a bounded queue, and
+* inspected when the missing data arrives; the packets are never delayed.
+*
+* When a forbidden word is found, the flow is dropped. When INSPECTION_DEPTH
+* bytes have been inspected without any match, or when the out of order queue
+* overflows, the flow is allowed and its packets are no longer inspected.
+*
+* This file does not depend on DPDK.
+*/
+
+#ifndef _STREAM_H_
+#define _STREAM_H_ 1
+
+#pragma once
+
+#include <inttypes.h>
+
+#include "flow_table.h"
+#include "matcher.h"
+
+/**
+*	@brief: number of bytes of a stream inspected before allowing it
+*/
+#define INSPECTION_DEPTH		16384
+
+/**
+*	@brief: limits of the out of order queue of a flow
+*/
+#define MAX_OOO_SEGMENTS		8
+#define MAX_OOO_BYTES			16384
+
+#define TCP_FLAG_FIN			0x01
+#define TCP_FLAG_SYN			0x02
+#define TCP_FLAG_RST			0x04
+
+/**
+*	@brief: initialize the stream of a flow just inserted in the flow table
+*
+*	@param: seq		Sequence number of the first packet of the flow
+*	@param: flags	TCP flags of the first packet of the flow
+*/
+void stream_init(struct flow_t *flow, uint32_t seq, uint8_t flags);
+
+/**
+*	@brief: process a segment of a flow
+*
+*	@param: pattern	Set to the index of the forbidden word found, if any
+*	@return: 1 if the packet must be dropped, 0 otherwise
+*/
+int stream_process(struct flow_t *flow, const struct matcher_t *matcher, uint32_t seq, uint8_t flags, const unsigned char *payload, uint32_t len, int *pattern);
+
+#endif //_STREAM_H_
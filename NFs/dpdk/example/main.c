@@ -1,44 +1,145 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+* @file main.c
+* @author Ivano Cerrato<ivano.cerrato (at) polito.it>
+*
+* @brief Simple NF: each packet gets a new destination MAC address, and is sent
+* on the port following the one it has been received from.
+*
+* The NF is the reference for the overhead of the ports of xDPd: the destination
+* MAC addresses of a batch are rewritten with SSE2 loads and stores, the packets
+* of a batch are sent together (they have the same output port), and they are
+* buffered until they can be sent to xDPd in large bursts (see TX_THRESHOLD). The
+* framework prefetches the packets of the next batch while a batch is processed.
+*/
+
 #include "main.h"
-#include "init.h"
 
-int MAIN(int argc, char *argv[])
+/**
+*	@brief: output port of the packets received from each port
+*/
+static unsigned int *output_port;
+
+/**
+*	@brief: the new destination MAC address, and the mask of the bytes of the first
+*		16 bytes of the packet that are not modified
+*/
+static __m128i new_dst;
+static __m128i keep_mask;
+
+/**
+*	Private prototypes
+*/
+int init(void);
+void process(struct rte_mbuf **pkts, unsigned int n, unsigned int in_port, struct nf_output_t *out, void *state);
+void rewrite(struct rte_mbuf *pkt);
+
+/**
+*	Implementations
+*/
+
+int init(void)
 {
+	unsigned int p;
+	const uint8_t mac[6] = NEW_DST_MAC;
+	uint8_t dst[16], mask[16];
+
+	output_port = (unsigned int*)malloc(nf_num_ports() * sizeof(unsigned int));
+	if(output_port == NULL)
+		return -1;
+	for(p = 0; p < nf_num_ports(); p++)
+		output_port[p] = (p + 1) % nf_num_ports();
+
+	memset(dst,0,sizeof(dst));
+	memset(mask,0xFF,sizeof(mask));
+	memcpy(dst,mac,sizeof(mac));
+	memset(mask,0,sizeof(mac));
+	new_dst = _mm_loadu_si128((const __m128i*)dst);
+	keep_mask = _mm_loadu_si128((const __m128i*)mask);
+
+	return 0;
+}
+
+/**
+*	@brief: rewrite the destination MAC address of a packet shorter than 16 bytes
+*/
+void rewrite(struct rte_mbuf *pkt)
+{
+	const uint8_t mac[6] = NEW_DST_MAC;
+	unsigned int len = rte_pktmbuf_data_len(pkt);
+
+	memcpy(rte_pktmbuf_mtod(pkt,unsigned char *),mac,(len < sizeof(mac))? len : sizeof(mac));
+}
 
-	//Check for root privileges 
-	if(geteuid() != 0)
+void process(struct rte_mbuf **pkts, unsigned int n, unsigned int in_port, struct nf_output_t *out, void *state)
+{
+	(void) state; //XXX: this line suppresses the "unused-parameter" error
+
+	unsigned int i, j;
+	__m128i hdr[REWRITE_UNROLL];
+
+#ifdef ENABLE_LOG
+	for (i=0;i < n;i++)
 	{
-		fprintf(stderr,"[%s] Root permissions are required to run %s\n",NAME,argv[0]);	
-		exit(EXIT_FAILURE);	
+		unsigned char *pkt = rte_pktmbuf_mtod(pkts[i],unsigned char *);
+		fprintf(logFile,"[%s] Packet size: %d\n",NAME,rte_pktmbuf_pkt_len(pkts[i]));
+		fprintf(logFile,"[%s] %.2x:%.2x:%.2x:%.2x:%.2x:%.2x -> %.2x:%.2x:%.2x:%.2x:%.2x:%.2x\n",NAME,pkt[6],pkt[7],pkt[8],pkt[9],pkt[10],pkt[11],pkt[0],pkt[1],pkt[2],pkt[3],pkt[4],pkt[5]);
 	}
+#endif
 
-	uint32_t lcore;
-	int ret;
+	//Change the destination MAC address of packets: the first 16 bytes of REWRITE_UNROLL
+	//packets are loaded, merged with the new address, and stored back
+	for (i=0;i + REWRITE_UNROLL <= n;i += REWRITE_UNROLL)
+	{
+		int short_pkt = 0;
+		for(j = 0; j < REWRITE_UNROLL; j++)
+			short_pkt |= (rte_pktmbuf_data_len(pkts[i + j]) < sizeof(__m128i));
 
-	/* Init EAL */
-	ret = rte_eal_init(argc, argv);
-	
-	fflush(stdout);
-	if (ret < 0)
-		return -1;
-	argc -= ret;
-	argv += ret;
+		if(unlikely(short_pkt))
+		{
+			for(j = 0; j < REWRITE_UNROLL; j++)
+				rewrite(pkts[i + j]);
+			continue;
+		}
 
-	if(init(argc, argv) < 0)
-		return -1;
-		
-	fprintf(logFile,"[%s] Network function started!\n",NAME);
-
-	rte_eal_mp_remote_launch(do_nf, NULL, CALL_MASTER);
-	
-	//In this version, the NF uses just one lcores.. Other potential lcores are no
-	//used
-	RTE_LCORE_FOREACH_SLAVE(lcore) 
-	{ 
-		if (rte_eal_wait_lcore(lcore)/*Wait until an lcore finishes its job.*/ < 0) 
+		for(j = 0; j < REWRITE_UNROLL; j++)
+			hdr[j] = _mm_loadu_si128(rte_pktmbuf_mtod(pkts[i + j],const __m128i *));
+		for(j = 0; j < REWRITE_UNROLL; j++)
+			_mm_storeu_si128(rte_pktmbuf_mtod(pkts[i + j],__m128i *),_mm_or_si128(_mm_and_si128(hdr[j],keep_mask),new_dst));
+	}
+	for (;i < n;i++)
+	{
+		if(likely(rte_pktmbuf_data_len(pkts[i]) >= sizeof(__m128i)))
 		{
-			return -1;
+			__m128i h = _mm_loadu_si128(rte_pktmbuf_mtod(pkts[i],const __m128i *));
+			_mm_storeu_si128(rte_pktmbuf_mtod(pkts[i],__m128i *),_mm_or_si128(_mm_and_si128(h,keep_mask),new_dst));
 		}
+		else
+			rewrite(pkts[i]);
 	}
 
-	return 0;
+	nf_send_burst(out,pkts,n,output_port[in_port]);
+}
+
+int MAIN(int argc, char *argv[])
+{
+	static const struct nf_t nf = {
+		.name = NAME,
+		.min_ports = 1,
+		.max_ports = 0,
+		.options = NULL,
+		.usage = NULL,
+		.parse_option = NULL,
+		.init = init,
+		.init_worker = NULL,
+		.process = process,
+		.poll = NULL,
+		.tx_threshold = TX_THRESHOLD,
+		.tx_timeout = TX_TIMEOUT
+	};
+
+	return nf_main(argc, argv, &nf);
 }
@@ -0,0 +1,9 @@
+# Sources of the framework shared by the DPDK NFs (see framework/README).
+# Include this file in the Makefile of an NF, after rte.vars.mk.
+
+NF_FRAMEWORK_DIR = $(SRCDIR)/../framework
+
+VPATH += $(NF_FRAMEWORK_DIR)
+CFLAGS += -I$(NF_FRAMEWORK_DIR)
+
+SRCS-y += nf_init.c nf_runtime.c nf_mbuf.c
@@ -0,0 +1,227 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+* @file nf.h
+*
+* @brief Framework shared by the DPDK NFs. The framework initializes the EAL,
+* parses the command line, attaches to the rings shared with xDPd, and runs the
+* RX/TX loop on all the lcores of the core mask (see README). An NF only
+* describes itself through a struct nf_t, and processes bursts of packets in
+* its process callback, by sending (nf_send) or dropping (nf_drop) each of them.
+*/
+
+#ifndef _NF_H_
+#define _NF_H_ 1
+
+#pragma once
+
+#include <stdio.h>
+#include <string.h>
+#include <getopt.h>
+
+#include <rte_mbuf.h>
+
+#include "nf_stats.h"
+#include "nf_mbuf.h"
+
+/**
+*	@brief: maximum number of packets received at once from a ring
+*/
+#define PKT_TO_NF_THRESHOLD 	200
+
+/**
+*	@brief: maximum number of packets given at once to the process callback. The
+*		packets of the next batch are prefetched while the NF processes a batch
+*/
+#define NF_BATCH_SIZE			32
+
+extern FILE *logFile;
+
+typedef struct mbuf_array
+{
+	/**
+	*	@brief: packets received / to be sent
+	*/
+	struct rte_mbuf *array[PKT_TO_NF_THRESHOLD];
+
+	/**
+	*	@brief: number of packets received / to be sent
+	*/
+	int n_mbufs;
+}mbuf_array_t;
+
+/**
+*	@brief: packets processed by a worker and not transmitted yet
+*/
+struct nf_output_t
+{
+	/**
+	*	@brief: packets to be sent, one array for each port
+	*/
+	mbuf_array_t *pkts_to_send;
+
+	/**
+	*	@brief: statistics of the worker, one entry for each port
+	*/
+	struct nf_port_stats_t *stats;
+
+	/**
+	*	@brief: port the packets being processed have been received from
+	*/
+	unsigned int in_port;
+
+	/**
+	*	@brief: for each port, TSC at which the worker found packets buffered and
+	*		not sent because they were less than the TX threshold (0 if none)
+	*/
+	uint64_t *held_since;
+};
+
+/**
+*	@brief: description of an NF
+*/
+struct nf_t
+{
+	/**
+	*	@brief: name printed in the log
+	*/
+	const char *name;
+
+	/**
+	*	@brief: number of ports (option --p) accepted by the NF; max_ports is 0
+	*		if there is no upper bound
+	*/
+	unsigned int min_ports;
+	unsigned int max_ports;
+
+	/**
+	*	@brief: options specific to the NF (terminated by an entry with a NULL
+	*		name), and their description printed by the help. Can be NULL
+	*/
+	const struct option *options;
+	const char *usage;
+
+	/**
+	*	@brief: called for each option specific to the NF, with its argument (NULL
+	*		if the option has no argument). Must return a negative value if the
+	*		option is not valid
+	*/
+	int (*parse_option)(const char *name, const char *arg);
+
+	/**
+	*	@brief: called once, after the command line has been parsed and the rings
+	*		have been attached. Must return a negative value in case of error.
+	*		Can be NULL
+	*/
+	int (*init)(void);
+
+	/**
+	*	@brief: called once for each worker, before the packets are processed.
+	*		The value returned is the state of the worker, given to process and
+	*		poll; NULL is a valid state. Can be NULL
+	*/
+	void *(*init_worker)(unsigned int worker_id);
+
+	/**
+	*	@brief: process a batch of packets received from the same port. Each packet
+	*		must be either sent (nf_send) or dropped (nf_drop). The packets of a flow
+	*		are always processed by the same worker, in order
+	*/
+	void (*process)(struct rte_mbuf **pkts, unsigned int n, unsigned int in_port, struct nf_output_t *out, void *state);
+
+	/**
+	*	@brief: called by each worker at each iteration of its loop, e.g., to expire
+	*		its state. Can be NULL
+	*/
+	void (*poll)(void *state);
+
+	/**
+	*	@brief: default values of the options --t and --o. The packets sent on a
+	*		port are buffered until they are at least tx_threshold, or until the
+	*		oldest one has been buffered for tx_timeout microseconds; they are sent
+	*		anyway when the worker does not receive packets. 0 means that the packets
+	*		are sent at the end of each iteration of the loop of the worker
+	*/
+	unsigned int tx_threshold;
+	unsigned int tx_timeout;
+};
+
+/**
+*	@brief: run the NF; this function never returns, unless an error occurs
+*
+*	@param: argc	Number of parameters in the command line (including those
+*					used by the EAL)
+*	@param: argv	The command line
+*	@param: nf		Description of the NF
+*/
+int nf_main(int argc, char *argv[], const struct nf_t *nf);
+
+/**
+*	@brief: number of ports of the NF, and name of a port
+*/
+unsigned int nf_num_ports(void);
+const char *nf_port_name(unsigned int port);
+
+/**
+*	@brief: send the packets buffered for a port (called by nf_send when the
+*		buffer is full)
+*/
+void nf_flush(struct nf_output_t *out, unsigned int port);
+
+/**
+*	@brief: send a packet on a port. The packets are buffered, and sent in bursts
+*/
+static inline void nf_send(struct nf_output_t *out, struct rte_mbuf *pkt, unsigned int port)
+{
+	mbuf_array_t *pkts = &out->pkts_to_send[port];
+
+	pkts->array[pkts->n_mbufs] = pkt;
+	pkts->n_mbufs++;
+	if(unlikely(pkts->n_mbufs == PKT_TO_NF_THRESHOLD))
+		nf_flush(out,port);
+}
+
+/**
+*	@brief: send n packets on the same port
+*/
+static inline void nf_send_burst(struct nf_output_t *out, struct rte_mbuf **pkts, unsigned int n, unsigned int port)
+{
+	mbuf_array_t *buffer = &out->pkts_to_send[port];
+
+	while(n > 0)
+	{
+		unsigned int room = PKT_TO_NF_THRESHOLD - buffer->n_mbufs;
+		unsigned int count = (n < room)? n : room;
+
+		memcpy(&buffer->array[buffer->n_mbufs],pkts,count * sizeof(struct rte_mbuf*));
+		buffer->n_mbufs += count;
+		pkts += count;
+		n -= count;
+		if(buffer->n_mbufs == PKT_TO_NF_THRESHOLD)
+			nf_flush(out,port);
+	}
+}
+
+/**
+*	@brief: drop a packet received from out->in_port
+*/
+static inline void nf_drop(struct nf_output_t *out, struct rte_mbuf *pkt)
+{
+	out->stats[out->in_port].dropped++;
+	rte_pktmbuf_free(pkt);
+}
+
+/**
+*	@brief: print the statistics of the ports, summed over all the workers
+*/
+void nf_print_stats(FILE *file);
+
+#ifdef RTE_EXEC_ENV_BAREMETAL
+	#define MAIN _main
+#else
+	#define MAIN main
+#endif
+
+#endif //_NF_H_
@@ -0,0 +1,605 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+* @file nf_init.c
+*
+* @brief Initialization of the NF: EAL, command line, shared resources and
+* workers.
+*/
+
+#include <signal.h>
+#include <string.h>
+#include <stdlib.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <rte_eal.h>
+#include <rte_memcpy.h>
+#include <rte_cycles.h>
+
+#include "nf_internal.h"
+
+FILE *logFile = NULL;
+
+struct nf_framework_t nf_framework;
+
+// Prototypes
+
+void usage(void);
+int parse_command_line(int argc, char *argv[]);
+void init_shared_resources(void);
+int init_stats(void);
+int init_workers(void);
+void sig_handler(int received_signal);
+
+// Functions
+
+void usage(void)
+{
+	char message[]=	\
+
+	"Usage:                                                                                   \n" \
+	"  sudo ./nf -c core_mask -n memory_channels --proc-type=secondary -- --p port_name       \n" \
+	"                [--p port_name ...] --s semaphore_name --l file_name [options]           \n" \
+	"                                                                                         \n" \
+	"Parameters:                                                                              \n" \
+	"  -c core_mask                                                                           \n" \
+	"        Lcores used by the NF. With more than one lcore, the first one dispatches the    \n" \
+	"        packets to the others according to their flow.                                   \n" \
+	"  -n memory_channels	                                                                  \n" \
+	"        Number of channels used by the NFs to access to the memory.                      \n" \
+	"  --proc-type=secondary                                                                  \n" \
+	"        The NF must be executed as a DPDK secondary process.                             \n" \
+	"  --p port_name                                                                          \n" \
+	"        Name of a port of the NF. This parameter must be repeated once for each port     \n" \
+	"        used by the NF.                                                                  \n" \
+	"  --l file_name                                                                          \n" \
+	"        Name of the file used to log information.                                        \n" \
+	"                                                                                         \n" \
+	"Options:                                                                                 \n" \
+	"  --s semaphore_name [mandatory if the NF is compiled with the flag ENABLE_SEMAPHORE]    \n" \
+	"        Name of the semaphore posted by xDPd when it sends packets to the NF. An idle    \n" \
+	"        NF blocks on it.                                                                 \n" \
+	"  --m segment_name                                                                       \n" \
+	"        Name of the POSIX shared memory segment where the NF exports its statistics,     \n" \
+	"        read by the orchestrator (see nf_stats.h). By default, they are not exported.    \n" \
+	"  --b pool_name                                                                          \n" \
+	"        Name of the mbuf pool of xDPd, used by the NF to create packets (default:        \n" \
+	"        pool_<NUMA socket of the first lcore>).                                          \n" \
+	"  --i microseconds                                                                       \n" \
+	"        Time without packets after which the NF stops spinning, and progressively backs  \n" \
+	"        off (pause, sleep, then wait on the semaphore). 0 means that the NF always spins \n" \
+	"        (default: 1000).                                                                 \n" \
+	"  --t packets                                                                            \n" \
+	"        Packets buffered for a port before they are sent to xDPd, to send them in larger \n" \
+	"        bursts. 0 means that they are sent at each iteration of the RX/TX loop.          \n" \
+	"  --o microseconds                                                                       \n" \
+	"        Maximum time a packet is buffered because of --t. The buffered packets are sent \n" \
+	"        anyway as soon as an iteration of the loop does not receive packets.             \n" \
+	"  --h                                                                                    \n" \
+	"        Print this help.                                                                 \n";
+
+	fprintf(stderr,"\n\n[%s] %s",nf_framework.nf->name,message);
+	if(nf_framework.nf->usage != NULL)
+		fprintf(stderr,"%s",nf_framework.nf->usage);
+	fprintf(stderr,"\n");
+	if(nf_framework.nf->max_ports != 0)
+		fprintf(stderr,"The NF requires between %d and %d ports.\n\n",nf_framework.nf->min_ports,nf_framework.nf->max_ports);
+	else
+		fprintf(stderr,"The NF requires at least %d ports.\n\n",nf_framework.nf->min_ports);
+}
+
+/**
+* @brief Parses the command line used to run the NF
+*
+* @param argc	Number of parameters in the command line (excluding those used
+*				the EAL)
+* @param argv	The command line (except the parameters used by the EAL)
+*/
+int parse_command_line(int argc, char *argv[])
+{
+	const struct nf_t *nf = nf_framework.nf;
+	char *logfilename = NULL;
+	int opt, ret;
+	char **argvopt;
+	int option_index;
+	char *prgname = argv[0];
+	static const struct option common_lgopts[] = {
+		{"s", 1, 0, 0},
+		{"p", 1, 0, 0},
+		{"l", 1, 0, 0},
+		{"i", 1, 0, 0},
+		{"m", 1, 0, 0},
+		{"b", 1, 0, 0},
+		{"t", 1, 0, 0},
+		{"o", 1, 0, 0},
+		{"h", 0, 0, 0}
+	};
+	unsigned int num_common = sizeof(common_lgopts) / sizeof(common_lgopts[0]);
+	unsigned int num_nf_options = 0;
+
+	//The options of the NF are added to the common ones
+	while(nf->options != NULL && nf->options[num_nf_options].name != NULL)
+		num_nf_options++;
+
+	struct option *lgopts = (struct option*)calloc(num_common + num_nf_options + 1,sizeof(struct option));
+	memcpy(lgopts,common_lgopts,sizeof(common_lgopts));
+	if(num_nf_options != 0)
+		memcpy(&lgopts[num_common],nf->options,num_nf_options * sizeof(struct option));
+
+	uint32_t arg_s = 0, arg_l = 0;
+	unsigned long idle_time = DEFAULT_IDLE_TIME;
+	unsigned long tx_threshold = nf->tx_threshold;
+	unsigned long tx_timeout = nf->tx_timeout;
+	argvopt = argv;
+
+	nf_framework.num_ports = 0;
+	nf_framework.ports = NULL;
+	nf_framework.stats_name = NULL;
+	nf_framework.pool_name = NULL;
+
+	while ((opt = getopt_long(argc, argvopt, "", lgopts, &option_index)) != EOF)
+	{
+		switch (opt)
+		{
+			/* long options */
+			case 0:
+				if (!strcmp(lgopts[option_index].name, "p"))/* port */
+				{
+					if(nf->max_ports != 0 && nf_framework.num_ports == nf->max_ports)
+					{
+						fprintf(stderr,"[%s] The parameter '--p' appear too many times in the command line\n",nf->name);
+						return -1;
+					}
+
+					nf_framework.ports = (struct nf_port_t*)realloc(nf_framework.ports,(nf_framework.num_ports + 1) * sizeof(struct nf_port_t));
+					memset(&nf_framework.ports[nf_framework.num_ports],0,sizeof(struct nf_port_t));
+					nf_framework.ports[nf_framework.num_ports].name = (char*)malloc(sizeof(char)*(strlen(optarg)+1));
+					strcpy(nf_framework.ports[nf_framework.num_ports].name,optarg);
+
+					nf_framework.num_ports++;
+				}
+				else if (!strcmp(lgopts[option_index].name, "s"))/* semaphore */
+				{
+					if(arg_s != 0)
+					{
+						fprintf(stderr,"[%s] The parameter '--s' appear too many times in the command line\n",nf->name);
+						return -1;
+					}
+
+#ifdef ENABLE_SEMAPHORE
+					nf_framework.sem_name = (char*)malloc(sizeof(char)*(strlen(optarg)+1));
+					strcpy(nf_framework.sem_name,optarg);
+#endif
+					arg_s++;
+				}
+				else if (!strcmp(lgopts[option_index].name, "l"))/* file to log */
+				{
+					if(arg_l != 0)
+					{
+						fprintf(stderr,"[%s] The parameter '--l' appear too many times in the command line\n",nf->name);
+						return -1;
+					}
+
+					logfilename = (char*)malloc(sizeof(char)*(strlen(optarg)+1));
+					strcpy(logfilename,optarg);
+
+					arg_l++;
+				}
+				else if (!strcmp(lgopts[option_index].name, "i"))/* idle time */
+				{
+					char *end;
+					idle_time = strtoul(optarg,&end,10);
+					if(*optarg == '\0' || *end != '\0')
+					{
+						fprintf(stderr,"[%s] Invalid idle time '%s'\n",nf->name,optarg);
+						return -1;
+					}
+				}
+				else if (!strcmp(lgopts[option_index].name, "t"))/* TX threshold */
+				{
+					char *end;
+					tx_threshold = strtoul(optarg,&end,10);
+					if(*optarg == '\0' || *end != '\0' || tx_threshold > MAX_TX_THRESHOLD)
+					{
+						fprintf(stderr,"[%s] Invalid TX threshold '%s' (maximum %d)\n",nf->name,optarg,MAX_TX_THRESHOLD);
+						return -1;
+					}
+				}
+				else if (!strcmp(lgopts[option_index].name, "o"))/* TX timeout */
+				{
+					char *end;
+					tx_timeout = strtoul(optarg,&end,10);
+					if(*optarg == '\0' || *end != '\0')
+					{
+						fprintf(stderr,"[%s] Invalid TX timeout '%s'\n",nf->name,optarg);
+						return -1;
+					}
+				}
+				else if (!strcmp(lgopts[option_index].name, "m"))/* statistics */
+				{
+					if(nf_framework.stats_name != NULL)
+					{
+						fprintf(stderr,"[%s] The parameter '--m' appear too many times in the command line\n",nf->name);
+						return -1;
+					}
+
+					//The names of the POSIX shared memory segments start with a slash
+					nf_framework.stats_name = (char*)malloc(sizeof(char)*(strlen(optarg)+2));
+					sprintf(nf_framework.stats_name,"%s%s",(optarg[0] == '/')? "" : "/",optarg);
+				}
+				else if (!strcmp(lgopts[option_index].name, "b"))/* mbuf pool */
+				{
+					if(nf_framework.pool_name != NULL)
+					{
+						fprintf(stderr,"[%s] The parameter '--b' appear too many times in the command line\n",nf->name);
+						return -1;
+					}
+
+					nf_framework.pool_name = (char*)malloc(sizeof(char)*(strlen(optarg)+1));
+					strcpy(nf_framework.pool_name,optarg);
+				}
+				else if (!strcmp(lgopts[option_index].name, "h"))/* help */
+				{
+					return -1;
+				}
+				else if(option_index >= (int)num_common && nf->parse_option != NULL)/* option of the NF */
+				{
+					if(nf->parse_option(lgopts[option_index].name,optarg) < 0)
+						return -1;
+				}
+				else
+				{
+					fprintf(stderr,"[%s] Invalid command line parameter '%s'\n",nf->name,lgopts[option_index].name);
+					return -1;
+				}
+				break;
+			default:
+				return -1;
+		}
+	}
+
+	/* Check that all mandatory arguments are provided */
+	if (
+#ifdef ENABLE_SEMAPHORE
+		(arg_s == 0)||
+#endif
+		(nf_framework.num_ports == 0)||(arg_l == 0))
+	{
+		fprintf(stderr,"[%s] Not all mandatory arguments are present in the command line\n",nf->name);
+		return -1;
+	}
+
+	if(nf_framework.num_ports < nf->min_ports)
+	{
+		fprintf(stderr,"[%s] The NF requires at least %d ports\n",nf->name,nf->min_ports);
+		return -1;
+	}
+
+	//Open the file to be used to log information
+
+	if((strcmp(logfilename,"stdout") != 0) && (strcmp(logfilename,"stderr") != 0))
+	{
+		logFile = fopen (logfilename,"w");
+		if (logFile==NULL)
+		{
+			fprintf(stderr,"[%s] Unable to open file to log!\n",logfilename);
+			exit (EXIT_FAILURE);
+		}
+	}
+	else
+	{
+		if(strcmp(logfilename,"stdout") == 0)
+			logFile = stdout;
+		else
+			logFile = stderr;
+	}
+
+	free(lgopts);
+
+	nf_framework.idle_cycles = (rte_get_tsc_hz() / 1000000) * idle_time;
+	nf_framework.tx_threshold = (tx_threshold > MAX_TX_THRESHOLD)? MAX_TX_THRESHOLD : tx_threshold;
+	nf_framework.tx_timeout_cycles = (rte_get_tsc_hz() / 1000000) * tx_timeout;
+
+	if (optind >= 0)
+		argv[optind - 1] = prgname;
+
+	ret = optind - 1;
+	optind = 0; /* reset getopt lib */
+
+	return ret;
+}
+
+/**
+*	@brief 	The NF attaches to the resources used to exchange
+*			packets with the xDPD
+*/
+void init_shared_resources(void)
+{
+	unsigned int i;
+	char queue_name[NAME_LENGTH];
+	const char *name = nf_framework.nf->name;
+
+	/*
+	*	Connect to the rte_rings
+	*/
+	for(i = 0; i < nf_framework.num_ports; i++)
+	{
+		snprintf(queue_name, NAME_LENGTH, "%s-to-nf", nf_framework.ports[i].name);
+		nf_framework.ports[i].to_nf_queue = rte_ring_lookup(queue_name);
+		if (nf_framework.ports[i].to_nf_queue == NULL)
+		{
+			fprintf(logFile,"[%s] Cannot get rte_ring '%s'\n", name,queue_name);
+			exit(1);
+		}
+		fprintf(logFile,"[%s] Attached to rte_ring '%s'\n", name,queue_name);
+
+		snprintf(queue_name, NAME_LENGTH, "%s-to-xdpd", nf_framework.ports[i].name);
+		nf_framework.ports[i].to_xdpd_queue = rte_ring_lookup(queue_name);
+		if (nf_framework.ports[i].to_xdpd_queue == NULL)
+		{
+			fprintf(logFile,"[%s] Cannot get rte_ring '%s'\n",name, queue_name);
+			exit(1);
+		}
+
+		fprintf(logFile,"[%s] Attached to rte_ring '%s'\n", name,queue_name);
+	}
+
+	/*
+	*	Connect to the mbuf pool of xDPd. It is only required by the NFs creating
+	*	packets, hence the NF runs even without it
+	*/
+	if(nf_framework.pool_name == NULL)
+	{
+		nf_framework.pool_name = (char*)malloc(sizeof(char)*NAME_LENGTH);
+		snprintf(nf_framework.pool_name,NAME_LENGTH,DEFAULT_POOL_NAME,rte_socket_id());
+	}
+	nf_framework.pool = rte_mempool_lookup(nf_framework.pool_name);
+	if(nf_framework.pool == NULL)
+		fprintf(logFile,"[%s] Cannot get the mbuf pool '%s'; the NF cannot create packets\n",name,nf_framework.pool_name);
+	else
+		fprintf(logFile,"[%s] Attached to the mbuf pool '%s'\n",name,nf_framework.pool_name);
+
+#ifdef ENABLE_SEMAPHORE
+	/*
+	*	Connect to the POSIX named semaphore
+	*/
+	nf_framework.semaphore = sem_open(nf_framework.sem_name,0);//, O_CREAT, 0644, 0);
+	if(nf_framework.semaphore == SEM_FAILED)
+	{
+		fprintf(logFile,"[%s] Cannot get the semaphore '%s'\n",name, nf_framework.sem_name);
+		exit(1);
+	}
+	fprintf(logFile,"[%s] Attached to semaphore '%s'\n", name, nf_framework.sem_name);
+#endif
+}
+
+/**
+*	@brief	Allocate the statistics of the workers. If required, they are placed in
+*			a shared memory segment, so that they can be read by the orchestrator
+*/
+int init_stats(void)
+{
+	const char *name = nf_framework.nf->name;
+	unsigned int p;
+	uint64_t size = nf_stats_size(nf_framework.num_workers,nf_framework.num_ports);
+	void *memory;
+
+	if(nf_framework.stats_name != NULL)
+	{
+		int fd = shm_open(nf_framework.stats_name,O_CREAT | O_TRUNC | O_RDWR,0644);
+		if(fd < 0)
+		{
+			fprintf(logFile,"[%s] Cannot create the shared memory segment '%s'\n",name,nf_framework.stats_name);
+			return -1;
+		}
+		if(ftruncate(fd,size) < 0)
+		{
+			fprintf(logFile,"[%s] Cannot resize the shared memory segment '%s'\n",name,nf_framework.stats_name);
+			close(fd);
+			return -1;
+		}
+		memory = mmap(NULL,size,PROT_READ | PROT_WRITE,MAP_SHARED,fd,0);
+		close(fd);
+		if(memory == MAP_FAILED)
+		{
+			fprintf(logFile,"[%s] Cannot map the shared memory segment '%s'\n",name,nf_framework.stats_name);
+			return -1;
+		}
+		fprintf(logFile,"[%s] Statistics exported in the shared memory segment '%s'\n",name,nf_framework.stats_name);
+	}
+	else if(posix_memalign(&memory,RTE_CACHE_LINE_SIZE,size) != 0)
+		return -1;
+
+	memset(memory,0,size);
+	nf_framework.stats = (struct nf_stats_header_t*)memory;
+	nf_framework.stats->num_ports = nf_framework.num_ports;
+	nf_framework.stats->num_workers = nf_framework.num_workers;
+	nf_framework.stats->tsc_hz = rte_get_tsc_hz();
+	nf_framework.stats->workers_offset = sizeof(struct nf_stats_header_t);
+	nf_framework.stats->ports_offset = sizeof(struct nf_stats_header_t) + nf_framework.num_workers * sizeof(struct nf_stats_worker_t);
+	nf_framework.stats->rings_offset = nf_framework.stats->ports_offset + (uint64_t)nf_framework.num_workers * nf_framework.num_ports * sizeof(struct nf_port_stats_t);
+	nf_framework.stats->dispatcher = nf_framework.dispatcher;
+
+	struct nf_ring_stats_t *rings_stats = (struct nf_ring_stats_t*)((char*)memory + nf_framework.stats->rings_offset);
+	for(p = 0; p < nf_framework.num_ports; p++)
+	{
+		//The size of the ring is not exported by all the versions of the DPDK
+		struct rte_ring *ring = nf_framework.ports[p].to_nf_queue;
+		rings_stats[p].capacity = rte_ring_count(ring) + rte_ring_free_count(ring);
+		nf_framework.ports[p].ring_stats = &rings_stats[p];
+	}
+
+	return 0;
+}
+
+/**
+*	@brief	Assign the lcores of the NF to the workers. With more than one lcore,
+*			the master lcore becomes the dispatcher, and each other lcore runs a
+*			worker
+*/
+int init_workers(void)
+{
+	unsigned int lcore, w;
+	const struct nf_t *nf = nf_framework.nf;
+
+	nf_framework.dispatcher = (rte_lcore_count() > 1);
+	nf_framework.num_workers = (nf_framework.dispatcher)? rte_lcore_count() - 1 : 1;
+
+	void *workers;
+	if(posix_memalign(&workers,RTE_CACHE_LINE_SIZE,nf_framework.num_workers * sizeof(struct nf_worker_t)) != 0)
+		return -1;
+	memset(workers,0,nf_framework.num_workers * sizeof(struct nf_worker_t));
+	nf_framework.workers = (struct nf_worker_t*)workers;
+
+	if(init_stats() < 0)
+		return -1;
+	struct nf_stats_worker_t *workers_stats = (struct nf_stats_worker_t*)((char*)nf_framework.stats + nf_framework.stats->workers_offset);
+	struct nf_port_stats_t *ports_stats = (struct nf_port_stats_t*)((char*)nf_framework.stats + nf_framework.stats->ports_offset);
+
+	w = 0;
+	RTE_LCORE_FOREACH(lcore)
+	{
+		if(nf_framework.dispatcher && lcore == rte_get_master_lcore())
+			continue;
+
+		struct nf_worker_t *worker = &nf_framework.workers[w];
+		void *memory;
+
+		worker->lcore_id = lcore;
+		nf_framework.worker_of_lcore[lcore] = w;
+
+		worker->stats = &ports_stats[w * nf_framework.num_ports];
+		worker->dispatch_stats = &workers_stats[w];
+		worker->dispatch_stats->lcore_id = lcore;
+
+		if(nf_framework.dispatcher)
+		{
+			if(posix_memalign(&memory,RTE_CACHE_LINE_SIZE,nf_framework.num_ports * sizeof(struct worker_ring_t)) != 0)
+				return -1;
+			memset(memory,0,nf_framework.num_ports * sizeof(struct worker_ring_t));
+			worker->rings = (struct worker_ring_t*)memory;
+
+			worker->wakeup_fd = eventfd(0,0);
+			if(worker->wakeup_fd < 0)
+				return -1;
+		}
+
+		if(nf->init_worker != NULL)
+			worker->state = nf->init_worker(w);
+
+		w++;
+	}
+
+	//The segment is valid for the readers only when it is completely initialized
+	nf_framework.stats->version = NF_STATS_VERSION;
+	rte_wmb();
+	nf_framework.stats->magic = NF_STATS_MAGIC;
+
+	if(nf_framework.dispatcher)
+		fprintf(logFile,"[%s] Dispatcher on lcore %d, %d workers\n",nf->name,rte_get_master_lcore(),nf_framework.num_workers);
+	else
+		fprintf(logFile,"[%s] Running on lcore %d\n",nf->name,nf_framework.workers[0].lcore_id);
+
+	return 0;
+}
+
+void sig_handler(int received_signal)
+{
+	fprintf(logFile,"[%s] Received signal %d. I'm going to terminate...\n",nf_framework.nf->name,received_signal);
+
+	if (received_signal == SIGINT || received_signal == SIGTERM)
+	{
+		nf_print_stats(logFile);
+		fflush(logFile);
+#ifdef ENABLE_SEMAPHORE
+		sem_unlink(nf_framework.sem_name);
+#endif
+		if(nf_framework.stats_name != NULL)
+			shm_unlink(nf_framework.stats_name);
+		exit(0);
+	}
+}
+
+int nf_init(int argc, char *argv[], const struct nf_t *nf)
+{
+	nf_framework.nf = nf;
+
+	if(parse_command_line(argc, argv) < 0)
+	{
+		usage();
+		return -1;
+	}
+
+	init_shared_resources();
+
+	if(nf->init != NULL && nf->init() < 0)
+		return -1;
+
+	if(init_workers() < 0)
+	{
+		fprintf(stderr,"[%s] Unable to allocate the workers\n",nf->name);
+		return -1;
+	}
+
+	/*
+	* Set the signal handler and global variables for termination
+	*/
+	signal(SIGINT, sig_handler);
+	signal(SIGTERM, sig_handler);
+
+	return 0;
+}
+
+int nf_main(int argc, char *argv[], const struct nf_t *nf)
+{
+	//Check for root privileges
+	if(geteuid() != 0)
+	{
+		fprintf(stderr,"[%s] Root permissions are required to run %s\n",nf->name,argv[0]);
+		exit(EXIT_FAILURE);
+	}
+
+	uint32_t lcore;
+	int ret;
+
+	/* Init EAL */
+	ret = rte_eal_init(argc, argv);
+
+	fflush(stdout);
+	if (ret < 0)
+		return -1;
+	argc -= ret;
+	argv += ret;
+
+	if(nf_init(argc, argv, nf) < 0)
+		return -1;
+
+	fprintf(logFile,"[%s] Network function started!\n",nf->name);
+	fflush(logFile);
+
+	rte_eal_mp_remote_launch(nf_run, NULL, CALL_MASTER);
+
+	RTE_LCORE_FOREACH_SLAVE(lcore)
+	{
+		if (rte_eal_wait_lcore(lcore)/*Wait until an lcore finishes its job.*/ < 0)
+		{
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+unsigned int nf_num_ports(void)
+{
+	return nf_framework.num_ports;
+}
+
+const char *nf_port_name(unsigned int port)
+{
+	return nf_framework.ports[port].name;
+}
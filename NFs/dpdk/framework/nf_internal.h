@@ -0,0 +1,236 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+* @file nf_internal.h
+*
+* @brief State of the framework, not visible to the NFs.
+*/
+
+#ifndef _NF_INTERNAL_H_
+#define _NF_INTERNAL_H_ 1
+
+#pragma once
+
+#ifdef ENABLE_SEMAPHORE
+	#include <semaphore.h>
+#endif
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <rte_lcore.h>
+#include <rte_ring.h>
+#include <rte_mempool.h>
+
+#include "nf.h"
+#include "worker_ring.h"
+
+#define NAME_LENGTH				100
+
+/**
+*	@brief: name of the mbuf pool created by xDPd on a NUMA socket (option --b)
+*/
+#define DEFAULT_POOL_NAME		"pool_%u"
+
+/**
+*	@brief: number of packets prefetched in advance by the dispatcher
+*/
+#define PREFETCH_OFFSET			4
+
+/**
+*	@brief: default time (in microseconds) without packets after which an lcore
+*		stops spinning (option --i)
+*/
+#define DEFAULT_IDLE_TIME		1000
+
+/**
+*	@brief: maximum TX threshold (option --t)
+*/
+#define MAX_TX_THRESHOLD		PKT_TO_NF_THRESHOLD
+
+/**
+*	@brief: pause instructions executed at each empty iteration, in the second
+*		stage of the backoff
+*/
+#define BACKOFF_PAUSES			32
+
+/**
+*	@brief: sleep (in microseconds) at each empty iteration, in the third stage
+*		of the backoff; it doubles at each iteration
+*/
+#define BACKOFF_MIN_SLEEP		5
+#define BACKOFF_MAX_SLEEP		1000
+
+/**
+*	@brief: state of the backoff of an lcore that does not receive packets. The
+*		lcore spins while packets arrive. After idle_time without packets, it
+*		executes pause instructions between the polls; after 2 * idle_time it
+*		sleeps between the polls, and after 4 * idle_time it blocks until packets
+*		arrive, if it can be woken up (semaphore posted by xDPd, or eventfd written
+*		by the dispatcher)
+*/
+struct nf_backoff_t
+{
+	/**
+	*	@brief: TSC of the first empty iteration, or 0 if the last iteration
+	*		received packets
+	*/
+	uint64_t idle_since;
+
+	/**
+	*	@brief: duration of the next sleep, in microseconds
+	*/
+	unsigned int sleep;
+};
+
+struct nf_port_t
+{
+	/**
+	*	@brief: queue used to receive packets
+	*/
+	struct rte_ring *to_nf_queue;
+
+	/**
+	*	@brief: queue used to transmit packets
+	*/
+	struct rte_ring *to_xdpd_queue;
+
+	/**
+	*	@brief: name of the port
+	*/
+	char *name;
+
+	/**
+	*	@brief: occupancy of to_nf_queue (in the segment exported by the NF, see
+	*		nf_stats.h)
+	*/
+	struct nf_ring_stats_t *ring_stats;
+};
+
+/**
+*	@brief: lcore processing the packets. When the NF runs on a single lcore,
+*		the only worker receives the packets directly from the ports. Otherwise,
+*		the master lcore dispatches the packets to the workers (one for each
+*		other lcore) according to their flow, so that the packets of a flow are
+*		always processed in order, by the same worker.
+*/
+struct nf_worker_t
+{
+	/**
+	*	@brief: lcore running the worker
+	*/
+	unsigned int lcore_id;
+
+	/**
+	*	@brief: rings used by the dispatcher to pass packets to the worker, one
+	*		for each port of the NF
+	*/
+	struct worker_ring_t *rings;
+
+	/**
+	*	@brief: state returned by the init_worker callback of the NF
+	*/
+	void *state;
+
+	/**
+	*	@brief: statistics of the worker, one entry for each port, and statistics
+	*		written by the dispatcher for the worker (both in the segment exported
+	*		by the NF, see nf_stats.h)
+	*/
+	struct nf_port_stats_t *stats;
+	struct nf_stats_worker_t *dispatch_stats;
+
+	/**
+	*	@brief: eventfd used by the dispatcher to wake up the worker, and flag set
+	*		by the worker while it is blocked on it
+	*/
+	int wakeup_fd __rte_cache_aligned;
+	volatile int sleeping;
+} __rte_cache_aligned;
+
+struct nf_framework_t
+{
+	/**
+	*	@brief: the NF being executed
+	*/
+	const struct nf_t *nf;
+
+	/**
+	*	@brief: ports to be used to transmit/receive packets
+	*/
+	unsigned int num_ports;
+	struct nf_port_t *ports;
+
+	/**
+	*	@brief: name of the mbuf pool of xDPd, and the pool (NULL if the NF
+	*		cannot attach to it)
+	*/
+	char *pool_name;
+	struct rte_mempool *pool;
+
+#ifdef ENABLE_SEMAPHORE
+	/**
+	*	@brief: name of the semaphore
+	*/
+	char *sem_name;
+
+	/**
+	*	@brief: semaphore used to implement a blocking model
+	*		and save CPU resources
+	*/
+	sem_t *semaphore;
+#endif
+
+	/**
+	*	@brief: true if the master lcore dispatches the packets to the workers
+	*/
+	int dispatcher;
+
+	/**
+	*	@brief: lcores processing the packets
+	*/
+	unsigned int num_workers;
+	struct nf_worker_t *workers;
+
+	/**
+	*	@brief: index of the worker running on each lcore
+	*/
+	unsigned int worker_of_lcore[RTE_MAX_LCORE];
+
+	/**
+	*	@brief: name of the shared memory segment exporting the statistics (NULL
+	*		if the statistics are not exported), and the segment
+	*/
+	char *stats_name;
+	struct nf_stats_header_t *stats;
+
+	/**
+	*	@brief: TSC cycles without packets after which an lcore starts the
+	*		backoff; 0 if the lcores always spin
+	*/
+	uint64_t idle_cycles;
+
+	/**
+	*	@brief: packets buffered for a port before they are sent, and maximum
+	*		time (in TSC cycles) they are buffered (options --t and --o)
+	*/
+	unsigned int tx_threshold;
+	uint64_t tx_timeout_cycles;
+};
+
+extern struct nf_framework_t nf_framework;
+
+/**
+*	@brief: parse the command line, attach to the shared resources and create
+*		the workers
+*/
+int nf_init(int argc, char *argv[], const struct nf_t *nf);
+
+/**
+*	@brief: main loop of an lcore
+*/
+int nf_run(void *useless);
+
+#endif //_NF_INTERNAL_H_
@@ -0,0 +1,156 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+* @file nf_mbuf.c
+*
+* @brief Creation of packets, based on the mbuf pool of xDPd.
+*/
+
+#include <string.h>
+
+#include <rte_mbuf.h>
+
+#include "nf_internal.h"
+
+/**
+*	Private prototypes
+*/
+struct rte_mbuf *indirect_segment(struct rte_mbuf *seg, uint32_t offset, uint32_t len);
+
+/**
+*	Implementations
+*/
+
+struct rte_mempool *nf_pool(void)
+{
+	return nf_framework.pool;
+}
+
+struct rte_mbuf *nf_alloc(void)
+{
+	if(unlikely(nf_framework.pool == NULL))
+		return NULL;
+
+	return rte_pktmbuf_alloc(nf_framework.pool);
+}
+
+struct rte_mbuf *nf_clone(struct rte_mbuf *pkt)
+{
+	return nf_slice(pkt,0,rte_pktmbuf_pkt_len(pkt));
+}
+
+/**
+*	@brief: create an indirect mbuf referring to len bytes of a segment, starting
+*		from offset
+*/
+struct rte_mbuf *indirect_segment(struct rte_mbuf *seg, uint32_t offset, uint32_t len)
+{
+	struct rte_mbuf *mi = nf_alloc();
+	if(unlikely(mi == NULL))
+		return NULL;
+
+	//The data of an indirect mbuf belongs to a direct one, which is the one referred
+	//by the new mbuf; the data of seg may be a part of the buffer of that mbuf
+	struct rte_mbuf *md = (RTE_MBUF_DIRECT(seg))? seg : RTE_MBUF_FROM_BADDR(seg->buf_addr);
+	rte_pktmbuf_attach(mi,md);
+
+	mi->pkt.data = (char*)seg->pkt.data + offset;
+	mi->pkt.data_len = len;
+	mi->pkt.pkt_len = len;
+
+	return mi;
+}
+
+struct rte_mbuf *nf_slice(struct rte_mbuf *pkt, uint32_t offset, uint32_t len)
+{
+	struct rte_mbuf *head = NULL, *last = NULL, *seg;
+
+	if(len == 0 || offset + len > rte_pktmbuf_pkt_len(pkt))
+		return NULL;
+
+	for(seg = pkt; seg != NULL && len > 0; seg = seg->pkt.next)
+	{
+		if(offset >= seg->pkt.data_len)
+		{
+			offset -= seg->pkt.data_len;
+			continue;
+		}
+
+		uint32_t n = (seg->pkt.data_len - offset < len)? seg->pkt.data_len - offset : len;
+		struct rte_mbuf *mi = indirect_segment(seg,offset,n);
+		if(unlikely(mi == NULL))
+		{
+			if(head != NULL)
+				rte_pktmbuf_free(head);
+			return NULL;
+		}
+
+		if(head == NULL)
+			head = mi;
+		else
+		{
+			last->pkt.next = mi;
+			head->pkt.nb_segs++;
+			head->pkt.pkt_len += n;
+		}
+		last = mi;
+
+		offset = 0;
+		len -= n;
+	}
+
+	return head;
+}
+
+struct rte_mbuf *nf_prepend(struct rte_mbuf *pkt, const void *header, uint16_t len)
+{
+	if(nf_writable(pkt) && rte_pktmbuf_headroom(pkt) >= len)
+	{
+		char *data = rte_pktmbuf_prepend(pkt,len);
+		memcpy(data,header,len);
+		return pkt;
+	}
+
+	//The header is written in a new segment, so that the data of the packet is not modified
+	struct rte_mbuf *head = nf_alloc();
+	if(unlikely(head == NULL))
+		return NULL;
+
+	char *data = rte_pktmbuf_append(head,len);
+	if(unlikely(data == NULL))
+	{
+		rte_pktmbuf_free(head);
+		return NULL;
+	}
+	memcpy(data,header,len);
+	nf_chain(head,pkt);
+
+	return head;
+}
+
+void nf_chain(struct rte_mbuf *head, struct rte_mbuf *tail)
+{
+	struct rte_mbuf *last = head;
+
+	while(last->pkt.next != NULL)
+		last = last->pkt.next;
+
+	last->pkt.next = tail;
+	head->pkt.nb_segs += tail->pkt.nb_segs;
+	head->pkt.pkt_len += tail->pkt.pkt_len;
+}
+
+int nf_writable(struct rte_mbuf *pkt)
+{
+	struct rte_mbuf *seg;
+
+	for(seg = pkt; seg != NULL; seg = seg->pkt.next)
+	{
+		if(RTE_MBUF_INDIRECT(seg) || rte_mbuf_refcnt_read(seg) != 1)
+			return 0;
+	}
+
+	return 1;
+}
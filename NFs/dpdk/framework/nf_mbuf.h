@@ -0,0 +1,75 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+* @file nf_mbuf.h
+*
+* @brief Creation of packets by the NFs. The NF is attached to the mbuf pool of
+* xDPd, so that the packets it creates can be sent to xDPd as the received ones.
+* The helpers below do not copy the payloads: a clone or a slice of a packet is
+* made of indirect mbufs, which refer to the data of the original packet.
+*
+* The data of a packet referred by other mbufs is shared, hence it must not be
+* modified (see nf_writable). A header is added in front of such a packet in a
+* new segment (see nf_prepend). The packets with several segments are sent to
+* xDPd as well; the headers parsed by xDPd must be in the first segment.
+*/
+
+#ifndef _NF_MBUF_H_
+#define _NF_MBUF_H_ 1
+
+#pragma once
+
+#include <stdint.h>
+
+#include <rte_mbuf.h>
+
+/**
+*	@brief: mbuf pool of xDPd, or NULL if the NF is not attached to it (in this
+*		case, the functions below fail)
+*/
+struct rte_mempool *nf_pool(void);
+
+/**
+*	@brief: allocate an empty packet
+*/
+struct rte_mbuf *nf_alloc(void);
+
+/**
+*	@brief: return a copy of a packet, which refers to the data of the original
+*		one. The original packet is still owned by the NF (e.g., it can be sent
+*		on another port). Returns NULL if no mbuf is available
+*/
+struct rte_mbuf *nf_clone(struct rte_mbuf *pkt);
+
+/**
+*	@brief: return a packet made of len bytes of a packet, starting from offset,
+*		which refers to the data of the original packet (e.g., the payload to be
+*		returned in a reply). Returns NULL if the bytes are not in the packet, or
+*		if no mbuf is available
+*/
+struct rte_mbuf *nf_slice(struct rte_mbuf *pkt, uint32_t offset, uint32_t len);
+
+/**
+*	@brief: add a header of len bytes in front of a packet, and return the new
+*		head of the packet. The header is written in the headroom of the first
+*		segment if the packet is writable, otherwise in a new segment followed by
+*		the packet. Returns NULL if no mbuf is available; in this case the packet
+*		is not modified
+*/
+struct rte_mbuf *nf_prepend(struct rte_mbuf *pkt, const void *header, uint16_t len);
+
+/**
+*	@brief: append the packet tail to the packet head (e.g., a header created
+*		with nf_alloc followed by a slice of another packet)
+*/
+void nf_chain(struct rte_mbuf *head, struct rte_mbuf *tail);
+
+/**
+*	@brief: return 1 if the data of the packet can be modified, i.e., if it is not
+*		referred by other mbufs
+*/
+int nf_writable(struct rte_mbuf *pkt);
+
+#endif //_NF_MBUF_H_
@@ -0,0 +1,469 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+* @file nf_runtime.c
+*
+* @brief RX/TX loops of the dispatcher and of the workers.
+*/
+
+#include <inttypes.h>
+#include <unistd.h>
+#include <emmintrin.h>
+
+#include <rte_mbuf.h>
+#include <rte_prefetch.h>
+#include <rte_cycles.h>
+
+#include "nf_internal.h"
+
+/**
+*	Private prototypes
+*/
+int dispatch(void);
+int work(struct nf_worker_t *worker);
+void process_burst(struct nf_worker_t *worker, struct rte_mbuf **pkts, unsigned int n, struct nf_output_t *out);
+uint32_t dispatch_hash(const unsigned char *pkt, unsigned int len);
+void backoff(struct nf_backoff_t *state, struct nf_worker_t *worker);
+void block(struct nf_worker_t *worker);
+void flush_ports(struct nf_output_t *out, int received);
+static inline void sample_ring(struct nf_port_t *port, unsigned int dequeued);
+
+/**
+*	Implementations
+*/
+
+int nf_run(void *useless)
+{
+	(void) useless; //XXX: this line suppresses the "unused-parameter" error
+
+	unsigned int lcore = rte_lcore_id();
+
+	if(nf_framework.dispatcher && lcore == rte_get_master_lcore())
+		return dispatch();
+
+	return work(&nf_framework.workers[nf_framework.worker_of_lcore[lcore]]);
+}
+
+/**
+*	@brief: receive the packets from the ports, and pass each one to the worker
+*		associated with its flow
+*/
+int dispatch(void)
+{
+	int i;
+	unsigned int p, w;
+	mbuf_array_t pkts_received;
+	unsigned int num_workers = nf_framework.num_workers;
+
+	struct nf_backoff_t backoff_state;
+
+	mbuf_array_t *pkts_to_worker = (mbuf_array_t*)malloc(num_workers * sizeof(mbuf_array_t));
+	for(w = 0; w < num_workers; w++)
+		pkts_to_worker[w].n_mbufs = 0;
+	backoff_state.idle_since = 0;
+
+	while(1)
+	{
+		int received = 0;
+
+		for(p = 0; p < nf_framework.num_ports; p++)
+		{
+			pkts_received.n_mbufs = rte_ring_sc_dequeue_burst(nf_framework.ports[p].to_nf_queue,(void **)&pkts_received.array[0],PKT_TO_NF_THRESHOLD);
+			sample_ring(&nf_framework.ports[p],pkts_received.n_mbufs);
+			if(unlikely(pkts_received.n_mbufs == 0))
+				continue;
+			received = 1;
+
+			for(i = 0; i < pkts_received.n_mbufs && i < PREFETCH_OFFSET; i++)
+				rte_prefetch0(rte_pktmbuf_mtod(pkts_received.array[i],void *));
+
+			for(i = 0; i < pkts_received.n_mbufs; i++)
+			{
+				if(i + PREFETCH_OFFSET < pkts_received.n_mbufs)
+					rte_prefetch0(rte_pktmbuf_mtod(pkts_received.array[i + PREFETCH_OFFSET],void *));
+
+				struct rte_mbuf *m = pkts_received.array[i];
+				w = dispatch_hash(rte_pktmbuf_mtod(m,unsigned char *),rte_pktmbuf_data_len(m)) % num_workers;
+				pkts_to_worker[w].array[pkts_to_worker[w].n_mbufs] = m;
+				pkts_to_worker[w].n_mbufs++;
+			}
+
+			for(w = 0; w < num_workers; w++)
+			{
+				if(pkts_to_worker[w].n_mbufs == 0)
+					continue;
+
+				int ret = worker_ring_enqueue_burst(&nf_framework.workers[w].rings[p],pkts_to_worker[w].array,pkts_to_worker[w].n_mbufs);
+				if(unlikely(ret < pkts_to_worker[w].n_mbufs))
+				{
+#ifdef ENABLE_LOG
+					fprintf(logFile,"[%s] Not enough room towards worker %d; the packet will be dropped.\n", nf_framework.nf->name,w);
+#endif
+					nf_framework.workers[w].dispatch_stats->dispatch_dropped += pkts_to_worker[w].n_mbufs - ret;
+					do {
+						rte_pktmbuf_free(pkts_to_worker[w].array[ret]);
+					} while (++ret < pkts_to_worker[w].n_mbufs);
+				}
+				pkts_to_worker[w].n_mbufs = 0;
+
+				//The worker may be blocked, waiting for packets
+				rte_mb();
+				if(unlikely(nf_framework.workers[w].sleeping))
+				{
+					uint64_t one = 1;
+					if(write(nf_framework.workers[w].wakeup_fd,&one,sizeof(one)) != sizeof(one))
+						fprintf(logFile,"[%s] Unable to wake up worker %d\n",nf_framework.nf->name,w);
+				}
+			}
+		}//end iteration on the ports
+
+		if(received)
+			backoff_state.idle_since = 0;
+		else
+			backoff(&backoff_state,NULL);
+	}/*End of while true*/
+
+	return 0;
+}
+
+/**
+*	@brief: record the occupancy of the ring from xDPd of a port, as it was before
+*		the packets just dequeued were taken
+*/
+static inline void sample_ring(struct nf_port_t *port, unsigned int dequeued)
+{
+	uint32_t occupancy = dequeued + rte_ring_count(port->to_nf_queue);
+
+	port->ring_stats->occupancy = occupancy;
+	port->ring_stats->occupancy_sum += occupancy;
+	port->ring_stats->polls++;
+}
+
+/**
+*	@brief: process the packets, received either from the ports (single lcore)
+*		or from the dispatcher
+*/
+int work(struct nf_worker_t *worker)
+{
+	unsigned int p;
+	mbuf_array_t pkts_received;
+	const struct nf_t *nf = nf_framework.nf;
+	struct nf_output_t out;
+	struct nf_backoff_t backoff_state;
+
+	out.pkts_to_send = (mbuf_array_t*)malloc(nf_framework.num_ports * sizeof(mbuf_array_t));
+	out.held_since = (uint64_t*)malloc(nf_framework.num_ports * sizeof(uint64_t));
+	out.stats = worker->stats;
+	for(p = 0; p < nf_framework.num_ports; p++)
+	{
+		out.pkts_to_send[p].n_mbufs = 0;
+		out.held_since[p] = 0;
+	}
+	backoff_state.idle_since = 0;
+
+	while(1)
+	{
+		int received = 0;
+
+		if(nf->poll != NULL)
+			nf->poll(worker->state);
+
+		/*0) Iterates on all the ports */
+		for(p = 0; p < nf_framework.num_ports; p++)
+		{
+			/*1) Receive incoming packets */
+
+			if(nf_framework.dispatcher)
+				pkts_received.n_mbufs = worker_ring_dequeue_burst(&worker->rings[p],&pkts_received.array[0],PKT_TO_NF_THRESHOLD);
+			else
+			{
+				pkts_received.n_mbufs = rte_ring_sc_dequeue_burst(nf_framework.ports[p].to_nf_queue,(void **)&pkts_received.array[0],PKT_TO_NF_THRESHOLD);
+				sample_ring(&nf_framework.ports[p],pkts_received.n_mbufs);
+			}
+
+			if(likely(pkts_received.n_mbufs > 0))
+			{
+#ifdef ENABLE_LOG
+				fprintf(logFile,"[%s] Lcore %d received %d pkts on port %d (%s)\n", nf->name, worker->lcore_id, pkts_received.n_mbufs,p,nf_framework.ports[p].name);
+#endif
+				unsigned int bucket = 31 - __builtin_clz(pkts_received.n_mbufs);
+				worker->stats[p].rx += pkts_received.n_mbufs;
+				worker->stats[p].bursts[(bucket < NF_STATS_BURST_BUCKETS)? bucket : NF_STATS_BURST_BUCKETS - 1]++;
+				received = 1;
+
+				/*2) Operate on the packets */
+				out.in_port = p;
+				uint64_t start = rte_rdtsc();
+				process_burst(worker,pkts_received.array,pkts_received.n_mbufs,&out);
+				worker->stats[p].cycles += rte_rdtsc() - start;
+			}
+		}//end iteration on the ports
+
+		/*3) Send the processed packet not transmitted yet*/
+		flush_ports(&out,received);
+
+		if(received)
+			backoff_state.idle_since = 0;
+		else
+			backoff(&backoff_state,worker);
+	}/*End of while true*/
+
+	return 0;
+}
+
+/**
+*	@brief: give the packets to the NF in batches of NF_BATCH_SIZE packets; the
+*		headers of the next batch are prefetched before processing a batch
+*/
+void process_burst(struct nf_worker_t *worker, struct rte_mbuf **pkts, unsigned int n, struct nf_output_t *out)
+{
+	unsigned int i, first;
+	uint64_t bytes = 0;
+
+	for(i = 0; i < n && i < NF_BATCH_SIZE; i++)
+		rte_prefetch0(rte_pktmbuf_mtod(pkts[i],void *));
+
+	for(i = 0; i < n; i++)
+		bytes += rte_pktmbuf_pkt_len(pkts[i]);
+	out->stats[out->in_port].rx_bytes += bytes;
+
+	for(first = 0; first < n; first += NF_BATCH_SIZE)
+	{
+		unsigned int batch = (n - first < NF_BATCH_SIZE)? n - first : NF_BATCH_SIZE;
+
+		for(i = first + NF_BATCH_SIZE; i < n && i < first + 2 * NF_BATCH_SIZE; i++)
+			rte_prefetch0(rte_pktmbuf_mtod(pkts[i],void *));
+
+		nf_framework.nf->process(&pkts[first],batch,out->in_port,out,worker->state);
+	}
+}
+
+/**
+*	@brief: send the packets buffered for the ports, at the end of an iteration
+*		of the loop of a worker. The packets of a port are kept in the buffer if
+*		they are less than the TX threshold, the oldest of them has been buffered
+*		for less than the TX timeout, and the iteration received packets
+*/
+void flush_ports(struct nf_output_t *out, int received)
+{
+	unsigned int p;
+	uint64_t now = 0;
+
+	for(p = 0; p < nf_framework.num_ports; p++)
+	{
+		unsigned int n = out->pkts_to_send[p].n_mbufs;
+		if(n == 0)
+			continue;
+
+		if(likely(n >= nf_framework.tx_threshold || !received))
+		{
+			nf_flush(out,p);
+			continue;
+		}
+
+		if(now == 0)
+			now = rte_rdtsc();
+		if(out->held_since[p] == 0)
+			out->held_since[p] = now;
+		else if(now - out->held_since[p] >= nf_framework.tx_timeout_cycles)
+			nf_flush(out,p);
+	}
+}
+
+void nf_flush(struct nf_output_t *out, unsigned int port)
+{
+	mbuf_array_t *pkts = &out->pkts_to_send[port];
+	uint64_t bytes = 0;
+	int i, ret;
+
+#ifdef ENABLE_LOG
+	fprintf(logFile,"[%s] Sending %d packets on port %x (%s).\n", nf_framework.nf->name,pkts->n_mbufs,port,nf_framework.ports[port].name);
+#endif
+
+	//When there are several workers, they share the rings towards xDPd
+	if(nf_framework.dispatcher)
+		ret = rte_ring_mp_enqueue_burst(nf_framework.ports[port].to_xdpd_queue,(void *const*)pkts->array,(unsigned)pkts->n_mbufs);
+	else
+		ret = rte_ring_sp_enqueue_burst(nf_framework.ports[port].to_xdpd_queue,(void *const*)pkts->array,(unsigned)pkts->n_mbufs);
+
+	for(i = 0; i < ret; i++)
+		bytes += rte_pktmbuf_pkt_len(pkts->array[i]);
+	out->stats[port].tx += ret;
+	out->stats[port].tx_bytes += bytes;
+
+	if (unlikely(ret < pkts->n_mbufs))
+	{
+#ifdef ENABLE_LOG
+		fprintf(logFile,"[%s] Not enough room in port %d towards xDPD to enqueue; the packet will be dropped.\n", nf_framework.nf->name,port);
+#endif
+		out->stats[port].tx_dropped += pkts->n_mbufs - ret;
+		do {
+			rte_pktmbuf_free(pkts->array[ret]);
+		} while (++ret < pkts->n_mbufs);
+	}
+
+	pkts->n_mbufs = 0;
+	out->held_since[port] = 0;
+}
+
+/**
+*	@brief: called after an iteration of the loop that did not receive any
+*		packet (see struct nf_backoff_t)
+*
+*	@param: worker	The worker executing the loop, or NULL for the dispatcher
+*/
+void backoff(struct nf_backoff_t *state, struct nf_worker_t *worker)
+{
+	unsigned int i;
+	uint64_t idle_cycles = nf_framework.idle_cycles;
+
+	if(idle_cycles == 0)
+		return;
+
+	uint64_t now = rte_rdtsc();
+	if(state->idle_since == 0)
+	{
+		state->idle_since = now;
+		state->sleep = BACKOFF_MIN_SLEEP;
+		return;
+	}
+
+	uint64_t idle = now - state->idle_since;
+	if(idle < idle_cycles)
+		return;
+
+	if(idle < 2 * idle_cycles)
+	{
+		for(i = 0; i < BACKOFF_PAUSES; i++)
+			_mm_pause();
+		return;
+	}
+
+	//The lcore can block if someone wakes it up when packets arrive
+	int can_block = (worker != NULL && nf_framework.dispatcher);
+#ifdef ENABLE_SEMAPHORE
+	can_block = 1;
+#endif
+
+	if(idle < 4 * idle_cycles || !can_block)
+	{
+		usleep(state->sleep);
+		if(state->sleep < BACKOFF_MAX_SLEEP)
+			state->sleep = (2 * state->sleep < BACKOFF_MAX_SLEEP)? 2 * state->sleep : BACKOFF_MAX_SLEEP;
+		return;
+	}
+
+	block(worker);
+}
+
+/**
+*	@brief: block until new packets arrive. A worker fed by the dispatcher waits on
+*		its eventfd; an lcore receiving from xDPd waits on the semaphore
+*/
+void block(struct nf_worker_t *worker)
+{
+	unsigned int p;
+
+	if(worker != NULL && nf_framework.dispatcher)
+	{
+		uint64_t value;
+
+		//The flag must be visible to the dispatcher before the rings are checked
+		worker->sleeping = 1;
+		rte_mb();
+		for(p = 0; p < nf_framework.num_ports; p++)
+		{
+			if(worker->rings[p].head != worker->rings[p].tail)
+				break;
+		}
+		if(p == nf_framework.num_ports && read(worker->wakeup_fd,&value,sizeof(value)) < 0)
+			fprintf(logFile,"[%s] Unable to wait on the eventfd of lcore %d\n",nf_framework.nf->name,worker->lcore_id);
+		worker->sleeping = 0;
+		return;
+	}
+
+#ifdef ENABLE_SEMAPHORE
+	//xDPd posts the semaphore each time it sends packets: the posts related to the
+	//packets already received are consumed, so that the wait ends with the next packets
+	while(sem_trywait(nf_framework.semaphore) == 0);
+
+	for(p = 0; p < nf_framework.num_ports; p++)
+	{
+		if(!rte_ring_empty(nf_framework.ports[p].to_nf_queue))
+			return;
+	}
+	sem_wait(nf_framework.semaphore);
+#endif
+}
+
+/**
+*	@brief: hash of the flow of a packet, used to select the worker. The hash
+*		is symmetric, so that the two directions of a connection are processed
+*		by the same worker. The IPv4 addresses and the TCP/UDP ports are used if
+*		present, otherwise the MAC addresses
+*/
+uint32_t dispatch_hash(const unsigned char *pkt, unsigned int len)
+{
+	uint32_t h;
+
+	if(len >= 34 && pkt[12] == 0x08 && pkt[13] == 0x00)
+	{
+		const unsigned char *ip = &pkt[14];
+		unsigned int hlen = (ip[0] & 0xF) * 4;
+
+		h = (*(const uint32_t*)&ip[12]) ^ (*(const uint32_t*)&ip[16]);
+		//Only the first fragment carries the ports, so they are not used for fragments
+		int fragment = ((ip[6] & 0x3F) | ip[7]) != 0;
+		if((ip[9] == 6 || ip[9] == 17) && !fragment && len >= 14 + hlen + 4)
+			h ^= (*(const uint16_t*)&ip[hlen]) ^ (*(const uint16_t*)&ip[hlen + 2]);
+	}
+	else if(len >= 12)
+		h = (*(const uint32_t*)&pkt[0]) ^ (*(const uint32_t*)&pkt[6]) ^ (*(const uint16_t*)&pkt[4]) ^ (*(const uint16_t*)&pkt[10]);
+	else
+		return 0;
+
+	h ^= h >> 16;
+	h *= 0x85EBCA6B;
+	h ^= h >> 13;
+
+	return h;
+}
+
+void nf_print_stats(FILE *file)
+{
+	unsigned int p, w;
+	uint64_t dispatch_dropped = 0;
+
+	for(p = 0; p < nf_framework.num_ports; p++)
+	{
+		struct nf_port_stats_t total;
+		memset(&total,0,sizeof(total));
+
+		for(w = 0; w < nf_framework.num_workers; w++)
+		{
+			total.rx += nf_framework.workers[w].stats[p].rx;
+			total.rx_bytes += nf_framework.workers[w].stats[p].rx_bytes;
+			total.tx += nf_framework.workers[w].stats[p].tx;
+			total.tx_bytes += nf_framework.workers[w].stats[p].tx_bytes;
+			total.dropped += nf_framework.workers[w].stats[p].dropped;
+			total.tx_dropped += nf_framework.workers[w].stats[p].tx_dropped;
+			total.cycles += nf_framework.workers[w].stats[p].cycles;
+		}
+
+		fprintf(file,"[%s] Port %d (%s): rx %" PRIu64 " (%" PRIu64 " bytes) tx %" PRIu64 " (%" PRIu64 " bytes) dropped by the NF %" PRIu64 " dropped on tx %" PRIu64 " cycles per packet %" PRIu64 "\n",
+			nf_framework.nf->name,p,nf_framework.ports[p].name,total.rx,total.rx_bytes,total.tx,total.tx_bytes,total.dropped,total.tx_dropped,
+			(total.rx != 0)? total.cycles / total.rx : 0);
+
+		struct nf_ring_stats_t *ring = nf_framework.ports[p].ring_stats;
+		if(ring->polls != 0 && ring->capacity != 0)
+			fprintf(file,"[%s] Port %d (%s): average occupancy of the ring from xDPd %.1f%%\n",
+				nf_framework.nf->name,p,nf_framework.ports[p].name,100.0 * ring->occupancy_sum / ring->polls / ring->capacity);
+	}
+
+	for(w = 0; w < nf_framework.num_workers; w++)
+		dispatch_dropped += nf_framework.workers[w].dispatch_stats->dispatch_dropped;
+	if(nf_framework.dispatcher)
+		fprintf(file,"[%s] Dropped by the dispatcher: %" PRIu64 "\n",nf_framework.nf->name,dispatch_dropped);
+}
@@ -0,0 +1,149 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+* @file nf_stats.h
+*
+* @brief Layout of the statistics exported by a DPDK NF in a POSIX shared memory
+* segment (option --m), so that the orchestrator can read them without
+* interacting with the NF. The segment contains:
+*	- a struct nf_stats_header_t;
+*	- num_workers struct nf_stats_worker_t, starting at workers_offset;
+*	- num_workers * num_ports struct nf_port_stats_t, starting at ports_offset
+*	  (the counters of port p of worker w are at index w * num_ports + p);
+*	- num_ports struct nf_ring_stats_t, starting at rings_offset.
+* Each counter is written by a single lcore, and read without synchronization.
+*
+* The orchestrator has its own copy of this layout (see
+* orchestrator/nfs_manager/dpdk_stats.h): NF_STATS_VERSION must be increased
+* each time the layout changes.
+*/
+
+#ifndef _NF_STATS_H_
+#define _NF_STATS_H_ 1
+
+#pragma once
+
+#include <stdint.h>
+
+#define NF_STATS_MAGIC			0x4E465354	/* "NFST" */
+#define NF_STATS_VERSION		2
+
+/**
+*	@brief: buckets of the histogram of the burst sizes. Bucket i counts the
+*		bursts of 2^i to 2^(i+1)-1 packets
+*/
+#define NF_STATS_BURST_BUCKETS	8
+
+#define NF_STATS_ALIGN			64
+
+struct nf_stats_header_t
+{
+	uint32_t magic;
+	uint32_t version;
+
+	uint32_t num_ports;
+	uint32_t num_workers;
+
+	/**
+	*	@brief: frequency of the TSC, used to convert the cycles into time
+	*/
+	uint64_t tsc_hz;
+
+	/**
+	*	@brief: position of the counters in the segment
+	*/
+	uint64_t workers_offset;
+	uint64_t ports_offset;
+	uint64_t rings_offset;
+
+	/**
+	*	@brief: 1 if the master lcore dispatches the packets to the workers
+	*/
+	uint32_t dispatcher;
+} __attribute__((aligned(NF_STATS_ALIGN)));
+
+struct nf_stats_worker_t
+{
+	/**
+	*	@brief: lcore running the worker
+	*/
+	uint32_t lcore_id;
+
+	/**
+	*	@brief: packets dropped by the dispatcher because the rings towards the
+	*		worker were full (written only by the dispatcher)
+	*/
+	uint64_t dispatch_dropped;
+} __attribute__((aligned(NF_STATS_ALIGN)));
+
+struct nf_port_stats_t
+{
+	/**
+	*	@brief: packets and bytes received from xDPd
+	*/
+	uint64_t rx;
+	uint64_t rx_bytes;
+
+	/**
+	*	@brief: packets and bytes sent to xDPd
+	*/
+	uint64_t tx;
+	uint64_t tx_bytes;
+
+	/**
+	*	@brief: packets received from the port and dropped by the NF
+	*/
+	uint64_t dropped;
+
+	/**
+	*	@brief: packets dropped because the ring towards xDPd was full
+	*/
+	uint64_t tx_dropped;
+
+	/**
+	*	@brief: TSC cycles spent by the NF processing the packets received
+	*		from the port
+	*/
+	uint64_t cycles;
+
+	/**
+	*	@brief: histogram of the size of the bursts received from the port
+	*/
+	uint64_t bursts[NF_STATS_BURST_BUCKETS];
+} __attribute__((aligned(NF_STATS_ALIGN)));
+
+/**
+*	@brief: occupancy of the ring through which a port receives the packets from
+*		xDPd, sampled at each poll of the ring (written only by the lcore polling
+*		it, i.e., the dispatcher or the only worker). The average occupancy in an
+*		interval is the increase of occupancy_sum divided by the increase of polls
+*/
+struct nf_ring_stats_t
+{
+	/**
+	*	@brief: packets that the ring can hold
+	*/
+	uint32_t capacity;
+
+	/**
+	*	@brief: packets in the ring at the last poll
+	*/
+	uint32_t occupancy;
+
+	uint64_t polls;
+	uint64_t occupancy_sum;
+} __attribute__((aligned(NF_STATS_ALIGN)));
+
+/**
+*	@brief: size of the segment
+*/
+static inline uint64_t nf_stats_size(uint32_t num_workers, uint32_t num_ports)
+{
+	return sizeof(struct nf_stats_header_t) + num_workers * sizeof(struct nf_stats_worker_t)
+		+ (uint64_t)num_workers * num_ports * sizeof(struct nf_port_stats_t)
+		+ (uint64_t)num_ports * sizeof(struct nf_ring_stats_t);
+}
+
+#endif //_NF_STATS_H_
@@ -0,0 +1,92 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+* @file worker_ring.h
+*
+* @brief Single producer / single consumer ring used by the dispatcher to pass
+* packets to a worker lcore. The rings are private to the NF, so they are
+* allocated in the memory of the process instead of in a memzone, which would
+* be shared with xDPd and the other NFs, and never released.
+*/
+
+#ifndef _WORKER_RING_H_
+#define _WORKER_RING_H_ 1
+
+#pragma once
+
+#include <rte_atomic.h>
+#include <rte_mbuf.h>
+
+/**
+*	@brief: number of packets of a ring; it must be a power of 2
+*/
+#define WORKER_RING_SIZE		1024
+#define WORKER_RING_MASK		(WORKER_RING_SIZE - 1)
+
+struct worker_ring_t
+{
+	/**
+	*	@brief: written only by the dispatcher
+	*/
+	volatile uint32_t head __rte_cache_aligned;
+
+	/**
+	*	@brief: written only by the worker
+	*/
+	volatile uint32_t tail __rte_cache_aligned;
+
+	struct rte_mbuf *slots[WORKER_RING_SIZE] __rte_cache_aligned;
+};
+
+/**
+*	@brief: enqueue up to n packets
+*
+*	@return: the number of packets enqueued
+*/
+static inline unsigned int worker_ring_enqueue_burst(struct worker_ring_t *ring, struct rte_mbuf **pkts, unsigned int n)
+{
+	unsigned int i;
+	uint32_t head = ring->head;
+	uint32_t free_slots = WORKER_RING_SIZE - (head - ring->tail);
+
+	if(n > free_slots)
+		n = free_slots;
+
+	for(i = 0; i < n; i++)
+		ring->slots[(head + i) & WORKER_RING_MASK] = pkts[i];
+
+	//The packets must be visible before the new head
+	rte_wmb();
+	ring->head = head + n;
+
+	return n;
+}
+
+/**
+*	@brief: dequeue up to n packets
+*
+*	@return: the number of packets dequeued
+*/
+static inline unsigned int worker_ring_dequeue_burst(struct worker_ring_t *ring, struct rte_mbuf **pkts, unsigned int n)
+{
+	unsigned int i;
+	uint32_t tail = ring->tail;
+	uint32_t available = ring->head - tail;
+
+	if(n > available)
+		n = available;
+
+	//The packets must be read after the head
+	rte_rmb();
+	for(i = 0; i < n; i++)
+		pkts[i] = ring->slots[(tail + i) & WORKER_RING_MASK];
+
+	rte_compiler_barrier();
+	ring->tail = tail + n;
+
+	return n;
+}
+
+#endif //_WORKER_RING_H_
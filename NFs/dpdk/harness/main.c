@@ -0,0 +1,238 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+* @file main.c
+*
+* @brief Command line and creation of the resources shared with the NF.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <fcntl.h>
+
+#include <rte_eal.h>
+#include <rte_lcore.h>
+
+#include "main.h"
+
+struct harness_params_t params;
+
+/**
+*	Private prototypes
+*/
+void usage(void);
+int parse_command_line(int argc, char *argv[]);
+int init_resources(void);
+
+/**
+*	Implementations
+*/
+
+void usage(void)
+{
+	char message[]=	\
+
+	"Usage:                                                                                   \n" \
+	"  sudo ./harness -c core_mask -n memory_channels -- --p port_name [--p port_name ...]   \n" \
+	"                --f pcap_file [options]                                                  \n" \
+	"                                                                                         \n" \
+	"Parameters:                                                                              \n" \
+	"  -c core_mask                                                                           \n" \
+	"        Lcore used by the harness (only the first one is used). It must not be used by   \n" \
+	"        the NF.                                                                          \n" \
+	"  -n memory_channels                                                                     \n" \
+	"        Number of channels used to access to the memory.                                 \n" \
+	"  --p port_name                                                                          \n" \
+	"        Name of a port of the NF, as given to the NF. This parameter must be repeated    \n" \
+	"        once for each port of the NF. The packets are sent to the first port.            \n" \
+	"  --f pcap_file                                                                          \n" \
+	"        File with the packets to be sent to the NF.                                      \n" \
+	"                                                                                         \n" \
+	"Options:                                                                                 \n" \
+	"  --s semaphore_name                                                                     \n" \
+	"        Semaphore given to the NF, posted each time packets are sent to the NF (required \n" \
+	"        if the NF is compiled with the flag ENABLE_SEMAPHORE).                           \n" \
+	"  --m segment_name                                                                       \n" \
+	"        Shared memory segment given to the NF to export its statistics; they are used to \n" \
+	"        report the packets dropped by the NF, and the cycles spent by the NF.            \n" \
+	"  --r packets_per_second                                                                 \n" \
+	"        Rate of the packets sent to the NF (default: as fast as the NF receives them).   \n" \
+	"  --n loops                                                                              \n" \
+	"        Times the pcap file is sent (default: 1).                                        \n" \
+	"  --w seconds                                                                            \n" \
+	"        Time waited for the NF before sending the packets (default: 5). With --m, the    \n" \
+	"        harness starts as soon as the NF exports its statistics.                         \n" \
+	"  --v                                                                                    \n" \
+	"        Check that the packets sent by the NF are equal to the ones sent to the NF.      \n" \
+	"  --h                                                                                    \n" \
+	"        Print this help.                                                                 \n";
+
+	fprintf(stderr,"\n\n[%s] %s\n",NAME,message);
+}
+
+/**
+* @brief Parses the command line
+*
+* @param argc	Number of parameters in the command line (excluding those used
+*				the EAL)
+* @param argv	The command line (except the parameters used by the EAL)
+*/
+int parse_command_line(int argc, char *argv[])
+{
+	int opt;
+	int option_index;
+	char *pcap_file = NULL;
+	static const struct option lgopts[] = {
+		{"p", 1, 0, 0},
+		{"f", 1, 0, 0},
+		{"s", 1, 0, 0},
+		{"m", 1, 0, 0},
+		{"r", 1, 0, 0},
+		{"n", 1, 0, 0},
+		{"w", 1, 0, 0},
+		{"v", 0, 0, 0},
+		{"h", 0, 0, 0},
+		{NULL, 0, 0, 0}
+	};
+
+	memset(&params,0,sizeof(params));
+	params.loops = 1;
+	params.wait = DEFAULT_WAIT;
+
+	while ((opt = getopt_long(argc, argv, "", lgopts, &option_index)) != EOF)
+	{
+		if(opt != 0)
+			return -1;
+
+		const char *name = lgopts[option_index].name;
+		if (!strcmp(name, "p"))/* port */
+		{
+			params.port_names = (char**)realloc(params.port_names,(params.num_ports + 1) * sizeof(char*));
+			params.port_names[params.num_ports] = strdup(optarg);
+			params.num_ports++;
+		}
+		else if (!strcmp(name, "f"))/* pcap file */
+			pcap_file = optarg;
+		else if (!strcmp(name, "s"))/* semaphore */
+			params.sem_name = strdup(optarg);
+		else if (!strcmp(name, "m"))/* statistics of the NF */
+		{
+			//The names of the POSIX shared memory segments start with a slash
+			params.stats_name = (char*)malloc(strlen(optarg) + 2);
+			sprintf(params.stats_name,"%s%s",(optarg[0] == '/')? "" : "/",optarg);
+		}
+		else if (!strcmp(name, "r") || !strcmp(name, "n") || !strcmp(name, "w"))
+		{
+			char *end;
+			unsigned long value = strtoul(optarg,&end,10);
+			if(*optarg == '\0' || *end != '\0')
+			{
+				fprintf(stderr,"[%s] Invalid value '%s' for the parameter '--%s'\n",NAME,optarg,name);
+				return -1;
+			}
+			if(!strcmp(name, "r"))
+				params.rate = value;
+			else if(!strcmp(name, "n"))
+				params.loops = value;
+			else
+				params.wait = value;
+		}
+		else if (!strcmp(name, "v"))/* verify */
+			params.verify = 1;
+		else/* help */
+			return -1;
+	}
+
+	if(params.num_ports == 0 || pcap_file == NULL)
+	{
+		fprintf(stderr,"[%s] Not all mandatory arguments are present in the command line\n",NAME);
+		return -1;
+	}
+
+	if(pcap_load(pcap_file,&params.packets,&params.num_packets) < 0)
+		return -1;
+
+	fprintf(stderr,"[%s] %u packets read from '%s'\n",NAME,params.num_packets,pcap_file);
+
+	return 0;
+}
+
+/**
+*	@brief: create the resources used by the NF, as xDPd does
+*/
+int init_resources(void)
+{
+	unsigned int i;
+	char name[NAME_LENGTH];
+
+	snprintf(name,NAME_LENGTH,POOL_NAME,rte_socket_id());
+	params.pool = rte_mempool_create(name,NUM_MBUFS,MBUF_SIZE,MBUF_CACHE_SIZE,sizeof(struct rte_pktmbuf_pool_private),
+		rte_pktmbuf_pool_init,NULL,rte_pktmbuf_init,NULL,rte_socket_id(),0);
+	if(params.pool == NULL)
+	{
+		fprintf(stderr,"[%s] Cannot create the mbuf pool '%s'\n",NAME,name);
+		return -1;
+	}
+
+	params.to_nf_queues = (struct rte_ring**)malloc(params.num_ports * sizeof(struct rte_ring*));
+	params.to_xdpd_queues = (struct rte_ring**)malloc(params.num_ports * sizeof(struct rte_ring*));
+	for(i = 0; i < params.num_ports; i++)
+	{
+		snprintf(name,NAME_LENGTH,RING_TO_NF_NAME,params.port_names[i]);
+		params.to_nf_queues[i] = rte_ring_create(name,RING_SIZE,rte_socket_id(),0);
+
+		snprintf(name,NAME_LENGTH,RING_TO_XDPD_NAME,params.port_names[i]);
+		params.to_xdpd_queues[i] = rte_ring_create(name,RING_SIZE,rte_socket_id(),0);
+
+		if(params.to_nf_queues[i] == NULL || params.to_xdpd_queues[i] == NULL)
+		{
+			fprintf(stderr,"[%s] Cannot create the rings of the port '%s'\n",NAME,params.port_names[i]);
+			return -1;
+		}
+	}
+
+	if(params.sem_name != NULL)
+	{
+		//A semaphore left by a previous execution is removed, so that it starts from 0
+		sem_unlink(params.sem_name);
+		params.semaphore = sem_open(params.sem_name,O_CREAT,0644,0);
+		if(params.semaphore == SEM_FAILED)
+		{
+			fprintf(stderr,"[%s] Cannot create the semaphore '%s'\n",NAME,params.sem_name);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+int MAIN(int argc, char *argv[])
+{
+	int ret = rte_eal_init(argc, argv);
+	if (ret < 0)
+	{
+		fprintf(stderr,"[%s] Cannot initialize the EAL\n",NAME);
+		return 1;
+	}
+	argc -= ret;
+	argv += ret;
+
+	if(parse_command_line(argc,argv) < 0)
+	{
+		usage();
+		return 1;
+	}
+
+	if(init_resources() < 0)
+		return 1;
+
+	run();
+
+	if(params.sem_name != NULL)
+		sem_unlink(params.sem_name);
+
+	return 0;
+}
@@ -0,0 +1,154 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+* @file main.h
+*
+* @brief Harness used to run a DPDK NF without xDPd. The harness is the DPDK
+* primary process: it creates the resources that the NF expects from xDPd (rings,
+* mbuf pool, semaphore), sends to the NF the packets of a pcap file, receives the
+* packets sent by the NF, and reports the performance of the NF.
+*/
+
+#ifndef _MAIN_H_
+#define _MAIN_H_ 1
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <semaphore.h>
+
+#include <rte_mbuf.h>
+#include <rte_ring.h>
+#include <rte_mempool.h>
+
+#define NAME 					"HARNESS"
+
+#define NAME_LENGTH				100
+
+/**
+*	@brief: resources created by xDPd for the ports of an NF. The names must be
+*		the ones expected by the NFs (see ../framework/nf_init.c)
+*/
+#define RING_TO_NF_NAME			"%s-to-nf"
+#define RING_TO_XDPD_NAME		"%s-to-xdpd"
+#define POOL_NAME				"pool_%u"
+#define RING_SIZE				2048
+
+/**
+*	@brief: mbufs of the pool
+*/
+#define NUM_MBUFS				16384
+#define MBUF_CACHE_SIZE			256
+#define MBUF_DATA_SIZE			2048
+#define MBUF_SIZE				(MBUF_DATA_SIZE + sizeof(struct rte_mbuf) + RTE_PKTMBUF_HEADROOM)
+
+/**
+*	@brief: maximum number of packets sent/received at once
+*/
+#define BURST_SIZE				32
+
+/**
+*	@brief: the harness stops when no packet arrives from the NF for this time
+*		(in milliseconds), after all the packets have been sent
+*/
+#define DRAIN_TIMEOUT			200
+
+/**
+*	@brief: seconds waited for the NF before sending packets (option --w)
+*/
+#define DEFAULT_WAIT			5
+
+/**
+*	@brief: packets whose latency is measured. They are identified by the tag
+*		written at the beginning of their buffer, in the headroom (so that it is
+*		not modified by the NF unless it adds a header longer than the headroom
+*		minus the tag)
+*/
+#define TAG_MAGIC				0x48524E5354414721ULL
+#define LATENCY_SAMPLES			(1 << 20)
+#define IN_FLIGHT_WINDOW		(1 << 16)
+
+struct tag_t
+{
+	uint64_t magic;
+	uint64_t seq;
+};
+
+/**
+*	@brief: packet read from the pcap file
+*/
+struct pcap_packet_t
+{
+	uint8_t *data;
+	uint32_t len;
+};
+
+struct harness_params_t
+{
+	/**
+	*	@brief: ports of the NF; the packets are sent to the first one
+	*/
+	unsigned int num_ports;
+	char **port_names;
+	struct rte_ring **to_nf_queues;
+	struct rte_ring **to_xdpd_queues;
+
+	/**
+	*	@brief: semaphore posted each time packets are sent to the NF (NULL if
+	*		the NF does not use it)
+	*/
+	char *sem_name;
+	sem_t *semaphore;
+
+	/**
+	*	@brief: shared memory segment with the statistics of the NF (NULL if not
+	*		given), used to report the drops and the cycles of the NF
+	*/
+	char *stats_name;
+
+	struct rte_mempool *pool;
+
+	/**
+	*	@brief: packets of the pcap file
+	*/
+	struct pcap_packet_t *packets;
+	uint32_t num_packets;
+
+	/**
+	*	@brief: times the pcap file is sent, rate in packets per second (0 means
+	*		as fast as the NF receives them), seconds waited for the NF
+	*/
+	unsigned long loops;
+	unsigned long rate;
+	unsigned long wait;
+
+	/**
+	*	@brief: true if the packets sent by the NF must be equal to the ones sent
+	*		to the NF
+	*/
+	int verify;
+};
+
+extern struct harness_params_t params;
+
+/**
+*	@brief: read all the packets of a pcap file. Returns a negative value in
+*		case of error
+*/
+int pcap_load(const char *file, struct pcap_packet_t **packets, uint32_t *num_packets);
+
+/**
+*	@brief: send the packets to the NF, receive them back, and print the report
+*/
+void run(void);
+
+#ifdef RTE_EXEC_ENV_BAREMETAL
+	#define MAIN _main
+#else
+	#define MAIN main
+#endif
+
+#endif /* _MAIN_H_ */
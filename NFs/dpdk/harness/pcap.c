@@ -0,0 +1,121 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+* @file pcap.c
+*
+* @brief Reader of the pcap files (the libpcap format, with timestamps in
+* microseconds or nanoseconds, in both the byte orders).
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "main.h"
+
+#define PCAP_MAGIC				0xA1B2C3D4
+#define PCAP_MAGIC_NSEC			0xA1B23C4D
+#define PCAP_MAGIC_SWAPPED		0xD4C3B2A1
+#define PCAP_MAGIC_NSEC_SWAPPED	0x4D3CB2A1
+#define PCAP_LINKTYPE_ETHERNET	1
+
+struct pcap_file_header_t
+{
+	uint32_t magic;
+	uint16_t version_major;
+	uint16_t version_minor;
+	int32_t thiszone;
+	uint32_t sigfigs;
+	uint32_t snaplen;
+	uint32_t linktype;
+};
+
+struct pcap_record_header_t
+{
+	uint32_t ts_sec;
+	uint32_t ts_frac;
+	uint32_t caplen;
+	uint32_t len;
+};
+
+int pcap_load(const char *file, struct pcap_packet_t **packets, uint32_t *num_packets)
+{
+	struct pcap_file_header_t header;
+	struct pcap_record_header_t record;
+	uint32_t allocated = 0;
+	int swapped;
+
+	FILE *f = fopen(file,"rb");
+	if(f == NULL)
+	{
+		fprintf(stderr,"[%s] Unable to open the pcap file '%s'\n",NAME,file);
+		return -1;
+	}
+
+	if(fread(&header,sizeof(header),1,f) != 1)
+	{
+		fprintf(stderr,"[%s] The file '%s' is too short\n",NAME,file);
+		fclose(f);
+		return -1;
+	}
+
+	if(header.magic == PCAP_MAGIC || header.magic == PCAP_MAGIC_NSEC)
+		swapped = 0;
+	else if(header.magic == PCAP_MAGIC_SWAPPED || header.magic == PCAP_MAGIC_NSEC_SWAPPED)
+		swapped = 1;
+	else
+	{
+		fprintf(stderr,"[%s] The file '%s' is not a pcap file\n",NAME,file);
+		fclose(f);
+		return -1;
+	}
+
+	if((swapped? __builtin_bswap32(header.linktype) : header.linktype) != PCAP_LINKTYPE_ETHERNET)
+	{
+		fprintf(stderr,"[%s] The file '%s' does not contain Ethernet frames\n",NAME,file);
+		fclose(f);
+		return -1;
+	}
+
+	*packets = NULL;
+	*num_packets = 0;
+
+	while(fread(&record,sizeof(record),1,f) == 1)
+	{
+		uint32_t caplen = swapped? __builtin_bswap32(record.caplen) : record.caplen;
+		if(caplen > MBUF_DATA_SIZE)
+		{
+			fprintf(stderr,"[%s] The packet %u of '%s' is too long (%u bytes)\n",NAME,*num_packets + 1,file,caplen);
+			fclose(f);
+			return -1;
+		}
+
+		if(*num_packets == allocated)
+		{
+			allocated = (allocated == 0)? 1024 : 2 * allocated;
+			*packets = (struct pcap_packet_t*)realloc(*packets,allocated * sizeof(struct pcap_packet_t));
+		}
+
+		struct pcap_packet_t *p = &(*packets)[*num_packets];
+		p->len = caplen;
+		p->data = (uint8_t*)malloc(caplen);
+		if(fread(p->data,1,caplen,f) != caplen)
+		{
+			//The last packet is truncated
+			free(p->data);
+			break;
+		}
+		(*num_packets)++;
+	}
+
+	fclose(f);
+
+	if(*num_packets == 0)
+	{
+		fprintf(stderr,"[%s] The file '%s' does not contain packets\n",NAME,file);
+		return -1;
+	}
+
+	return 0;
+}
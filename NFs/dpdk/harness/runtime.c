@@ -0,0 +1,377 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+* @file runtime.c
+*
+* @brief Sends the packets to the NF, receives them back and measures the NF.
+*/
+
+#include <inttypes.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <rte_cycles.h>
+
+#include "main.h"
+#include "nf_stats.h"
+
+struct harness_counters_t
+{
+	/**
+	*	@brief: packets sent to the NF, and received from the NF
+	*/
+	uint64_t sent;
+	uint64_t received;
+
+	/**
+	*	@brief: packets received whose latency has been measured, and packets
+	*		that cannot be associated with a packet sent (created by the NF, or
+	*		duplicated)
+	*/
+	uint64_t measured;
+	uint64_t unknown;
+
+	/**
+	*	@brief: packets different from the ones sent (option --v)
+	*/
+	uint64_t modified;
+};
+
+/**
+*	@brief: counters exported by the NF, summed over all its ports and lcores
+*/
+struct nf_totals_t
+{
+	uint64_t rx;
+	uint64_t dropped;
+	uint64_t tx_dropped;
+	uint64_t dispatch_dropped;
+	uint64_t cycles;
+};
+
+/**
+*	Private prototypes
+*/
+struct nf_stats_header_t *wait_nf(void);
+void read_nf_stats(struct nf_stats_header_t *stats, struct nf_totals_t *totals);
+struct rte_mbuf *create_packet(uint64_t seq);
+void check_packet(struct rte_mbuf *pkt, uint64_t now, uint64_t last_seq, struct harness_counters_t *counters);
+int equal(struct rte_mbuf *pkt, const struct pcap_packet_t *original);
+void add_latency(uint64_t latency);
+int compare_latencies(const void *a, const void *b);
+void report(struct harness_counters_t *counters, uint64_t elapsed, struct nf_totals_t *nf_before, struct nf_totals_t *nf_after);
+
+/**
+*	@brief: TSC at which the packets in flight have been sent (0 if not in
+*		flight), indexed by their sequence number modulo IN_FLIGHT_WINDOW
+*/
+static uint64_t sent_tsc[IN_FLIGHT_WINDOW];
+
+/**
+*	@brief: latencies measured (a uniform sample of them, when more than
+*		LATENCY_SAMPLES packets are measured)
+*/
+static uint64_t *latencies;
+static uint64_t num_latencies;
+static uint64_t latencies_seen;
+
+/**
+*	Implementations
+*/
+
+void run(void)
+{
+	struct harness_counters_t counters;
+	struct nf_totals_t nf_before, nf_after;
+	struct rte_mbuf *pkts[BURST_SIZE];
+	unsigned int i, p;
+
+	memset(&counters,0,sizeof(counters));
+	memset(&nf_before,0,sizeof(nf_before));
+	memset(&nf_after,0,sizeof(nf_after));
+	latencies = (uint64_t*)malloc(LATENCY_SAMPLES * sizeof(uint64_t));
+
+	struct nf_stats_header_t *stats = wait_nf();
+	if(stats != NULL)
+		read_nf_stats(stats,&nf_before);
+
+	uint64_t hz = rte_get_tsc_hz();
+	uint64_t interval = (params.rate != 0)? hz / params.rate : 0;
+	uint64_t drain = hz / 1000 * DRAIN_TIMEOUT;
+	uint64_t total = (uint64_t)params.loops * params.num_packets;
+	uint64_t seq = 0;
+
+	fprintf(stderr,"[%s] Sending %" PRIu64 " packets to the NF\n",NAME,total);
+
+	uint64_t start = rte_rdtsc();
+	uint64_t next_send = start;
+	uint64_t last_activity = start;
+	uint64_t last_received = start;
+
+	while(1)
+	{
+		uint64_t now = rte_rdtsc();
+
+		/* 1) Send a burst to the first port of the NF, according to the rate */
+		if(seq < total && now >= next_send)
+		{
+			unsigned int n = BURST_SIZE;
+			if(interval != 0 && (now - next_send) / interval + 1 < n)
+				n = (now - next_send) / interval + 1;
+			if(seq + n > total)
+				n = total - seq;
+			//When the ring is full, the packets are sent later, so that the NF is never overloaded
+			if(rte_ring_free_count(params.to_nf_queues[0]) < n)
+				n = rte_ring_free_count(params.to_nf_queues[0]);
+
+			for(i = 0; i < n; i++)
+			{
+				pkts[i] = create_packet(seq + i);
+				if(pkts[i] == NULL)
+					break;//The mbufs are all in use
+			}
+			n = i;
+
+			if(n > 0)
+			{
+				now = rte_rdtsc();
+				for(i = 0; i < n; i++)
+					sent_tsc[(seq + i) % IN_FLIGHT_WINDOW] = now;
+
+				rte_ring_sp_enqueue_burst(params.to_nf_queues[0],(void *const*)pkts,n);
+				if(params.semaphore != NULL)
+					sem_post(params.semaphore);
+
+				seq += n;
+				counters.sent += n;
+				last_activity = now;
+				if(interval != 0)
+					next_send += n * interval;
+			}
+		}
+
+		/* 2) Receive the packets sent by the NF */
+		for(p = 0; p < params.num_ports; p++)
+		{
+			unsigned int n = rte_ring_sc_dequeue_burst(params.to_xdpd_queues[p],(void **)pkts,BURST_SIZE);
+			if(n == 0)
+				continue;
+
+			now = rte_rdtsc();
+			for(i = 0; i < n; i++)
+				check_packet(pkts[i],now,seq,&counters);
+			counters.received += n;
+			last_activity = last_received = now;
+		}
+
+		/* 3) Stop when the NF does not send packets anymore */
+		if(seq == total && rte_rdtsc() - last_activity > drain)
+			break;
+	}
+
+	if(stats != NULL)
+		read_nf_stats(stats,&nf_after);
+
+	report(&counters,last_received - start,&nf_before,&nf_after);
+}
+
+/**
+*	@brief: wait for the NF. Returns the statistics exported by the NF, if any
+*/
+struct nf_stats_header_t *wait_nf(void)
+{
+	if(params.stats_name == NULL)
+	{
+		fprintf(stderr,"[%s] Waiting %lu seconds for the NF...\n",NAME,params.wait);
+		sleep(params.wait);
+		return NULL;
+	}
+
+	fprintf(stderr,"[%s] Waiting for the NF to export its statistics in '%s'...\n",NAME,params.stats_name);
+	while(1)
+	{
+		int fd = shm_open(params.stats_name,O_RDONLY,0);
+		struct stat st;
+
+		if(fd >= 0 && fstat(fd,&st) == 0 && (size_t)st.st_size >= sizeof(struct nf_stats_header_t))
+		{
+			struct nf_stats_header_t *stats = (struct nf_stats_header_t*)mmap(NULL,st.st_size,PROT_READ,MAP_SHARED,fd,0);
+			close(fd);
+
+			if(stats != MAP_FAILED)
+			{
+				//The magic number is written when the NF is ready
+				if(stats->magic == NF_STATS_MAGIC && stats->version == NF_STATS_VERSION
+					&& nf_stats_size(stats->num_workers,stats->num_ports) <= (uint64_t)st.st_size)
+					return stats;
+				munmap(stats,st.st_size);
+			}
+		}
+		else if(fd >= 0)
+			close(fd);
+
+		usleep(100000);
+	}
+}
+
+void read_nf_stats(struct nf_stats_header_t *stats, struct nf_totals_t *totals)
+{
+	uint32_t i;
+	struct nf_stats_worker_t *workers = (struct nf_stats_worker_t*)((char*)stats + stats->workers_offset);
+	struct nf_port_stats_t *ports = (struct nf_port_stats_t*)((char*)stats + stats->ports_offset);
+
+	memset(totals,0,sizeof(*totals));
+	for(i = 0; i < stats->num_workers; i++)
+		totals->dispatch_dropped += workers[i].dispatch_dropped;
+	for(i = 0; i < stats->num_workers * stats->num_ports; i++)
+	{
+		totals->rx += ports[i].rx;
+		totals->dropped += ports[i].dropped;
+		totals->tx_dropped += ports[i].tx_dropped;
+		totals->cycles += ports[i].cycles;
+	}
+}
+
+/**
+*	@brief: create the packet with a given sequence number, and tag it
+*/
+struct rte_mbuf *create_packet(uint64_t seq)
+{
+	const struct pcap_packet_t *original = &params.packets[seq % params.num_packets];
+
+	struct rte_mbuf *pkt = rte_pktmbuf_alloc(params.pool);
+	if(unlikely(pkt == NULL))
+		return NULL;
+
+	char *data = rte_pktmbuf_append(pkt,original->len);
+	memcpy(data,original->data,original->len);
+
+	struct tag_t *tag = (struct tag_t*)pkt->buf_addr;
+	tag->magic = TAG_MAGIC;
+	tag->seq = seq;
+
+	return pkt;
+}
+
+/**
+*	@brief: measure the latency of a packet received from the NF, and free it
+*
+*	@param: last_seq	Sequence number of the next packet to be sent
+*/
+void check_packet(struct rte_mbuf *pkt, uint64_t now, uint64_t last_seq, struct harness_counters_t *counters)
+{
+	//The tag of a packet cloned by the NF is in the buffer of the original packet
+	struct tag_t *tag = (struct tag_t*)pkt->buf_addr;
+	uint64_t seq = tag->seq;
+
+	if(tag->magic == TAG_MAGIC && seq < last_seq && seq + IN_FLIGHT_WINDOW >= last_seq && sent_tsc[seq % IN_FLIGHT_WINDOW] != 0)
+	{
+		add_latency(now - sent_tsc[seq % IN_FLIGHT_WINDOW]);
+		sent_tsc[seq % IN_FLIGHT_WINDOW] = 0;
+		counters->measured++;
+
+		if(params.verify && !equal(pkt,&params.packets[seq % params.num_packets]))
+			counters->modified++;
+	}
+	else
+		counters->unknown++;
+
+	//The tag is removed, so that it is not found if the NF reuses the mbuf
+	if(RTE_MBUF_DIRECT(pkt) && rte_mbuf_refcnt_read(pkt) == 1)
+		tag->magic = 0;
+
+	rte_pktmbuf_free(pkt);
+}
+
+/**
+*	@brief: compare a packet, possibly made of several segments, with the
+*		original one
+*/
+int equal(struct rte_mbuf *pkt, const struct pcap_packet_t *original)
+{
+	uint32_t offset = 0;
+
+	if(rte_pktmbuf_pkt_len(pkt) != original->len)
+		return 0;
+
+	for(; pkt != NULL; pkt = pkt->pkt.next)
+	{
+		if(memcmp(rte_pktmbuf_mtod(pkt,void *),&original->data[offset],rte_pktmbuf_data_len(pkt)) != 0)
+			return 0;
+		offset += rte_pktmbuf_data_len(pkt);
+	}
+
+	return 1;
+}
+
+/**
+*	@brief: store a latency; after LATENCY_SAMPLES latencies, a uniform sample
+*		is kept (reservoir sampling)
+*/
+void add_latency(uint64_t latency)
+{
+	static uint64_t random = 88172645463325252ULL;
+
+	latencies_seen++;
+	if(num_latencies < LATENCY_SAMPLES)
+	{
+		latencies[num_latencies++] = latency;
+		return;
+	}
+
+	random ^= random << 13;
+	random ^= random >> 7;
+	random ^= random << 17;
+	uint64_t j = random % latencies_seen;
+	if(j < LATENCY_SAMPLES)
+		latencies[j] = latency;
+}
+
+int compare_latencies(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+	return (x > y) - (x < y);
+}
+
+void report(struct harness_counters_t *counters, uint64_t elapsed, struct nf_totals_t *nf_before, struct nf_totals_t *nf_after)
+{
+	double hz = (double)rte_get_tsc_hz();
+	double seconds = elapsed / hz;
+	unsigned int i;
+
+	fprintf(stdout,"[%s] Packets sent: %" PRIu64 ", received: %" PRIu64 " (%" PRIu64 " not sent by the harness or duplicated)\n",
+		NAME,counters->sent,counters->received,counters->unknown);
+	fprintf(stdout,"[%s] Packets lost: %" PRIu64 "\n",NAME,counters->sent - counters->measured);
+	if(params.verify)
+		fprintf(stdout,"[%s] Packets modified by the NF: %" PRIu64 "\n",NAME,counters->modified);
+	if(seconds > 0)
+		fprintf(stdout,"[%s] Duration: %.3f s, throughput: %.3f Mpps sent, %.3f Mpps received\n",
+			NAME,seconds,counters->sent / seconds / 1e6,counters->received / seconds / 1e6);
+
+	if(params.stats_name != NULL)
+	{
+		uint64_t rx = nf_after->rx - nf_before->rx;
+		uint64_t cycles = nf_after->cycles - nf_before->cycles;
+		fprintf(stdout,"[%s] NF: received %" PRIu64 ", dropped by the NF %" PRIu64 ", dropped on tx %" PRIu64 ", dropped by the dispatcher %" PRIu64 "\n",
+			NAME,rx,nf_after->dropped - nf_before->dropped,nf_after->tx_dropped - nf_before->tx_dropped,nf_after->dispatch_dropped - nf_before->dispatch_dropped);
+		if(rx != 0)
+			fprintf(stdout,"[%s] NF: %.1f cycles per packet\n",NAME,(double)cycles / rx);
+	}
+
+	if(num_latencies == 0)
+		return;
+
+	static const double percentiles[] = {50, 90, 99, 99.9, 100};
+	qsort(latencies,num_latencies,sizeof(uint64_t),compare_latencies);
+	fprintf(stdout,"[%s] Latency (us):",NAME);
+	for(i = 0; i < sizeof(percentiles) / sizeof(percentiles[0]); i++)
+	{
+		uint64_t index = (uint64_t)(percentiles[i] / 100 * (num_latencies - 1));
+		fprintf(stdout," p%g %.2f",percentiles[i],latencies[index] / hz * 1e6);
+	}
+	fprintf(stdout,"\n");
+}
@@ -4,10 +4,19 @@ Controller::Controller(rofl::openflow::cofhello_elem_versionbitmap const& versio
 	crofbase(versionbitmap),
 	dpt(NULL),
 	isOpen(false),
-	graph(graph),
+	version(0),
 	controllerPort(controllerPort)
 {
 	pthread_mutex_init(&controller_mutex, NULL);
+	
+	list<Rule> rules = graph.getRules();
+	for(list<Rule>::iterator r = rules.begin(); r != rules.end(); r++)
+		this->graph[GraphOptimizer::partition(*r)].addRule(*r);
+	
+	optimization_stats_t stats;
+	GraphOptimizer::resetStats(stats);
+	for(map<rule_partition_t, Graph>::iterator p = this->graph.begin(); p != this->graph.end(); p++)
+		entries[p->first] = GraphOptimizer::optimize(p->second.getRules(),stats);
 }
 
 void Controller::start()
@@ -16,6 +25,11 @@ void Controller::start()
 	pthread_create(&thread[0],NULL,loop,this);
 }
 
+string Controller::getControllerPort()
+{
+	return controllerPort;
+}
+
 void Controller::handle_dpt_open(crofdpt& dpt)
 {
 	pthread_mutex_lock(&controller_mutex);
@@ -27,10 +41,142 @@ void Controller::handle_dpt_open(crofdpt& dpt)
 
 	this->dpt = &dpt;
 	isOpen = true;
+	version = dpt.get_version();
+
+	if(dpt.get_version() >= openflow13::OFP_VERSION)
+	{
+		//Remove all the meters, as done with the flow entries and the groups
+		sendMeterMod(Meter(openflow13::OFPM_ALL,0,false),openflow13::OFPMC_DELETE);
+	}
+	else if(!meters.empty())
+		logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "The datapath does not support Openflow 1.3: %d meters cannot be installed, and the rate of the graphs is not limited",meters.size());
+	
+	//The meters must exist before the flow entries using them
+	for(map<uint32_t, Meter>::iterator m = meters.begin(); m != meters.end(); m++)
+		sendMeterMod(m->second,openflow13::OFPMC_ADD);
+	
+	//The same holds for the groups
+	for(map<uint32_t, Group>::iterator g = groups.begin(); g != groups.end(); g++)
+		sendGroupMod(g->second,openflow12::OFPGC_ADD);
+
+	installNewRulesIntoLSI(allEntries());
+	
+	pthread_mutex_unlock(&controller_mutex);
+}
+
+list<Rule> Controller::getEntries()
+{
+	pthread_mutex_lock(&controller_mutex);
+	list<Rule> current = allEntries();
+	pthread_mutex_unlock(&controller_mutex);
+	
+	return current;
+}
+
+list<Rule> Controller::allEntries()
+{
+	list<Rule> all;
+	for(map<rule_partition_t, list<Rule> >::iterator p = entries.begin(); p != entries.end(); p++)
+		all.insert(all.end(),p->second.begin(),p->second.end());
+	return all;
+}
+
+bool Controller::installMeter(Meter meter)
+{
+	pthread_mutex_lock(&controller_mutex);
+
+	bool retVal = true;
+	map<uint32_t, Meter>::iterator old = meters.find(meter.getID());
+	if(old == meters.end())
+	{
+		meters.insert(make_pair(meter.getID(),meter));
+		retVal = sendMeterMod(meter,openflow13::OFPMC_ADD);
+	}
+	else if(!(old->second == meter))
+	{
+		old->second = meter;
+		retVal = sendMeterMod(meter,openflow13::OFPMC_MODIFY);
+	}
+	
+	pthread_mutex_unlock(&controller_mutex);
+	
+	return retVal;
+}
+
+bool Controller::supportsMeters()
+{
+	pthread_mutex_lock(&controller_mutex);
+	bool supported = (version == 0 || version >= openflow13::OFP_VERSION);
+	pthread_mutex_unlock(&controller_mutex);
+	
+	return supported;
+}
+
+bool Controller::removeMeter(uint32_t meterID)
+{
+	pthread_mutex_lock(&controller_mutex);
+
+	bool retVal = false;
+	map<uint32_t, Meter>::iterator meter = meters.find(meterID);
+	if(meter != meters.end())
+	{
+		retVal = sendMeterMod(meter->second,openflow13::OFPMC_DELETE);
+		meters.erase(meter);
+	}
+	
+	pthread_mutex_unlock(&controller_mutex);
+	
+	return retVal;
+}
 
-	installNewRulesIntoLSI(graph.getRules());
+bool Controller::installGroup(Group group)
+{
+	pthread_mutex_lock(&controller_mutex);
+
+	bool retVal = true;
+	map<uint32_t, Group>::iterator old = groups.find(group.getID());
+	if(old == groups.end())
+	{
+		groups.insert(make_pair(group.getID(),group));
+		retVal = sendGroupMod(group,openflow12::OFPGC_ADD);
+	}
+	else if(!(old->second == group))
+	{
+		old->second = group;
+		retVal = sendGroupMod(group,openflow12::OFPGC_MODIFY);
+	}
 	
 	pthread_mutex_unlock(&controller_mutex);
+	
+	return retVal;
+}
+
+bool Controller::removeGroup(uint32_t groupID)
+{
+	pthread_mutex_lock(&controller_mutex);
+
+	bool retVal = false;
+	map<uint32_t, Group>::iterator group = groups.find(groupID);
+	if(group != groups.end())
+	{
+		retVal = sendGroupMod(group->second,openflow12::OFPGC_DELETE);
+		groups.erase(group);
+	}
+	
+	pthread_mutex_unlock(&controller_mutex);
+	
+	return retVal;
+}
+
+list<Group> Controller::getGroups()
+{
+	pthread_mutex_lock(&controller_mutex);
+	list<Group> current;
+	for(map<uint32_t, Group>::iterator g = groups.begin(); g != groups.end(); g++)
+		current.push_back(g->second);
+	pthread_mutex_unlock(&controller_mutex);
+	
+	return current;
 }
 
 void Controller::handle_dpt_close(crofdpt& dpt)
@@ -49,9 +195,9 @@ bool Controller::installNewRule(Rule rule)
 	rules.push_back(rule);
 	
 	//Add the rule to the whole graph
-	graph.addRule(rule);
+	graph[GraphOptimizer::partition(rule)].addRule(rule);
 
-	bool retVal = installNewRulesIntoLSI(rules);
+	bool retVal = updateEntries(rules);
 	
 	pthread_mutex_unlock(&controller_mutex);
 	
@@ -63,9 +209,35 @@ bool Controller::installNewRules(list<Rule> rules)
 	pthread_mutex_lock(&controller_mutex);
 
 	for(list<Rule>::iterator r = rules.begin(); r != rules.end(); r++)
-		graph.addRule(*r);
+		graph[GraphOptimizer::partition(*r)].addRule(*r);
+		
+	bool retVal = updateEntries(rules);
+	
+	pthread_mutex_unlock(&controller_mutex);
+	
+	return retVal;
+}
+
+bool Controller::replaceRules(list<Rule> rules)
+{
+	pthread_mutex_lock(&controller_mutex);
+
+	for(list<Rule>::iterator r = rules.begin(); r != rules.end(); r++)
+	{
+		//The replaced rule has the same match, hence the same partition
+		Graph &partition = graph[GraphOptimizer::partition(*r)];
+		try
+		{
+			partition.getRule(r->getID());
+			partition.removeRuleFromID(r->getID());
+		}catch(...)
+		{
+			//No problem.. This means that the rule is new
+		}
+		partition.addRule(*r);
+	}
 		
-	bool retVal = installNewRulesIntoLSI(rules);
+	bool retVal = updateEntries(rules);
 	
 	pthread_mutex_unlock(&controller_mutex);
 	
@@ -77,11 +249,11 @@ bool Controller::removeRules(list<Rule> rules)
 	pthread_mutex_lock(&controller_mutex);
 
 	for(list<Rule>::iterator r = rules.begin(); r != rules.end(); r++)
-		graph.removeRule(*r);
+		graph[GraphOptimizer::partition(*r)].removeRule(*r);
 		
-	//TODO: removes, from LSI, only rules that do not still appear in the graph	
-	bool retVal = removeRulesFromLSI(rules);
-	pthread_mutex_unlock(&controller_mutex);;
+	//The flow entries still needed by the rules in the graph are not removed
+	bool retVal = updateEntries(rules);
+	pthread_mutex_unlock(&controller_mutex);
 	return retVal;
 }
 
@@ -92,23 +264,27 @@ bool Controller::removeRuleFromID(string ID)
 	
 	pthread_mutex_lock(&controller_mutex);
 
-	try
-	{	
-		Rule rule = graph.getRule(ID);
-	
-		if(!graph.removeRuleFromID(ID))
+	//A rule can be lowered into several ones with the same ID (e.g., a match on
+	//a NF with replicas), which are all removed
+	list<Rule> rules;
+	for(map<rule_partition_t, Graph>::iterator p = graph.begin(); p != graph.end(); p++)
+	{
+		list<Rule> current = p->second.getRules();
+		for(list<Rule>::iterator r = current.begin(); r != current.end(); r++)
 		{
-			//The graph does not contain another rule equal to the
-			//one removed. Then the flowmod can be sent
-			list<Rule> rules;
-			rules.push_back(rule);
-			retVal = removeRulesFromLSI(rules);
+			if(r->getID() == ID)
+			{
+				rules.push_back(*r);
+				p->second.removeRuleFromID(ID);
+			}
 		}
-	}catch(...)
-	{
-		//No problem.. This means that the rule with ID has not been lowered in this graph.
-		//This is ok, since some rules have a lowering just into the LSI-0 or tenant-LSI.
 	}
+	
+	//No problem if there are no rules.. This means that the rule with ID has not been lowered in this graph.
+	//This is ok, since some rules have a lowering just into the LSI-0 or tenant-LSI.
+	//If the graph contains another rule equal to the one removed, its flow entry is not changed
+	if(!rules.empty())
+		retVal = updateEntries(rules);
 	pthread_mutex_unlock(&controller_mutex);
 	
 	return retVal;
@@ -162,6 +338,119 @@ bool Controller::removeRulesFromLSI(list<Rule> rules)
 	return false;
 }
 
+bool Controller::updateEntries(list<Rule> changed)
+{
+	set<rule_partition_t> partitions;
+	for(list<Rule>::iterator r = changed.begin(); r != changed.end(); r++)
+		partitions.insert(GraphOptimizer::partition(*r));
+
+	optimization_stats_t stats;
+	GraphOptimizer::resetStats(stats);
+	
+	//Compile again the rules on the same table and input port of the changed ones
+	list<Rule> toBeInstalled, toBeRemoved;
+	for(set<rule_partition_t>::iterator p = partitions.begin(); p != partitions.end(); p++)
+	{
+		list<Rule> newEntries;
+		map<rule_partition_t, Graph>::iterator partition = graph.find(*p);
+		if(partition != graph.end())
+		{
+			list<Rule> rules = partition->second.getRules();
+			if(rules.empty())
+				graph.erase(partition);
+			else
+				newEntries = GraphOptimizer::optimize(rules,stats);
+		}
+		list<Rule> &oldEntries = entries[*p];
+		
+		//Only the entries with the same priority can be the same entry
+		map<uint64_t, list<Rule> > oldPriorities, newPriorities;
+		for(list<Rule>::iterator o = oldEntries.begin(); o != oldEntries.end(); o++)
+			oldPriorities[o->getPriority()].push_back(*o);
+		for(list<Rule>::iterator n = newEntries.begin(); n != newEntries.end(); n++)
+			newPriorities[n->getPriority()].push_back(*n);
+		
+		//A new entry with the same table, priority and match of an old one overwrites it
+		for(list<Rule>::iterator n = newEntries.begin(); n != newEntries.end(); n++)
+		{
+			list<Rule> &same = oldPriorities[n->getPriority()];
+			if(find(same.begin(),same.end(),*n) == same.end())
+				toBeInstalled.push_back(*n);
+		}
+		for(list<Rule>::iterator o = oldEntries.begin(); o != oldEntries.end(); o++)
+		{
+			list<Rule> &same = newPriorities[o->getPriority()];
+			bool found = false;
+			for(list<Rule>::iterator n = same.begin(); n != same.end() && !found; n++)
+				found = n->sameEntry(*o);
+			if(!found)
+				toBeRemoved.push_back(*o);
+		}
+		
+		if(newEntries.empty())
+			entries.erase(*p);
+		else
+			oldEntries.swap(newEntries);
+	}
+	
+	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "%d rules implemented by %d flow entries (%d duplicated, %d aggregated, %d shadowed)",stats.rules,stats.entries,stats.duplicated,stats.merged,stats.shadowed);
+
+	//The new entries are inserted before removing the old ones, so that the packets
+	//are always matched
+	bool retVal = true;
+	if(!toBeInstalled.empty())
+		retVal = installNewRulesIntoLSI(toBeInstalled);
+	if(!toBeRemoved.empty())
+		retVal = removeRulesFromLSI(toBeRemoved) && retVal;
+	
+	return retVal;
+}
+
+bool Controller::sendMeterMod(Meter meter, uint16_t command)
+{
+	if(!isOpen)
+	{
+		//The meter is sent when the datapath connects
+		logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "No datapath connected! Cannot send the meter %d!",meter.getID());
+		return false;
+	}
+	
+	if(dpt->get_version() < openflow13::OFP_VERSION)
+		return false;
+	
+	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Sending meter %x (command %d)",meter.getID(),command);
+	
+	rofl::openflow::cofmeter_bands bands(dpt->get_version());
+	if(command != openflow13::OFPMC_DELETE)
+		meter.fillMeterBands(bands);
+	if(LOGGING_LEVEL <= ORCH_DEBUG)
+		meter.print();
+	dpt->send_meter_mod_message(cauxid(0),command,meter.getFlags(),meter.getID(),bands);
+	
+	return true;
+}
+
+bool Controller::sendGroupMod(Group group, uint16_t command)
+{
+	if(!isOpen)
+	{
+		//The group is sent when the datapath connects
+		logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "No datapath connected! Cannot send the group %d!",group.getID());
+		return false;
+	}
+	
+	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Sending group %x (command %d)",group.getID(),command);
+	
+	rofl::openflow::cofbuckets buckets(dpt->get_version());
+	if(command != openflow12::OFPGC_DELETE)
+		group.fillBuckets(buckets);
+	if(LOGGING_LEVEL <= ORCH_DEBUG)
+		group.print();
+	dpt->send_group_mod_message(cauxid(0),command,openflow::OFPGT_SELECT,group.getID(),buckets);
+	
+	return true;
+}
+
 void *Controller::loop(void *param)
 {
 	Controller *controller = (Controller*)param;
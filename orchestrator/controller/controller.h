@@ -5,7 +5,13 @@
 
 #include <rofl/common/logging.h>
 
+#include <set>
+#include <algorithm>
+
 #include "../graph/low_level_graph/graph.h"
+#include "../graph/low_level_graph/meter.h"
+#include "../graph/low_level_graph/group.h"
+#include "../graph/low_level_graph/graph_optimizer.h"
 #include "../utils/logger.h"
 #include "../utils/constants.h"
 
@@ -32,12 +38,36 @@ private:
 	*	@brief: flag indicating whereas the connection with the datapath is open
 	*/
 	bool isOpen;
+	
+	/**
+	*	@brief: Openflow version negotiated with the datapath (0 if the datapath
+	*		has never connected)
+	*/
+	uint8_t version;
 
 	/**
 	*	@brief: NFs graph to be translated into flowmod messages
-	*		and instantiated within the LSI
+	*		and instantiated within the LSI, split by table and input port
+	*		(see GraphOptimizer), so that a change only touches the rules of
+	*		its own partitions
+	*/
+	map<rule_partition_t, Graph> graph;
+	
+	/**
+	*	@brief: flow entries implementing the graph (see GraphOptimizer), i.e.,
+	*		the flowmod messages actually sent to the LSI, split as the graph
 	*/
-	Graph graph;
+	map<rule_partition_t, list<Rule> > entries;
+
+	/**
+	*	@brief: meters used by the flow entries, indexed by ID
+	*/
+	map<uint32_t, Meter> meters;
+
+	/**
+	*	@brief: groups used by the flow entries, indexed by ID
+	*/
+	map<uint32_t, Group> groups;
 
 	/**
 	*	@brief: TCP port that the dpath should use to contact the controller
@@ -60,10 +90,45 @@ private:
 	*/
 	bool removeRulesFromLSI(list<Rule> rules);
 	
+	/**
+	*	@brief: compile again the flow entries of the table and input port of
+	*		some rules just added to the graph or removed from it, and send to the
+	*		datapath the flow entries changed
+	*
+	*	@param: changed	Rules added to the graph or removed from it
+	*/
+	bool updateEntries(list<Rule> changed);
+	
+	/**
+	*	@brief: return the flow entries of all the partitions
+	*/
+	list<Rule> allEntries();
+	
+	/**
+	*	@brief: send a meter_mod message to the datapath. The meters require
+	*		Openflow 1.3; with older versions, they are not sent (and then the
+	*		flow entries are not rate limited)
+	*
+	*	@param: command	OFPMC_ADD, OFPMC_MODIFY or OFPMC_DELETE
+	*/
+	bool sendMeterMod(Meter meter, uint16_t command);
+	
+	/**
+	*	@brief: send a group_mod message for a select group to the datapath
+	*
+	*	@param: command	OFPGC_ADD, OFPGC_MODIFY or OFPGC_DELETE
+	*/
+	bool sendGroupMod(Group group, uint16_t command);
+	
 public:
 	Controller(rofl::openflow::cofhello_elem_versionbitmap const& versionbitmap,Graph graph,string controllerPort);
 
 	void start();
+
+	/**
+	*	@brief: return the TCP port on which the controller waits for the datapath
+	*/
+	string getControllerPort();
 	
 	/**
 	*	@brief: callback executed when the connection with the datapath is established.
@@ -86,11 +151,19 @@ public:
 	*	@brief: install new rules in the datapath.
 	*/
 	bool installNewRules(list<Rule> rules);
+	
+	/**
+	*	@brief: install rules in the datapath, replacing the rules with the same
+	*		ID. Since a replaced rule has the same match and priority of the new
+	*		one, the flowmod adding the new rule overwrites it in the datapath.
+	*/
+	bool replaceRules(list<Rule> rules);
 
 	/**
 	*	@brief: remove a rule with a specific ID. If the graph does not have other
 	*		identical rules (i.e., same match and same action), a flowmod to remove
-	*		the flow from the LSI is sent to the LSI itself.
+	*		the flow from the LSI is sent to the LSI itself (the rules shadowed by 
+	*		the removed one are inserted in the LSI, if needed).
 	*/
 	bool removeRuleFromID(string ID);
 
@@ -98,6 +171,51 @@ public:
 	*	@brief: remove rules from the datapath.
 	*/
 	bool removeRules(list<Rule> rules);
+	
+	/**
+	*	@brief: install a meter in the datapath, or change the band of the meter
+	*		with the same ID. A meter must be installed before the flow entries
+	*		using it.
+	*/
+	bool installMeter(Meter meter);
+	
+	/**
+	*	@brief: remove the meter with a specific ID. The flow entries using it
+	*		must have been already removed.
+	*/
+	bool removeMeter(uint32_t meterID);
+	
+	/**
+	*	@brief: return false if the datapath does not support the meters, i.e., it
+	*		negotiated a version older than Openflow 1.3. If the datapath has never
+	*		connected, the meters are assumed to be supported (they are installed
+	*		when it connects)
+	*/
+	bool supportsMeters();
+	
+	/**
+	*	@brief: install a group in the datapath, or change the buckets of the
+	*		group with the same ID. A group must be installed before the flow
+	*		entries using it. Changing the buckets does not touch the flow
+	*		entries, which keep sending the packets to the group.
+	*/
+	bool installGroup(Group group);
+	
+	/**
+	*	@brief: remove the group with a specific ID. The flow entries using it
+	*		must have been already removed.
+	*/
+	bool removeGroup(uint32_t groupID);
+	
+	/**
+	*	@brief: return the groups currently installed
+	*/
+	list<Group> getGroups();
+	
+	/**
+	*	@brief: return the flow entries currently implementing the graph
+	*/
+	list<Rule> getEntries();
 
 	static void *loop(void *param);
 
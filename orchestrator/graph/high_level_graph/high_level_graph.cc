@@ -4,7 +4,7 @@ namespace highlevel
 {
 
 Graph::Graph(string ID) :
-	ID(ID)
+	ID(ID), hasLimit(false)
 {
 }
 
@@ -13,6 +13,22 @@ string Graph::getID()
 	return ID;
 }
 
+void Graph::setRateLimit(rate_limit_t rateLimit)
+{
+	this->rateLimit = rateLimit;
+	hasLimit = true;
+}
+
+bool Graph::hasRateLimit()
+{
+	return hasLimit;
+}
+
+rate_limit_t Graph::getRateLimit()
+{
+	return rateLimit;
+}
+
 set<string> Graph::getPorts()
 {
 	return ports;
@@ -58,6 +74,32 @@ bool Graph::addPort(string port)
 	return true;
 }
 
+bool Graph::setNetworkFunctionReplicas(string nf, unsigned int replicas)
+{
+	if(networkFunctions.count(nf) == 0)
+	{
+		logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "NF \"%s\" does not exist",nf.c_str());
+		return false;
+	}
+	
+	networkFunctionsReplicas[nf] = replicas;
+	
+	return true;
+}
+
+unsigned int Graph::getNetworkFunctionReplicas(string nf)
+{
+	if(networkFunctionsReplicas.count(nf) != 0)
+		return networkFunctionsReplicas.find(nf)->second;
+	
+	return 1;
+}
+
+map<string, unsigned int> Graph::getNetworkFunctionsReplicas()
+{
+	return networkFunctionsReplicas;
+}
+
 bool Graph::addNetworkFunction(string nf)
 {
 	if(networkFunctions.count(nf) != 0)
@@ -139,119 +181,144 @@ bool Graph::updateNetworkFunctionEthernetPortsRequirements(string nf, unsigned i
 
 bool Graph::addRule(Rule rule)
 {
-	for(list<Rule>::iterator r = rules.begin(); r != rules.end(); r++)
-	{
-		if(*r == rule)
-			return false;
-	}
+	if(rulesIndex.count(rule.getFlowID()) != 0)
+		return false;
 
 	rules.push_back(rule);
 	
+	list<Rule>::iterator r = rules.end();
+	r--;
+	rulesIndex[rule.getFlowID()] = r;
+	updateIndexes(*r,true);
+	
 	return true;
 }
 
 bool Graph::ruleExists(string ID)
 {
-	for(list<Rule>::iterator r = rules.begin(); r != rules.end(); r++)
-	{
-		if(r->getFlowID() == ID)
-			return true;
-	}
-	return false;
+	return (rulesIndex.count(ID) != 0);
 }
 
 Rule Graph::getRuleFromID(string ID)
 {
-	list<Rule>::iterator r = rules.begin();
+	map<string, list<Rule>::iterator>::iterator r = rulesIndex.find(ID);
+	
+	assert(r != rulesIndex.end());
 	
-	for(; r != rules.end(); r++)
+	return *(r->second);
+}
+
+void Graph::updateCounter(map<string, unsigned int> &index, string element, bool increment)
+{
+	if(increment)
 	{
-		if(r->getFlowID() == ID)
-			return *r;
+		index[element]++;
+		return;
 	}
 	
-	assert(0);
+	map<string, unsigned int>::iterator counter = index.find(element);
+	assert(counter != index.end() && counter->second > 0);
 	
-	//This cannot happen; it is just for the compiler.
-	return *r;
+	counter->second--;
+	if(counter->second == 0)
+		index.erase(counter);
+}
+
+void Graph::updateIndexes(Rule &rule, bool added)
+{
+	Match match = rule.getMatch();
+	Action *action = rule.getAction();
+	
+	if(match.matchOnNF())
+		updateCounter(nfsUsage,match.getNF(),added);
+	else if(match.matchOnPort())
+		updateCounter(portsUsage,match.getPhysicalPort(),added);
+	else if(match.matchOnEndPoint())
+	{
+		stringstream ss;
+		ss << match.getGraphID() << ":" << match.getEndPoint();
+		updateCounter(endpointsInMatches,ss.str(),added);
+	}
+	
+	action_t actionType = action->getType();
+	if(actionType == ACTION_ON_NETWORK_FUNCTION)
+		updateCounter(nfsUsage,((ActionNetworkFunction*)action)->getInfo(),added);
+	else if(actionType == ACTION_ON_PORT)
+		updateCounter(portsUsage,((ActionPort*)action)->getInfo(),added);
+	else if(actionType == ACTION_ON_ENDPOINT)
+		updateCounter(endpointsInActions,action->toString(),added);
 }
 
 RuleRemovedInfo Graph::removeRuleFromID(string ID)
 {
 	RuleRemovedInfo rri;
 	
-	for(list<Rule>::iterator r = rules.begin(); r != rules.end(); r++)
+	map<string, list<Rule>::iterator>::iterator it = rulesIndex.find(ID);
+	assert(it != rulesIndex.end());
+	
+	list<Rule>::iterator r = it->second;
+	
+	Match match = r->getMatch();
+	Action *action = r->getAction();
+	
+	action_t actionType = action->getType();
+	bool matchOnPort = match.matchOnPort();
+	bool matchOnNF = match.matchOnNF();
+
+	if(actionType == ACTION_ON_PORT)
 	{
-		if(r->getFlowID() == ID)
-		{
-			Match match = r->getMatch();
-			Action *action = r->getAction();
-			
-			action_t actionType = action->getType();
-			bool matchOnPort = match.matchOnPort();
-			bool matchOnNF = match.matchOnNF();
-
-			if(actionType == ACTION_ON_PORT)
-			{
-				//Removed an action on a port. It is possible that a vlink must be removed
-				rri.port = ((ActionPort*)action)->getInfo();
-				rri.isNFport = false;
-				rri.isPort = true;
-				rri.isEndpoint = false;
-				
-				rri.ports.push_back(rri.port);
-			}
-			else if(actionType == ACTION_ON_NETWORK_FUNCTION)
-			{
-				//Removed an action on a NF. It is possible that a vlink must be removed
-				stringstream nf_port;
-				nf_port << ((ActionNetworkFunction*)action)->getInfo() << "_" << ((ActionNetworkFunction*)action)->getPort();
-				rri.nf_port = nf_port.str();
-				
-				//Potentially, the NF is useless in the graph
-				rri.nfs.push_back(((ActionNetworkFunction*)action)->getInfo());
-				rri.isNFport = true;
-				rri.isPort = false;
-				rri.isEndpoint = false;
-			}
-			else
-			{
-				//Removed an action on an endpoint
-				assert(actionType == ACTION_ON_ENDPOINT);
-				rri.endpoint = action->toString();
-				
-				rri.isNFport = false;
-				rri.isPort = false;
-				rri.isEndpoint = true;
-			}
-			
-			if(matchOnNF)
-				//Potentially, the NF is useless in the graph
-				rri.nfs.push_back(match.getNF());
-			else if(matchOnPort)
-				//Potentially, the port is useless in the graph
-				rri.ports.push_back(match.getPhysicalPort());
-			else
-			{
-				stringstream ss;
-				ss << match.getGraphID() << ":" << match.getEndPoint();
-				rri.endpoint = ss.str();
-			}
-
-			//finally, remove the rule!
-			rules.erase(r);
+		//Removed an action on a port. It is possible that a vlink must be removed
+		rri.port = ((ActionPort*)action)->getInfo();
+		rri.isNFport = false;
+		rri.isPort = true;
+		rri.isEndpoint = false;
 		
-			logger(ORCH_DEBUG, MODULE_NAME, __FILE__, __LINE__, "The graph still contains the rules: ");
-			for(list<Rule>::iterator print = rules.begin(); print != rules.end(); print++)
-				logger(ORCH_DEBUG, MODULE_NAME, __FILE__, __LINE__, "\t%s",print->getFlowID().c_str());
+		rri.ports.push_back(rri.port);
+	}
+	else if(actionType == ACTION_ON_NETWORK_FUNCTION)
+	{
+		//Removed an action on a NF. It is possible that a vlink must be removed
+		stringstream nf_port;
+		nf_port << ((ActionNetworkFunction*)action)->getInfo() << "_" << ((ActionNetworkFunction*)action)->getPort();
+		rri.nf_port = nf_port.str();
 		
-			return rri;
-		}//end if(r->getFlowID() == ID)	
+		//Potentially, the NF is useless in the graph
+		rri.nfs.push_back(((ActionNetworkFunction*)action)->getInfo());
+		rri.isNFport = true;
+		rri.isPort = false;
+		rri.isEndpoint = false;
+	}
+	else
+	{
+		//Removed an action on an endpoint
+		assert(actionType == ACTION_ON_ENDPOINT);
+		rri.endpoint = action->toString();
+		
+		rri.isNFport = false;
+		rri.isPort = false;
+		rri.isEndpoint = true;
 	}
 	
-	assert(0);
-	
-	//Just for the compiler
+	if(matchOnNF)
+		//Potentially, the NF is useless in the graph
+		rri.nfs.push_back(match.getNF());
+	else if(matchOnPort)
+		//Potentially, the port is useless in the graph
+		rri.ports.push_back(match.getPhysicalPort());
+	else
+	{
+		stringstream ss;
+		ss << match.getGraphID() << ":" << match.getEndPoint();
+		rri.endpoint = ss.str();
+	}
+
+	//finally, remove the rule!
+	updateIndexes(*r,false);
+	rulesIndex.erase(it);
+	rules.erase(r);
+
+	logger(ORCH_DEBUG, MODULE_NAME, __FILE__, __LINE__, "The graph still contains %d rules",(int)rules.size());
+
 	return rri;
 }
 
@@ -283,6 +350,22 @@ Object Graph::toJSON()
 	
 	flow_graph[FLOW_RULES] = flow_rules;
 	
+	if(hasLimit)
+	{
+		//The values are strings, as in the description of the graph received
+		Object rate_limit;
+		stringstream rate;
+		rate << rateLimit.rate;
+		rate_limit[(rateLimit.pps)? PPS : BANDWIDTH] = rate.str();
+		if(rateLimit.burst != 0)
+		{
+			stringstream burst;
+			burst << rateLimit.burst;
+			rate_limit[BURST] = burst.str();
+		}
+		flow_graph[RATE_LIMIT] = rate_limit;
+	}
+	
 	return flow_graph;
 }
 
@@ -291,30 +374,12 @@ bool Graph::stillExistNF(string nf)
 	if(networkFunctions.count(nf) == 0)
 		return false;
 
-	for(list<Rule>::iterator r = rules.begin(); r != rules.end(); r++)
-	{
-		Match match = r->getMatch();
-		Action *action = r->getAction();
-		
-		action_t actionType = action->getType();
-		bool matchOnNF = match.matchOnNF();
-		
-		if(matchOnNF)
-		{
-			if(match.getNF() == nf)
-				//The NF still exists into the graph
-				return true;
-		}
-		
-		if(actionType == ACTION_ON_NETWORK_FUNCTION)
-		{
-			if(((ActionNetworkFunction*)action)->getInfo() == nf)
-				//The NF still exist into the graph
-				return true;
-		}
-	}
+	if(nfsUsage.count(nf) != 0)
+		//The NF still exists into the graph
+		return true;
 	
 	networkFunctions.erase(nf);
+	networkFunctionsReplicas.erase(nf);
 	return false;
 }
 
@@ -338,28 +403,9 @@ bool Graph::stillExistPort(string port)
 	if(ports.count(port) == 0)
 		return false;
 
-	for(list<Rule>::iterator r = rules.begin(); r != rules.end(); r++)
-	{
-		Match match = r->getMatch();
-		Action *action = r->getAction();
-		
-		action_t actionType = action->getType();
-		bool matchOnPort = match.matchOnPort();
-		
-		if(matchOnPort)
-		{
-			if(match.getPhysicalPort() == port)
-				//The port still exists into the graph
-				return true;
-		}
-		
-		if(actionType == ACTION_ON_PORT)
-		{
-			if(((ActionPort*)action)->getInfo() == port)
-				//The port still exist into the graph
-				return true;
-		}
-	}
+	if(portsUsage.count(port) != 0)
+		//The port still exists into the graph
+		return true;
 
 	ports.erase(port);
 	
@@ -395,9 +441,11 @@ bool Graph::isDefinedHere(string endpoint)
 
 string Graph::getEndpointInvolved(string flowID)
 {
-	highlevel::Rule r = getRuleFromID(flowID);
-	highlevel::Match m = r.getMatch();
-	highlevel::Action *a = r.getAction();
+	map<string, list<Rule>::iterator>::iterator r = rulesIndex.find(flowID);
+	assert(r != rulesIndex.end());
+	
+	highlevel::Match m = r->second->getMatch();
+	highlevel::Action *a = r->second->getAction();
 	
 	if(a->getType() == highlevel::ACTION_ON_ENDPOINT)
 		return a->toString();
@@ -414,36 +462,12 @@ string Graph::getEndpointInvolved(string flowID)
 
 bool Graph::endpointIsUsedInMatch(string endpoint)
 {
-	for(list<Rule>::iterator r = rules.begin(); r != rules.end(); r++)
-	{
-		Match match = r->getMatch();		
-		if(match.matchOnEndPoint())
-		{
-			stringstream ss;
-			ss << match.getGraphID() << ":" << match.getEndPoint();
-			if(ss.str() == endpoint)
-				//The endpoint is used in a match
-				return true;
-		}		
-	}
-	return false;
+	return (endpointsInMatches.count(endpoint) != 0);
 }
 
 bool Graph::endpointIsUsedInAction(string endpoint)
 {
-	for(list<Rule>::iterator r = rules.begin(); r != rules.end(); r++)
-	{
-		Action *action = r->getAction();		
-		action_t actionType = action->getType();
-		
-		if(actionType == ACTION_ON_ENDPOINT)
-		{
-			if(action->toString() == endpoint)
-				//The port is used in an action
-				return true;
-		}
-	}
-	return false;
+	return (endpointsInActions.count(endpoint) != 0);
 }
 
 }
@@ -4,6 +4,7 @@
 #pragma once
 
 #include <list>
+#include <map>
 #include <set>
 #include <string>
 #include <iostream>
@@ -26,6 +27,23 @@ using namespace std;
 namespace highlevel
 {
 
+/**
+*	@brief: maximum rate of the traffic entering the graph through the LSI-0
+*/
+typedef struct
+{
+	/**
+	*	@brief: rate in kbit/s, or in packets per second if pps is true
+	*/
+	uint32_t rate;
+	bool pps;
+	
+	/**
+	*	@brief: burst size, in kbit or in packets (0 if not specified)
+	*/
+	uint32_t burst;
+}rate_limit_t;
+
 /**
 *	@brief: describes the graph required from the extern
 */
@@ -56,6 +74,12 @@ private:
 	*/
 	map<string, map<unsigned int,pair<string,string> > > networkFunctionsIPv4PortRequirements;
 
+	/**
+	*	@brief: number of instances of the NFs, for the NFs for which it has been
+	*		specified. The other NFs have a single instance.
+	*/
+	map<string, unsigned int> networkFunctionsReplicas;
+
 	/**
 	*	@brief: physical ports to be attached to the graph
 	*/
@@ -72,11 +96,69 @@ private:
 	*/
 	list<Rule> rules;
 	
+	/**
+	*	@brief: for each flow ID, the position of the corresponding rule in the
+	*		"rules" list. This allows a rule to be retrieved or removed without
+	*		scanning the whole graph
+	*/
+	map<string, list<Rule>::iterator> rulesIndex;
+	
+	/**
+	*	@brief: number of rules using a specific NF (either in the match or
+	*		in the action)
+	*/
+	map<string, unsigned int> nfsUsage;
+	
+	/**
+	*	@brief: number of rules using a specific physical port (either in the
+	*		match or in the action)
+	*/
+	map<string, unsigned int> portsUsage;
+	
+	/**
+	*	@brief: number of matches using a specific endpoint. Endpoints are
+	*		expressed in the form "graphID:endpoint"
+	*/
+	map<string, unsigned int> endpointsInMatches;
+	
+	/**
+	*	@brief: number of actions using a specific endpoint
+	*/
+	map<string, unsigned int> endpointsInActions;
+	
 	/**
 	*	@brief: Identifier of the graph
 	*/
 	string ID;
 	
+	/**
+	*	@brief: rate limit of the graph, if hasLimit is true
+	*/
+	bool hasLimit;
+	rate_limit_t rateLimit;
+	
+	/**
+	*	@brief: update the indexes of the graph with the elements used by a rule
+	*
+	*	@param: rule	Rule that has been added to or removed from the graph
+	*	@param: added	True if the rule has been added; false if it has been removed
+	*/
+	void updateIndexes(Rule &rule, bool added);
+	
+	/**
+	*	@brief: increment or decrement the counter associated with an element
+	*		of an index. The element is erased from the index when its counter
+	*		reaches zero
+	*/
+	void updateCounter(map<string, unsigned int> &index, string element, bool increment);
+	
+	/**
+	*	@brief: the graph cannot be copied, since "rulesIndex" refers to the
+	*		elements of its own "rules" list
+	*/
+	Graph(const Graph &other);
+	Graph &operator=(const Graph &other);
+	
 public:	
 
 	/**
@@ -152,6 +234,28 @@ public:
 	*/
 	map<unsigned int,pair<string,string> > getNetworkFunctionIPv4PortsRequirements(string nf);	
 	
+	/**
+	*	@brief: Set the number of instances of a NF. The traffic sent to the NF is
+	*		balanced among its instances
+	*
+	*	@param: nf			Name of the network function to be updated
+	*	@param: replicas	Number of instances of the network function
+	*/
+	bool setNetworkFunctionReplicas(string nf, unsigned int replicas);
+	
+	/**
+	*	@brief: Return the number of instances of a NF (1 if not specified)
+	*
+	*	@param: nf	Name of a network function
+	*/
+	unsigned int getNetworkFunctionReplicas(string nf);
+	
+	/**
+	*	@brief: Return the number of instances of the NFs for which it has been
+	*		specified
+	*/
+	map<string, unsigned int> getNetworkFunctionsReplicas();
+	
 	/**
 	*	@brief: Add an end point to the graph, to be used to connect the graph itself with
 	*		other graphs.
@@ -180,6 +284,22 @@ public:
 	*/
 	string getID();
 	
+	/**
+	*	@brief: Set the maximum rate of the traffic entering the graph
+	*/
+	void setRateLimit(rate_limit_t rateLimit);
+	
+	/**
+	*	@brief: Return true if the graph has a rate limit
+	*/
+	bool hasRateLimit();
+	
+	/**
+	*	@brief: Return the rate limit of the graph (meaningless if the graph
+	*		does not have a rate limit)
+	*/
+	rate_limit_t getRateLimit();
+	
 	/**
 	*	@brief: Return the rules of the graph
 	*/
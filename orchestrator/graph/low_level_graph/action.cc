@@ -4,13 +4,38 @@ namespace lowlevel
 {
 
 Action::Action(uint32_t port_id)
-	: type(openflow::OFPAT_OUTPUT), port_id(port_id)
+	: type(openflow::OFPAT_OUTPUT), port_id(port_id), goto_table(false), table_id(0), output_group(false), group_id(0), meter_id(0)
 {
 
 }
 
+Action Action::gotoTable(uint8_t table_id)
+{
+	Action action(0);
+	action.goto_table = true;
+	action.table_id = table_id;
+	return action;
+}
+
+Action Action::outputGroup(uint32_t group_id)
+{
+	Action action(0);
+	action.output_group = true;
+	action.group_id = group_id;
+	return action;
+}
+
 bool Action::operator==(const Action &other) const
 {
+	if((goto_table != other.goto_table) || (output_group != other.output_group) || (meter_id != other.meter_id))
+		return false;
+	
+	if(goto_table)
+		return table_id == other.table_id;
+	
+	if(output_group)
+		return group_id == other.group_id;
+
 	if((type == other.type) && (port_id == other.port_id))
 		return true;
 		
@@ -22,9 +47,52 @@ openflow::ofp_action_type Action::getActionType()
 	return type;
 }
 
-void Action::fillFlowmodMessage(rofl::openflow::cofflowmod &message)
+bool Action::isGotoTable()
+{
+	return goto_table;
+}
+
+bool Action::isGroup()
+{
+	return output_group;
+}
+
+uint32_t Action::getPortID()
+{
+	return port_id;
+}
+
+uint8_t Action::getTable()
 {
-	message.set_instructions().set_inst_apply_actions().set_actions().add_action_output(cindex(0)).set_port_no(port_id);
+	return table_id;
+}
+
+uint32_t Action::getGroup()
+{
+	return group_id;
+}
+
+void Action::setMeter(uint32_t meter_id)
+{
+	this->meter_id = meter_id;
+}
+
+uint32_t Action::getMeter()
+{
+	return meter_id;
+}
+
+void Action::fillFlowmodMessage(rofl::openflow::cofflowmod &message, uint8_t of_version)
+{
+	if(meter_id != 0 && of_version >= openflow13::OFP_VERSION)
+		message.set_instructions().set_inst_meter().set_meter_id(meter_id);
+
+	if(goto_table)
+		message.set_instructions().set_inst_goto_table().set_table_id(table_id);
+	else if(output_group)
+		message.set_instructions().set_inst_apply_actions().set_actions().add_action_group(cindex(0)).set_group_id(group_id);
+	else
+		message.set_instructions().set_inst_apply_actions().set_actions().add_action_output(cindex(0)).set_port_no(port_id);
 }
 
 void Action::print()
@@ -32,9 +100,30 @@ void Action::print()
 	if(LOGGING_LEVEL <= ORCH_DEBUG_INFO)
 	{
 		cout << "\t\tAction:" << endl << "\t\t{" << endl;
-		cout << "\t\t\tOUTPUT: " << port_id << endl;
+		if(goto_table)
+			cout << "\t\t\tGOTO_TABLE: " << (unsigned int)table_id << endl;
+		else if(output_group)
+			cout << "\t\t\tGROUP: " << group_id << endl;
+		else
+			cout << "\t\t\tOUTPUT: " << port_id << endl;
+		if(meter_id != 0)
+			cout << "\t\t\tMETER: " << meter_id << endl;
 		cout << "\t\t}" << endl;
 	}
 }
 
+Object Action::toJSON()
+{
+	Object action;
+	if(goto_table)
+		action[GOTO_TABLE] = (uint64_t)table_id;
+	else if(output_group)
+		action[GROUP] = (uint64_t)group_id;
+	else
+		action[OUTPUT_PORT] = (uint64_t)port_id;
+	if(meter_id != 0)
+		action[METER] = (uint64_t)meter_id;
+	return action;
+}
+
 }
@@ -11,9 +11,15 @@
 #include <ostream>
 
 #include "../../utils/logger.h"
+#include "../../utils/constants.h"
+
+#include <json_spirit/json_spirit.h>
+#include <json_spirit/value.h>
+#include <json_spirit/writer.h>
 
 using namespace rofl;
 using namespace std;
+using namespace json_spirit;
 
 namespace lowlevel
 {
@@ -21,16 +27,92 @@ namespace lowlevel
 class Action
 {
 
-//XXX: only the OUTPUT action is supported
+//XXX: only the OUTPUT action is supported (on a port or on a group), besides the
+//goto table instruction used by the pipeline of the LSI-0
 
 private:
 	openflow::ofp_action_type type;
 	uint32_t port_id;
 	
+	/**
+	*	@brief: true if the packets are sent to another table (table_id) instead
+	*		of being sent on a port
+	*/
+	bool goto_table;
+	uint8_t table_id;
+	
+	/**
+	*	@brief: true if the packets are sent to a group (group_id) instead of
+	*		being sent on a port (see Group)
+	*/
+	bool output_group;
+	uint32_t group_id;
+	
+	/**
+	*	@brief: meter applied to the packets before the action (0 if none)
+	*/
+	uint32_t meter_id;
+	
 public:
 	Action(uint32_t port_id);
+	
+	/**
+	*	@brief: create an action sending the packets to another table
+	*
+	*	@param: table_id	Table to which the packets are sent
+	*/
+	static Action gotoTable(uint8_t table_id);
+	
+	/**
+	*	@brief: create an action sending the packets to a group
+	*
+	*	@param: group_id	Group to which the packets are sent
+	*/
+	static Action outputGroup(uint32_t group_id);
+	
 	openflow::ofp_action_type getActionType();
 	
+	/**
+	*	@brief: return true if the packets are sent to another table
+	*/
+	bool isGotoTable();
+	
+	/**
+	*	@brief: return true if the packets are sent to a group
+	*/
+	bool isGroup();
+	
+	/**
+	*	@brief: return the port on which the packets are sent (meaningless if
+	*		the packets are sent to another table or to a group)
+	*/
+	uint32_t getPortID();
+	
+	/**
+	*	@brief: return the table to which the packets are sent (meaningless if
+	*		the packets are sent on a port)
+	*/
+	uint8_t getTable();
+	
+	/**
+	*	@brief: return the group to which the packets are sent (meaningless if
+	*		the packets are not sent to a group)
+	*/
+	uint32_t getGroup();
+	
+	/**
+	*	@brief: apply a meter to the packets (see Meter). The meter is ignored
+	*		by the datapaths not supporting Openflow 1.3
+	*
+	*	@param: meter_id	Meter to be applied, or 0 to remove the meter
+	*/
+	void setMeter(uint32_t meter_id);
+	
+	/**
+	*	@brief: return the meter applied to the packets (0 if none)
+	*/
+	uint32_t getMeter();
+	
 	bool operator==(const Action &other) const;
 	
 	/**
@@ -39,9 +121,10 @@ public:
 	*	@param: message		flowmod message
 	*	@param: of_version	openflow version of the flowmod message
 	*/
-	void fillFlowmodMessage(rofl::openflow::cofflowmod &message);
+	void fillFlowmodMessage(rofl::openflow::cofflowmod &message, uint8_t of_version);
 	
 	void print();
+	Object toJSON();
 };
 
 }
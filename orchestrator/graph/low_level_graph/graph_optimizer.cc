@@ -0,0 +1,117 @@
+#include "graph_optimizer.h"
+
+namespace lowlevel
+{
+
+rule_partition_t GraphOptimizer::partition(Rule &rule)
+{
+	return make_pair(rule.getTable(),rule.getMatch().getInputPort());
+}
+
+list<Rule> GraphOptimizer::optimize(list<Rule> rules, optimization_stats_t &stats)
+{
+	stats.rules += rules.size();
+
+	//Only the rules in the same table and on the same input port can overlap
+	map<rule_partition_t, list<Rule> > partitions;
+	for(list<Rule>::iterator r = rules.begin(); r != rules.end(); r++)
+		partitions[partition(*r)].push_back(*r);
+
+	list<Rule> entries;
+	for(map<rule_partition_t, list<Rule> >::iterator p = partitions.begin(); p != partitions.end(); p++)
+	{
+		/**
+		*	1) Remove the rules overwritten by a rule inserted later
+		*/
+		map<uint64_t, list<Rule> > priorities;
+		for(list<Rule>::reverse_iterator r = p->second.rbegin(); r != p->second.rend(); r++)
+		{
+			list<Rule> &unique = priorities[r->getPriority()];
+			bool duplicated = false;
+			for(list<Rule>::iterator u = unique.begin(); u != unique.end() && !duplicated; u++)
+				duplicated = u->sameEntry(*r);
+			if(duplicated)
+				stats.duplicated++;
+			else
+				unique.push_front(*r);
+		}
+
+		/**
+		*	2) Aggregate the rules with the same priority and action. An aggregated rule
+		*	goes back to the worklist, since it may be aggregated again, while the rules
+		*	already done cannot be aggregated among them
+		*/
+		for(map<uint64_t, list<Rule> >::iterator priority = priorities.begin(); priority != priorities.end(); priority++)
+		{
+			list<Rule> pending;
+			pending.swap(priority->second);
+			list<Rule> &done = priority->second;
+			while(!pending.empty())
+			{
+				Rule rule = pending.front();
+				pending.pop_front();
+
+				list<Rule>::iterator other = done.begin();
+				for(; other != done.end(); other++)
+				{
+					if(!(other->getAction() == rule.getAction()))
+						continue;
+
+					Match match = other->getMatch();
+					if(!match.mergeIpv4Prefix(rule.getMatch()))
+						continue;
+
+					logger(ORCH_DEBUG, MODULE_NAME, __FILE__, __LINE__, "Rules %s and %s aggregated",other->getID().c_str(),rule.getID().c_str());
+					pending.push_front(Rule(match,other->getAction(),other->getID(),other->getPriority(),other->getTable()));
+					done.erase(other);
+					stats.merged++;
+					break;
+				}
+				if(other == done.end())
+					done.push_back(rule);
+			}
+		}
+
+		/**
+		*	3) Remove the rules shadowed by rules with higher priority
+		*/
+		list<Rule> kept;
+		for(map<uint64_t, list<Rule> >::reverse_iterator priority = priorities.rbegin(); priority != priorities.rend(); priority++)
+		{
+			//The rules kept so far have an higher priority
+			list<Rule> level;
+			for(list<Rule>::iterator r = priority->second.begin(); r != priority->second.end(); r++)
+			{
+				bool shadowed = false;
+				for(list<Rule>::iterator k = kept.begin(); k != kept.end() && !shadowed; k++)
+					shadowed = k->getMatch().covers(r->getMatch());
+
+				if(shadowed)
+				{
+					logger(ORCH_DEBUG, MODULE_NAME, __FILE__, __LINE__, "Rule %s is shadowed by rules with higher priority",r->getID().c_str());
+					stats.shadowed++;
+				}
+				else
+					level.push_back(*r);
+			}
+			kept.splice(kept.end(),level);
+		}
+
+		entries.splice(entries.end(),kept);
+	}
+
+	stats.entries += entries.size();
+
+	return entries;
+}
+
+void GraphOptimizer::resetStats(optimization_stats_t &stats)
+{
+	stats.rules = 0;
+	stats.entries = 0;
+	stats.duplicated = 0;
+	stats.shadowed = 0;
+	stats.merged = 0;
+}
+
+}
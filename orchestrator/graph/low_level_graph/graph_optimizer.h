@@ -0,0 +1,94 @@
+#ifndef GRAPH_OPTIMIZER_H_
+#define GRAPH_OPTIMIZER_H_ 1
+
+#pragma once
+
+#include <map>
+#include <list>
+#include "rule.h"
+#include "../../utils/logger.h"
+
+using namespace std;
+
+namespace lowlevel
+{
+
+/**
+*	@brief: effects of the optimization of a set of rules
+*/
+typedef struct
+{
+	/**
+	*	@brief: rules before and after the optimization
+	*/
+	unsigned int rules;
+	unsigned int entries;
+
+	/**
+	*	@brief: rules removed because identical to another one (same table, priority
+	*		and match), or because all their packets are matched by a rule with higher
+	*		priority
+	*/
+	unsigned int duplicated;
+	unsigned int shadowed;
+
+	/**
+	*	@brief: rules removed because aggregated with another one
+	*/
+	unsigned int merged;
+}optimization_stats_t;
+
+/**
+*	@brief: table and input port of a rule. Only the rules in the same partition
+*		can overlap
+*/
+typedef pair<uint8_t, unsigned int> rule_partition_t;
+
+/**
+*	@brief: compiles the rules of a graph into the (possibly fewer) flow entries to be
+*		inserted in an LSI, without changing the forwarding behavior. Smaller tables
+*		mean faster lookups in the datapath, and faster reinstallations when the
+*		connection with the datapath is open again.
+*
+*		The rules are optimized as follows:
+*			- a rule is removed if it has the same table, priority and match of a rule
+*				inserted later (the flowmod of the latter overwrites the former);
+*			- two rules with the same table, priority and action, whose matches differ
+*				only in an IPv4 prefix (source or destination), are replaced by a single
+*				rule if the two prefixes can be aggregated (e.g., 10.0.0.0/25 and
+*				10.0.0.128/25 into 10.0.0.0/24);
+*			- a rule is removed if all its packets are matched by a rule of the same
+*				table with an higher priority.
+*
+*		Only the rules in the same table and on the same input port are compared;
+*		moreover, the rules are grouped by priority, and a rule is compared with the
+*		rules with its own priority (duplicates and aggregations) or with the kept
+*		rules with higher priority (shadowing). The aggregated rules are handled as a
+*		worklist, so that a rule is never compared again with the rules that cannot be
+*		aggregated with it.
+*/
+class GraphOptimizer
+{
+public:
+	/**
+	*	@brief: return the flow entries implementing a list of rules
+	*
+	*	@param: rules	Rules to be optimized
+	*	@param: stats	Effects of the optimization (the counters are increased)
+	*/
+	static list<Rule> optimize(list<Rule> rules, optimization_stats_t &stats);
+
+	/**
+	*	@brief: return the partition (table and input port) of a rule
+	*/
+	static rule_partition_t partition(Rule &rule);
+
+	/**
+	*	@brief: reset the effects of the optimization
+	*/
+	static void resetStats(optimization_stats_t &stats);
+};
+
+}
+
+#endif //GRAPH_OPTIMIZER_H_
@@ -0,0 +1,90 @@
+#include "group.h"
+
+namespace lowlevel
+{
+
+Group::Group(uint32_t group_id, list<uint32_t> ports)
+	: group_id(group_id), ports(ports)
+{
+
+}
+
+vector<unsigned int> Group::bucketsOwners(unsigned int replicas)
+{
+	vector<unsigned int> owners(NF_GROUP_BUCKETS,0);
+	vector<unsigned int> owned(1,NF_GROUP_BUCKETS);
+
+	for(unsigned int added = 1; added < replicas; added++)
+	{
+		owned.push_back(0);
+		for(unsigned int moved = 0; moved < NF_GROUP_BUCKETS / (added + 1); moved++)
+		{
+			//The last bucket of the replica owning more buckets (the first one, in case of tie)
+			unsigned int from = 0;
+			for(unsigned int r = 1; r < added; r++)
+			{
+				if(owned[r] > owned[from])
+					from = r;
+			}
+			unsigned int bucket = NF_GROUP_BUCKETS - 1;
+			while(owners[bucket] != from)
+				bucket--;
+
+			owners[bucket] = added;
+			owned[from]--;
+			owned[added]++;
+		}
+	}
+
+	return owners;
+}
+
+uint32_t Group::getID()
+{
+	return group_id;
+}
+
+list<uint32_t> Group::getPorts()
+{
+	return ports;
+}
+
+bool Group::operator==(const Group &other) const
+{
+	return ports == other.ports;
+}
+
+void Group::fillBuckets(rofl::openflow::cofbuckets &buckets)
+{
+	uint32_t i = 0;
+	for(list<uint32_t>::iterator p = ports.begin(); p != ports.end(); p++, i++)
+	{
+		rofl::openflow::cofbucket &bucket = buckets.add_bucket(i);
+		bucket.set_weight(1);
+		bucket.set_actions().add_action_output(cindex(0)).set_port_no(*p);
+	}
+}
+
+void Group::print()
+{
+	if(LOGGING_LEVEL <= ORCH_DEBUG_INFO)
+	{
+		cout << "\tgroup " << group_id << ": " << endl << "\t{" << endl;
+		for(list<uint32_t>::iterator p = ports.begin(); p != ports.end(); p++)
+			cout << "\t\tOUTPUT: " << *p << endl;
+		cout << "\t}" << endl;
+	}
+}
+
+Object Group::toJSON()
+{
+	Object group;
+	Array buckets;
+	for(list<uint32_t>::iterator p = ports.begin(); p != ports.end(); p++)
+		buckets.push_back((uint64_t)*p);
+	group[_ID] = (uint64_t)group_id;
+	group[BUCKETS] = buckets;
+	return group;
+}
+
+}
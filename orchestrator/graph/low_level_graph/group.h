@@ -0,0 +1,83 @@
+#ifndef GROUP_H_
+#define GROUP_H_ 1
+
+#pragma once
+
+#include <rofl/common/crofbase.h>
+#include <rofl/common/logging.h>
+#include <rofl/common/openflow/openflow_common.h>
+
+#include <list>
+#include <vector>
+#include <ostream>
+
+#include "../../utils/logger.h"
+#include "../../utils/constants.h"
+
+#include <json_spirit/json_spirit.h>
+#include <json_spirit/value.h>
+#include <json_spirit/writer.h>
+
+using namespace rofl;
+using namespace std;
+using namespace json_spirit;
+
+namespace lowlevel
+{
+
+/**
+*	@brief: Openflow select group sending each packet on one of its ports
+*		(see Action::outputGroup). Each port is a bucket with the same weight;
+*		the bucket is chosen by the datapath, hashing the header of the
+*		packet, so that the packets of a flow always take the same bucket
+*		as long as the number of buckets does not change.
+*
+*		The groups balancing the replicas of a NF always have NF_GROUP_BUCKETS
+*		buckets, shared among the replicas as in bucketsOwners: when a replica
+*		is added or removed, only the flows of the buckets it takes or gives
+*		back change port
+*/
+class Group
+{
+private:
+	uint32_t group_id;
+
+	/**
+	*	@brief: ports of the buckets, in order
+	*/
+	list<uint32_t> ports;
+
+public:
+	Group(uint32_t group_id, list<uint32_t> ports);
+
+	/**
+	*	@brief: return the replica owning each of the NF_GROUP_BUCKETS buckets
+	*		of a group balancing a number of replicas. The buckets of n+1 replicas
+	*		are those of n replicas, except for the ones moved to the new replica,
+	*		which are taken from the replicas owning more buckets; hence the
+	*		buckets are shared evenly, and bucket 0 always belongs to the replica 0
+	*
+	*	@param: replicas	Number of replicas (from 1 to MAX_NF_REPLICAS)
+	*/
+	static vector<unsigned int> bucketsOwners(unsigned int replicas);
+
+	uint32_t getID();
+	list<uint32_t> getPorts();
+
+	/**
+	*	@brief: return true if the two groups have the same buckets
+	*/
+	bool operator==(const Group &other) const;
+
+	/**
+	*	@brief: insert the buckets of the group into a group_mod message
+	*/
+	void fillBuckets(rofl::openflow::cofbuckets &buckets);
+
+	void print();
+	Object toJSON();
+};
+
+}
+
+#endif //GROUP_H_
@@ -4,7 +4,7 @@ namespace lowlevel
 {
 
 Match::Match() :
-	graph::Match(),isInput_port(false)
+	graph::Match(),isInput_port(false),input_port(0)
 {
 
 }
@@ -152,6 +152,434 @@ void Match::setInputPort(unsigned int input_port)
 
 }
 
+unsigned int Match::getInputPort()
+{
+	return (isInput_port)? input_port : 0;
+}
+
+/**
+*	@brief: a field is covered if it is not specified in the first match, or if it
+*		has the same value in both the matches
+*/
+static bool coversField(bool isSet, uint32_t value, bool otherIsSet, uint32_t otherValue)
+{
+	return !isSet || (otherIsSet && value == otherValue);
+}
+
+static bool coversField(const char *value, const char *otherValue)
+{
+	return value == NULL || (otherValue != NULL && strcmp(value,otherValue) == 0);
+}
+
+bool Match::parseIpv4(const char *address, const char *netmask, uint32_t &addr, uint32_t &mask)
+{
+	struct in_addr a;
+	if(inet_pton(AF_INET,address,&a) != 1)
+		return false;
+	addr = ntohl(a.s_addr);
+	
+	mask = 0xFFFFFFFF;
+	if(netmask != NULL)
+	{
+		struct in_addr m;
+		if(inet_pton(AF_INET,netmask,&m) != 1)
+			return false;
+		mask = ntohl(m.s_addr);
+	}
+	addr &= mask;
+	
+	return true;
+}
+
+bool Match::coversIpv4(const char *address, const char *netmask, const char *otherAddress, const char *otherNetmask)
+{
+	if(address == NULL)
+		return true;
+	if(otherAddress == NULL)
+		return false;
+	
+	uint32_t addr, mask, otherAddr, otherMask;
+	if(!parseIpv4(address,netmask,addr,mask) || !parseIpv4(otherAddress,otherNetmask,otherAddr,otherMask))
+		return false;
+	
+	return ((mask & otherMask) == mask) && ((otherAddr & mask) == addr);
+}
+
+bool Match::mergeIpv4(char *&address, char *&netmask, const char *otherAddress, const char *otherNetmask)
+{
+	if(address == NULL || otherAddress == NULL)
+		return false;
+
+	uint32_t addr, mask, otherAddr, otherMask;
+	if(!parseIpv4(address,netmask,addr,mask) || !parseIpv4(otherAddress,otherNetmask,otherAddr,otherMask))
+		return false;
+	
+	//The prefixes must have the same (contiguous) length, and differ in their last bit
+	uint32_t lastBit = mask & (~mask + 1);
+	if(mask != otherMask || lastBit == 0 || (mask | (mask - 1)) != 0xFFFFFFFF || (addr ^ otherAddr) != lastBit)
+		return false;
+	
+	mask &= ~lastBit;
+	addr &= mask;
+	if(mask == 0)
+	{
+		//Any address is matched
+		address = NULL;
+		netmask = NULL;
+		return true;
+	}
+	
+	char buffer[INET_ADDRSTRLEN];
+	struct in_addr a;
+	a.s_addr = htonl(addr);
+	inet_ntop(AF_INET,&a,buffer,sizeof(buffer));
+	address = (char*)malloc(sizeof(char)*(strlen(buffer)+1));
+	strcpy(address,buffer);
+	
+	a.s_addr = htonl(mask);
+	inet_ntop(AF_INET,&a,buffer,sizeof(buffer));
+	netmask = (char*)malloc(sizeof(char)*(strlen(buffer)+1));
+	strcpy(netmask,buffer);
+	
+	return true;
+}
+
+bool Match::covers(const Match &other) const
+{
+	if(!coversField(isInput_port,input_port,other.isInput_port,other.input_port))
+		return false;
+
+	/*
+	*	Ethernet
+	*/
+	if(!coversField(eth_src,other.eth_src) || !coversField(eth_src_mask,other.eth_src_mask))
+		return false;
+	if(eth_src != NULL && eth_src_mask == NULL && other.eth_src_mask != NULL)
+		return false;
+	if(!coversField(eth_dst,other.eth_dst) || !coversField(eth_dst_mask,other.eth_dst_mask))
+		return false;
+	if(eth_dst != NULL && eth_dst_mask == NULL && other.eth_dst_mask != NULL)
+		return false;
+	if(!coversField(isEthType,ethType,other.isEthType,other.ethType))
+		return false;
+	
+	/*
+	*	VLAN
+	*/
+	if(isVlanID && !(other.isVlanID && vlanID == other.vlanID))
+		return false;
+	if(isNoVlan && !other.isNoVlan)
+		return false;
+	if(isAnyVlan && !(other.isAnyVlan || other.isVlanID))
+		return false;
+	if(!coversField(isVlanPCP,vlanPCP,other.isVlanPCP,other.vlanPCP))
+		return false;
+	
+	/*
+	*	IPv4
+	*/
+	if(!coversField(isIpDSCP,ipDSCP,other.isIpDSCP,other.ipDSCP))
+		return false;
+	if(!coversField(isIpECN,ipECN,other.isIpECN,other.ipECN))
+		return false;
+	if(!coversField(isIpProto,ipProto,other.isIpProto,other.ipProto))
+		return false;
+	if(!coversIpv4(ipv4_src,ipv4_src_mask,other.ipv4_src,other.ipv4_src_mask))
+		return false;
+	if(!coversIpv4(ipv4_dst,ipv4_dst_mask,other.ipv4_dst,other.ipv4_dst_mask))
+		return false;
+	
+	/*
+	*	TCP, UDP, SCTP
+	*/
+	if(!coversField(isTcpSrc,tcp_src,other.isTcpSrc,other.tcp_src) || !coversField(isTcpDst,tcp_dst,other.isTcpDst,other.tcp_dst))
+		return false;
+	if(!coversField(isUdpSrc,udp_src,other.isUdpSrc,other.udp_src) || !coversField(isUdpDst,udp_dst,other.isUdpDst,other.udp_dst))
+		return false;
+	if(!coversField(isSctpSrc,sctp_src,other.isSctpSrc,other.sctp_src) || !coversField(isSctpDst,sctp_dst,other.isSctpDst,other.sctp_dst))
+		return false;
+	
+	/*
+	*	ICMPv4
+	*/
+	if(!coversField(isIcmpv4Type,icmpv4Type,other.isIcmpv4Type,other.icmpv4Type) || !coversField(isIcmpv4Code,icmpv4Code,other.isIcmpv4Code,other.icmpv4Code))
+		return false;
+	
+	/*
+	*	ARP
+	*/
+	if(!coversField(isArpOpcode,arpOpcode,other.isArpOpcode,other.arpOpcode))
+		return false;
+	if(!coversIpv4(arp_spa,arp_spa_mask,other.arp_spa,other.arp_spa_mask))
+		return false;
+	if(!coversIpv4(arp_tpa,arp_tpa_mask,other.arp_tpa,other.arp_tpa_mask))
+		return false;
+	if(!coversField(arp_sha,other.arp_sha) || !coversField(arp_tha,other.arp_tha))
+		return false;
+	
+	/*
+	*	IPv6
+	*/
+	if(!coversField(ipv6_src,other.ipv6_src) || !coversField(ipv6_src_mask,other.ipv6_src_mask))
+		return false;
+	if(ipv6_src != NULL && ipv6_src_mask == NULL && other.ipv6_src_mask != NULL)
+		return false;
+	if(!coversField(ipv6_dst,other.ipv6_dst) || !coversField(ipv6_dst_mask,other.ipv6_dst_mask))
+		return false;
+	if(ipv6_dst != NULL && ipv6_dst_mask == NULL && other.ipv6_dst_mask != NULL)
+		return false;
+	if(!coversField(isIpv6Flabel,ipv6_flabel,other.isIpv6Flabel,other.ipv6_flabel))
+		return false;
+	if(!coversField(ipv6_nd_target,other.ipv6_nd_target) || !coversField(ipv6_nd_sll,other.ipv6_nd_sll) || !coversField(ipv6_nd_tll,other.ipv6_nd_tll))
+		return false;
+	
+	/*
+	*	ICMPv6
+	*/
+	if(!coversField(isIcmpv6Type,icmpv6Type,other.isIcmpv6Type,other.icmpv6Type) || !coversField(isIcmpv6Code,icmpv6Code,other.isIcmpv6Code,other.icmpv6Code))
+		return false;
+	
+	/*
+	*	MPLS
+	*/
+	if(!coversField(isMplsLabel,mplsLabel,other.isMplsLabel,other.mplsLabel) || !coversField(isMplsTC,mplsTC,other.isMplsTC,other.mplsTC))
+		return false;
+	
+	return true;
+}
+
+bool Match::mergeIpv4Prefix(const Match &other)
+{
+	//Source prefix: the other fields must be identical
+	Match thisWithoutSrc = *this, otherWithoutSrc = other;
+	thisWithoutSrc.ipv4_src = thisWithoutSrc.ipv4_src_mask = NULL;
+	otherWithoutSrc.ipv4_src = otherWithoutSrc.ipv4_src_mask = NULL;
+	if(thisWithoutSrc == otherWithoutSrc && mergeIpv4(ipv4_src,ipv4_src_mask,other.ipv4_src,other.ipv4_src_mask))
+		return true;
+	
+	//Destination prefix
+	Match thisWithoutDst = *this, otherWithoutDst = other;
+	thisWithoutDst.ipv4_dst = thisWithoutDst.ipv4_dst_mask = NULL;
+	otherWithoutDst.ipv4_dst = otherWithoutDst.ipv4_dst_mask = NULL;
+	if(thisWithoutDst == otherWithoutDst && mergeIpv4(ipv4_dst,ipv4_dst_mask,other.ipv4_dst,other.ipv4_dst_mask))
+		return true;
+	
+	return false;
+}
+
+/**
+*	@brief: two matches are disjoint if a field has different values in them
+*/
+static bool disjointField(bool isSet, uint32_t value, bool otherIsSet, uint32_t otherValue)
+{
+	return isSet && otherIsSet && value != otherValue;
+}
+
+static bool disjointEthernet(const char *address, const char *mask, const char *otherAddress, const char *otherMask)
+{
+	//Masked Ethernet addresses are not compared
+	return address != NULL && otherAddress != NULL && mask == NULL && otherMask == NULL && strcasecmp(address,otherAddress) != 0;
+}
+
+static bool disjointIpv6(const char *address, const char *mask, const char *otherAddress, const char *otherMask)
+{
+	if(address == NULL || otherAddress == NULL)
+		return false;
+
+	struct in6_addr a, m, o, om;
+	memset(&m,0xFF,sizeof(m));
+	memset(&om,0xFF,sizeof(om));
+	if(inet_pton(AF_INET6,address,&a) != 1 || inet_pton(AF_INET6,otherAddress,&o) != 1)
+		return false;
+	if((mask != NULL && inet_pton(AF_INET6,mask,&m) != 1) || (otherMask != NULL && inet_pton(AF_INET6,otherMask,&om) != 1))
+		return false;
+
+	for(unsigned int i = 0; i < sizeof(a.s6_addr); i++)
+	{
+		if(((a.s6_addr[i] ^ o.s6_addr[i]) & m.s6_addr[i] & om.s6_addr[i]) != 0)
+			return true;
+	}
+	return false;
+}
+
+bool Match::overlapsIpv4(const char *address, const char *netmask, const char *otherAddress, const char *otherNetmask)
+{
+	if(address == NULL || otherAddress == NULL)
+		return true;
+
+	uint32_t addr, mask, otherAddr, otherMask;
+	if(!parseIpv4(address,netmask,addr,mask) || !parseIpv4(otherAddress,otherNetmask,otherAddr,otherMask))
+		return true;
+
+	return ((addr ^ otherAddr) & mask & otherMask) == 0;
+}
+
+bool Match::overlaps(const Match &other) const
+{
+	if(disjointField(isInput_port,input_port,other.isInput_port,other.input_port))
+		return false;
+
+	/*
+	*	Ethernet
+	*/
+	if(disjointEthernet(eth_src,eth_src_mask,other.eth_src,other.eth_src_mask) || disjointEthernet(eth_dst,eth_dst_mask,other.eth_dst,other.eth_dst_mask))
+		return false;
+	if(disjointField(isEthType,ethType,other.isEthType,other.ethType))
+		return false;
+
+	/*
+	*	VLAN
+	*/
+	if(disjointField(isVlanID,vlanID,other.isVlanID,other.vlanID))
+		return false;
+	if((isNoVlan && (other.isVlanID || other.isAnyVlan)) || (other.isNoVlan && (isVlanID || isAnyVlan)))
+		return false;
+	if(disjointField(isVlanPCP,vlanPCP,other.isVlanPCP,other.vlanPCP))
+		return false;
+
+	/*
+	*	IPv4
+	*/
+	if(disjointField(isIpDSCP,ipDSCP,other.isIpDSCP,other.ipDSCP) || disjointField(isIpECN,ipECN,other.isIpECN,other.ipECN))
+		return false;
+	if(disjointField(isIpProto,ipProto,other.isIpProto,other.ipProto))
+		return false;
+	if(!overlapsIpv4(ipv4_src,ipv4_src_mask,other.ipv4_src,other.ipv4_src_mask) || !overlapsIpv4(ipv4_dst,ipv4_dst_mask,other.ipv4_dst,other.ipv4_dst_mask))
+		return false;
+
+	/*
+	*	TCP, UDP, SCTP
+	*/
+	if(disjointField(isTcpSrc,tcp_src,other.isTcpSrc,other.tcp_src) || disjointField(isTcpDst,tcp_dst,other.isTcpDst,other.tcp_dst))
+		return false;
+	if(disjointField(isUdpSrc,udp_src,other.isUdpSrc,other.udp_src) || disjointField(isUdpDst,udp_dst,other.isUdpDst,other.udp_dst))
+		return false;
+	if(disjointField(isSctpSrc,sctp_src,other.isSctpSrc,other.sctp_src) || disjointField(isSctpDst,sctp_dst,other.isSctpDst,other.sctp_dst))
+		return false;
+
+	/*
+	*	ICMPv4
+	*/
+	if(disjointField(isIcmpv4Type,icmpv4Type,other.isIcmpv4Type,other.icmpv4Type) || disjointField(isIcmpv4Code,icmpv4Code,other.isIcmpv4Code,other.icmpv4Code))
+		return false;
+
+	/*
+	*	ARP
+	*/
+	if(disjointField(isArpOpcode,arpOpcode,other.isArpOpcode,other.arpOpcode))
+		return false;
+	if(!overlapsIpv4(arp_spa,arp_spa_mask,other.arp_spa,other.arp_spa_mask) || !overlapsIpv4(arp_tpa,arp_tpa_mask,other.arp_tpa,other.arp_tpa_mask))
+		return false;
+	if(disjointEthernet(arp_sha,NULL,other.arp_sha,NULL) || disjointEthernet(arp_tha,NULL,other.arp_tha,NULL))
+		return false;
+
+	/*
+	*	IPv6
+	*/
+	if(disjointIpv6(ipv6_src,ipv6_src_mask,other.ipv6_src,other.ipv6_src_mask) || disjointIpv6(ipv6_dst,ipv6_dst_mask,other.ipv6_dst,other.ipv6_dst_mask))
+		return false;
+	if(disjointField(isIpv6Flabel,ipv6_flabel,other.isIpv6Flabel,other.ipv6_flabel))
+		return false;
+	if(disjointIpv6(ipv6_nd_target,NULL,other.ipv6_nd_target,NULL))
+		return false;
+	if(disjointEthernet(ipv6_nd_sll,NULL,other.ipv6_nd_sll,NULL) || disjointEthernet(ipv6_nd_tll,NULL,other.ipv6_nd_tll,NULL))
+		return false;
+
+	/*
+	*	ICMPv6
+	*/
+	if(disjointField(isIcmpv6Type,icmpv6Type,other.isIcmpv6Type,other.icmpv6Type) || disjointField(isIcmpv6Code,icmpv6Code,other.isIcmpv6Code,other.icmpv6Code))
+		return false;
+
+	/*
+	*	MPLS
+	*/
+	if(disjointField(isMplsLabel,mplsLabel,other.isMplsLabel,other.mplsLabel) || disjointField(isMplsTC,mplsTC,other.isMplsTC,other.mplsTC))
+		return false;
+
+	return true;
+}
+
+void Match::ipv4Prefix(const char *address, const char *netmask, uint32_t &prefix, uint8_t &length)
+{
+	prefix = 0;
+	length = 0;
+
+	uint32_t addr, mask;
+	if(address == NULL || !parseIpv4(address,netmask,addr,mask))
+		return;
+
+	//A non contiguous netmask is reduced to its leading ones
+	while(length < 32 && (mask & (0x80000000 >> length)) != 0)
+		length++;
+	if(length != 0)
+		prefix = addr & (0xFFFFFFFF << (32 - length));
+}
+
+void Match::getIpv4DstPrefix(uint32_t &address, uint8_t &length) const
+{
+	ipv4Prefix(ipv4_dst,ipv4_dst_mask,address,length);
+}
+
+void Match::getIpv4SrcPrefix(uint32_t &address, uint8_t &length) const
+{
+	ipv4Prefix(ipv4_src,ipv4_src_mask,address,length);
+}
+
+bool Match::parseEthernet(const char *address, uint64_t &value)
+{
+	unsigned int bytes[6];
+	char end;
+	if(sscanf(address,"%x:%x:%x:%x:%x:%x%c",&bytes[0],&bytes[1],&bytes[2],&bytes[3],&bytes[4],&bytes[5],&end) != 6)
+		return false;
+
+	value = 0;
+	for(unsigned int i = 0; i < 6; i++)
+	{
+		if(bytes[i] > 0xFF)
+			return false;
+		value = (value << 8) | bytes[i];
+	}
+	return true;
+}
+
+bool Match::getExactField(exact_field_t field, uint64_t &value) const
+{
+	switch(field)
+	{
+		case EXACT_ETH_SRC:
+			return eth_src != NULL && eth_src_mask == NULL && parseEthernet(eth_src,value);
+		case EXACT_ETH_DST:
+			return eth_dst != NULL && eth_dst_mask == NULL && parseEthernet(eth_dst,value);
+		case EXACT_ETH_TYPE:
+			value = ethType;
+			return isEthType;
+		case EXACT_IP_PROTO:
+			value = ipProto;
+			return isIpProto;
+		case EXACT_TCP_SRC:
+			value = tcp_src;
+			return isTcpSrc;
+		case EXACT_TCP_DST:
+			value = tcp_dst;
+			return isTcpDst;
+		case EXACT_UDP_SRC:
+			value = udp_src;
+			return isUdpSrc;
+		case EXACT_UDP_DST:
+			value = udp_dst;
+			return isUdpDst;
+		default:
+			return false;
+	}
+}
+
+bool Match::getVlanID(uint16_t &vlanID) const
+{
+	vlanID = this->vlanID;
+	return isVlanID;
+}
+
 void Match::setAllCommonFields(graph::Match match)
 {
 	graph::Match::setAllCommonFields(match);
@@ -169,4 +597,15 @@ void Match::print()
 }
 
 
+void Match::toJSON(Object &match)
+{
+	if(isInput_port)
+	{
+		stringstream port;
+		port << input_port;
+		match[IN_PORT] = port.str().c_str();
+	}
+	graph::Match::toJSON(match);
+}
+
 }
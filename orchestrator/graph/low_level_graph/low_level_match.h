@@ -5,6 +5,9 @@
 
 #include <inttypes.h>
 #include <ostream>
+#include <string.h>
+#include <stdio.h>
+#include <arpa/inet.h>
 
 #include <rofl/platform/unix/cunixenv.h>
 #include <rofl/platform/unix/cdaemon.h>
@@ -22,6 +25,12 @@ using namespace std;
 namespace lowlevel
 {
 
+/**
+*	@brief: fields that a match can express with a single value (see
+*		Match::getExactField)
+*/
+typedef enum{EXACT_ETH_SRC,EXACT_ETH_DST,EXACT_ETH_TYPE,EXACT_IP_PROTO,EXACT_TCP_SRC,EXACT_TCP_DST,EXACT_UDP_SRC,EXACT_UDP_DST,EXACT_FIELDS}exact_field_t;
+
 class Match : public graph::Match
 {
 private:
@@ -29,6 +38,40 @@ private:
 	bool isInput_port;
 	unsigned int input_port;
 	
+	/**
+	*	@brief: parse an IPv4 address and its (optional) netmask. Returns false if
+	*		they are not valid
+	*/
+	static bool parseIpv4(const char *address, const char *netmask, uint32_t &addr, uint32_t &mask);
+	
+	/**
+	*	@brief: return true if all the IPv4 addresses matched by the second prefix
+	*		are also matched by the first one
+	*/
+	static bool coversIpv4(const char *address, const char *netmask, const char *otherAddress, const char *otherNetmask);
+	
+	/**
+	*	@brief: if the two prefixes differ only in their last bit, replace the first
+	*		one with the prefix containing both of them. Returns true in this case
+	*/
+	static bool mergeIpv4(char *&address, char *&netmask, const char *otherAddress, const char *otherNetmask);
+	
+	/**
+	*	@brief: return true if some IPv4 addresses are matched by both the prefixes
+	*/
+	static bool overlapsIpv4(const char *address, const char *netmask, const char *otherAddress, const char *otherNetmask);
+	
+	/**
+	*	@brief: return the longest IPv4 prefix containing all the addresses
+	*		matched by an address and its (optional) netmask
+	*/
+	static void ipv4Prefix(const char *address, const char *netmask, uint32_t &prefix, uint8_t &length);
+	
+	/**
+	*	@brief: parse an Ethernet address. Returns false if it is not valid
+	*/
+	static bool parseEthernet(const char *address, uint64_t &value);
+	
 public:
 	Match();
 	
@@ -50,7 +93,75 @@ public:
 	
 	void setInputPort(unsigned int input_port);
 	
+	/**
+	*	@brief: return the input port of the match, or 0 if the
+	*		match is not expressed on the input port
+	*/
+	unsigned int getInputPort();
+	
+	/**
+	*	@brief: return true if all the packets matched by other are also matched
+	*		by this match. The result is conservative: false is returned when this
+	*		cannot be proved (e.g., Ethernet and IPv6 addresses are only compared 
+	*		for equality)
+	*
+	*	@param: other	Match to be compared with this one
+	*/
+	bool covers(const Match &other) const;
+	
+	/**
+	*	@brief: if this match and other differ only in an IPv4 prefix (source or 
+	*		destination), and the two prefixes can be aggregated, this match is 
+	*		extended to the packets matched by other. Returns true in this case
+	*
+	*	@param: other	Match to be merged into this one
+	*/
+	bool mergeIpv4Prefix(const Match &other);
+	
+	/**
+	*	@brief: return true if some packets can be matched by both this match and
+	*		other. The result is conservative: true is returned when the two matches
+	*		cannot be proved to be disjoint
+	*
+	*	@param: other	Match to be compared with this one
+	*/
+	bool overlaps(const Match &other) const;
+	
+	/**
+	*	@brief: return the longest IPv4 prefix containing all the destination 
+	*		addresses matched (the length is 0 if the match is not expressed on
+	*		the destination address)
+	*/
+	void getIpv4DstPrefix(uint32_t &address, uint8_t &length) const;
+	
+	/**
+	*	@brief: return the longest IPv4 prefix containing all the source 
+	*		addresses matched (the length is 0 if the match is not expressed on
+	*		the source address)
+	*/
+	void getIpv4SrcPrefix(uint32_t &address, uint8_t &length) const;
+	
+	/**
+	*	@brief: return true if the match is expressed on a single value of a
+	*		field. Two matches with different values of the same field cannot
+	*		overlap. Masked Ethernet addresses are not considered, as in overlaps
+	*
+	*	@param: field	Field to be read
+	*	@param: value	Value of the field (an Ethernet address is a 48 bits integer)
+	*/
+	bool getExactField(exact_field_t field, uint64_t &value) const;
+	
+	/**
+	*	@brief: return true if the match is expressed on a VLAN ID
+	*/
+	bool getVlanID(uint16_t &vlanID) const;
+	
 	void print();
+	
+	/**
+	*	@brief: JSON representation of the match, including the input port
+	*/
+	void toJSON(Object &match);
 };
 
 }
@@ -0,0 +1,59 @@
+#include "meter.h"
+
+namespace lowlevel
+{
+
+Meter::Meter(uint32_t meter_id, uint32_t rate, bool pps, uint32_t burst)
+	: meter_id(meter_id), rate(rate), pps(pps), burst(burst)
+{
+
+}
+
+uint32_t Meter::getID()
+{
+	return meter_id;
+}
+
+bool Meter::operator==(const Meter &other) const
+{
+	return (rate == other.rate) && (pps == other.pps) && (burst == other.burst);
+}
+
+uint16_t Meter::getFlags()
+{
+	uint16_t flags = (pps)? openflow13::OFPMF_PKTPS : openflow13::OFPMF_KBPS;
+	if(burst != 0)
+		flags |= openflow13::OFPMF_BURST;
+	return flags;
+}
+
+void Meter::fillMeterBands(rofl::openflow::cofmeter_bands &bands)
+{
+	rofl::openflow::cofmeter_band_drop &band = bands.add_meter_band_drop(0);
+	band.set_rate(rate);
+	band.set_burst_size(burst);
+}
+
+void Meter::print()
+{
+	if(LOGGING_LEVEL <= ORCH_DEBUG_INFO)
+	{
+		cout << "\tmeter " << meter_id << ": " << endl << "\t{" << endl;
+		cout << "\t\t" << ((pps)? PPS : BANDWIDTH) << " : " << rate << endl;
+		if(burst != 0)
+			cout << "\t\t" << BURST << " : " << burst << endl;
+		cout << "\t}" << endl;
+	}
+}
+
+Object Meter::toJSON()
+{
+	Object meter;
+	meter[_ID] = (uint64_t)meter_id;
+	meter[(pps)? PPS : BANDWIDTH] = (uint64_t)rate;
+	if(burst != 0)
+		meter[BURST] = (uint64_t)burst;
+	return meter;
+}
+
+}
@@ -0,0 +1,73 @@
+#ifndef METER_H_
+#define METER_H_ 1
+
+#pragma once
+
+#include <rofl/common/crofbase.h>
+#include <rofl/common/logging.h>
+#include <rofl/common/openflow/openflow_common.h>
+
+#include <ostream>
+
+#include "../../utils/logger.h"
+#include "../../utils/constants.h"
+
+#include <json_spirit/json_spirit.h>
+#include <json_spirit/value.h>
+#include <json_spirit/writer.h>
+
+using namespace rofl;
+using namespace std;
+using namespace json_spirit;
+
+namespace lowlevel
+{
+
+/**
+*	@brief: Openflow 1.3 meter with a single drop band, used to limit the
+*		rate of the flow entries pointing to it (see Action::setMeter)
+*/
+class Meter
+{
+private:
+	uint32_t meter_id;
+
+	/**
+	*	@brief: rate of the band, in kbit/s, or in packets per second if pps
+	*		is true
+	*/
+	uint32_t rate;
+	bool pps;
+
+	/**
+	*	@brief: burst size of the band (0 lets the datapath choose it)
+	*/
+	uint32_t burst;
+
+public:
+	Meter(uint32_t meter_id, uint32_t rate, bool pps, uint32_t burst = 0);
+
+	uint32_t getID();
+
+	/**
+	*	@brief: return true if the two meters have the same band
+	*/
+	bool operator==(const Meter &other) const;
+
+	/**
+	*	@brief: return the flags of the meter_mod message
+	*/
+	uint16_t getFlags();
+
+	/**
+	*	@brief: insert the band of the meter into a meter_mod message
+	*/
+	void fillMeterBands(rofl::openflow::cofmeter_bands &bands);
+
+	void print();
+	Object toJSON();
+};
+
+}
+
+#endif //METER_H_
@@ -3,15 +3,15 @@
 namespace lowlevel
 {
 
-Rule::Rule(Match match, Action action, string flowID, uint64_t priority) :
-	priority(priority), match(match), action(action), flowID(flowID) {};
+Rule::Rule(Match match, Action action, string flowID, uint64_t priority, uint8_t table_id) :
+	priority(priority), match(match), action(action), flowID(flowID), table_id(table_id) {};
 	
 //XXX: the flowID is not considered. In fact, this operator
 //is used to check if two rules have the same match and the
 //same action, regardless of their ID
 bool Rule::operator==(const Rule &other) const 
 {	
-	if((priority == other.priority) && (action == other.action) && (match == other.match))
+	if((table_id == other.table_id) && (priority == other.priority) && (action == other.action) && (match == other.match))
 		//The two rules are identical
 		return true;	
 	
@@ -20,7 +20,7 @@ bool Rule::operator==(const Rule &other) const
 
 void Rule::fillFlowmodMessage(rofl::openflow::cofflowmod &message, uint8_t of_version, commad_t command)
 {
-	message.set_table_id(0);
+	message.set_table_id(table_id);
 	
 	switch (of_version) 
 	{
@@ -29,7 +29,7 @@ void Rule::fillFlowmodMessage(rofl::openflow::cofflowmod &message, uint8_t of_ve
 			if(command == ADD_RULE)
 				message.set_command(openflow10::OFPFC_ADD);
 			else
-				message.set_command(openflow10::OFPFC_DELETE);		
+				message.set_command(openflow10::OFPFC_DELETE_STRICT);		
 			break;
 		}
 		case openflow12::OFP_VERSION: 
@@ -37,7 +37,7 @@ void Rule::fillFlowmodMessage(rofl::openflow::cofflowmod &message, uint8_t of_ve
 			if(command == ADD_RULE)
 				message.set_command(openflow12::OFPFC_ADD);
 			else
-				message.set_command(openflow12::OFPFC_DELETE);
+				message.set_command(openflow12::OFPFC_DELETE_STRICT);
 			break;
 		}
 		case openflow13::OFP_VERSION: 
@@ -45,7 +45,7 @@ void Rule::fillFlowmodMessage(rofl::openflow::cofflowmod &message, uint8_t of_ve
 			if(command == ADD_RULE)
 				message.set_command(openflow13::OFPFC_ADD);
 			else
-				message.set_command(openflow13::OFPFC_DELETE);
+				message.set_command(openflow13::OFPFC_DELETE_STRICT);
 			break;
 		}
 		default:
@@ -61,7 +61,7 @@ void Rule::fillFlowmodMessage(rofl::openflow::cofflowmod &message, uint8_t of_ve
 	
 	if(command == ADD_RULE)
 		//The action is only useful when a new entry is added
-		action.fillFlowmodMessage(message);
+		action.fillFlowmodMessage(message,of_version);
 	else
 	{
 		//Set the out_port and the out_group to any
@@ -75,16 +75,56 @@ string Rule::getID()
 	return flowID;
 }
 
+uint8_t Rule::getTable()
+{
+	return table_id;
+}
+
+Match Rule::getMatch()
+{
+	return match;
+}
+
+Action Rule::getAction()
+{
+	return action;
+}
+
+uint64_t Rule::getPriority()
+{
+	return priority;
+}
+
+bool Rule::sameEntry(const Rule &other) const
+{
+	return (table_id == other.table_id) && (priority == other.priority) && (match == other.match);
+}
+
 void Rule::print()
 {
 	if(LOGGING_LEVEL <= ORCH_DEBUG_INFO)
 	{
 		cout << "\trule " << flowID << ": " << endl << "\t{" << endl;
 		cout << "\t\tpriority : " << priority << endl;
+		cout << "\t\ttable : " << (unsigned int)table_id << endl;
 		match.print();
 		action.print();
 		cout << "\t}" << endl;
 	}
 }
 
+Object Rule::toJSON()
+{
+	Object rule, jsonMatch;
+	match.toJSON(jsonMatch);
+	
+	rule[_ID] = flowID;
+	rule[TABLE_ID] = (uint64_t)table_id;
+	rule[PRIORITY] = priority;
+	rule[MATCH] = jsonMatch;
+	rule[ACTION] = action.toJSON();
+	
+	return rule;
+}
+
 }
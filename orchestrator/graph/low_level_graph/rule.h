@@ -28,8 +28,13 @@ private:
 	
 	string flowID;
 	
+	/**
+	*	@brief: table of the LSI in which the rule is inserted
+	*/
+	uint8_t table_id;
+	
 public:
-	Rule(Match match, Action action, string flowID, uint64_t priority);
+	Rule(Match match, Action action, string flowID, uint64_t priority, uint8_t table_id = 0);
 	
 	bool operator==(const Rule &other) const;
 	
@@ -45,8 +50,33 @@ public:
 	*	@brief: return the identifier of this rule
 	*/
 	string getID();
+	
+	/**
+	*	@brief: return the table in which the rule is inserted
+	*/
+	uint8_t getTable();
+	
+	/**
+	*	@brief: return the match of this rule
+	*/
+	Match getMatch();
+	
+	/**
+	*	@brief: return the action of this rule
+	*/
+	Action getAction();
+	
+	uint64_t getPriority();
+	
+	/**
+	*	@brief: return true if the two rules correspond to the same flow entry
+	*		in the LSI (i.e., same table, priority and match), regardless of
+	*		their action
+	*/
+	bool sameEntry(const Rule &other) const;
 
 	void print();
+	Object toJSON();
 };
 
 }
@@ -949,7 +949,7 @@ void Match::toJSON(Object &match)
 		if(isVlanPCP)
 		{
 			stringstream vlanpcp;
-			vlanpcp << vlanPCP;
+			vlanpcp << (unsigned int)vlanPCP;
 			match[VLAN_PCP] = vlanpcp.str().c_str();
 		}
 	
@@ -959,13 +959,13 @@ void Match::toJSON(Object &match)
 		if(isIpDSCP)
 		{
 			stringstream ipdscp;
-			ipdscp << ipDSCP;
+			ipdscp << (unsigned int)ipDSCP;
 			match[IP_DSCP] = ipdscp.str().c_str();
 		}
 		if(isIpECN)
 		{
 			stringstream ipecn;
-			ipecn << ipECN;
+			ipecn << (unsigned int)ipECN;
 			match[IP_ECN] = ipecn.str().c_str();
 		}
 		if(isIpProto)
@@ -1037,13 +1037,13 @@ void Match::toJSON(Object &match)
 		if(isIcmpv4Type)
 		{
 			stringstream icmpv4type;
-			icmpv4type << icmpv4Type;
+			icmpv4type << (unsigned int)icmpv4Type;
 			match[ICMPv4_TYPE] = icmpv4type.str().c_str();
 		}
 		if(isIcmpv4Code)
 		{
 			stringstream icmpv4code;
-			icmpv4code << icmpv4Code;
+			icmpv4code << (unsigned int)icmpv4Code;
 			match[ICMPv4_CODE] = icmpv4code.str().c_str();
 		}
 	
@@ -1099,13 +1099,13 @@ void Match::toJSON(Object &match)
 		if(isIcmpv6Type)
 		{
 			stringstream icmpv6type;
-			icmpv6type << icmpv6Type;
+			icmpv6type << (unsigned int)icmpv6Type;
 			match[ICMPv6_TYPE] = icmpv6type.str().c_str();
 		}
 		if(isIcmpv6Code)
 		{
 			stringstream icmpv6code;
-			icmpv6code << icmpv6Code;
+			icmpv6code << (unsigned int)icmpv6Code;
 			match[ICMPv6_CODE] = icmpv6code.str().c_str();
 		}
 	
@@ -1121,7 +1121,7 @@ void Match::toJSON(Object &match)
 		if(isMplsTC)
 		{
 			stringstream mplstc;
-			mplstc << mplsTC;
+			mplstc << (unsigned int)mplsTC;
 			match[MPLS_TC] = mplstc.str().c_str();
 		}
 }
@@ -0,0 +1,209 @@
+#include "autoscaler.h"
+
+Autoscaler::Autoscaler(bool enabled) :
+	enabled(enabled), terminating(false)
+{
+	pthread_mutex_init(&autoscaler_mutex, NULL);
+	pthread_cond_init(&terminate_cond, NULL);
+}
+
+Autoscaler::~Autoscaler()
+{
+	pthread_cond_destroy(&terminate_cond);
+	pthread_mutex_destroy(&autoscaler_mutex);
+}
+
+bool Autoscaler::isEnabled()
+{
+	return enabled;
+}
+
+bool Autoscaler::waitPeriod()
+{
+	struct timespec deadline;
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += AUTOSCALER_PERIOD;
+
+	pthread_mutex_lock(&autoscaler_mutex);
+	int ret = 0;
+	while(!terminating && ret != ETIMEDOUT)
+		ret = pthread_cond_timedwait(&terminate_cond, &autoscaler_mutex, &deadline);
+	bool goOn = !terminating;
+	pthread_mutex_unlock(&autoscaler_mutex);
+
+	return goOn;
+}
+
+void Autoscaler::terminate()
+{
+	pthread_mutex_lock(&autoscaler_mutex);
+	terminating = true;
+	pthread_cond_signal(&terminate_cond);
+	pthread_mutex_unlock(&autoscaler_mutex);
+}
+
+bool Autoscaler::replicaLoad(nf_load_t &previous, nf_load_t &current, double &occupancy, uint64_t &received, uint64_t &dropped)
+{
+	//The counters restart from zero if the replica has been restarted
+	if(previous.rings.size() != current.rings.size() || current.received < previous.received || current.overload_dropped < previous.overload_dropped)
+		return false;
+
+	occupancy = 0;
+	for(unsigned int p = 0; p < current.rings.size(); p++)
+	{
+		struct nf_ring_stats_t &before = previous.rings[p];
+		struct nf_ring_stats_t &now = current.rings[p];
+		if(now.polls < before.polls || now.occupancy_sum < before.occupancy_sum || now.capacity == 0)
+			return false;
+
+		//A port that has not been polled in the period (e.g., the NF is blocked) is as full as it was
+		double average = (now.polls != before.polls)? (double)(now.occupancy_sum - before.occupancy_sum) / (now.polls - before.polls) : now.occupancy;
+		average /= now.capacity;
+		if(average > occupancy)
+			occupancy = average;
+	}
+	received = current.received - previous.received;
+	dropped = current.overload_dropped - previous.overload_dropped;
+
+	return true;
+}
+
+unsigned int Autoscaler::evaluate(string graphID, string nf, unsigned int replicas, map<unsigned int, nf_load_t> loads, string &reason)
+{
+	nf_scaling_t &state = nfs[make_pair(graphID,nf)];
+
+	//The replicas whose counters cannot be read in this period are compared in the next one
+	bool complete = (loads.size() == replicas);
+	double occupancy = 0;
+	uint64_t received = 0;
+	uint64_t dropped = 0;
+	for(map<unsigned int, nf_load_t>::iterator l = loads.begin(); l != loads.end(); l++)
+	{
+		double replicaOccupancy;
+		uint64_t replicaReceived;
+		uint64_t replicaDropped;
+		if(state.previous.count(l->first) == 0 || !replicaLoad(state.previous[l->first],l->second,replicaOccupancy,replicaReceived,replicaDropped))
+			complete = false;
+		else
+		{
+			occupancy += replicaOccupancy;
+			received += replicaReceived;
+			dropped += replicaDropped;
+		}
+		state.previous[l->first] = l->second;
+	}
+
+	if(!complete)
+		return replicas;
+	if(state.cooldown > 0)
+	{
+		state.cooldown--;
+		return replicas;
+	}
+
+	occupancy /= replicas;
+	//The drop rate, rather than any packet dropped, makes the NF overloaded, so that
+	//a burst occasionally filling a ring does not add a replica
+	double dropRate = (received != 0)? (double)dropped / received : ((dropped != 0)? 1.0 : 0.0);
+
+	logger(ORCH_DEBUG, MODULE_NAME, __FILE__, __LINE__, "NF \"%s\" of graph \"%s\": %d replicas, occupancy of the rings %.1f%%, %" PRIu64 " packets dropped out of %" PRIu64,nf.c_str(),graphID.c_str(),replicas,occupancy * 100,dropped,received);
+
+	bool overloaded = (occupancy >= AUTOSCALER_HIGH_OCCUPANCY || dropRate >= AUTOSCALER_HIGH_DROP_RATE);
+	bool underloaded = (!overloaded && replicas > 1 && dropRate < AUTOSCALER_LOW_DROP_RATE && occupancy < AUTOSCALER_LOW_OCCUPANCY
+		&& occupancy * replicas / (replicas - 1) < AUTOSCALER_HIGH_OCCUPANCY);
+
+	state.overloaded = (overloaded)? state.overloaded + 1 : 0;
+	state.underloaded = (underloaded)? state.underloaded + 1 : 0;
+
+	stringstream description;
+	description.precision(3);
+	description << "occupancy of the rings " << occupancy * 100 << "%, drop rate " << dropRate * 100 << "% (" << dropped << " packets dropped out of " << received << ")";
+	reason = description.str();
+
+	if(state.overloaded >= AUTOSCALER_UP_PERIODS)
+	{
+		if(replicas < MAX_NF_REPLICAS)
+			return replicas + 1;
+
+		//Signalled once, when the NF becomes overloaded
+		if(state.overloaded == AUTOSCALER_UP_PERIODS)
+		{
+			logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "NF \"%s\" of graph \"%s\" is overloaded, but it already has %d replicas (%s)",nf.c_str(),graphID.c_str(),replicas,reason.c_str());
+
+			Object event;
+			event["time"] = (uint64_t)time(NULL);
+			event["graph"] = graphID;
+			event["VNF"] = nf;
+			event["from"] = (uint64_t)replicas;
+			event["to"] = (uint64_t)replicas;
+			event["reason"] = reason;
+			event["result"] = "saturated";
+			addEvent(event);
+		}
+	}
+	else if(state.underloaded >= AUTOSCALER_DOWN_PERIODS)
+		return replicas - 1;
+
+	return replicas;
+}
+
+void Autoscaler::recordScaling(string graphID, string nf, unsigned int from, unsigned int to, string reason, bool done)
+{
+	if(done)
+		logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "NF \"%s\" of graph \"%s\" scaled from %d to %d replicas (%s)",nf.c_str(),graphID.c_str(),from,to,reason.c_str());
+	else
+		logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "NF \"%s\" of graph \"%s\" cannot be scaled from %d to %d replicas (%s)",nf.c_str(),graphID.c_str(),from,to,reason.c_str());
+
+	Object event;
+	event["time"] = (uint64_t)time(NULL);
+	event["graph"] = graphID;
+	event["VNF"] = nf;
+	event["from"] = (uint64_t)from;
+	event["to"] = (uint64_t)to;
+	event["reason"] = reason;
+	event["result"] = (done)? "done" : "failed";
+	addEvent(event);
+
+	//The load is balanced differently, hence the sampling restarts
+	nf_scaling_t &state = nfs[make_pair(graphID,nf)];
+	state.previous.clear();
+	state.overloaded = 0;
+	state.underloaded = 0;
+	state.cooldown = AUTOSCALER_COOLDOWN_PERIODS;
+}
+
+void Autoscaler::forgetGraph(string graphID)
+{
+	map<pair<string, string>, nf_scaling_t>::iterator it = nfs.lower_bound(make_pair(graphID,string("")));
+	while(it != nfs.end() && it->first.first == graphID)
+		nfs.erase(it++);
+}
+
+void Autoscaler::addEvent(Object event)
+{
+	events.push_back(event);
+	if(events.size() > AUTOSCALER_MAX_EVENTS)
+		events.pop_front();
+}
+
+Object Autoscaler::toJSON()
+{
+	Object json;
+
+	json["enabled"] = enabled;
+	json["period"] = (uint64_t)AUTOSCALER_PERIOD;
+	json["high-occupancy"] = AUTOSCALER_HIGH_OCCUPANCY;
+	json["low-occupancy"] = AUTOSCALER_LOW_OCCUPANCY;
+	json["high-drop-rate"] = AUTOSCALER_HIGH_DROP_RATE;
+	json["low-drop-rate"] = AUTOSCALER_LOW_DROP_RATE;
+	json["up-periods"] = (uint64_t)AUTOSCALER_UP_PERIODS;
+	json["down-periods"] = (uint64_t)AUTOSCALER_DOWN_PERIODS;
+	json["max-replicas"] = (uint64_t)MAX_NF_REPLICAS;
+
+	Array events_array;
+	for(list<Object>::iterator e = events.begin(); e != events.end(); e++)
+		events_array.push_back(*e);
+	json["events"] = events_array;
+
+	return json;
+}
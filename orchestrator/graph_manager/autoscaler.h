@@ -0,0 +1,185 @@
+#ifndef AUTOSCALER_H_
+#define AUTOSCALER_H_ 1
+
+#pragma once
+
+#include <map>
+#include <list>
+#include <string>
+#include <sstream>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include <inttypes.h>
+
+#include "../utils/logger.h"
+#include "../utils/constants.h"
+#include "../nfs_manager/dpdk_stats.h"
+
+#include <json_spirit/json_spirit.h>
+#include <json_spirit/value.h>
+#include <json_spirit/writer.h>
+
+using namespace std;
+using namespace json_spirit;
+
+/**
+*	@brief: seconds between two consecutive samples of the load of the DPDK NFs
+*/
+#define AUTOSCALER_PERIOD				5
+
+/**
+*	@brief: average occupancy of the rings from xDPd (fraction of their capacity)
+*		above which a NF is overloaded, and below which it is underloaded
+*/
+#define AUTOSCALER_HIGH_OCCUPANCY		0.5
+#define AUTOSCALER_LOW_OCCUPANCY		0.1
+
+/**
+*	@brief: fraction of the packets received by a NF in a period that it dropped
+*		because it could not keep up, above which the NF is overloaded, and below
+*		which it can be underloaded
+*/
+#define AUTOSCALER_HIGH_DROP_RATE		0.001
+#define AUTOSCALER_LOW_DROP_RATE		0.0001
+
+/**
+*	@brief: consecutive overloaded (underloaded) periods after which a replica
+*		is added (removed)
+*/
+#define AUTOSCALER_UP_PERIODS			2
+#define AUTOSCALER_DOWN_PERIODS			6
+
+/**
+*	@brief: periods ignored after the number of replicas of a NF has changed, so
+*		that the traffic is balanced among the new replicas before it is sampled
+*/
+#define AUTOSCALER_COOLDOWN_PERIODS		3
+
+/**
+*	@brief: number of events kept by the autoscaler
+*/
+#define AUTOSCALER_MAX_EVENTS			100
+
+/**
+*	@brief: state of the autoscaling of a NF of a graph
+*/
+typedef struct
+{
+	/**
+	*	@brief: counters read in the previous period, for each replica
+	*/
+	map<unsigned int, nf_load_t> previous;
+
+	/**
+	*	@brief: consecutive overloaded and underloaded periods
+	*/
+	unsigned int overloaded;
+	unsigned int underloaded;
+
+	/**
+	*	@brief: periods still to be ignored
+	*/
+	unsigned int cooldown;
+}nf_scaling_t;
+
+/**
+*	@brief: policy changing the number of replicas of the DPDK NFs according to
+*		their load. In each period, the GraphManager reads the counters exported by
+*		all the replicas of a NF (see DPDKStats::readLoad), and the autoscaler
+*		computes, for each replica, the average occupancy of its rings from xDPd
+*		in the period (the most loaded port is considered), and the packets it
+*		received and dropped because it could not keep up.
+*
+*		The NF is overloaded if the average occupancy among its replicas is above
+*		AUTOSCALER_HIGH_OCCUPANCY, or if its replicas dropped more than
+*		AUTOSCALER_HIGH_DROP_RATE of the packets they received; it is underloaded
+*		if the drop rate is below AUTOSCALER_LOW_DROP_RATE, and the occupancy is
+*		below AUTOSCALER_LOW_OCCUPANCY and would still be below
+*		AUTOSCALER_HIGH_OCCUPANCY with one replica less. A replica
+*		is added after AUTOSCALER_UP_PERIODS consecutive overloaded periods (up to
+*		MAX_NF_REPLICAS), and removed after AUTOSCALER_DOWN_PERIODS consecutive
+*		underloaded periods (down to one replica).
+*
+*		Each change of the number of replicas is recorded as an event. The state
+*		is not protected by any lock: it must be accessed with the lock of the
+*		GraphManager held, except for waitPeriod and terminate.
+*/
+class Autoscaler
+{
+private:
+	bool enabled;
+	bool terminating;
+
+	pthread_mutex_t autoscaler_mutex;
+	pthread_cond_t terminate_cond;
+
+	/**
+	*	@brief: state of the NFs, indexed by <graph ID, NF name>
+	*/
+	map<pair<string, string>, nf_scaling_t> nfs;
+
+	/**
+	*	@brief: last events, the oldest first
+	*/
+	list<Object> events;
+
+	/**
+	*	@brief: average occupancy of the rings of a replica in the last period,
+	*		i.e., the maximum among its ports, and packets received and dropped
+	*		in the period. Returns false if the counters of the replica cannot be
+	*		compared with the previous ones (e.g., the replica has just been started)
+	*/
+	bool replicaLoad(nf_load_t &previous, nf_load_t &current, double &occupancy, uint64_t &received, uint64_t &dropped);
+
+	void addEvent(Object event);
+
+public:
+	Autoscaler(bool enabled = false);
+	~Autoscaler();
+
+	bool isEnabled();
+
+	/**
+	*	@brief: wait for the next period. Returns false if the autoscaler is
+	*		terminating
+	*/
+	bool waitPeriod();
+
+	/**
+	*	@brief: wake up the thread waiting for the next period, and make
+	*		waitPeriod return false
+	*/
+	void terminate();
+
+	/**
+	*	@brief: evaluate the load of a NF in the last period, and return the number
+	*		of replicas it should have (replicas if it must not change)
+	*
+	*	@param:	graphID		Identifier of the graph
+	*	@param:	nf			Name of the network function
+	*	@param:	replicas	Current number of replicas of the network function
+	*	@param:	loads		Counters read from the replicas (a replica is missing if
+	*						its counters cannot be read)
+	*	@param:	reason		Description of the load that caused the change
+	*/
+	unsigned int evaluate(string graphID, string nf, unsigned int replicas, map<unsigned int, nf_load_t> loads, string &reason);
+
+	/**
+	*	@brief: record that the number of replicas of a NF has been changed (or that
+	*		the change failed), and restart the sampling of the NF
+	*/
+	void recordScaling(string graphID, string nf, unsigned int from, unsigned int to, string reason, bool done);
+
+	/**
+	*	@brief: forget the state of the NFs of a graph
+	*/
+	void forgetGraph(string graphID);
+
+	/**
+	*	@brief: create the JSON representation of the policy and of the last events
+	*/
+	Object toJSON();
+};
+
+#endif //AUTOSCALER_H_
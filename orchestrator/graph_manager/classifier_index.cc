@@ -0,0 +1,244 @@
+#include "classifier_index.h"
+
+static uint32_t prefixMask(uint8_t length)
+{
+	return (length == 0)? 0 : (0xFFFFFFFF << (32 - length));
+}
+
+uint32_t ClassifierIndex::vlanKey(const classified_rule_t &rule)
+{
+	uint16_t vlanID;
+	if(rule.match.getVlanID(vlanID))
+		return vlanID;
+	return CLASSIFIER_ANY_VLAN;
+}
+
+uint64_t ClassifierIndex::valueKey(const classified_rule_t &rule, lowlevel::exact_field_t field)
+{
+	uint64_t value;
+	if(rule.match.getExactField(field,value))
+		return value;
+	return CLASSIFIER_ANY_VALUE;
+}
+
+/**
+*	@brief: remove a key from an index, and the entry if it becomes empty
+*/
+template <class K, class V>
+static void eraseKey(map<K, set<V> > &index, K entry, V key)
+{
+	typename map<K, set<V> >::iterator it = index.find(entry);
+	if(it == index.end())
+		return;
+	it->second.erase(key);
+	if(it->second.empty())
+		index.erase(it);
+}
+
+void ClassifierIndex::addRules(list<classified_rule_t> rules)
+{
+	for(list<classified_rule_t>::iterator r = rules.begin(); r != rules.end(); r++)
+	{
+		rule_key_t key = make_pair(r->graph,r->flow);
+		if(this->rules.count(key) != 0)
+			removeRule(r->graph,r->flow);
+
+		uint32_t address;
+		uint8_t length;
+		this->rules[key] = *r;
+		port_index_t &port = index[r->port];
+
+		r->match.getIpv4DstPrefix(address,length);
+		port.ipv4Dst[vlanKey(*r)][make_pair(address,length)].insert(key);
+		r->match.getIpv4SrcPrefix(address,length);
+		port.ipv4Src[make_pair(address,length)].insert(key);
+		for(unsigned int f = 0; f < lowlevel::EXACT_FIELDS; f++)
+			port.fields[f][valueKey(*r,(lowlevel::exact_field_t)f)].insert(key);
+	}
+
+	logger(ORCH_DEBUG, MODULE_NAME, __FILE__, __LINE__, "%d rules on the shared ports of the LSI-0",this->rules.size());
+}
+
+void ClassifierIndex::removeRule(string graph, string flow)
+{
+	map<rule_key_t, classified_rule_t>::iterator rule = rules.find(make_pair(graph,flow));
+	if(rule == rules.end())
+		return;
+
+	map<unsigned int, port_index_t>::iterator port = index.find(rule->second.port);
+	if(port != index.end())
+	{
+		uint32_t address;
+		uint8_t length;
+
+		//Remove the rule, and the empty levels of the index
+		uint32_t vlan = vlanKey(rule->second);
+		rule->second.match.getIpv4DstPrefix(address,length);
+		eraseKey(port->second.ipv4Dst[vlan],make_pair(address,length),rule->first);
+		if(port->second.ipv4Dst[vlan].empty())
+			port->second.ipv4Dst.erase(vlan);
+
+		rule->second.match.getIpv4SrcPrefix(address,length);
+		eraseKey(port->second.ipv4Src,make_pair(address,length),rule->first);
+
+		for(unsigned int f = 0; f < lowlevel::EXACT_FIELDS; f++)
+			eraseKey(port->second.fields[f],valueKey(rule->second,(lowlevel::exact_field_t)f),rule->first);
+
+		//Each rule of the port is in the source prefix index
+		if(port->second.ipv4Src.empty())
+			index.erase(port);
+	}
+
+	rules.erase(rule);
+}
+
+void ClassifierIndex::removeGraph(string graph)
+{
+	//The rules of a graph are contiguous in the map
+	map<rule_key_t, classified_rule_t>::iterator rule = rules.lower_bound(make_pair(graph,string("")));
+	while(rule != rules.end() && rule->first.first == graph)
+	{
+		string flow = rule->first.second;
+		rule++;
+		removeRule(graph,flow);
+	}
+}
+
+bool ClassifierIndex::findPrefixes(prefix_index_t &prefixes, uint32_t address, uint8_t length, set<rule_key_t> &candidates, size_t limit)
+{
+	//Prefixes containing the given one
+	for(uint8_t l = 0; l <= length; l++)
+	{
+		prefix_index_t::iterator p = prefixes.find(make_pair(address & prefixMask(l),l));
+		if(p != prefixes.end())
+		{
+			candidates.insert(p->second.begin(),p->second.end());
+			if(candidates.size() >= limit)
+				return false;
+		}
+	}
+
+	//Prefixes contained in the given one, i.e., longer prefixes whose address is
+	//in the interval [address, last]
+	uint32_t last = address | ~prefixMask(length);
+	for(prefix_index_t::iterator p = prefixes.lower_bound(make_pair(address,length + 1)); p != prefixes.end() && p->first.first <= last; p++)
+	{
+		if(p->first.second > length)
+		{
+			candidates.insert(p->second.begin(),p->second.end());
+			if(candidates.size() >= limit)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+void ClassifierIndex::findCandidates(port_index_t &port, classified_rule_t &rule, set<rule_key_t> &candidates)
+{
+	size_t best = (size_t)-1;
+
+	//Fields with a single value: the rules with the same value, or not expressed
+	//on the field. Only the sizes are needed to choose the best field
+	int bestField = -1;
+	uint64_t bestValue = 0;
+	for(unsigned int f = 0; f < lowlevel::EXACT_FIELDS; f++)
+	{
+		uint64_t value = valueKey(rule,(lowlevel::exact_field_t)f);
+		if(value == CLASSIFIER_ANY_VALUE)
+			continue;
+
+		size_t size = 0;
+		value_index_t::iterator v = port.fields[f].find(value);
+		if(v != port.fields[f].end())
+			size += v->second.size();
+		v = port.fields[f].find(CLASSIFIER_ANY_VALUE);
+		if(v != port.fields[f].end())
+			size += v->second.size();
+
+		if(size < best)
+		{
+			best = size;
+			bestField = f;
+			bestValue = value;
+		}
+	}
+
+	uint32_t address;
+	uint8_t length;
+
+	//VLAN and destination prefix. The lookup stops as soon as it cannot select
+	//fewer rules than the best field found so far
+	set<rule_key_t> dst;
+	bool found = true;
+	uint32_t vlan = vlanKey(rule);
+	rule.match.getIpv4DstPrefix(address,length);
+	for(map<uint32_t, prefix_index_t>::iterator v = port.ipv4Dst.begin(); v != port.ipv4Dst.end() && found; v++)
+	{
+		//A rule on a VLAN can only overlap rules on the same VLAN, or on any VLAN
+		if(vlan != CLASSIFIER_ANY_VLAN && v->first != vlan && v->first != CLASSIFIER_ANY_VLAN)
+			continue;
+		found = findPrefixes(v->second,address,length,dst,best);
+	}
+	if(found)
+	{
+		best = dst.size();
+		bestField = -1;
+		candidates.swap(dst);
+	}
+
+	//Source prefix
+	set<rule_key_t> src;
+	rule.match.getIpv4SrcPrefix(address,length);
+	if(findPrefixes(port.ipv4Src,address,length,src,best))
+	{
+		bestField = -1;
+		candidates.swap(src);
+	}
+
+	if(bestField >= 0)
+	{
+		candidates.clear();
+		value_index_t::iterator v = port.fields[bestField].find(bestValue);
+		if(v != port.fields[bestField].end())
+			candidates.insert(v->second.begin(),v->second.end());
+		v = port.fields[bestField].find(CLASSIFIER_ANY_VALUE);
+		if(v != port.fields[bestField].end())
+			candidates.insert(v->second.begin(),v->second.end());
+	}
+}
+
+bool ClassifierIndex::findConflict(list<classified_rule_t> rules, classified_rule_t &rule, classified_rule_t &existing)
+{
+	unsigned int compared = 0;
+
+	for(list<classified_rule_t>::iterator r = rules.begin(); r != rules.end(); r++)
+	{
+		map<unsigned int, port_index_t>::iterator port = index.find(r->port);
+		if(port == index.end())
+			continue;
+
+		set<rule_key_t> candidates;
+		findCandidates(port->second,*r,candidates);
+
+		for(set<rule_key_t>::iterator c = candidates.begin(); c != candidates.end(); c++)
+		{
+			if(c->first == r->graph)
+				continue;
+
+			compared++;
+			classified_rule_t &candidate = this->rules[*c];
+			if(r->match.overlaps(candidate.match))
+			{
+				logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "Flow \"%s\" of graph \"%s\" overlaps flow \"%s\" of graph \"%s\" on port \"%s\"",r->flow.c_str(),r->graph.c_str(),candidate.flow.c_str(),candidate.graph.c_str(),r->portName.c_str());
+				rule = *r;
+				existing = candidate;
+				return true;
+			}
+		}
+	}
+
+	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "No conflict on the shared ports of the LSI-0 (%d rules checked, %d comparisons with the %d rules in the index)",rules.size(),compared,this->rules.size());
+
+	return false;
+}
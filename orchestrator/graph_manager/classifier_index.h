@@ -0,0 +1,164 @@
+#ifndef CLASSIFIER_INDEX_H_
+#define CLASSIFIER_INDEX_H_ 1
+
+#pragma once
+
+#include <map>
+#include <set>
+#include <list>
+#include <string>
+#include <inttypes.h>
+
+#include "../graph/low_level_graph/low_level_match.h"
+#include "../utils/logger.h"
+#include "../utils/constants.h"
+
+using namespace std;
+
+/**
+*	@brief: VLAN key of the rules that are not expressed on a VLAN ID
+*/
+#define CLASSIFIER_ANY_VLAN		0x10000
+
+/**
+*	@brief: key of the rules that are not expressed on a single value of a field
+*		(the values of the fields are at most 48 bits long)
+*/
+#define CLASSIFIER_ANY_VALUE	0x1000000000000ULL
+
+/**
+*	@brief: a rule of a graph matching traffic received by the LSI-0 from a port
+*		shared among the graphs (a physical port, or an endpoint defined by another
+*		graph)
+*/
+typedef struct
+{
+	string graph;
+	string flow;
+
+	/**
+	*	@brief: name of the port (or endpoint) and its ID in the LSI-0
+	*/
+	string portName;
+	unsigned int port;
+
+	/**
+	*	@brief: match of the rule in the LSI-0 (the input port is the port above)
+	*/
+	lowlevel::Match match;
+	uint64_t priority;
+}classified_rule_t;
+
+/**
+*	@brief: index of the rules matching traffic on the shared ports of the LSI-0,
+*		used to detect conflicts among graphs when a graph is deployed or updated.
+*
+*		Two graphs conflict if some packets received from the same port can be
+*		matched by a rule of each graph. At the same priority, the LSI-0 picks one
+*		of the two rules arbitrarily; otherwise, the rule with the higher priority
+*		(or in the table processed first, see LSI0Pipeline) steals the packets of
+*		the other graph. In both the cases the forwarding of a tenant silently
+*		depends on the other one, so any overlap is a conflict.
+*
+*		The rules are indexed by input port and, within each port, on several
+*		fields at the same time, so that tenants separated by any of them do not
+*		need to be compared with each other:
+*		-	VLAN ID (CLASSIFIER_ANY_VLAN if not matched) and destination IPv4 prefix;
+*		-	source IPv4 prefix;
+*		-	the fields with a single value listed in lowlevel::exact_field_t (MAC
+*			addresses, ethertype, IP protocol, TCP and UDP ports), with the rules
+*			that do not match a field under CLASSIFIER_ANY_VALUE.
+*		The prefixes are ordered by address, so that the prefixes containing (the
+*		ancestors in the trie) and contained (an address interval) in a given
+*		prefix are found with a logarithmic number of lookups. A rule can only
+*		overlap the rules with the same value of a field, or not expressed on that
+*		field; for each new rule, the field selecting the fewest rules is used, and
+*		only these rules are compared field by field with Match::overlaps.
+*/
+class ClassifierIndex
+{
+private:
+	typedef pair<string, string> rule_key_t;
+	typedef pair<uint32_t, uint8_t> prefix_t;
+	typedef map<prefix_t, set<rule_key_t> > prefix_index_t;
+	typedef map<uint64_t, set<rule_key_t> > value_index_t;
+
+	/**
+	*	@brief: the keys of the rules matching traffic from a port
+	*/
+	typedef struct
+	{
+		/**
+		*	@brief: indexed by VLAN and destination prefix
+		*/
+		map<uint32_t, prefix_index_t> ipv4Dst;
+
+		/**
+		*	@brief: indexed by source prefix (each rule is here exactly once)
+		*/
+		prefix_index_t ipv4Src;
+
+		/**
+		*	@brief: indexed by the value of each field
+		*/
+		value_index_t fields[lowlevel::EXACT_FIELDS];
+	}port_index_t;
+
+	/**
+	*	@brief: the rules, indexed by <graph, flow>
+	*/
+	map<rule_key_t, classified_rule_t> rules;
+
+	/**
+	*	@brief: the keys of the rules, indexed by input port
+	*/
+	map<unsigned int, port_index_t> index;
+
+	static uint32_t vlanKey(const classified_rule_t &rule);
+
+	static uint64_t valueKey(const classified_rule_t &rule, lowlevel::exact_field_t field);
+
+	/**
+	*	@brief: add to candidates the rules in a prefix index whose prefix
+	*		contains, or is contained in, a given prefix. Returns false as soon
+	*		as the candidates are limit or more
+	*/
+	static bool findPrefixes(prefix_index_t &prefixes, uint32_t address, uint8_t length, set<rule_key_t> &candidates, size_t limit);
+
+	/**
+	*	@brief: return the rules of a port that can overlap a rule, selected
+	*		through the field of the index selecting the fewest of them
+	*/
+	static void findCandidates(port_index_t &port, classified_rule_t &rule, set<rule_key_t> &candidates);
+
+public:
+	/**
+	*	@brief: insert the rules of a graph in the index
+	*/
+	void addRules(list<classified_rule_t> rules);
+
+	/**
+	*	@brief: remove a rule of a graph from the index (nothing happens if the
+	*		rule does not match a shared port)
+	*/
+	void removeRule(string graph, string flow);
+
+	/**
+	*	@brief: remove all the rules of a graph from the index
+	*/
+	void removeGraph(string graph);
+
+	/**
+	*	@brief: look for a rule, of another graph, conflicting with one of the rules
+	*		provided
+	*
+	*	@param: rules		Rules of a graph to be deployed
+	*	@param: rule		Rule (among the ones provided) in conflict
+	*	@param: existing	Rule of another graph in conflict with the previous one
+	*
+	*	@return: true if a conflict has been found
+	*/
+	bool findConflict(list<classified_rule_t> rules, classified_rule_t &rule, classified_rule_t &existing);
+};
+
+#endif //CLASSIFIER_INDEX_H_
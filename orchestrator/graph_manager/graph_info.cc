@@ -1,7 +1,7 @@
 #include "graph_info.h"
 
 GraphInfo::GraphInfo() :
-	controller(NULL), lsi(NULL), nfsManager(NULL)//, graph(NULL)
+	controller(NULL), lsi(NULL), nfsManager(NULL), resourceTracker(NULL), meterID(0)//, graph(NULL)
 {
 
 }
@@ -30,6 +30,16 @@ void GraphInfo::setGraph(highlevel::Graph *graph)
 	this->graph = graph;
 }
 
+void GraphInfo::setResourceTracker(ResourceTracker *resourceTracker)
+{
+	this->resourceTracker = resourceTracker;
+}
+
+void GraphInfo::setMeterID(uint32_t meterID)
+{
+	this->meterID = meterID;
+}
+
 Controller *GraphInfo::getController()
 {
 	return controller;
@@ -50,3 +60,12 @@ NFsManager *GraphInfo::getNFsManager()
 	return nfsManager;
 }
 
+ResourceTracker *GraphInfo::getResourceTracker()
+{
+	return resourceTracker;
+}
+
+uint32_t GraphInfo::getMeterID()
+{
+	return meterID;
+}
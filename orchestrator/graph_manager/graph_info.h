@@ -7,6 +7,7 @@
 #include "../xdpd_manager/lsi.h"
 #include "../nfs_manager/nfs_manager.h"
 #include "../graph/high_level_graph/high_level_graph.h"
+#include "resource_tracker.h"
 
 class Controller;
 
@@ -17,6 +18,12 @@ private:
 	LSI *lsi;
 	NFsManager *nfsManager;
 	highlevel::Graph *graph;
+	ResourceTracker *resourceTracker;
+	
+	/**
+	*	@brief: meter of the LSI-0 limiting the rate of the graph (0 if none)
+	*/
+	uint32_t meterID;
 
 	//FIXME: PUT the following methods protected, and the GraphCreator as a friend?
 public:
@@ -27,11 +34,15 @@ public:
 	void setLSI(LSI *lsi);
 	void setNFsManager(NFsManager *nfsManager);
 	void setGraph(highlevel::Graph *graph);
+	void setResourceTracker(ResourceTracker *resourceTracker);
+	void setMeterID(uint32_t meterID);
 	
 	NFsManager *getNFsManager();
 	LSI *getLSI();
 	Controller *getController();
 	highlevel::Graph *getGraph();
+	ResourceTracker *getResourceTracker();
+	uint32_t getMeterID();
 };
 
 #endif //GRAPH_INFO_H_
@@ -1,27 +1,33 @@
 #include "graph_manager.h"
 
-pthread_mutex_t GraphManager::graph_manager_mutex;
-uint32_t GraphManager::nextControllerPort = FIRTS_OF_CONTROLLER_PORT;
+pthread_mutex_t GraphManager::graph_manager_mutex = PTHREAD_MUTEX_INITIALIZER;
+IDAllocator GraphManager::controllerPorts("controller port",FIRTS_OF_CONTROLLER_PORT,NUMBER_OF_CONTROLLER_PORTS,CONTROLLER_PORT_REUSE_DELAY);
+IDAllocator GraphManager::meterIDs("meter",FIRST_METER_ID,NUMBER_OF_METERS);
 
 void GraphManager::mutexInit()
 {
 	pthread_mutex_init(&graph_manager_mutex, NULL);
 }
 
-GraphManager::GraphManager(int core_mask, bool wireless, char *wirelessName) :
-	xDPDManager(string(XDPD_PORT))
+void GraphManager::mutexLock()
+{
+	pthread_mutex_lock(&graph_manager_mutex);
+}
+
+void GraphManager::mutexUnlock()
+{
+	pthread_mutex_unlock(&graph_manager_mutex);
+}
+
+GraphManager::GraphManager(int core_mask, bool wireless, char *wirelessName, unsigned int lsiPoolSize, bool autoscaling) :
+	xDPDManager(string(XDPD_PORT)), lsiPool(lsiPoolSize), autoscaler(autoscaling)
 {
 	//TODO: we may have two implementations: one with the LSI-0, the other that uses the queues of the NIC
 
 	//Create the openflow controller for the LSI-0
 
-	pthread_mutex_lock(&graph_manager_mutex);
-	uint32_t controllerPort = nextControllerPort;
-	nextControllerPort++;
-	pthread_mutex_unlock(&graph_manager_mutex);
-	
 	ostringstream strControllerPort;
-	strControllerPort << controllerPort;
+	strControllerPort << allocateControllerPort();
 
 	//Create the LSI-0 with all the phy ports managed by xDPD
 	map<string,string> phyPorts;
@@ -91,6 +97,7 @@ GraphManager::GraphManager(int core_mask, bool wireless, char *wirelessName) :
 
 	rofl::openflow::cofhello_elem_versionbitmap versionbitmap;
 	versionbitmap.add_ofp_version(rofl::openflow12::OFP_VERSION);
+	versionbitmap.add_ofp_version(rofl::openflow13::OFP_VERSION);
 	
 	Controller *controller = new Controller(versionbitmap,graph,strControllerPort.str());
 	controller->start();
@@ -99,26 +106,74 @@ GraphManager::GraphManager(int core_mask, bool wireless, char *wirelessName) :
 	
 	logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "LSI-0 and its controller are created");
 
-	NFsManager::setCoreMask(core_mask);
+	list<string> phyPortNames;
+	for(map<string,string>::iterator p = phyPorts.begin(); p != phyPorts.end(); p++)
+		phyPortNames.push_back(p->first);
+	NFsManager::setCoreMask(core_mask,phyPortNames);
+
+	logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "Probing the execution environments of the NFs...");
+	Capabilities::start();
+	
+	ArtifactCache::init();
+	
+	if(lsiPool.isEnabled())
+	{
+		logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "Filling the pool with %d tenant-LSIs...",lsiPoolSize);
+		refillLSIPool();
+	}
+	
+	if(autoscaler.isEnabled())
+	{
+		logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "Starting the autoscaler of the DPDK NFs...");
+		if(pthread_create(&autoscalerThreadID, NULL, &autoscalerThread, (void *)this) != 0)
+		{
+			logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "An error occurred while creating the thread of the autoscaler");
+			throw GraphManagerException();
+		}
+	}
 }
 
 GraphManager::~GraphManager()
 {	
-	//Deleting tenants LSIs
-	for(map<string,GraphInfo>::iterator lsi = tenantLSIs.begin(); lsi != tenantLSIs.end();)
-	{	
-		logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "Deleting the graph'%s'...",lsi->first.c_str());
-		map<string,GraphInfo>::iterator tmp = lsi;
-		lsi++;
+	//Stopping the autoscaler, which could otherwise change the graphs being deleted
+	if(autoscaler.isEnabled())
+	{
+		autoscaler.terminate();
+		pthread_join(autoscalerThreadID, NULL);
+	}
+	
+	//Deleting the LSIs of the pool
+	list<PooledLSI> pooled = lsiPool.drain();
+	for(list<PooledLSI>::iterator p = pooled.begin(); p != pooled.end(); p++)
+	{
+		logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "Deleting an unused LSI of the pool...");
 		try
 		{
-			deleteGraph(tmp->first, true);
-		}catch(...)
+			xDPDManager.destroyLsi(*(p->lsi));
+		} catch (XDPDManagerException e)
 		{
-			assert(0);
-			/*nothing to do, since the node orchestrator is terminating*/
+			logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "%s",e.what());
+			//we don't throw any exception here, since the graph manager is terminating
 		}
+		delete(p->lsi);
+		destroyController(p->controller);
 	}
+	if(lsiPool.isEnabled())
+		lsiPool.printStatistics();
+
+	//Deleting tenants LSIs
+	struct timeval shutdownStart;
+	gettimeofday(&shutdownStart,NULL);
+	unsigned int numberOfGraphs = tenantLSIs.size();
+	
+	deleteAllGraphs();
+	
+	Capabilities::stop();
+	
+	struct timeval shutdownEnd;
+	gettimeofday(&shutdownEnd,NULL);
+	uint64_t elapsed = (shutdownEnd.tv_sec - shutdownStart.tv_sec) * 1000000ULL + shutdownEnd.tv_usec - shutdownStart.tv_usec;
+	logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "%d graphs deleted in %llu ms",numberOfGraphs,(unsigned long long)(elapsed/1000));
 	
 	//Deleting LSI-0
 	logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "Deleting the graph for the LSI-0...");
@@ -135,7 +190,7 @@ GraphManager::~GraphManager()
 	}
 	
 	Controller *controller = graphInfoLSI0.getController();
-	delete(controller);
+	destroyController(controller);
 	controller = NULL;
 }
 
@@ -196,6 +251,20 @@ Object GraphManager::toJSON(string graphID)
 	return flow_graph;
 }
 
+Object GraphManager::statsToJSON(string graphID)
+{
+	if(tenantLSIs.count(graphID) == 0)
+	{
+		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "The graph \"%s\" does not exist",graphID.c_str());
+		assert(0);
+		throw GraphManagerException();
+	}
+	NFsManager *nfsManager = (tenantLSIs.find(graphID))->second.getNFsManager();
+	assert(nfsManager != NULL);
+	
+	return nfsManager->statsToJSON();
+}
+
 Object GraphManager::toJSONPhysicalInterfaces()
 {
 	Object interfaces;
@@ -210,6 +279,9 @@ Object GraphManager::toJSONPhysicalInterfaces()
 		Object iface;
 		iface["name"] = t->first;
 		iface["type"] = t->second;
+		int node = CoreAllocator::interfaceNode(t->first);
+		if(node >= 0)
+			iface["numa-node"] = node;
 		interfaces_array.push_back(iface);	
 	}
 	
@@ -226,6 +298,105 @@ Object GraphManager::toJSONPhysicalInterfaces()
 	return interfaces;
 }
 
+Object GraphManager::lsiToJSON(string name, LSI *lsi, map<string,unsigned int> ports, Controller *controller)
+{
+	Object jsonLSI, jsonPorts;
+	
+	jsonLSI[PORT_NAME] = name;
+	jsonLSI[LSI_DPID] = lsi->getDpid();
+	
+	for(map<string,unsigned int>::iterator p = ports.begin(); p != ports.end(); p++)
+		jsonPorts[p->first] = (uint64_t)p->second;
+	jsonLSI[LSI_PORTS] = jsonPorts;
+	
+	Array entries;
+	list<lowlevel::Rule> rules = controller->getEntries();
+	for(list<lowlevel::Rule>::iterator r = rules.begin(); r != rules.end(); r++)
+		entries.push_back(r->toJSON());
+	jsonLSI[FLOW_ENTRIES] = entries;
+	
+	list<lowlevel::Group> groups = controller->getGroups();
+	if(!groups.empty())
+	{
+		Array jsonGroups;
+		for(list<lowlevel::Group>::iterator g = groups.begin(); g != groups.end(); g++)
+			jsonGroups.push_back(g->toJSON());
+		jsonLSI[GROUPS] = jsonGroups;
+	}
+	
+	return jsonLSI;
+}
+
+Object GraphManager::toJSONTables()
+{
+	Array lsis, vlinks;
+	
+	LSI *lsi0 = graphInfoLSI0.getLSI();
+	map<string,unsigned int> ports = lsi0->getEthPorts();
+	if(lsi0->hasWireless())
+		ports.insert(lsi0->getWirelessPort());
+	lsis.push_back(lsiToJSON(LSI0_NAME,lsi0,ports,graphInfoLSI0.getController()));
+	
+	for(map<string,GraphInfo>::iterator t = tenantLSIs.begin(); t != tenantLSIs.end(); t++)
+	{
+		LSI *lsi = t->second.getLSI();
+		
+		//The ports of the tenant-LSI are the ports of its NFs, and the virtual links
+		ports.clear();
+		set<string> nfs = lsi->getNetworkFunctionsName();
+		for(set<string>::iterator nf = nfs.begin(); nf != nfs.end(); nf++)
+		{
+			map<string,unsigned int> nfPorts = lsi->getNetworkFunctionsPorts(*nf);
+			ports.insert(nfPorts.begin(),nfPorts.end());
+		}
+		lsis.push_back(lsiToJSON(t->first,lsi,ports,t->second.getController()));
+		
+		vector<VLink> links = lsi->getVirtualLinks();
+		for(vector<VLink>::iterator v = links.begin(); v != links.end(); v++)
+		{
+			assert(v->getRemoteDpid() == dpid0);
+		
+			Object vlink;
+			vlink[LSI_NAME] = t->first;
+			vlink[PORT] = (uint64_t)v->getLocalID();
+			vlink[REMOTE_LSI] = LSI0_NAME;
+			vlink[REMOTE_PORT] = (uint64_t)v->getRemoteID();
+			vlinks.push_back(vlink);
+		}
+	}
+	
+	Object tables;
+	tables[LSIS] = lsis;
+	tables[VIRTUAL_LINKS] = vlinks;
+	
+	return tables;
+}
+
+Object GraphManager::toJSONCores()
+{
+	return CoreAllocator::toJSON();
+}
+
+Object GraphManager::toJSONCache()
+{
+	return ArtifactCache::toJSON();
+}
+
+nf_manager_ret_t GraphManager::prefetchNF(string nf_name, Object &json)
+{
+	NFsManager nfsManager;
+	Array artifacts;
+	
+	nf_manager_ret_t retVal = nfsManager.prefetchNF(nf_name,artifacts);
+	if(retVal == NFManager_OK)
+	{
+		json[_ID] = nf_name;
+		json["artifacts"] = artifacts;
+	}
+	
+	return retVal;
+}
+
 bool GraphManager::deleteGraph(string graphID, bool shutdown)
 {
 	if(tenantLSIs.count(graphID) == 0)
@@ -247,8 +418,8 @@ bool GraphManager::deleteGraph(string graphID, bool shutdown)
 	
 	logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "Deleting graph '%s'...",graphID.c_str());
 
-	LSI *tenantLSI = (tenantLSIs.find(graphID))->second.getLSI();
-	highlevel::Graph *highLevelGraph = (tenantLSIs.find(graphID))->second.getGraph();
+	GraphInfo graphInfo = (tenantLSIs.find(graphID))->second;
+	highlevel::Graph *highLevelGraph = graphInfo.getGraph();
 
 	/**
 	*		0) check if the graph can be removed
@@ -270,22 +441,70 @@ bool GraphManager::deleteGraph(string graphID, bool shutdown)
 	}
 	
 	/**
-	*		1) remove the rules from the LSI-0
+	*		1), 2), 3)
 	*/
-	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "1) Remove the rules from the LSI-0");
+	if(!teardownGraph(graphInfo,getLSI0Rules(graphInfo)))
+		throw GraphManagerException();
+	
+	/**
+	*		4) delete the endpoints defined by the graph
+	*/
+	releaseGraph(graphInfo,shutdown);
+	
+	return true;
+}
+
+list<lowlevel::Rule> GraphManager::getLSI0Rules(GraphInfo &graphInfo, bool updateDispatching)
+{
+	uint8_t table = lsi0Pipeline.getTable(graphInfo.getGraph()->getID());
+	lowlevel::Graph graphLSI0 = GraphTranslator::lowerGraphToLSI0(graphInfo.getGraph(),graphInfo.getLSI(),graphInfoLSI0.getLSI(), table, graphInfo.getMeterID(), endPointsDefinedInMatches, endPointsDefinedInActions, availableEndPoints, false);
+	list<lowlevel::Rule> rules = graphLSI0.getRules();
+	
+	lsi0Pipeline.removeRules(rules);
+	if(updateDispatching)
+		updateLSI0Dispatching();
+	
+	return rules;
+}
+
+void GraphManager::installLSI0Rules(list<lowlevel::Rule> rules)
+{
+	(graphInfoLSI0.getController())->installNewRules(rules);
 	
-	lowlevel::Graph graphLSI0 = GraphTranslator::lowerGraphToLSI0(highLevelGraph,tenantLSI,graphInfoLSI0.getLSI(), endPointsDefinedInMatches, endPointsDefinedInActions, availableEndPoints, false);	
+	lsi0Pipeline.addRules(rules);
+	updateLSI0Dispatching();
+}
+
+void GraphManager::updateLSI0Dispatching()
+{
+	list<lowlevel::Rule> toBeInstalled, toBeRemoved;
+	lsi0Pipeline.dispatchingChanges(toBeInstalled,toBeRemoved);
 	
-	//Remove rules from the LSI-0
-	graphInfoLSI0.getController()->removeRules(graphLSI0.getRules());
+	Controller *lsi0Controller = graphInfoLSI0.getController();
+	if(!toBeInstalled.empty())
+		lsi0Controller->replaceRules(toBeInstalled);
+	if(!toBeRemoved.empty())
+		lsi0Controller->removeRules(toBeRemoved);
+}
+
+bool GraphManager::teardownGraph(GraphInfo graphInfo, list<lowlevel::Rule> lsi0Rules)
+{
+	LSI *tenantLSI = graphInfo.getLSI();
+
+	/**
+	*		1) remove the rules from the LSI-0
+	*/
+	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "1) Remove the rules from the LSI-0");
+	graphInfoLSI0.getController()->removeRules(lsi0Rules);
+	if(graphInfo.getMeterID() != 0)
+		destroyMeter(graphInfo.getMeterID());
 	
 	/**
 	*		2) stop the NFs
 	*/
-	NFsManager *nfsManager = (tenantLSIs.find(graphID))->second.getNFsManager();
 #ifdef RUN_NFS
 	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "2) Stop the NFs");
-	nfsManager->stopAll();
+	graphInfo.getNFsManager()->stopAll();
 #else
 	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "2) Flag RUN_NFS disabled. No NF to be stopped");
 #endif
@@ -302,14 +521,33 @@ bool GraphManager::deleteGraph(string graphID, bool shutdown)
 	} catch (XDPDManagerException e)
 	{
 		logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "%s",e.what());
-		throw GraphManagerException();
+		return false;
 	}
 
 	detachWirelessPort(tenantLSI);
 	
-	/**
-	*		4) delete the endpoints defined by the graph
-	*/
+	destroyController(graphInfo.getController());
+	
+	return true;
+}
+
+void *GraphManager::teardownGraphThread(void *param)
+{
+	to_teardown_thread_t *args = (to_teardown_thread_t*)param;
+	
+	if(!args->graphManager->teardownGraph(args->graphInfo,args->lsi0Rules))
+		return (void*) 0;
+	else
+		return (void*) 1;
+}
+
+void GraphManager::releaseGraph(GraphInfo graphInfo, bool shutdown)
+{
+	highlevel::Graph *highLevelGraph = graphInfo.getGraph();
+	LSI *tenantLSI = graphInfo.getLSI();
+	NFsManager *nfsManager = graphInfo.getNFsManager();
+	ResourceTracker *resourceTracker = graphInfo.getResourceTracker();
+
 	if(!shutdown)
 	{
 		set<string> endpoints = highLevelGraph->getEndPoints();
@@ -337,16 +575,101 @@ bool GraphManager::deleteGraph(string graphID, bool shutdown)
 	}
 	
 	tenantLSIs.erase(tenantLSIs.find(highLevelGraph->getID()));
+	lsi0Pipeline.releaseTable(highLevelGraph->getID());
+	classifierIndex.removeGraph(highLevelGraph->getID());
+	autoscaler.forgetGraph(highLevelGraph->getID());
 
 	delete(highLevelGraph);
 	delete(tenantLSI);
 	delete(nfsManager);
+	delete(resourceTracker);
 
 	highLevelGraph = NULL;
 	tenantLSI = NULL;
 	nfsManager = NULL;
+	resourceTracker = NULL;
+}
+
+void GraphManager::deleteAllGraphs()
+{
+	while(!tenantLSIs.empty())
+	{
+		//Count, for each endpoint, the graphs (still existing) using it without defining it
+		map<string, unsigned int> users;
+		for(map<string,GraphInfo>::iterator g = tenantLSIs.begin(); g != tenantLSIs.end(); g++)
+		{
+			highlevel::Graph *graph = g->second.getGraph();
+			set<string> endpoints = graph->getEndPoints();
+			for(set<string>::iterator ep = endpoints.begin(); ep != endpoints.end(); ep++)
+			{
+				if(!graph->isDefinedHere(*ep))
+					users[*ep]++;
+			}
+		}
 	
-	return true;
+		//The graphs not defining endpoints used by other graphs can be deleted in parallel
+		list<string> wave;
+		for(map<string,GraphInfo>::iterator g = tenantLSIs.begin(); g != tenantLSIs.end(); g++)
+		{
+			highlevel::Graph *graph = g->second.getGraph();
+			set<string> endpoints = graph->getEndPoints();
+			set<string>::iterator ep = endpoints.begin();
+			for(; ep != endpoints.end(); ep++)
+			{
+				if(graph->isDefinedHere(*ep) && users.count(*ep) != 0)
+					break;
+			}
+			if(ep == endpoints.end())
+				wave.push_back(g->first);
+		}
+		
+		if(wave.empty())
+		{
+			//This should never happen, since the dependencies between graphs cannot be circular
+			logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "Circular dependency between the remaining graphs. Deleting all of them");
+			for(map<string,GraphInfo>::iterator g = tenantLSIs.begin(); g != tenantLSIs.end(); g++)
+				wave.push_back(g->first);
+		}
+		
+		logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "Deleting %d graphs in parallel...",wave.size());
+		
+		pthread_t some_thread[wave.size()];
+		bool started[wave.size()];
+		to_teardown_thread_t thr[wave.size()];
+		int i = 0;
+		
+		//The translation reads the endpoints shared among the graphs, and the dispatching
+		//rules of the LSI-0 are shared among the graphs as well; hence, both are done for
+		//the whole wave before any teardown thread starts changing the LSI-0
+		for(list<string>::iterator g = wave.begin(); g != wave.end(); g++, i++)
+		{
+			thr[i].graphManager = this;
+			thr[i].graphInfo = tenantLSIs.find(*g)->second;
+			thr[i].lsi0Rules = getLSI0Rules(thr[i].graphInfo,false);
+		}
+		updateLSI0Dispatching();
+		
+		i = 0;
+		for(list<string>::iterator g = wave.begin(); g != wave.end(); g++, i++)
+		{
+			logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "Deleting the graph'%s'...",g->c_str());
+			
+			started[i] = (pthread_create(&some_thread[i], NULL, &teardownGraphThread, (void *)&thr[i]) == 0);
+			if(!started[i])
+			{
+				logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "An error occurred while creating a new thread. The graph is deleted sequentially");
+				teardownGraph(thr[i].graphInfo,thr[i].lsi0Rules);
+			}
+		}
+		
+		for(int j = 0; j < i; j++)
+		{
+			if(started[j])
+				pthread_join(some_thread[j], NULL);
+			/*errors are ignored, since the node orchestrator is terminating*/
+			releaseGraph(thr[j].graphInfo,true);
+		}
+	}
 }
 
 bool GraphManager::deleteFlow(string graphID, string flowID)
@@ -393,18 +716,23 @@ bool GraphManager::deleteFlow(string graphID, string flowID)
 	stringstream lsi0FlowID;
 	lsi0FlowID << graph->getID() << "_" << flowID;
 	lsi0Controller->removeRuleFromID(lsi0FlowID.str());
+	lsi0Pipeline.removeRuleFromID(lsi0FlowID.str());
+	updateLSI0Dispatching();
+	classifierIndex.removeRule(graphID,flowID);
 	
 	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Removing the flow from the tenant-LSI graph");
 	Controller *tenantController = graphInfo.getController();
 	tenantController->removeRuleFromID(flowID);
 	
 	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Removing the flow from the high level graph");
+	ResourceTracker *resourceTracker = graphInfo.getResourceTracker();
+	list<VLinkEvent> events = resourceTracker->removeRule(graph->getRuleFromID(flowID));
 	RuleRemovedInfo rri = graph->removeRuleFromID(flowID);
 	
 	NFsManager *nfs_manager = graphInfo.getNFsManager();
 	LSI *lsi = graphInfo.getLSI();
 	
-	removeUselessPorts_NFs_Endpoints_VirtualLinks(rri,nfs_manager,graph,lsi);
+	removeUselessPorts_NFs_Endpoints_VirtualLinks(rri,events,nfs_manager,graph,lsi,tenantController);
 	
 	if(endpointInvolved != "")
 	{
@@ -489,6 +817,20 @@ bool GraphManager::checkGraphValidity(highlevel::Graph *graph, NFsManager *nfsMa
 
 	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "The command requires to retrieve %d new NFs",network_functions.size());
 
+	//The names of the replicas must not be used by other NFs of the graph
+	map<string, unsigned int> replicas = graph->getNetworkFunctionsReplicas();
+	for(map<string, unsigned int>::iterator nf = replicas.begin(); nf != replicas.end(); nf++)
+	{
+		for(unsigned int r = 1; r < nf->second; r++)
+		{
+			if(network_functions.count(NFsManager::replicaName(nf->first,r)) != 0)
+			{
+				logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "The replica \"%s\" of NF \"%s\" has the same name of another NF",NFsManager::replicaName(nf->first,r).c_str(),nf->first.c_str());
+				return false;
+			}
+		}
+	}
+
 	list<string> requiredNFs;
 	for(map<string,list<unsigned int> >::iterator nf = network_functions.begin(); nf != network_functions.end(); nf++)
 	{
@@ -508,6 +850,38 @@ bool GraphManager::checkGraphValidity(highlevel::Graph *graph, NFsManager *nfsMa
 	return true;
 }
 
+list<classified_rule_t> GraphManager::checkGraphConflicts(highlevel::Graph *graph)
+{
+	list<classified_rule_t> rules = GraphTranslator::rulesOnSharedPorts(graph,graphInfoLSI0.getLSI(),endPointsDefinedInActions);
+	
+	classified_rule_t rule, existing;
+	if(!classifierIndex.findConflict(rules,rule,existing))
+		return rules;
+	
+	Object newFlow, existingFlow, newMatch, existingMatch;
+	rule.match.toJSON(newMatch);
+	existing.match.toJSON(existingMatch);
+	
+	newFlow[_ID] = rule.flow;
+	newFlow[PRIORITY] = rule.priority;
+	newFlow[MATCH] = newMatch;
+	
+	existingFlow["graph"] = existing.graph;
+	existingFlow[_ID] = existing.flow;
+	existingFlow[PRIORITY] = existing.priority;
+	existingFlow[MATCH] = existingMatch;
+	
+	Object conflict;
+	conflict[PORT] = rule.portName;
+	conflict["flow"] = newFlow;
+	conflict["conflicting-flow"] = existingFlow;
+	
+	Object json;
+	json["conflict"] = conflict;
+	
+	throw GraphConflictException(json);
+}
+
 void *startNF(void *arguments)
 {
     to_thread_t *args = (to_thread_t *)arguments;
@@ -551,26 +925,79 @@ bool GraphManager::newGraph(highlevel::Graph *graph)
 		nfsManager = NULL;
 		return false;
 	}
+	
+	list<classified_rule_t> sharedRules;
+	try
+	{
+		sharedRules = checkGraphConflicts(graph);
+	} catch (GraphConflictException e)
+	{
+		delete(nfsManager);
+		nfsManager = NULL;
+		throw;
+	}
+	
+	if(graph->hasRateLimit() && !graphInfoLSI0.getController()->supportsMeters())
+	{
+		//Accepting the graph would deploy it without any rate limit
+		logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "The rate of the graph cannot be limited: the LSI-0 does not support Openflow 1.3");
+		delete(nfsManager);
+		nfsManager = NULL;
+		return false;
+	}
+	
+	if(graph->hasRateLimit() && !meterIDs.isAvailable())
+	{
+		//This is an internal error
+		logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "The rate of the graph cannot be limited: all the %d meters of the LSI-0 are used or in quarantine",NUMBER_OF_METERS);
+		delete(nfsManager);
+		nfsManager = NULL;
+		throw GraphManagerException();
+	}
 
 	/**
 	*	1) Create the Openflow controller for the tenant LSI
 	*/
 	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "1) Create the Openflow controller for the tenant LSI");
 	
-	pthread_mutex_lock(&graph_manager_mutex);
-	uint32_t controllerPort = nextControllerPort;
-	nextControllerPort++;
-	pthread_mutex_unlock(&graph_manager_mutex);
-
+	struct timeval claimStart;
+	gettimeofday(&claimStart,NULL);
+	
+	//If available, take an LSI (and its controller) from the pool
+	PooledLSI pooled;
+	bool fromPool = lsiPool.claim(pooled);
+	if(lsiPool.isEnabled())
+		refillLSIPool();
+	
 	ostringstream strControllerPort;
-	strControllerPort << controllerPort;
+	Controller *controller = NULL;
+	
+	if(fromPool)
+	{
+		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Using the LSI %x taken from the pool, with its controller",pooled.lsi->getDpid());
+		strControllerPort << pooled.lsi->getControllerPort();
+		controller = pooled.controller;
+	}
+	else
+	{
+		try
+		{
+			strControllerPort << allocateControllerPort();
+		} catch (GraphManagerException e)
+		{
+			delete(nfsManager);
+			nfsManager = NULL;
+			throw;
+		}
 
-	rofl::openflow::cofhello_elem_versionbitmap versionbitmap;
-	versionbitmap.add_ofp_version(rofl::openflow12::OFP_VERSION);
+		rofl::openflow::cofhello_elem_versionbitmap versionbitmap;
+		versionbitmap.add_ofp_version(rofl::openflow12::OFP_VERSION);
+		versionbitmap.add_ofp_version(rofl::openflow13::OFP_VERSION);
 
-	lowlevel::Graph graphTmp ;
-	Controller *controller = new Controller(versionbitmap,graphTmp,strControllerPort.str());
-	controller->start();
+		lowlevel::Graph graphTmp ;
+		controller = new Controller(versionbitmap,graphTmp,strControllerPort.str());
+		controller->start();
+	}
 	
 	/**
 	*	2) Select an implementation for each network function of the graph
@@ -579,8 +1006,13 @@ bool GraphManager::newGraph(highlevel::Graph *graph)
 	if(!nfsManager->selectImplementation())
 	{
 		//This is an internal error
+		if(fromPool)
+		{
+			xDPDManager.destroyLsi(*(pooled.lsi));
+			delete(pooled.lsi);
+		}
 		delete(nfsManager);
-		delete(controller);
+		destroyController(controller);
 		nfsManager = NULL;
 		controller = NULL;
 		throw GraphManagerException();
@@ -594,11 +1026,24 @@ bool GraphManager::newGraph(highlevel::Graph *graph)
 	set<string> phyPorts = graph->getPorts();
 	map<string, list<unsigned int> > network_functions = graph->getNetworkFunctions();
 	
-	vector<set<string> > vlVector = identifyVirtualLinksRequired(graph);
-	set<string> vlNFs = vlVector[0];
-	set<string> vlPhyPorts = vlVector[1];
-	set<string> vlEndPoints = vlVector[2];
-	set<string> NFsFromEndPoint = vlVector[3];
+	//The replicas of the NFs are attached to the LSI and started as any other NF
+	map<string, unsigned int> replicas = graph->getNetworkFunctionsReplicas();
+	for(map<string, unsigned int>::iterator nf = replicas.begin(); nf != replicas.end(); nf++)
+	{
+		for(unsigned int r = 1; r < nf->second; r++)
+		{
+			string replica = NFsManager::replicaName(nf->first,r);
+			nfsManager->addReplica(nf->first,replica);
+			network_functions[replica] = network_functions[nf->first];
+		}
+	}
+	
+	ResourceTracker *resourceTracker = new ResourceTracker();
+	set<string> vlNFs;
+	set<string> vlPhyPorts;
+	set<string> vlEndPoints;
+	map<string,string> NFsFromEndPoint;
+	identifyVirtualLinksRequired(graph,resourceTracker,vlNFs,vlPhyPorts,vlEndPoints,NFsFromEndPoint);
 	
 	/**
 	*	A virtual link can be used in two direction, hence it can be shared between a NF port and a physical port.
@@ -610,39 +1055,71 @@ bool GraphManager::newGraph(highlevel::Graph *graph)
 	
 	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "%d virtual links are required to connect the new LSI with LSI-0",numberOfVLrequired);
 	
-	vector<VLink> virtual_links;
-	for(unsigned int i = 0; i < numberOfVLrequired; i++)
-		virtual_links.push_back(VLink(dpid0));
-		
-	//The tenant-LSI is not connected to physical ports, but just the LSI-0
-	//through virtual links, and to network functions through virtual ports
-	map<string,string> dummyPhyPorts;
-	
-	map<string,nf_t>  nf_types;
-	for(map<string, list<unsigned int> >::iterator nf = network_functions.begin(); nf != network_functions.end(); nf++)
-		nf_types[nf->first] = nfsManager->getNFType(nf->first);
-	
-	//Prepare the structure representing the new tenant-LSI
-	LSI *lsi = new LSI(string(OF_CONTROLLER_ADDRESS), strControllerPort.str(), dummyPhyPorts, network_functions,virtual_links,nf_types);
+	LSI *lsi = NULL;
+	//The LSI taken from the pool already exists in xDPd
+	bool lsiCreated = fromPool;
 	
 	try
 	{
-		xDPDManager.createLsi(*lsi);
+		if(fromPool)
+		{
+			lsi = pooled.lsi;
+			customizePooledLSI(lsi,numberOfVLrequired,network_functions,nfsManager);
+		}
+		else
+		{
+			vector<VLink> virtual_links;
+			for(unsigned int i = 0; i < numberOfVLrequired; i++)
+				virtual_links.push_back(VLink(dpid0));
+			
+			//The tenant-LSI is not connected to physical ports, but just the LSI-0
+			//through virtual links, and to network functions through virtual ports
+			map<string,string> dummyPhyPorts;
+	
+			map<string,nf_t>  nf_types;
+			for(map<string, list<unsigned int> >::iterator nf = network_functions.begin(); nf != network_functions.end(); nf++)
+				nf_types[nf->first] = nfsManager->getNFType(nf->first);
+	
+			//Prepare the structure representing the new tenant-LSI
+			lsi = new LSI(string(OF_CONTROLLER_ADDRESS), strControllerPort.str(), dummyPhyPorts, network_functions,virtual_links,nf_types);
+	
+			xDPDManager.createLsi(*lsi);
+			lsiCreated = true;
+		}
 	} catch (XDPDManagerException e)
 	{
 		logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "%s",e.what());
-		xDPDManager.destroyLsi(*lsi);
-		delete(graph);
-		delete(lsi);
-		delete(nfsManager);
-		delete(controller);
-		graph = NULL;
-		lsi = NULL;
+		if(lsiCreated)
+		{
+			try
+			{
+				xDPDManager.destroyLsi(*lsi);
+			} catch (XDPDManagerException e)
+			{
+				logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "%s",e.what());
+			}
+		}
+		delete(graph);
+		delete(lsi);
+		delete(nfsManager);
+		destroyController(controller);
+		delete(resourceTracker);
+		graph = NULL;
+		lsi = NULL;
 		nfsManager = NULL;
 		controller = NULL;
+		resourceTracker = NULL;
 		throw GraphManagerException();
 	}
 	
+	if(lsiPool.isEnabled())
+	{
+		struct timeval claimEnd;
+		gettimeofday(&claimEnd,NULL);
+		uint64_t usec = (claimEnd.tv_sec - claimStart.tv_sec) * 1000000 + (claimEnd.tv_usec - claimStart.tv_usec);
+		lsiPool.recordClaim(fromPool,usec);
+	}
+	
 	uint64_t dpid = lsi->getDpid();
 	
 	map<string,unsigned int> lsi_ports = lsi->getEthPorts();
@@ -682,7 +1159,7 @@ bool GraphManager::newGraph(highlevel::Graph *graph)
 		{
 			//since this rule has a graph endpoint in the match that is defined in this
 			//graph, we save the port of the vlink of the NF in LSI-0, so that other graphs can use this endpoint
-			string ep = findEndPointTowardsNF(graph,*nf);
+			string ep = NFsFromEndPoint[*nf];
 			logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "The endpoint \"%s\" is defined in a match of the current Graph. Other graphs can use it expressing an action on the port %d of the LSI-0",ep.c_str(),vl1->getRemoteID());
 			endPointsDefinedInMatches[ep] = vl1->getRemoteID();
 			
@@ -751,8 +1228,9 @@ bool GraphManager::newGraph(highlevel::Graph *graph)
 		
 		thr[i].nf_name = nf->first;
 		thr[i].number_of_ports = nf->second.size();
-		thr[i].ipv4PortsRequirements = graph->getNetworkFunctionIPv4PortsRequirements(nf->first);
-		thr[i].ethPortsRequirements = graph->getNetworkFunctionEthernetPortsRequirements(nf->first);
+		//The replicas have the same requirements of their NF
+		thr[i].ipv4PortsRequirements = graph->getNetworkFunctionIPv4PortsRequirements(nfsManager->replicatedNF(nf->first));
+		thr[i].ethPortsRequirements = graph->getNetworkFunctionEthernetPortsRequirements(nfsManager->replicatedNF(nf->first));
 		thr[i].nfsManager = nfsManager;
 		
 		if (pthread_create(&some_thread[i], NULL, &startNF, (void *)&thr[i]) != 0)
@@ -785,12 +1263,14 @@ bool GraphManager::newGraph(highlevel::Graph *graph)
 		delete(graph);
 		delete(lsi);
 		delete(nfsManager);
-		delete(controller);
+		destroyController(controller);
+		delete(resourceTracker);
 		
 		graph = NULL;;
 		lsi = NULL;
 		nfsManager = NULL;
 		controller = NULL;
+		resourceTracker = NULL;
 		
 		throw GraphManagerException();
 	}
@@ -803,18 +1283,29 @@ bool GraphManager::newGraph(highlevel::Graph *graph)
 	*	5) Create the rules and download them in LSI-0 and tenant-LSI
 	*/
 	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "5) Create the rules and download them in LSI-0 and tenant-LSI");
+	uint32_t meterID = 0;
 	try
 	{
+		//the meter limiting the rate of the graph must exist before the rules using it
+		if(graph->hasRateLimit())
+			meterID = createMeter(graph->getRateLimit());
+	
 		//creates the rules for LSI-0 and for the tenant-LSI
 		
-		lowlevel::Graph graphLSI0 = GraphTranslator::lowerGraphToLSI0(graph,lsi,graphInfoLSI0.getLSI(), endPointsDefinedInMatches, endPointsDefinedInActions, availableEndPoints);
+		uint8_t table = lsi0Pipeline.assignTable(graph->getID());
+		lowlevel::Graph graphLSI0 = GraphTranslator::lowerGraphToLSI0(graph,lsi,graphInfoLSI0.getLSI(), table, meterID, endPointsDefinedInMatches, endPointsDefinedInActions, availableEndPoints);
 		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "New graph for LSI-0:");
 		graphLSI0.print();
 				
-		lowlevel::Graph graphTenant =  GraphTranslator::lowerGraphToTenantLSI(graph,lsi,graphInfoLSI0.getLSI());
+		lowlevel::Graph graphTenant =  GraphTranslator::lowerGraphToTenantLSI(graph,lsi,graphInfoLSI0.getLSI(),replicas);
 		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Graph for tenant LSI:");
 		graphTenant.print();	
 		
+		//the groups balancing the traffic among the replicas must exist before the rules using them
+		list<lowlevel::Group> groups = GraphTranslator::tenantGroups(graph,lsi,replicas);
+		for(list<lowlevel::Group>::iterator g = groups.begin(); g != groups.end(); g++)
+			controller->installGroup(*g);
+		
 		controller->installNewRules(graphTenant.getRules());
 
 		GraphInfo graphInfoTenantLSI;
@@ -822,18 +1313,23 @@ bool GraphManager::newGraph(highlevel::Graph *graph)
 		graphInfoTenantLSI.setNFsManager(nfsManager);
 		graphInfoTenantLSI.setLSI(lsi);
 		graphInfoTenantLSI.setController(controller);
+		graphInfoTenantLSI.setResourceTracker(resourceTracker);
+		graphInfoTenantLSI.setMeterID(meterID);
 
 		//Save the graph information
 		tenantLSIs[graph->getID()] = graphInfoTenantLSI;
 
 		//Insert new rules into the LSI-0
 		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Adding the new rules to the LSI-0");
-		(graphInfoLSI0.getController())->installNewRules(graphLSI0.getRules());
+		installLSI0Rules(graphLSI0.getRules());
+		classifierIndex.addRules(sharedRules);
 	
 		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Tenant LSI and its controller are created");
 		
-	} catch (XDPDManagerException e)
+	} catch (exception &e)
 	{
+		//Either xDPd failed (XDPDManagerException), or no meter is available
+		//(IDAllocatorException): in both cases, the graph is rolled back
 #ifdef RUN_NFS
 		for(map<string, list<unsigned int> >::iterator nf = network_functions.begin(); nf != network_functions.end(); nf++)
 			nfsManager->stopNF(nf->first);
@@ -843,16 +1339,21 @@ bool GraphManager::newGraph(highlevel::Graph *graph)
 	
 		if(tenantLSIs.count(graph->getID()) != 0)
 			tenantLSIs.erase(tenantLSIs.find(graph->getID()));
+		lsi0Pipeline.releaseTable(graph->getID());
+		if(meterID != 0)
+			destroyMeter(meterID);
 	
 		delete(graph);
 		delete(lsi);
 		delete(nfsManager);
-		delete(controller);
+		destroyController(controller);
+		delete(resourceTracker);
 
 		graph = NULL;
 		lsi = NULL;
 		nfsManager = NULL;
 		controller = NULL;
+		resourceTracker = NULL;
 
 		logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "%s",e.what());
 		throw GraphManagerException();
@@ -876,13 +1377,15 @@ bool GraphManager::updateGraph(string graphID, highlevel::Graph *newPiece)
 	highlevel::Graph *graph = graphInfo.getGraph();
 	LSI *lsi = graphInfo.getLSI();
 	Controller *tenantController = graphInfo.getController();
+	ResourceTracker *resourceTracker = graphInfo.getResourceTracker();
 	
 	uint64_t dpid = lsi->getDpid();
 
 	/**
 	*	Outline:
 	*	
-	*	0) check the validity of the new piece of the graph
+	*	0) check the validity of the new piece of the graph, and change the number of
+	*		replicas of the NFs already in the graph
 	*	1) update the high level graph
 	*	2) select an implementation for the new NFs
 	*	3) update the lsi (in case of new ports/NFs/endpoints are required)
@@ -910,6 +1413,8 @@ bool GraphManager::updateGraph(string graphID, highlevel::Graph *newPiece)
 			list<unsigned int> ports = it->second;
 			for(list<unsigned int>::iterator p = ports.begin(); p != ports.end(); p++)
 				tmp->updateNetworkFunction(it->first,*p);
+			if(newPiece->getNetworkFunctionReplicas(it->first) > 1)
+				tmp->setNetworkFunctionReplicas(it->first,newPiece->getNetworkFunctionReplicas(it->first));
 		}
 		else
 		{
@@ -967,6 +1472,32 @@ bool GraphManager::updateGraph(string graphID, highlevel::Graph *newPiece)
 	}
 
 	//tmp contains only the new NFs, the new ports and the new endpoints that are not already into the graph
+	
+	//The NFs already in the graph whose number of instances is changed by the update
+	map<string, unsigned int> scaledNFs;
+	map<string, unsigned int> new_replicas = newPiece->getNetworkFunctionsReplicas();
+	for(map<string, unsigned int>::iterator it = new_replicas.begin(); it != new_replicas.end(); it++)
+	{
+		if(nfs.count(it->first) != 0 && graph->getNetworkFunctionReplicas(it->first) != it->second)
+			scaledNFs[it->first] = it->second;
+	}
+	
+	if(newPiece->hasRateLimit() && graphInfo.getMeterID() == 0)
+	{
+		//The rules already in the LSI-0 do not use a meter
+		logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "The rate of the graph can be limited only when the graph is created");
+		delete(tmp);
+		tmp = NULL;
+		return false;
+	}
+	
+	if(newPiece->hasRateLimit() && !graphInfoLSI0.getController()->supportsMeters())
+	{
+		logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "The rate of the graph cannot be changed: the LSI-0 does not support Openflow 1.3");
+		delete(tmp);
+		tmp = NULL;
+		return false;
+	}
 
 	if(!checkGraphValidity(tmp,nfsManager))
 	{
@@ -976,6 +1507,45 @@ bool GraphManager::updateGraph(string graphID, highlevel::Graph *newPiece)
 		return false;
 	}
 	
+	list<classified_rule_t> sharedRules;
+	try
+	{
+		sharedRules = checkGraphConflicts(newPiece);
+	} catch (GraphConflictException e)
+	{
+		delete(tmp);
+		tmp = NULL;
+		throw;
+	}
+	
+	list<highlevel::Rule> newRules = newPiece->getRules();
+	for(list<highlevel::Rule>::iterator rule = newRules.begin(); rule != newRules.end(); rule++)
+	{
+		if(graph->ruleExists(rule->getFlowID()))
+		{
+			logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "The graph has at least two rules with the same ID: %s",rule->getFlowID().c_str());
+			delete(tmp);
+			tmp = NULL;
+			return false;
+		}
+	}
+	
+	//Change the number of instances of the NFs already in the graph, if required. This is
+	//done before changing anything else, so that the graph is untouched if it fails
+	map<string, unsigned int> replicasBefore;
+	for(map<string, unsigned int>::iterator nf = scaledNFs.begin(); nf != scaledNFs.end(); nf++)
+	{
+		replicasBefore[nf->first] = graph->getNetworkFunctionReplicas(nf->first);
+		if(!scaleNF(graphID,nf->first,nf->second))
+		{
+			//The NFs already scaled get back their replicas
+			restoreReplicas(graphID,replicasBefore);
+			delete(tmp);
+			tmp = NULL;
+			return false;
+		}
+	}
+	
 	//The update is valid
 	
 	/**
@@ -983,12 +1553,16 @@ bool GraphManager::updateGraph(string graphID, highlevel::Graph *newPiece)
 	*/
 	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "1) Update the high level graph");
 	
-	list<highlevel::Rule> newRules = newPiece->getRules();
 	for(list<highlevel::Rule>::iterator rule = newRules.begin(); rule != newRules.end(); rule++)
 	{
 		if(!graph->addRule(*rule))
 		{
 			logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "The graph has at least two rules with the same ID: %s",rule->getFlowID().c_str());
+			for(list<highlevel::Rule>::iterator added = newRules.begin(); added != rule; added++)
+				graph->removeRuleFromID(added->getFlowID());
+			restoreReplicas(graphID,replicasBefore);
+			delete(tmp);
+			tmp = NULL;
 			return false;
 		}
 	}
@@ -1004,6 +1578,8 @@ bool GraphManager::updateGraph(string graphID, highlevel::Graph *newPiece)
 		{
 			graph->updateNetworkFunction(nf->first,*p);
 		}
+		if(tmp->getNetworkFunctionReplicas(nf->first) > 1)
+			graph->setNetworkFunctionReplicas(nf->first,tmp->getNetworkFunctionReplicas(nf->first));
 	}
 	set<string> nep = tmp->getEndPoints();
 	for(set<string>::iterator ep = nep.begin(); ep != nep.end(); ep++)
@@ -1013,6 +1589,8 @@ bool GraphManager::updateGraph(string graphID, highlevel::Graph *newPiece)
 		//The endpoint is not part of the graph
 		graph->addEndPoint(tmp_graph_id,*ep);
 	}
+	if(newPiece->hasRateLimit())
+		graph->setRateLimit(newPiece->getRateLimit());
 	
 	graph->print();
 	
@@ -1022,9 +1600,13 @@ bool GraphManager::updateGraph(string graphID, highlevel::Graph *newPiece)
 	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "2) Select an implementation for the new NFs");	
 	if(!nfsManager->selectImplementation())
 	{
-		//This is an internal error
-		delete(nfsManager);
-		nfsManager = NULL;
+		//This is an internal error. The NFs manager is the one of the graph,
+		//hence it is not destroyed
+		for(list<highlevel::Rule>::iterator rule = newRules.begin(); rule != newRules.end(); rule++)
+			graph->removeRuleFromID(rule->getFlowID());
+		restoreReplicas(graphID,replicasBefore);
+		delete(tmp);
+		tmp = NULL;
 		throw GraphManagerException();
 	}
 	
@@ -1036,13 +1618,28 @@ bool GraphManager::updateGraph(string graphID, highlevel::Graph *newPiece)
 	set<string> phyPorts = tmp->getPorts();
 	map<string, list<unsigned int> > network_functions = tmp->getNetworkFunctions();
 	
+	//The replicas of the new NFs are attached to the LSI and started as any other NF
+	map<string, unsigned int> replicas = tmp->getNetworkFunctionsReplicas();
+	for(map<string, unsigned int>::iterator nf = replicas.begin(); nf != replicas.end(); nf++)
+	{
+		for(unsigned int r = 1; r < nf->second; r++)
+		{
+			string replica = NFsManager::replicaName(nf->first,r);
+			nfsManager->addReplica(nf->first,replica);
+			network_functions[replica] = network_functions[nf->first];
+		}
+	}
+	
 	//Since the NFs cannot specify new ports, new virtual links can be required only by the new NFs and the physical ports
 	
-	vector<set<string> > vlVector = identifyVirtualLinksRequired(newPiece,lsi);
-	set<string> vlNFs = vlVector[0];
-	set<string> vlPhyPorts = vlVector[1];
-	set<string> vlEndPoints = vlVector[2];
-	set<string> NFsFromEndPoint = vlVector[3];
+	set<string> vlNFs;
+	set<string> vlPhyPorts;
+	set<string> vlEndPoints;
+	map<string,string> NFsFromEndPoint;
+	
+	//The rules are accounted in the resource tracker only once their virtual links exist
+	ResourceTracker updatedTracker = *resourceTracker;
+	identifyVirtualLinksRequired(newPiece,&updatedTracker,vlNFs,vlPhyPorts,vlEndPoints,NFsFromEndPoint);
 
 	//TODO: check if a virtual link is already available and can be used (because it is currentl used only in one direction)	
 	int numberOfVLrequiredBeforeEndPoints = (vlNFs.size() > vlPhyPorts.size())? vlNFs.size() : vlPhyPorts.size();
@@ -1050,14 +1647,18 @@ bool GraphManager::updateGraph(string graphID, highlevel::Graph *newPiece)
 	
 	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "%d virtual links are required to connect the new part of the LSI with LSI-0",numberOfVLrequired);
 
+	//The virtual links created so far, removed if the others cannot be created
+	list<uint64_t> newVLinks;
+	set<string>::iterator nf = vlNFs.begin();
+	set<string>::iterator p = vlPhyPorts.begin();
+	set<string>::iterator ep = vlEndPoints.begin();
 	try
 	{
-		set<string>::iterator nf = vlNFs.begin();
-		set<string>::iterator p = vlPhyPorts.begin();
 		for(; nf != vlNFs.end() || p != vlPhyPorts.end() ;)
 		{
 		
 			uint64_t vlinkID = xDPDManager.addVirtualLink(*lsi,VLink(dpid0));
+			newVLinks.push_back(vlinkID);
 			
 			VLink vlink = lsi->getVirtualLink(vlinkID);
 			logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Virtual link: (ID: %x) %x:%d -> %x:%d",vlink.getID(),dpid,vlink.getLocalID(),vlink.getRemoteDpid(),vlink.getRemoteID());
@@ -1076,9 +1677,10 @@ bool GraphManager::updateGraph(string graphID, highlevel::Graph *newPiece)
 			}
 		}
 	
-		for(set<string>::iterator ep = vlEndPoints.begin(); ep != vlEndPoints.end(); ep++)
+		for(; ep != vlEndPoints.end(); ep++)
 		{
 			uint64_t vlinkID = xDPDManager.addVirtualLink(*lsi,VLink(dpid0));
+			newVLinks.push_back(vlinkID);
 	
 			VLink vlink = lsi->getVirtualLink(vlinkID);
 			logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Virtual link: (ID: %x) %x:%d -> %x:%d",vlink.getID(),dpid,vlink.getLocalID(),vlink.getRemoteDpid(),vlink.getRemoteID());
@@ -1104,24 +1706,57 @@ bool GraphManager::updateGraph(string graphID, highlevel::Graph *newPiece)
 	}catch(XDPDManagerException e)
 	{
 		logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "%s",e.what());
+		
+		//The resources that got a virtual link are those before the ones reached by the loops
+		for(set<string>::iterator n = vlNFs.begin(); n != nf; n++)
+			lsi->removeNFvlink(*n);
+		for(set<string>::iterator pp = vlPhyPorts.begin(); pp != p; pp++)
+			lsi->removePortvlink(*pp);
+		for(set<string>::iterator e = vlEndPoints.begin(); e != ep; e++)
+		{
+			lsi->removeEndPointvlink(*e);
+			if(graph->isDefinedHere(*e))
+			{
+				endPointsDefinedInActions.erase(*e);
+				availableEndPoints.erase(*e);
+			}
+		}
+		for(list<uint64_t>::iterator vl = newVLinks.begin(); vl != newVLinks.end(); vl++)
+		{
+			try
+			{
+				xDPDManager.destroyVirtualLink(*lsi,*vl);
+			} catch (XDPDManagerException e)
+			{
+				logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "%s",e.what());
+			}
+		}
+		
+		//The new rules are not accounted in the resource tracker, hence they cannot stay in the graph
+		for(list<highlevel::Rule>::iterator rule = newRules.begin(); rule != newRules.end(); rule++)
+			graph->removeRuleFromID(rule->getFlowID());
+		restoreReplicas(graphID,replicasBefore);
+		
 		delete(tmp);
 		tmp = NULL;	
 		throw GraphManagerException();
 	}
 	
-	for(set<string>::iterator nf = NFsFromEndPoint.begin(); nf != NFsFromEndPoint.end(); nf++)
+	*resourceTracker = updatedTracker;
+	
+	for(map<string,string>::iterator nf = NFsFromEndPoint.begin(); nf != NFsFromEndPoint.end(); nf++)
 	{
 		//XXX: this works because I'm assuming that a graph cannot use twice the same endpoint in matches, if this
 		//endpoint is defined by the graph itself.
 	
 		//since this rule has a graph endpoint in the match that is defined in this
 		//graph, we save the port of the vlink of the NF in LSI-0, so that other graphs can use this endpoint
-		string ep = findEndPointTowardsNF(newPiece,*nf);
+		string ep = nf->second;
 		
 		map<string, uint64_t> nfs_vlinks = lsi->getNFsVlinks();
-		assert(nfs_vlinks.count(*nf) != 0);
+		assert(nfs_vlinks.count(nf->first) != 0);
 		
-		VLink vlink = lsi->getVirtualLink(nfs_vlinks.find(*nf)->second);
+		VLink vlink = lsi->getVirtualLink(nfs_vlinks.find(nf->first)->second);
 		
 		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "The endpoint \"%s\" is defined in a match of the current Graph. Other graphs can use it expressing an action on the port %d of the LSI-0",ep.c_str(),vlink.getRemoteID());
 		endPointsDefinedInMatches[ep] = vlink.getRemoteID();
@@ -1155,7 +1790,8 @@ bool GraphManager::updateGraph(string graphID, highlevel::Graph *newPiece)
 	
 	for(map<string, list<unsigned int> >::iterator nf = network_functions.begin(); nf != network_functions.end(); nf++)
 	{
-		if(!nfsManager->startNF(nf->first, nf->second.size(),newPiece->getNetworkFunctionIPv4PortsRequirements(nf->first),newPiece->getNetworkFunctionEthernetPortsRequirements(nf->first)))
+		string nf_name = nfsManager->replicatedNF(nf->first);
+		if(!nfsManager->startNF(nf->first, nf->second.size(),newPiece->getNetworkFunctionIPv4PortsRequirements(nf_name),newPiece->getNetworkFunctionEthernetPortsRequirements(nf_name)))
 		{
 			//TODO: no idea on what I have to do at this point
 			assert(0);
@@ -1175,19 +1811,32 @@ bool GraphManager::updateGraph(string graphID, highlevel::Graph *newPiece)
 
 	try
 	{
+		//changes the rate limit of the graph, if required
+		if(newPiece->hasRateLimit())
+		{
+			highlevel::rate_limit_t rateLimit = newPiece->getRateLimit();
+			graphInfoLSI0.getController()->installMeter(lowlevel::Meter(graphInfo.getMeterID(),rateLimit.rate,rateLimit.pps,rateLimit.burst));
+		}
+	
 		//creates the new rules for LSI-0 and for the tenant-LSI
 		
-		lowlevel::Graph graphLSI0 = GraphTranslator::lowerGraphToLSI0(newPiece,lsi,graphInfoLSI0.getLSI(), endPointsDefinedInMatches, endPointsDefinedInActions, availableEndPoints);
+		lowlevel::Graph graphLSI0 = GraphTranslator::lowerGraphToLSI0(newPiece,lsi,graphInfoLSI0.getLSI(), lsi0Pipeline.getTable(graphID), graphInfo.getMeterID(), endPointsDefinedInMatches, endPointsDefinedInActions, availableEndPoints);
 		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "New piece of graph for LSI-0:");
 		graphLSI0.print();
 				
-		lowlevel::Graph graphTenant =  GraphTranslator::lowerGraphToTenantLSI(newPiece,lsi,graphInfoLSI0.getLSI());
+		lowlevel::Graph graphTenant =  GraphTranslator::lowerGraphToTenantLSI(newPiece,lsi,graphInfoLSI0.getLSI(),graph->getNetworkFunctionsReplicas());
 		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "New piece of graph for tenant LSI:");
 		graphTenant.print();	
+		
+		//the groups of the new NFs with replicas (the other groups do not change)
+		list<lowlevel::Group> groups = GraphTranslator::tenantGroups(graph,lsi,graph->getNetworkFunctionsReplicas());
+		for(list<lowlevel::Group>::iterator g = groups.begin(); g != groups.end(); g++)
+			tenantController->installGroup(*g);
 
 		//Insert new rules into the LSI-0
 		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Adding the new rules to the LSI-0");
-		(graphInfoLSI0.getController())->installNewRules(graphLSI0.getRules());
+		installLSI0Rules(graphLSI0.getRules());
+		classifierIndex.addRules(sharedRules);
 	
 		//Insert new rules into the tenant-LSI
 		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Adding the new rules to the tenant-LSI");
@@ -1209,345 +1858,159 @@ bool GraphManager::updateGraph(string graphID, highlevel::Graph *newPiece)
 	
 	delete(tmp);
 	tmp = NULL;
+	
 	return true;
 }
 
-vector<set<string> > GraphManager::identifyVirtualLinksRequired(highlevel::Graph *graph)
+void GraphManager::identifyVirtualLinksRequired(highlevel::Graph *graph, ResourceTracker *tracker, set<string> &vlNFs, set<string> &vlPhyPorts, set<string> &vlEndPoints, map<string,string> &NFsFromEndPoint)
 {
-	set<string> NFs;
-	set<string> phyPorts;
-	set<string> endPoints;
-	
-	set<string> NFsFromEndPoint;
-	
 	list<highlevel::Rule> rules = graph->getRules();
 	for(list<highlevel::Rule>::iterator rule = rules.begin(); rule != rules.end(); rule++)
 	{
-		highlevel::Action *action = rule->getAction();
-		highlevel::Match match = rule->getMatch();
-		if(action->getType() == highlevel::ACTION_ON_NETWORK_FUNCTION)
-		{
-			if(match.matchOnPort() || match.matchOnEndPoint())
-			{
-				highlevel::ActionNetworkFunction *action_nf = (highlevel::ActionNetworkFunction*)action;
-				stringstream ss;
-				ss << action->getInfo() << "_" << action_nf->getPort();
-				NFs.insert(ss.str());
-				
-				if(match.matchOnEndPoint())
-				{
-					stringstream ssm;
-					ssm << match.getGraphID() << ":" << match.getEndPoint();
-					if(graph->isDefinedHere(ssm.str()))
-						NFsFromEndPoint.insert(ss.str());
-				}
-			}
-		}
-		else if(action->getType() == highlevel::ACTION_ON_PORT)
+		list<VLinkEvent> events = tracker->addRule(*rule);
+		for(list<VLinkEvent>::iterator e = events.begin(); e != events.end(); e++)
 		{
-			if(match.matchOnNF())
-				phyPorts.insert(action->getInfo());
-		}
-		else if(action->getType() == highlevel::ACTION_ON_ENDPOINT)
-		{
-			assert(match.matchOnNF());
-			highlevel::ActionEndPoint *action_ep = (highlevel::ActionEndPoint*)action;
-			//stringstream ss;
-			//ss << action_ep->getInfo() << ":" << action_ep->getPort();			
-			//endPoints.insert(ss.str());
-			endPoints.insert(action_ep->toString());
+			assert(e->type == VLINK_NEEDED);
+			if(e->resource == VLINK_FOR_NF_PORT)
+				vlNFs.insert(e->name);
+			else if(e->resource == VLINK_FOR_PORT)
+				vlPhyPorts.insert(e->name);
+			else
+				vlEndPoints.insert(e->name);
 		}
-	}
-	
-	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Network functions input ports requiring a virtual link:");
-	for(set<string>::iterator nf = NFs.begin(); nf != NFs.end(); nf++)
-		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "\t%s",(*nf).c_str());
-	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Physical ports requiring a virtual link:");
-	for(set<string>::iterator p = phyPorts.begin(); p != phyPorts.end(); p++)
-		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "\t%s",(*p).c_str());
-	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Endpoints requiring a virtual link:");
-	for(set<string>::iterator e = endPoints.begin(); e != endPoints.end(); e++)
-		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "\t%s",(*e).c_str());
-	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "NFs reached from an endpoint defined in this graph:");
-	for(set<string>::iterator nfe = NFsFromEndPoint.begin(); nfe != NFsFromEndPoint.end(); nfe++)
-		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "\t%s",(*nfe).c_str());	
-	
-	vector<set<string> > retval;
-	vector<set<string> >::iterator rv;
-	
-	rv = retval.end();
-	retval.insert(rv,NFs);
-	rv = retval.end();
-	retval.insert(rv,phyPorts);
-	rv = retval.end();
-	retval.insert(rv,endPoints);
-	rv = retval.end();
-	retval.insert(rv,NFsFromEndPoint);
-	
-	return retval;
-}
-
-vector<set<string> > GraphManager::identifyVirtualLinksRequired(highlevel::Graph *newPiece, LSI *lsi)
-{
-	set<string> NFs;
-	set<string> phyPorts;
-	set<string> endPoints;
-
-	set<string> NFsFromEndPoint;	
-
-	list<highlevel::Rule> rules = newPiece->getRules();
-	for(list<highlevel::Rule>::iterator rule = rules.begin(); rule != rules.end(); rule++)
-	{
+		
 		highlevel::Action *action = rule->getAction();
 		highlevel::Match match = rule->getMatch();
-		if(action->getType() == highlevel::ACTION_ON_NETWORK_FUNCTION)
+		if(action->getType() == highlevel::ACTION_ON_NETWORK_FUNCTION && match.matchOnEndPoint())
 		{
-			if(match.matchOnPort() || match.matchOnEndPoint())
+			stringstream ssm;
+			ssm << match.getGraphID() << ":" << match.getEndPoint();
+			if(graph->isDefinedHere(ssm.str()))
 			{
 				highlevel::ActionNetworkFunction *action_nf = (highlevel::ActionNetworkFunction*)action;
-
-				//Check if a vlink is required for this NF port
-				map<string, uint64_t> nfs_vlinks = lsi->getNFsVlinks();
 				stringstream ss;
 				ss << action->getInfo() << "_" << action_nf->getPort();
-				if(nfs_vlinks.count(ss.str()) == 0)
-					NFs.insert(ss.str());
-					
-				if(match.matchOnEndPoint())
-				{
-					stringstream ssm;
-					ssm << match.getGraphID() << ":" << match.getEndPoint();
-					if(newPiece->isDefinedHere(ssm.str()))
-						NFsFromEndPoint.insert(ss.str());
-				}
+				NFsFromEndPoint[ss.str()] = ssm.str();
 			}
 		}
-		else if(action->getType() == highlevel::ACTION_ON_PORT)
-		{
-			//check if a vlink is required for this physical port
-			map<string, uint64_t> ports_vlinks = lsi->getPortsVlinks();
-			highlevel::ActionPort *action_port = (highlevel::ActionPort*)action;
-			if(ports_vlinks.count(action_port->getInfo()) == 0)
-				phyPorts.insert(action_port->getInfo());
-		}
-		else if(action->getType() == highlevel::ACTION_ON_ENDPOINT)
-		{
-			assert(match.matchOnNF());
-			
-			//check if a vlink is required for this endpoint
-			map<string, uint64_t> endpoints_vlinks = lsi->getEndPointsVlinks();
-			highlevel::ActionEndPoint *action_ep = (highlevel::ActionEndPoint*)action;
-			if(endpoints_vlinks.count(action_ep->toString()) == 0)
-				endPoints.insert(action_ep->toString());
-		}
 	}
 	
 	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Network functions input ports requiring a virtual link:");
-	for(set<string>::iterator nf = NFs.begin(); nf != NFs.end(); nf++)
+	for(set<string>::iterator nf = vlNFs.begin(); nf != vlNFs.end(); nf++)
 		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "\t%s",(*nf).c_str());
 	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Physical ports requiring a virtual link:");
-	for(set<string>::iterator p = phyPorts.begin(); p != phyPorts.end(); p++)
+	for(set<string>::iterator p = vlPhyPorts.begin(); p != vlPhyPorts.end(); p++)
 		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "\t%s",(*p).c_str());
 	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Endpoints requiring a virtual link:");
-	for(set<string>::iterator e = endPoints.begin(); e != endPoints.end(); e++)
+	for(set<string>::iterator e = vlEndPoints.begin(); e != vlEndPoints.end(); e++)
 		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "\t%s",(*e).c_str());
 	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "NFs reached from an endpoint defined in this graph:");
-	for(set<string>::iterator nfe = NFsFromEndPoint.begin(); nfe != NFsFromEndPoint.end(); nfe++)
-		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "\t%s",(*nfe).c_str());	
-	
-	//prepare the return value
-	vector<set<string> > retval;
-	vector<set<string> >::iterator rv;
-	rv = retval.end();
-	retval.insert(rv,NFs);
-	rv = retval.end();
-	retval.insert(rv,phyPorts);
-	rv = retval.end();
-	retval.insert(rv,endPoints);
-	rv = retval.end();
-	retval.insert(rv,NFsFromEndPoint);
-	
-	return retval;
+	for(map<string,string>::iterator nfe = NFsFromEndPoint.begin(); nfe != NFsFromEndPoint.end(); nfe++)
+		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "\t%s (from %s)",nfe->first.c_str(),nfe->second.c_str());
 }
 
-void GraphManager::removeUselessPorts_NFs_Endpoints_VirtualLinks(RuleRemovedInfo rri, NFsManager *nfsManager,highlevel::Graph *graph, LSI * lsi)
+void GraphManager::removeUselessPorts_NFs_Endpoints_VirtualLinks(RuleRemovedInfo rri, list<VLinkEvent> events, NFsManager *nfsManager,highlevel::Graph *graph, LSI * lsi, Controller *controller)
 {
 	map<string, uint64_t> nfs_vlinks = lsi->getNFsVlinks();
 	map<string, uint64_t> ports_vlinks = lsi->getPortsVlinks();
 	map<string, uint64_t> endpoints_vlinks = lsi->getEndPointsVlinks();
 	
-	
-	list<highlevel::Rule> rules = graph->getRules();
-	
-	if(rri.isNFport)
-		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Check if the vlink associated with the NF port '%s' must be removed (if this vlink exists)",rri.nf_port.c_str());
-	
-	if(rri.isNFport && nfs_vlinks.count(rri.nf_port) != 0)
+	for(list<VLinkEvent>::iterator ev = events.begin(); ev != events.end(); ev++)
 	{
-		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "The NF port '%s' is associated with a vlink",rri.nf_port.c_str());
+		assert(ev->type == VLINK_NO_LONGER_NEEDED);
 		
-		/**
-		*	In case NF:port does not appear in other actions, the vlink must be removed
-		*/
-		bool equal = false;
-		for(list<highlevel::Rule>::iterator again = rules.begin(); again != rules.end(); again++)
-		{
+		uint64_t vlink;
 		
-			highlevel::Action *a = again->getAction();
-			if(a->getType() == highlevel::ACTION_ON_NETWORK_FUNCTION)
-			{
-				if(((highlevel::ActionNetworkFunction*)a)->getInfo() == rri.nf_port)
-				{
-					//The action is on the same NF:port of the removed one, hence
-					//the vlink must not be removed
-					equal = true;
-					break;
-				}
-			}
-			
-		}//end of again iterator on the rules of the graph		
-		if(!equal)
+		if(ev->resource == VLINK_FOR_NF_PORT)
 		{
+			if(nfs_vlinks.count(ev->name) == 0)
+				continue;
+			
 			//We just know that the vlink is no longer used for a NF. However, it might used in the opposite
 			//direction, for a port
-			logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Virtual link no longer required for NF port: %s",rri.nf_port.c_str());
-			uint64_t nfvlink = nfs_vlinks.find(rri.nf_port)->second;
-			
-			lsi->removeNFvlink(rri.nf_port);
+			logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Virtual link no longer required for NF port: %s",ev->name.c_str());
+			vlink = nfs_vlinks.find(ev->name)->second;
+			lsi->removeNFvlink(ev->name);
+			nfs_vlinks.erase(ev->name);
 			
+			bool stillUsed = false;
 			for(map<string, uint64_t>::iterator pvl = ports_vlinks.begin(); pvl != ports_vlinks.end(); pvl++)
 			{
-				if(pvl->second == nfvlink)
+				if(pvl->second == vlink)
 				{
 					logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "The virtual link cannot be removed because it is still used by the port: %s",pvl->first.c_str());
-					goto next;
-				}
-			}
-			
-			logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "The virtual link must be removed");
-			
-			try
-			{
-				xDPDManager.destroyVirtualLink(*lsi,nfvlink);
-			} catch (XDPDManagerException e)
-			{
-				logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "%s",e.what());
-				throw GraphManagerException();
-			}
-		}
-	}	
-
-next:	
-	
-	if(rri.isPort)
-		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Check of the vlink associated with the port '%s' must be removed (if this vlink exists)",rri.port.c_str());
-	
-	if(rri.isPort && ports_vlinks.count(rri.port) != 0)
-	{
-		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "The port '%s' is associated with a vlink",rri.port.c_str());
-		/**
-		*	In case port does not appear in other actions, the vlink must be removed
-		*/
-		bool equal = false;
-		for(list<highlevel::Rule>::iterator again = rules.begin(); again != rules.end(); again++)
-		{	
-			highlevel::Action *a = again->getAction();
-			if(a->getType() == highlevel::ACTION_ON_PORT)
-			{
-				if(((highlevel::ActionPort*)a)->getInfo() == rri.port)
-				{
-					//The action are the same, hence no vlink must be removed
-					equal = true;
+					stillUsed = true;
 					break;
 				}
 			}
-			
-		}//end of again iterator on the rules of the graph		
-		if(!equal)
+			if(stillUsed)
+				continue;
+		}
+		else if(ev->resource == VLINK_FOR_PORT)
 		{
+			if(ports_vlinks.count(ev->name) == 0)
+				continue;
+			
 			//We just know that the vlink is no longer used for a port. However, it might used in the opposite
 			//direction, for a NF port
-			logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Virtual link no longer required for port: %s",rri.port.c_str());
-			uint64_t portlink = ports_vlinks.find(rri.port)->second;
-			
-			lsi->removePortvlink(rri.port);
+			logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Virtual link no longer required for port: %s",ev->name.c_str());
+			vlink = ports_vlinks.find(ev->name)->second;
+			lsi->removePortvlink(ev->name);
+			ports_vlinks.erase(ev->name);
 			
+			bool stillUsed = false;
 			for(map<string, uint64_t>::iterator nfvl = nfs_vlinks.begin(); nfvl != nfs_vlinks.end(); nfvl++)
 			{
-				if(nfvl->second == portlink)
+				if(nfvl->second == vlink)
 				{
 					logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "The virtual link cannot be removed because it is still used by the NF port: %s",nfvl->first.c_str());
-					goto next2;
+					stillUsed = true;
+					break;
 				}
 			}
-			
-			logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "The virtual link must be removed");
-			try
-			{
-				xDPDManager.destroyVirtualLink(*lsi,portlink);
-			} catch (XDPDManagerException e)
-			{
-				logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "%s",e.what());
-				throw GraphManagerException();
-			}
+			if(stillUsed)
+				continue;
 		}
-	}
-	
-next2:
-
-	if(rri.isEndpoint)
-		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Check if the vlink associated with the endpoint '%s' must be removed (if this vlink exists)",rri.endpoint.c_str());
-	
-	if(rri.isEndpoint && endpoints_vlinks.count(rri.endpoint) != 0)
-	{
-		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "The endpoint '%s' is associated with a vlink",rri.endpoint.c_str());
-		
-		/**
-		*	In case the endpoint does not appear in other actions, the vlink must be removed
-		*/
-		bool equal = false;
-		for(list<highlevel::Rule>::iterator again = rules.begin(); again != rules.end(); again++)
+		else
 		{
+			if(endpoints_vlinks.count(ev->name) == 0)
+				continue;
+				
+			logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Virtual link no longer required for the endpoint: %s",ev->name.c_str());
+			vlink = endpoints_vlinks.find(ev->name)->second;
+			lsi->removeEndPointvlink(ev->name);
+			endpoints_vlinks.erase(ev->name);
+		}
 		
-			highlevel::Action *a = again->getAction();
-			if(a->getType() == highlevel::ACTION_ON_ENDPOINT)
-			{
-				if(((highlevel::ActionEndPoint*)a)->toString() == rri.endpoint)
-				{
-					//The action is on the same endpoint of the removed one, hence
-					//the vlink must not be removed
-					equal = true;
-					break;
-				}
-			}
-			
-		}//end of again iterator on the rules of the graph		
-		if(!equal)
+		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "The virtual link must be removed");
+		try
 		{
-			logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Virtual link no longer required for the endpoint: %s",rri.endpoint.c_str());
-			
-			uint64_t epvlink = endpoints_vlinks.find(rri.endpoint)->second;			
-			lsi->removeEndPointvlink(rri.endpoint);
-			
-			logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "The virtual link must be removed");
-			
-			try
-			{
-				xDPDManager.destroyVirtualLink(*lsi,epvlink);
-			} catch (XDPDManagerException e)
-			{
-				logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "%s",e.what());
-				throw GraphManagerException();
-			}
+			xDPDManager.destroyVirtualLink(*lsi,vlink);
+		} catch (XDPDManagerException e)
+		{
+			logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "%s",e.what());
+			throw GraphManagerException();
 		}
 	}
 
 	//Remove NFs, if they no longer appear in the graph
 	for(list<string>::iterator nf = rri.nfs.begin(); nf != rri.nfs.end(); nf++)
 	{
+		unsigned int replicas = graph->getNetworkFunctionReplicas(*nf);
 		if(!graph->stillExistNF(*nf))
 		{
 			logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "The NF '%s' is no longer part of the graph",(*nf).c_str());
+			
+			if(replicas > 1)
+			{
+				//The groups of the NF have the IDs of its ports (see GraphTranslator::tenantGroups)
+				map<string,unsigned int> nfPorts = lsi->getNetworkFunctionsPorts(*nf);
+				for(map<string,unsigned int>::iterator p = nfPorts.begin(); p != nfPorts.end(); p++)
+					controller->removeGroup(p->second);
+				
+				for(unsigned int r = 1; r < replicas; r++)
+					destroyReplica(nfsManager,lsi,NFsManager::replicaName(*nf,r));
+			}
 
 			//Stop the NF	
 #ifdef RUN_NFS
@@ -1578,6 +2041,189 @@ next2:
 		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "The endpoint '%s' is no longer part of the graph",rri.endpoint.c_str());	
 }
 
+bool GraphManager::scaleNF(string graphID, string nf, unsigned int replicas)
+{
+	assert(tenantLSIs.count(graphID) != 0);
+
+	GraphInfo graphInfo = (tenantLSIs.find(graphID))->second;
+	NFsManager *nfsManager = graphInfo.getNFsManager();
+	highlevel::Graph *graph = graphInfo.getGraph();
+	LSI *lsi = graphInfo.getLSI();
+	Controller *tenantController = graphInfo.getController();
+	
+	map<string, list<unsigned int> > nfs = graph->getNetworkFunctions();
+	if(nfs.count(nf) == 0)
+	{
+		logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "The NF '%s' is not part of the graph '%s'",nf.c_str(),graphID.c_str());
+		return false;
+	}
+	if(replicas == 0 || replicas > MAX_NF_REPLICAS)
+	{
+		logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "A NF can have from 1 to %d replicas",MAX_NF_REPLICAS);
+		return false;
+	}
+	
+	unsigned int current = graph->getNetworkFunctionReplicas(nf);
+	if(replicas == current)
+		return true;
+	
+	logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "Scaling the NF '%s' of the graph '%s' from %d to %d replicas...",nf.c_str(),graphID.c_str(),current,replicas);
+	
+	map<string, unsigned int> oldReplicas = graph->getNetworkFunctionsReplicas();
+	map<string, unsigned int> newReplicas = oldReplicas;
+	newReplicas[nf] = replicas;
+	
+	/**
+	*	1) Start the new replicas
+	*/
+	for(unsigned int r = current; r < replicas; r++)
+	{
+		if(!createReplica(graph,nfsManager,lsi,nf,NFsManager::replicaName(nf,r)))
+		{
+			//The replicas already started in this operation are destroyed
+			for(unsigned int started = current; started < r; started++)
+			{
+				try
+				{
+					destroyReplica(nfsManager,lsi,NFsManager::replicaName(nf,started));
+				} catch (GraphManagerException e)
+				{
+					logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "The replica '%s' cannot be destroyed",NFsManager::replicaName(nf,started).c_str());
+				}
+			}
+			return false;
+		}
+	}
+	
+	/**
+	*	2) Update the groups and the rules of the tenant-LSI. The groups are changed before
+	*	the rules, so that the rules sending the packets to the NF already use the groups when
+	*	the replicas are added. The flow entries that do not change are not touched
+	*/
+	lowlevel::Graph oldTenant = GraphTranslator::lowerGraphToTenantLSI(graph,lsi,graphInfoLSI0.getLSI(),oldReplicas);
+	lowlevel::Graph newTenant = GraphTranslator::lowerGraphToTenantLSI(graph,lsi,graphInfoLSI0.getLSI(),newReplicas);
+	
+	list<lowlevel::Group> oldGroups = GraphTranslator::tenantGroups(graph,lsi,oldReplicas);
+	list<lowlevel::Group> newGroups = GraphTranslator::tenantGroups(graph,lsi,newReplicas);
+	for(list<lowlevel::Group>::iterator g = newGroups.begin(); g != newGroups.end(); g++)
+		tenantController->installGroup(*g);
+	
+	list<lowlevel::Rule> oldRules = oldTenant.getRules();
+	list<lowlevel::Rule> newRules = newTenant.getRules();
+	list<lowlevel::Rule> toBeInstalled, toBeRemoved;
+	for(list<lowlevel::Rule>::iterator n = newRules.begin(); n != newRules.end(); n++)
+	{
+		if(find(oldRules.begin(),oldRules.end(),*n) == oldRules.end())
+			toBeInstalled.push_back(*n);
+	}
+	for(list<lowlevel::Rule>::iterator o = oldRules.begin(); o != oldRules.end(); o++)
+	{
+		if(find(newRules.begin(),newRules.end(),*o) == newRules.end())
+			toBeRemoved.push_back(*o);
+	}
+	
+	//The new rules are inserted before removing the old ones, so that the packets are always matched
+	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "%d rules added to the tenant-LSI, %d rules removed",toBeInstalled.size(),toBeRemoved.size());
+	if(!toBeInstalled.empty())
+		tenantController->installNewRules(toBeInstalled);
+	if(!toBeRemoved.empty())
+		tenantController->removeRules(toBeRemoved);
+	
+	//The groups are no longer needed if the NF has a single instance
+	for(list<lowlevel::Group>::iterator og = oldGroups.begin(); og != oldGroups.end(); og++)
+	{
+		bool found = false;
+		for(list<lowlevel::Group>::iterator ng = newGroups.begin(); ng != newGroups.end() && !found; ng++)
+			found = (og->getID() == ng->getID());
+		if(!found)
+			tenantController->removeGroup(og->getID());
+	}
+	
+	graph->setNetworkFunctionReplicas(nf,replicas);
+	
+	/**
+	*	3) Stop the replicas no longer used
+	*/
+	for(unsigned int r = replicas; r < current; r++)
+	{
+		//The replica no longer receives traffic, hence the scaling is done anyway
+		try
+		{
+			destroyReplica(nfsManager,lsi,NFsManager::replicaName(nf,r));
+		} catch (GraphManagerException e)
+		{
+			logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "The replica '%s' cannot be destroyed",NFsManager::replicaName(nf,r).c_str());
+		}
+	}
+	
+	logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "The NF '%s' of the graph '%s' has now %d replicas",nf.c_str(),graphID.c_str(),replicas);
+	
+	return true;
+}
+
+void GraphManager::restoreReplicas(string graphID, map<string, unsigned int> replicasBefore)
+{
+	for(map<string, unsigned int>::iterator nf = replicasBefore.begin(); nf != replicasBefore.end(); nf++)
+	{
+		if(!scaleNF(graphID,nf->first,nf->second))
+			logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "The NF '%s' cannot get back its %d replicas",nf->first.c_str(),nf->second);
+	}
+}
+
+bool GraphManager::createReplica(highlevel::Graph *graph, NFsManager *nfsManager, LSI *lsi, string nf, string replica)
+{
+	if(!nfsManager->addReplica(nf,replica))
+		return false;
+	
+	list<unsigned int> ports = graph->getNetworkFunctions()[nf];
+	try
+	{
+		xDPDManager.addNFPorts(*lsi,make_pair(replica,ports),nfsManager->getNFType(replica));
+	} catch (XDPDManagerException e)
+	{
+		logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "%s",e.what());
+		nfsManager->removeReplica(replica);
+		return false;
+	}
+	
+#ifdef RUN_NFS
+	if(!nfsManager->startNF(replica,ports.size(),graph->getNetworkFunctionIPv4PortsRequirements(nf),graph->getNetworkFunctionEthernetPortsRequirements(nf)))
+	{
+		try
+		{
+			xDPDManager.destroyNFPorts(*lsi,replica);
+		} catch (XDPDManagerException e)
+		{
+			logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "%s",e.what());
+		}
+		nfsManager->removeReplica(replica);
+		return false;
+	}
+#else
+	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Flag RUN_NFS disabled. The replica '%s' will not start",replica.c_str());
+#endif
+
+	return true;
+}
+
+void GraphManager::destroyReplica(NFsManager *nfsManager, LSI *lsi, string replica)
+{
+#ifdef RUN_NFS
+	nfsManager->stopNF(replica);
+#else
+	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Flag RUN_NFS disabled. No replica to be stopped");
+#endif
+	try
+	{
+		xDPDManager.destroyNFPorts(*lsi,replica);
+	} catch (XDPDManagerException e)
+	{
+		logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "%s",e.what());
+		throw GraphManagerException();
+	}
+	nfsManager->removeReplica(replica);
+}
+
 bool GraphManager::attachWirelessPort(LSI *lsi)
 {
 	//The interface created by xDPd for the wireless, must be attached to the real wireles interface through a bridge
@@ -1611,31 +2257,217 @@ void GraphManager::detachWirelessPort(LSI *lsi)
 	}
 }
 
-string GraphManager::findEndPointTowardsNF(highlevel::Graph *graph, string nf)
+uint32_t GraphManager::createMeter(highlevel::rate_limit_t rateLimit)
 {
-	list<highlevel::Rule> rules = graph->getRules();
-	for(list<highlevel::Rule>::iterator rule = rules.begin(); rule != rules.end(); rule++)
+	uint32_t meterID = meterIDs.allocate();
+	
+	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Meter %d limits the graph at %d %s",meterID,rateLimit.rate,(rateLimit.pps)? "packets/s" : "kbit/s");
+	graphInfoLSI0.getController()->installMeter(lowlevel::Meter(meterID,rateLimit.rate,rateLimit.pps,rateLimit.burst));
+	
+	return meterID;
+}
+
+void GraphManager::destroyMeter(uint32_t meterID)
+{
+	graphInfoLSI0.getController()->removeMeter(meterID);
+	meterIDs.release(meterID);
+}
+
+string GraphManager::allocateControllerPort()
+{
+	ostringstream port;
+	try
 	{
-		highlevel::Action *action = rule->getAction();
-		highlevel::Match match = rule->getMatch();
-		if(action->getType() == highlevel::ACTION_ON_NETWORK_FUNCTION && match.matchOnEndPoint())
+		port << controllerPorts.allocate();
+	} catch (IDAllocatorException &e)
+	{
+		logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "No TCP port available for a new Openflow controller (%s)",e.what());
+		throw GraphManagerException();
+	}
+	
+	return port.str();
+}
+
+void GraphManager::destroyController(Controller *controller)
+{
+	if(controller == NULL)
+		return;
+
+	uint64_t port = strtoull(controller->getControllerPort().c_str(),NULL,10);
+	delete(controller);
+	controllerPorts.release(port);
+}
+
+bool GraphManager::createPooledLSI(PooledLSI &pooled)
+{
+	ostringstream strControllerPort;
+	try
+	{
+		strControllerPort << allocateControllerPort();
+	} catch (GraphManagerException e)
+	{
+		return false;
+	}
+
+	rofl::openflow::cofhello_elem_versionbitmap versionbitmap;
+	versionbitmap.add_ofp_version(rofl::openflow12::OFP_VERSION);
+	versionbitmap.add_ofp_version(rofl::openflow13::OFP_VERSION);
+
+	lowlevel::Graph graphTmp ;
+	Controller *controller = new Controller(versionbitmap,graphTmp,strControllerPort.str());
+	controller->start();
+	
+	vector<VLink> virtual_links;
+	for(unsigned int i = 0; i < LSI_POOL_SPARE_VLINKS; i++)
+		virtual_links.push_back(VLink(dpid0));
+	
+	//The LSI has neither physical ports nor network functions
+	map<string,string> dummyPhyPorts;
+	map<string, list<unsigned int> > dummy_network_functions;
+	map<string,nf_t> nf_types;
+	
+	LSI *lsi = new LSI(string(OF_CONTROLLER_ADDRESS), strControllerPort.str(), dummyPhyPorts, dummy_network_functions,virtual_links,nf_types);
+	
+	try
+	{
+		xDPDManager.createLsi(*lsi);
+	} catch (XDPDManagerException e)
+	{
+		//The LSI has not been created
+		logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "%s",e.what());
+		delete(lsi);
+		destroyController(controller);
+		return false;
+	}
+	
+	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "LSI %x created for the pool",lsi->getDpid());
+	
+	pooled.lsi = lsi;
+	pooled.controller = controller;
+	
+	return true;
+}
+
+void GraphManager::customizePooledLSI(LSI *lsi, unsigned int numberOfVLrequired, map<string, list<unsigned int> > network_functions, NFsManager *nfsManager)
+{
+	vector<VLink> spare = lsi->getVirtualLinks();
+	
+	//Remove the virtual links that are not needed by the graph
+	for(unsigned int i = numberOfVLrequired; i < spare.size(); i++)
+		xDPDManager.destroyVirtualLink(*lsi,spare[i].getID());
+	
+	//Create the virtual links that are still missing
+	for(unsigned int i = spare.size(); i < numberOfVLrequired; i++)
+		xDPDManager.addVirtualLink(*lsi,VLink(dpid0));
+		
+	for(map<string, list<unsigned int> >::iterator nf = network_functions.begin(); nf != network_functions.end(); nf++)
+		xDPDManager.addNFPorts(*lsi,*nf,nfsManager->getNFType(nf->first));
+}
+
+void GraphManager::refillLSIPool()
+{
+	pthread_t thread;
+	if(pthread_create(&thread, NULL, &refillLSIPoolThread, (void *)this) != 0)
+	{
+		logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "An error occurred while creating the thread that refills the LSI pool");
+		return;
+	}
+	pthread_detach(thread);
+}
+
+void *GraphManager::refillLSIPoolThread(void *param)
+{
+	GraphManager *gm = (GraphManager*)param;
+	
+	unsigned int missing = gm->lsiPool.startRefill();
+	for(unsigned int i = 0; i < missing; i++)
+	{
+		//The LSIs are created with the lock of the GraphManager held, as the graphs,
+		//since they use the same allocators, the LSI-0 and the connection with xDPd
+		PooledLSI pooled;
+		bool ok = false;
+		mutexLock();
+		if(!gm->lsiPool.isTerminating())
+			ok = gm->createPooledLSI(pooled);
+		mutexUnlock();
+		gm->lsiPool.refillCompleted(pooled,ok);
+	}
+	
+	return NULL;
+}
+
+void GraphManager::autoscale()
+{
+	for(map<string,GraphInfo>::iterator g = tenantLSIs.begin(); g != tenantLSIs.end(); g++)
+	{
+		string graphID = g->first;
+		highlevel::Graph *graph = g->second.getGraph();
+		NFsManager *nfsManager = g->second.getNFsManager();
+		uint64_t lsiID = g->second.getLSI()->getDpid();
+
+		//Only the DPDK NFs export the occupancy of their rings
+		list<string> dpdkNFs;
+		map<string, list<unsigned int> > nfs = graph->getNetworkFunctions();
+		for(map<string, list<unsigned int> >::iterator nf = nfs.begin(); nf != nfs.end(); nf++)
 		{
-			highlevel::ActionNetworkFunction *action_nf = (highlevel::ActionNetworkFunction*)action;
-			stringstream ss;
-			ss << action->getInfo() << "_" << action_nf->getPort();
-			
-			if(nf == ss.str())
+			if(nfsManager->getNFType(nf->first) == DPDK)
+				dpdkNFs.push_back(nf->first);
+		}
+
+		for(list<string>::iterator nf = dpdkNFs.begin(); nf != dpdkNFs.end(); nf++)
+		{
+			unsigned int replicas = graph->getNetworkFunctionReplicas(*nf);
+
+			map<unsigned int, nf_load_t> loads;
+			for(unsigned int r = 0; r < replicas; r++)
+			{
+				nf_load_t load;
+				if(DPDKStats::readLoad(DPDKStats::segmentName(lsiID,NFsManager::replicaName(*nf,r)),load))
+					loads[r] = load;
+			}
+
+			string reason;
+			unsigned int target = autoscaler.evaluate(graphID,*nf,replicas,loads,reason);
+			if(target == replicas)
+				continue;
+
+			logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "Scaling NF \"%s\" of graph \"%s\" from %d to %d replicas (%s)...",nf->c_str(),graphID.c_str(),replicas,target,reason.c_str());
+
+			bool done;
+			try
 			{
-				stringstream ssm;
-				ssm << match.getGraphID() << ":" << match.getEndPoint();
-				return ssm.str();
-			}		
+				done = scaleNF(graphID,*nf,target);
+			}catch(...)
+			{
+				done = false;
+			}
+			autoscaler.recordScaling(graphID,*nf,replicas,target,reason,done);
 		}
 	}
+}
 
-	assert(0);
+void *GraphManager::autoscalerThread(void *param)
+{
+	GraphManager *gm = (GraphManager*)param;
+	
+	while(gm->autoscaler.waitPeriod())
+	{
+		mutexLock();
+		gm->autoscale();
+		mutexUnlock();
+	}
 	
-	return ""; //just for the compiler
+	return NULL;
+}
+
+Object GraphManager::toJSONAutoscaler()
+{
+	return autoscaler.toJSON();
+}
+
+Object GraphManager::toJSONPool()
+{
+	return lsiPool.toJSON();
 }
 
 bool GraphManager::canDeleteFlow(highlevel::Graph *graph, string flowID)
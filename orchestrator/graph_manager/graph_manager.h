@@ -6,9 +6,15 @@
 #include "../controller/controller.h"
 #include "graph_info.h"
 #include "graph_translator.h"
+#include "resource_tracker.h"
+#include "lsi_pool.h"
+#include "lsi0_pipeline.h"
+#include "classifier_index.h"
+#include "autoscaler.h"
 #include "../xdpd_manager/xdpd_manager.h"
 #include "../xdpd_manager/lsi.h"
 #include "../utils/constants.h"
+#include "../utils/id_allocator.h"
 #include "../graph/high_level_graph/high_level_graph.h"
 #include "../graph/low_level_graph/graph.h"
 #include "../graph/high_level_graph/high_level_action_nf.h"
@@ -21,6 +27,8 @@
 #include <string>
 #include <sstream>
 #include <pthread.h>
+#include <sys/time.h>
+#include <algorithm>
 
 #include <stdexcept>
 
@@ -34,6 +42,11 @@ using namespace std;
 #define ATTACH_WIRELESS_INTERFACE	"./graph_manager/scripts/attachWirelessInterface.sh"
 #define DETACH_WIRELESS_INTERFACE	"./graph_manager/scripts/detachWirelessInterface.sh"
 
+/**
+*	@brief: number of virtual links created in advance for each LSI of the pool
+*/
+#define LSI_POOL_SPARE_VLINKS	4
+
 typedef struct
 	{
 		string nf_name;
@@ -43,6 +56,15 @@ typedef struct
 		NFsManager *nfsManager;
 	}to_thread_t;
 
+class GraphManager;
+
+typedef struct
+	{
+		GraphManager *graphManager;
+		GraphInfo graphInfo;
+		list<lowlevel::Rule> lsi0Rules;
+	}to_teardown_thread_t;
+
 class GraphManager
 {
 private:
@@ -51,9 +73,14 @@ private:
 	static pthread_mutex_t graph_manager_mutex;
 
 	/**
-	*	Port of the openflow controller of the next graph created
+	*	Ports used by the openflow controllers of the LSIs
+	*/
+	static IDAllocator controllerPorts;
+	
+	/**
+	*	Meters of the LSI-0, used to limit the rate of the graphs
 	*/
-	static uint32_t nextControllerPort;
+	static IDAllocator meterIDs;
 	
 	/**
 	*	This structure contains all the graph end points which are not
@@ -110,35 +137,48 @@ private:
 	XDPDManager xDPDManager;
 	
 	/**
-	*	@brief: identify the virtual links required to implement the graph: each action
-	*		expressed on a NF port, associated with a match on a physical port, requires a 
-	*		a virtual link; each action on a port associated with a match on a NF requires
-	*		a virtual link; each action expressed on an end point associated with a match
-	*		on a NF requires a virtual link. 
-	*		Two actions on the same NF port requires a single virtual link, as well as two 
-	*		ouput actions realted to the same physical port or end point requrie just one
-	*		virtual link.
-	*
-	*	@param:  graph	The description of the graph to be implemented
-	*	@return: the return value is quite complicated. It is a vector whose fields have the
-	*		following meaning:
-	*			- vector[0]: NFs requiring a virtual link
-	*			- vector[1]: physical ports requiring a virtual link
-	*			- vector[2]: endpoints requiring a virtual link
-	*			- vector[3]: NFs reached from an endpoint that is defined in the current graph	
+	*	Tenant-LSIs created in advance, to be used by new graphs
 	*/
-	vector<set<string> > identifyVirtualLinksRequired(highlevel::Graph *graph);
+	LSIPool lsiPool;
 	
 	/**
-	*	@brief: apply the same rules of the previous functions, but the virtual link is required
-	*		only if the NF or the port that would need it are not alredy present in the graph.
-	*		In fact, this function must be used during the updating of an existing graph, and not 
-	*		during the creation of a new one
+	*	Tables of the LSI-0, and rules dispatching the packets among them
+	*/
+	LSI0Pipeline lsi0Pipeline;
+	
+	/**
+	*	Rules of the graphs on the ports of the LSI-0 shared among the graphs
+	*/
+	ClassifierIndex classifierIndex;
+	
+	/**
+	*	Policy changing the number of replicas of the DPDK NFs, and the thread
+	*	applying it
+	*/
+	Autoscaler autoscaler;
+	pthread_t autoscalerThreadID;
+	
+	/**
+	*	@brief: account the rules of a (piece of) graph in the resource tracker of a tenant-LSI, 
+	*		and identify the new virtual links required to implement them. Each action
+	*		expressed on a NF port, associated with a match on a physical port or on an 
+	*		endpoint, requires a virtual link; each action on a port associated with a match 
+	*		on a NF requires a virtual link; each action expressed on an end point associated 
+	*		with a match on a NF requires a virtual link. 
+	*		Two actions on the same NF port requires a single virtual link, as well as two 
+	*		ouput actions realted to the same physical port or end point requrie just one
+	*		virtual link. Moreover, no virtual link is required for the resources that
+	*		already have one in the tenant-LSI.
 	*
-	*	@param: newPiece	The new part of the graph to be created
-	*	@param: lsi		Data structure describing the graph to be updated
+	*	@param: graph				Rules to be accounted
+	*	@param: tracker				Resource tracker of the tenant-LSI
+	*	@param: vlNFs				Filled with the NF ports requiring a new virtual link
+	*	@param: vlPhyPorts			Filled with the physical ports requiring a new virtual link
+	*	@param: vlEndPoints			Filled with the endpoints requiring a new virtual link
+	*	@param: NFsFromEndPoint		Filled with the NF ports reached from an endpoint that is defined
+	*								in the current graph, and with the endpoint itself
 	*/
-	vector<set<string> > identifyVirtualLinksRequired(highlevel::Graph *newPiece, LSI *lsi);
+	void identifyVirtualLinksRequired(highlevel::Graph *graph, ResourceTracker *tracker, set<string> &vlNFs, set<string> &vlPhyPorts, set<string> &vlEndPoints, map<string,string> &NFsFromEndPoint);
 	
 	/**
 	*	@brief: given a graph description, check if the ports and the NFs required by the
@@ -149,6 +189,22 @@ private:
 	*/
 	bool checkGraphValidity(highlevel::Graph *graph, NFsManager *nfsManager);
 	
+	/**
+	*	@brief: check that the rules of a (piece of) graph do not overlap the rules of
+	*		the other graphs on the shared ports of the LSI-0, and return the rules to
+	*		be inserted in the classifier index once the graph is deployed.
+	*		GraphConflictException is thrown in case of conflict
+	*
+	*	@param: graph	Graph description to be validated
+	*/
+	list<classified_rule_t> checkGraphConflicts(highlevel::Graph *graph);
+	
+	/**
+	*	@brief: create the JSON representation of the ports and of the flow entries of
+	*		an LSI
+	*/
+	Object lsiToJSON(string name, LSI *lsi, map<string,unsigned int> ports, Controller *controller);
+	
 	/**
 	*	@brief: check if
 	*		- a NF no longer requires a vlink in a specific graph
@@ -159,8 +215,16 @@ private:
 	*		- physical ports are no longer used
 	*		- endpoints are no longer used
 	*	and then remove the useles things from the LSI on xDPD
+	*
+	*	@param: tbr			Information on the rule removed from the high level graph
+	*	@param: events		Virtual links no longer needed after the removal of the rule, as
+	*						notified by the resource tracker of the tenant-LSI
+	*	@param: nfsManager	NFs manager of the graph
+	*	@param: graph		High level graph from which the rule has been removed
+	*	@param: lsi			Tenant-LSI implementing the graph
+	*	@param: controller	Controller of the tenant-LSI
 	*/
-	void removeUselessPorts_NFs_Endpoints_VirtualLinks(RuleRemovedInfo tbr, NFsManager *nfsManager,highlevel::Graph *graph, LSI * lsi);
+	void removeUselessPorts_NFs_Endpoints_VirtualLinks(RuleRemovedInfo tbr, list<VLinkEvent> events, NFsManager *nfsManager,highlevel::Graph *graph, LSI * lsi, Controller *controller);
 	
 	/**
 	*	@brief: attach the wireless interface of the LSI to a real wireless port, by means of a Linux bridge.
@@ -177,15 +241,6 @@ private:
 	*/
 	void detachWirelessPort(LSI *lsi);
 	
-	/**
-	*	@brief: given a NF of the graph (in the form NF_port), return the endpoint expressed in the match of a rule
-	*		whose action is expressed on the function.
-	*
-	*	@param: graph	Graph in which the information must be seatched
-	*	@param: nf		Involved NF
-	*/
-	string findEndPointTowardsNF(highlevel::Graph *graph, string nf);
-	
 	/**
 	*	@brief: check if a specific flow can be removed from a graph. The flow cannot be removed if it defines
 	*		an endpoint currently used by other graphs.
@@ -197,12 +252,146 @@ private:
 	*	be removed if it is not used in actions of other graphs. 
 	*/
 	bool canDeleteFlow(highlevel::Graph *graph, string flowID);
+
+	/**
+	*	@brief: return a free TCP port for a new Openflow controller
+	*/
+	string allocateControllerPort();
+
+	/**
+	*	@brief: destroy an Openflow controller, and give its TCP port back to the allocator
+	*/
+	void destroyController(Controller *controller);
+
+	/**
+	*	@brief: allocate a meter of the LSI-0, and install it with the rate limit
+	*		of a graph. An IDAllocatorException is raised if no meter is available
+	*/
+	uint32_t createMeter(highlevel::rate_limit_t rateLimit);
+
+	/**
+	*	@brief: remove a meter from the LSI-0, and give its ID back to the allocator.
+	*		The rules using the meter must have been already removed
+	*/
+	void destroyMeter(uint32_t meterID);
+
+	/**
+	*	@brief: create a replica of a NF of a graph: attach its ports to the tenant-LSI,
+	*		and start it. The traffic is not sent to the replica yet
+	*
+	*	@param: graph		High level graph containing the NF
+	*	@param: nfsManager	NFs manager of the graph
+	*	@param: lsi			Tenant-LSI implementing the graph
+	*	@param: nf			Name of the network function
+	*	@param: replica		Name of the replica (see NFsManager::replicaName)
+	*/
+	bool createReplica(highlevel::Graph *graph, NFsManager *nfsManager, LSI *lsi, string nf, string replica);
+	
+	/**
+	*	@brief: stop a replica of a NF, and destroy its ports. The traffic must be no
+	*		longer sent to the replica
+	*
+	*	@param: nfsManager	NFs manager of the graph
+	*	@param: lsi			Tenant-LSI implementing the graph
+	*	@param: replica		Name of the replica (see NFsManager::replicaName)
+	*/
+	void destroyReplica(NFsManager *nfsManager, LSI *lsi, string replica);
+
+	/**
+	*	@brief: give back to the NFs of a graph the number of replicas they had
+	*		before an update that failed
+	*
+	*	@param: graphID			Identifier of the graph
+	*	@param: replicasBefore	Number of replicas of each NF scaled by the update
+	*/
+	void restoreReplicas(string graphID, map<string, unsigned int> replicasBefore);
+
+	/**
+	*	@brief: return the rules to be removed from the LSI-0 when a graph is deleted.
+	*		If updateDispatching is true, the packets are no longer dispatched to those
+	*		rules as soon as this method returns; otherwise, updateLSI0Dispatching must
+	*		be called before removing the rules
+	*/
+	list<lowlevel::Rule> getLSI0Rules(GraphInfo &graphInfo, bool updateDispatching = true);
+	
+	/**
+	*	@brief: insert rules in the LSI-0, and then the rules dispatching the packets
+	*		to them
+	*/
+	void installLSI0Rules(list<lowlevel::Rule> rules);
+	
+	/**
+	*	@brief: update the rules dispatching the packets among the tables of the LSI-0,
+	*		after that some rules have been inserted in the LSI-0 or removed from it
+	*/
+	void updateLSI0Dispatching();
+
+	/**
+	*	@brief: remove the rules of a graph from the LSI-0, stop its NFs and destroy its
+	*		LSI and controller. This method does not change the state of the graph manager,
+	*		hence many graphs can be torn down in parallel.
+	*
+	*	@param: graphInfo	Graph to be torn down
+	*	@param: lsi0Rules	Rules to be removed from the LSI-0 (see getLSI0Rules)
+	*	@return: false if the LSI cannot be destroyed
+	*/
+	bool teardownGraph(GraphInfo graphInfo, list<lowlevel::Rule> lsi0Rules);
+
+	static void *teardownGraphThread(void *param);
+
+	/**
+	*	@brief: remove from the graph manager a graph already torn down, and delete
+	*		the endpoints defined by the graph (if not shutting down)
+	*/
+	void releaseGraph(GraphInfo graphInfo, bool shutdown);
+
+	/**
+	*	@brief: delete all the graphs, when the orchestrator is terminating. The graphs
+	*		are deleted in waves: all the graphs that do not define endpoints used by the
+	*		other graphs still existing are torn down in parallel.
+	*/
+	void deleteAllGraphs();
+
+	/**
+	*	@brief: create an empty tenant-LSI, connected to the LSI-0 through LSI_POOL_SPARE_VLINKS
+	*		virtual links, and its Openflow controller
+	*
+	*	@param: pooled	Filled with the new LSI and its controller
+	*/
+	bool createPooledLSI(PooledLSI &pooled);
+	
+	/**
+	*	@brief: adapt an LSI taken from the pool to a new graph, by adjusting the number of virtual
+	*		links and by creating the ports of the network functions
+	*
+	*	@param: lsi					LSI taken from the pool
+	*	@param: numberOfVLrequired	Number of virtual links required by the graph
+	*	@param: network_functions	NFs of the graph, with their ports
+	*	@param: nfsManager			NFs manager of the graph
+	*/
+	void customizePooledLSI(LSI *lsi, unsigned int numberOfVLrequired, map<string, list<unsigned int> > network_functions, NFsManager *nfsManager);
+	
+	/**
+	*	@brief: start a thread that brings the LSI pool back to its size. The thread
+	*		creates each LSI with the lock of the GraphManager held
+	*/
+	void refillLSIPool();
+	
+	/**
+	*	@brief: read the counters exported by the replicas of the DPDK NFs of all the
+	*		graphs, and change the number of replicas as decided by the autoscaler
+	*/
+	void autoscale();
+	
+	static void *autoscalerThread(void *param);
+	
+	static void *refillLSIPoolThread(void *param);
 	
 public:
 	//XXX: Currently I only support rules with a match expressed on a port or on a NF
 	//(plus other fields)
 
-	GraphManager(int core_mask, bool wireless = false, char *wirelessName = "wlan0");
+	GraphManager(int core_mask, bool wireless = false, char *wirelessName = "wlan0", unsigned int lsiPoolSize = 0, bool autoscaling = false);
 	~GraphManager();
 		
 	/**
@@ -238,6 +427,19 @@ public:
 	*	of the graph fails
 	*/
 	bool updateGraph(string graphID, highlevel::Graph *newFlow);
+	
+	/**
+	*	@brief: change the number of instances of a NF of an existing graph. The new
+	*		replicas are started before being added to the groups balancing the traffic
+	*		sent to the NF (see GraphTranslator::tenantGroups), while the replicas
+	*		removed are stopped after having been removed from those groups. The
+	*		flow entries of the LSI-0 do not change.
+	*
+	*	@param: graphID		Identifier of the graph
+	*	@param: nf			Name of the network function
+	*	@param: replicas	New number of instances of the network function
+	*/
+	bool scaleNF(string graphID, string nf, unsigned int replicas);
 
 	/**
 	*	@brief: remove the flow with a specified ID, from a specified graph
@@ -277,13 +479,66 @@ public:
 	*/
 	Object toJSON(string graphID);
 	
+	/**
+	*	@brief: create the JSON representation of the statistics of the NFs of the
+	*		graph with the given ID
+	*/
+	Object statsToJSON(string graphID);
+	
 	/**
 	*	@brief: create the JSON representation of the physical interfaces that can be connected
 	*		to the graphs (both ethernet and wifi)
 	*/
 	Object toJSONPhysicalInterfaces();
 	
+	/**
+	*	@brief: create the JSON representation of the flow entries of the LSI-0 and of the
+	*		tenant-LSIs, with their ports and the virtual links connecting them (i.e., the
+	*		input of the OpenFlow simulator)
+	*/
+	Object toJSONTables();
+	
+	/**
+	*	@brief: create the JSON representation of the cores that can be allocated to the
+	*		DPDK NFs, with their NUMA node and the NFs using them
+	*/
+	Object toJSONCores();
+	
+	/**
+	*	@brief: create the JSON representation of the artifacts of the NFs in the cache
+	*/
+	Object toJSONCache();
+	
+	/**
+	*	@brief: start retrieving in background the artifacts of a network function, so that
+	*		it starts faster when a graph uses it
+	*
+	*	@param:	nf_name	Name of the network function
+	*	@param:	json	JSON representation of the artifacts being retrieved
+	*/
+	nf_manager_ret_t prefetchNF(string nf_name, Object &json);
+	
+	/**
+	*	@brief: create the JSON representation of the policy of the autoscaler, and of
+	*		the last changes of the number of replicas it decided
+	*/
+	Object toJSONAutoscaler();
+
+	/**
+	*	@brief: create the JSON representation of the LSI pool, with its hit rate and
+	*		the time needed to provide the new graphs with their LSI
+	*/
+	Object toJSONPool();
+	
 	static void mutexInit();
+	
+	/**
+	*	@brief: serialize the operations on the graphs. The lock must be held while
+	*		calling any other method, since the autoscaler changes the graphs from
+	*		its own thread
+	*/
+	static void mutexLock();
+	static void mutexUnlock();
 };
 
 
@@ -296,4 +551,27 @@ public:
 	}
 };
 
+class GraphConflictException: public exception
+{
+private:
+	/**
+	*	@brief: JSON description of the conflicting rules
+	*/
+	Object conflict;
+
+public:
+	GraphConflictException(Object conflict) : conflict(conflict) {}
+	~GraphConflictException() throw() {}
+
+	Object toJSON()
+	{
+		return conflict;
+	}
+
+	virtual const char* what() const throw()
+	{
+		return "GraphConflictException";
+	}
+};
+
 #endif //GRAPH_MANAGER_H_
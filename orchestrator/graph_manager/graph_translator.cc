@@ -1,6 +1,6 @@
 #include "graph_translator.h"
 
-lowlevel::Graph GraphTranslator::lowerGraphToLSI0(highlevel::Graph *graph, LSI *tenantLSI, LSI *lsi0, map<string, unsigned int> endPointsDefinedInMatches, map<string, unsigned int> endPointsDefinedInActions,map<string, unsigned int > &availableEndPoints, bool creating)
+lowlevel::Graph GraphTranslator::lowerGraphToLSI0(highlevel::Graph *graph, LSI *tenantLSI, LSI *lsi0, uint8_t table, uint32_t meter, map<string, unsigned int> endPointsDefinedInMatches, map<string, unsigned int> endPointsDefinedInActions,map<string, unsigned int > &availableEndPoints, bool creating)
 {
 	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Creating rules for LSI-0");
 	
@@ -22,7 +22,8 @@ lowlevel::Graph GraphTranslator::lowerGraphToLSI0(highlevel::Graph *graph, LSI *
 	
 		highlevel::Match match = hlr->getMatch();
 		highlevel::Action *action = hlr->getAction();
-		uint64_t priority = hlr->getPriority();
+		//Above the rules dispatching the packets among the tables
+		uint64_t priority = hlr->getPriority() + LSI0_GRAPH_PRIORITY_OFFSET;
 		
 		if( (match.matchOnNF()) && (action->getType() == highlevel::ACTION_ON_NETWORK_FUNCTION) )
 		{
@@ -95,7 +96,7 @@ lowlevel::Graph GraphTranslator::lowerGraphToLSI0(highlevel::Graph *graph, LSI *
 				//The rule ID is created as follows  highlevelGraphID_hlrID
 				stringstream newRuleID;
 				newRuleID << graph->getID() << "_" << hlr->getFlowID();
-				lowlevel::Rule lsi0Rule(lsi0Match,lsi0Action,newRuleID.str(),priority);
+				lowlevel::Rule lsi0Rule(lsi0Match,lsi0Action,newRuleID.str(),priority,LSI0_DISPATCH_TABLE);
 				lsi0Graph.addRule(lsi0Rule);
 			}
 			continue;
@@ -154,7 +155,8 @@ lowlevel::Graph GraphTranslator::lowerGraphToLSI0(highlevel::Graph *graph, LSI *
 				//The rule ID is created as follows  highlevelGraphID_hlrID
 				stringstream newRuleID;
 				newRuleID << graph->getID() << "_" << hlr->getFlowID();
-				lowlevel::Rule lsi0Rule(lsi0Match,lsi0Action,newRuleID.str(),priority);
+				lsi0Action.setMeter(meter);
+				lowlevel::Rule lsi0Rule(lsi0Match,lsi0Action,newRuleID.str(),priority,table);
 				lsi0Graph.addRule(lsi0Rule);
 			}
 			else //XXX: for sure the action is a NF. Currently, other actions are not supported
@@ -190,7 +192,8 @@ lowlevel::Graph GraphTranslator::lowerGraphToLSI0(highlevel::Graph *graph, LSI *
 				//The rule ID is created as follows  highlevelGraphID_hlrID
 				stringstream newRuleID;
 				newRuleID << graph->getID() << "_" << hlr->getFlowID();
-				lowlevel::Rule lsi0Rule(lsi0Match,lsi0Action,newRuleID.str(),priority);
+				lsi0Action.setMeter(meter);
+				lowlevel::Rule lsi0Rule(lsi0Match,lsi0Action,newRuleID.str(),priority,table);
 				lsi0Graph.addRule(lsi0Rule);
 			}
 	
@@ -257,7 +260,8 @@ lowlevel::Graph GraphTranslator::lowerGraphToLSI0(highlevel::Graph *graph, LSI *
 				//The rule ID is created as follows  highlevelGraphID_hlrID
 				stringstream newRuleID;
 				newRuleID << graph->getID() << "_" << hlr->getFlowID();
-				lowlevel::Rule lsi0Rule(lsi0Match,lsi0Action,newRuleID.str(),priority);
+				lsi0Action.setMeter(meter);
+				lowlevel::Rule lsi0Rule(lsi0Match,lsi0Action,newRuleID.str(),priority,table);
 				lsi0Graph.addRule(lsi0Rule);
 			}
 			continue;
@@ -315,7 +319,7 @@ lowlevel::Graph GraphTranslator::lowerGraphToLSI0(highlevel::Graph *graph, LSI *
 			//The rule ID is created as follows  highlevelGraphID_hlrID
 			stringstream newRuleID;
 			newRuleID << graph->getID() << "_" << hlr->getFlowID();
-			lowlevel::Rule lsi0Rule(lsi0Match,lsi0Action,newRuleID.str(),priority);
+			lowlevel::Rule lsi0Rule(lsi0Match,lsi0Action,newRuleID.str(),priority,LSI0_DISPATCH_TABLE);
 			lsi0Graph.addRule(lsi0Rule);
 		 }//end of match.matchOnNF()
 	}
@@ -323,7 +327,13 @@ lowlevel::Graph GraphTranslator::lowerGraphToLSI0(highlevel::Graph *graph, LSI *
 	return lsi0Graph;	
 }
 
-lowlevel::Graph GraphTranslator::lowerGraphToTenantLSI(highlevel::Graph *graph, LSI *tenantLSI, LSI *lsi0)
+unsigned int GraphTranslator::numberOfReplicas(map<string, unsigned int> &replicas, string nf)
+{
+	map<string, unsigned int>::iterator r = replicas.find(nf);
+	return (r != replicas.end())? r->second : 1;
+}
+
+lowlevel::Graph GraphTranslator::lowerGraphToTenantLSI(highlevel::Graph *graph, LSI *tenantLSI, LSI *lsi0, map<string, unsigned int> replicas)
 {
 	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Creating rules for the tenant LSI");
 	
@@ -409,9 +419,9 @@ lowlevel::Graph GraphTranslator::lowerGraphToTenantLSI(highlevel::Graph *graph,
 			assert(vlink != tenantVirtualLinks.end());
 			tenantMatch.setInputPort(vlink->getLocalID());
 
-			//Translate the action
+			//Translate the action (the group of a NF with replicas has the ID of the port of the NF)
 			map<string,unsigned int>::iterator translation = tenantNetworkFunctionsPorts.find(nf_port.str());
-			lowlevel::Action tenantAction(translation->second);
+			lowlevel::Action tenantAction = (numberOfReplicas(replicas,action_info) > 1)? lowlevel::Action::outputGroup(translation->second) : lowlevel::Action(translation->second);
 
 			//Create the rule and add it to the graph
 			lowlevel::Rule tenantRule(tenantMatch,tenantAction,hlr->getFlowID(),priority);
@@ -430,29 +440,38 @@ lowlevel::Graph GraphTranslator::lowerGraphToTenantLSI(highlevel::Graph *graph,
 			string nf = match.getNF();
 			int nfPort = match.getPortOfNF();
 			
-			if(tenantNetworkFunctions.count(nf) == 0)
+			//The packets can come from any replica of the NF, hence the match
+			//is replicated on the ports of all of them
+			list<unsigned int> inputPorts;
+			for(unsigned int r = 0; r < numberOfReplicas(replicas,nf); r++)
 			{
-				logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "The tenant graph expresses a match \"%s\", which is not a NF attacched to the tenant LSI",nf.c_str());
-				throw GraphManagerException();
-			}
+				string instance = NFsManager::replicaName(nf,r);
+			
+				if(tenantNetworkFunctions.count(instance) == 0)
+				{
+					logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "The tenant graph expresses a match \"%s\", which is not a NF attacched to the tenant LSI",instance.c_str());
+					throw GraphManagerException();
+				}
 			
-			map<string,unsigned int> tenantNetworkFunctionsPorts = tenantLSI->getNetworkFunctionsPorts(nf);
+				map<string,unsigned int> tenantNetworkFunctionsPorts = tenantLSI->getNetworkFunctionsPorts(instance);
 			
-			stringstream nf_output;
-			nf_output << nf << "_" << nfPort;
+				stringstream nf_output;
+				nf_output << instance << "_" << nfPort;
 						
-			if(tenantNetworkFunctionsPorts.count(nf_output.str()) == 0)
-			{
-				logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "The tenant graph expresses (at rule %s) a match on \"%s:%d\", which is not attached to the tenant LSI",(hlr->getFlowID()).c_str(),nf.c_str(),nfPort);
-				throw GraphManagerException();
+				if(tenantNetworkFunctionsPorts.count(nf_output.str()) == 0)
+				{
+					logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "The tenant graph expresses (at rule %s) a match on \"%s:%d\", which is not attached to the tenant LSI",(hlr->getFlowID()).c_str(),instance.c_str(),nfPort);
+					throw GraphManagerException();
+				}
+				
+				inputPorts.push_back(tenantNetworkFunctionsPorts.find(nf_output.str())->second);
 			}
 		
-			//Translate the match
+			//Translate the match (the input port is set when the rules are created)
 			lowlevel::Match tenantMatch;
 			tenantMatch.setAllCommonFields(match);		
-	
-			map<string,unsigned int>::iterator translation = tenantNetworkFunctionsPorts.find(nf_output.str());
-			tenantMatch.setInputPort(translation->second);
+			
+			lowlevel::Action tenantAction(0);
 			
 			//Translate the action
 			string action_info = action->getInfo(); //e.g., "firewall"
@@ -480,11 +499,10 @@ lowlevel::Graph GraphTranslator::lowerGraphToTenantLSI(highlevel::Graph *graph,
 					throw GraphManagerException();
 				}
 				map<string,unsigned int>::iterator translation = tenantNetworkFunctionsPortsAction.find(nf_port.str());
-				lowlevel::Action tenantAction(translation->second);
-	
-				//Create the rule and add it to the graph
-				lowlevel::Rule tenantRule(tenantMatch,tenantAction,hlr->getFlowID(),priority);
-				tenantGraph.addRule(tenantRule);
+				if(numberOfReplicas(replicas,action_info) > 1)
+					tenantAction = lowlevel::Action::outputGroup(translation->second);
+				else
+					tenantAction = lowlevel::Action(translation->second);
 			}
 			else if(action->getType() == highlevel::ACTION_ON_PORT)
 			{
@@ -512,11 +530,7 @@ lowlevel::Graph GraphTranslator::lowerGraphToTenantLSI(highlevel::Graph *graph,
 						break;
 				}
 				assert(vlink != tenantVirtualLinks.end());
-				lowlevel::Action tenantAction(vlink->getLocalID());
-				
-				//Create the rule and add it to the graph
-				lowlevel::Rule tenantRule(tenantMatch,tenantAction,hlr->getFlowID(),priority);
-				tenantGraph.addRule(tenantRule);
+				tenantAction = lowlevel::Action(vlink->getLocalID());
 			}
 			else
 			{
@@ -548,9 +562,13 @@ lowlevel::Graph GraphTranslator::lowerGraphToTenantLSI(highlevel::Graph *graph,
 						break;
 				}
 				assert(vlink != tenantVirtualLinks.end());
-				lowlevel::Action tenantAction(vlink->getLocalID());
-				
-				//Create the rule and add it to the graph
+				tenantAction = lowlevel::Action(vlink->getLocalID());
+			}
+		
+			//Create the rules and add them to the graph
+			for(list<unsigned int>::iterator inputPort = inputPorts.begin(); inputPort != inputPorts.end(); inputPort++)
+			{
+				tenantMatch.setInputPort(*inputPort);
 				lowlevel::Rule tenantRule(tenantMatch,tenantAction,hlr->getFlowID(),priority);
 				tenantGraph.addRule(tenantRule);
 			}
@@ -560,3 +578,101 @@ lowlevel::Graph GraphTranslator::lowerGraphToTenantLSI(highlevel::Graph *graph,
 
 	return tenantGraph;	
 }
+
+list<lowlevel::Group> GraphTranslator::tenantGroups(highlevel::Graph *graph, LSI *tenantLSI, map<string, unsigned int> replicas)
+{
+	list<lowlevel::Group> groups;
+
+	map<string, list<unsigned int> > nfs = graph->getNetworkFunctions();
+	for(map<string, list<unsigned int> >::iterator nf = nfs.begin(); nf != nfs.end(); nf++)
+	{
+		unsigned int nfReplicas = numberOfReplicas(replicas,nf->first);
+		if(nfReplicas == 1)
+			continue;
+		
+		//A group for each port of the NF, whose buckets are shared among the replicas
+		vector<unsigned int> owners = lowlevel::Group::bucketsOwners(nfReplicas);
+		for(list<unsigned int>::iterator p = nf->second.begin(); p != nf->second.end(); p++)
+		{
+			vector<uint32_t> replicaPorts;
+			for(unsigned int r = 0; r < nfReplicas; r++)
+			{
+				string instance = NFsManager::replicaName(nf->first,r);
+				map<string,unsigned int> instancePorts = tenantLSI->getNetworkFunctionsPorts(instance);
+				
+				stringstream instance_port;
+				instance_port << instance << "_" << *p;
+				
+				if(instancePorts.count(instance_port.str()) == 0)
+				{
+					logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "The port \"%s\" is not attached to the tenant LSI",instance_port.str().c_str());
+					throw GraphManagerException();
+				}
+				replicaPorts.push_back(instancePorts.find(instance_port.str())->second);
+			}
+			
+			list<uint32_t> ports;
+			for(unsigned int b = 0; b < owners.size(); b++)
+				ports.push_back(replicaPorts[owners[b]]);
+			
+			logger(ORCH_DEBUG, MODULE_NAME, __FILE__, __LINE__, "The port %d of NF \"%s\" is balanced among %d replicas with the group %d",*p,nf->first.c_str(),nfReplicas,replicaPorts.front());
+			groups.push_back(lowlevel::Group(replicaPorts.front(),ports));
+		}
+	}
+
+	return groups;
+}
+
+list<classified_rule_t> GraphTranslator::rulesOnSharedPorts(highlevel::Graph *graph, LSI *lsi0, map<string, unsigned int> endPointsDefinedInActions)
+{
+	map<string,unsigned int> ports_lsi0 = lsi0->getEthPorts();
+	pair<string, unsigned int> wireless_port_lsi0;
+	
+	if(lsi0->hasWireless())
+		wireless_port_lsi0 = lsi0->getWirelessPort();
+
+	list<classified_rule_t> rules;
+	
+	list<highlevel::Rule> highLevelRules = graph->getRules();
+	for(list<highlevel::Rule>::iterator hlr = highLevelRules.begin(); hlr != highLevelRules.end(); hlr++)
+	{
+		highlevel::Match match = hlr->getMatch();
+		
+		classified_rule_t rule;
+		rule.graph = graph->getID();
+		rule.flow = hlr->getFlowID();
+		rule.priority = hlr->getPriority();
+		
+		if(match.matchOnPort())
+		{
+			rule.portName = match.getPhysicalPort();
+			if(ports_lsi0.count(rule.portName) != 0)
+				rule.port = ports_lsi0.find(rule.portName)->second;
+			else if(wireless_port_lsi0.first == rule.portName)
+				rule.port = wireless_port_lsi0.second;
+			else
+				//The port does not exist; this is detected by the graph manager
+				continue;
+		}
+		else if(match.matchOnEndPoint())
+		{
+			stringstream ss;
+			ss << match.getGraphID() << ":" << match.getEndPoint();
+			rule.portName = ss.str();
+			
+			if(graph->isDefinedHere(rule.portName) || endPointsDefinedInActions.count(rule.portName) == 0)
+				//The endpoint is used by this graph only
+				continue;
+			rule.port = endPointsDefinedInActions[rule.portName];
+		}
+		else
+			//The match is replaced with a virtual link of the tenant-LSI
+			continue;
+		
+		rule.match.setAllCommonFields(match);
+		rule.match.setInputPort(rule.port);
+		rules.push_back(rule);
+	}
+	
+	return rules;
+}
@@ -6,7 +6,9 @@
 #include <sstream>
 
 #include "graph_manager.h"
+#include "classifier_index.h"
 #include "../graph/high_level_graph/high_level_graph.h"
+#include "../graph/low_level_graph/group.h"
 
 class GraphTranslator
 {
@@ -32,6 +34,8 @@ protected:
 	*	@param: graph						High level graph to be translated
 	*	@param: tenantLSI					Information related to the LSI of the tenant
 	*	@param: lsi0						Information related to the LSI-0
+	*	@param: table						Table of the LSI-0 associated with the graph (see LSI0Pipeline)
+	*	@param: meter						Meter of the LSI-0 limiting the rate of the graph (0 if none)
 	*	@param:	endPointsDefinedInMatches	For each endpoint currently defined, contains the port
 	*										in the LSI-0 to be used to send packets on that endpoint
 	*	@param: endPointsDefinedInActions	For each endpoint currently defined, contains the port
@@ -43,6 +47,12 @@ protected:
 	*										a graph
 	*
 	*	@Translation rules:
+	*		The rules whose match is replaced with a virtual link (NF -> phyPort, NF -> endpoint) 
+	*		are inserted in the table LSI0_DISPATCH_TABLE, the others in the table of the graph.
+	*		The rules in the table of the graph (i.e., the traffic entering the graph) use the
+	*		meter of the graph, if any. The priority of all the rules is increased by
+	*		LSI0_GRAPH_PRIORITY_OFFSET (see LSI0Pipeline).
+	*
 	*		phyPort -> phyPort :
 	*			Each phyPort is translated into its port ID on LSI-0.
 	*			The other parameters expressed in the match are not
@@ -84,7 +94,7 @@ protected:
 	*				the LSI-0 side virtual link that "represents the NF" in LSI-0.
 	*				The other parameters expressed into the match are not changed
 	*/
-	static lowlevel::Graph lowerGraphToLSI0(highlevel::Graph *graph, LSI *tenantLSI, LSI *lsi0, map<string, unsigned int> endPointsDefinedInMatches, map<string, unsigned int> endPointsDefinedInActions, map<string, unsigned int > &availableEndPoints, bool creating = true);
+	static lowlevel::Graph lowerGraphToLSI0(highlevel::Graph *graph, LSI *tenantLSI, LSI *lsi0, uint8_t table, uint32_t meter, map<string, unsigned int> endPointsDefinedInMatches, map<string, unsigned int> endPointsDefinedInActions, map<string, unsigned int > &availableEndPoints, bool creating = true);
 	
 	/**
 	*	@brief: translate an high level graph into a rules to be sent to
@@ -93,6 +103,7 @@ protected:
 	*	@param: graph		High level graph to be translated
 	*	@graph: tenantLSI	Information related to the LSI of the tenant
 	*	@graph: lsi0		Information related to the LSI-0
+	*	@graph: replicas	Number of instances of the NFs (1 if not specified)
 	*
 	*	@Translation rules:
 	*		phyPort -> phyPort :
@@ -115,8 +126,44 @@ protected:
 	*			NF is translated into the port ID on tenant-LSI, while endpoint 
 	*			is rtanslated into the tenant side virtual link that "represents
 	*			the endpoint" in the tenant LSI.
+	*
+	*		In case of NF with replicas (see NFsManager::replicaName), an action on
+	*		a port of the NF is translated into the group of that port (see tenantGroups),
+	*		while a match on a port of the NF is translated into a rule for each replica.
+	*/
+	static lowlevel::Graph lowerGraphToTenantLSI(highlevel::Graph *graph, LSI *tenantLSI, LSI *lsi0, map<string, unsigned int> replicas);
+	
+	/**
+	*	@brief: return the select groups balancing the traffic among the replicas
+	*		of the NFs of a graph. Each port of a NF with replicas has a group, whose
+	*		NF_GROUP_BUCKETS buckets are the same port of the replicas, shared as in
+	*		Group::bucketsOwners; the ID of the group is the ID of the port of the NF
+	*		(i.e., of the replica 0) on the tenant-LSI.
+	*
+	*	@param: graph		High level graph
+	*	@graph: tenantLSI	Information related to the LSI of the tenant
+	*	@graph: replicas	Number of instances of the NFs (1 if not specified)
+	*/
+	static list<lowlevel::Group> tenantGroups(highlevel::Graph *graph, LSI *tenantLSI, map<string, unsigned int> replicas);
+	
+	/**
+	*	@brief: return the rules of an high level graph that, in the LSI-0, match
+	*		traffic received from a port shared with the other graphs (phyPort -> *,
+	*		and endpoint -> NF with the endpoint defined into another graph). These
+	*		rules do not depend on the tenant-LSI, hence they can be computed before
+	*		creating it
+	*
+	*	@param: graph						High level graph to be translated
+	*	@param: lsi0						Information related to the LSI-0
+	*	@param: endPointsDefinedInActions	See lowerGraphToLSI0
+	*/
+	static list<classified_rule_t> rulesOnSharedPorts(highlevel::Graph *graph, LSI *lsi0, map<string, unsigned int> endPointsDefinedInActions);
+
+private:
+	/**
+	*	@brief: return the number of instances of a NF
 	*/
-	static lowlevel::Graph lowerGraphToTenantLSI(highlevel::Graph *graph, LSI *tenantLSI, LSI *lsi0);
+	static unsigned int numberOfReplicas(map<string, unsigned int> &replicas, string nf);
 
 };
 
@@ -0,0 +1,136 @@
+#include "lsi0_pipeline.h"
+
+LSI0Pipeline::LSI0Pipeline()
+{
+	for(uint8_t t = LSI0_DISPATCH_TABLE + 1; t < LSI0_NUM_TABLES; t++)
+		graphsInTable[t] = 0;
+}
+
+uint8_t LSI0Pipeline::assignTable(string graphID)
+{
+	if(tables.count(graphID) != 0)
+		return tables[graphID];
+
+	uint8_t table = LSI0_DISPATCH_TABLE;
+	for(map<uint8_t, unsigned int>::iterator t = graphsInTable.begin(); t != graphsInTable.end(); t++)
+	{
+		if(t->second == 0)
+		{
+			table = t->first;
+			break;
+		}
+	}
+
+	tables[graphID] = table;
+
+	if(table == LSI0_DISPATCH_TABLE)
+	{
+		logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "All the %d tables of the LSI-0 for the graphs are used: the rules of the graph \"%s\" are inserted in the table %d, shared with the other graphs exceeding the tables",LSI0_NUM_TABLES - 1,graphID.c_str(),table);
+		return table;
+	}
+
+	graphsInTable[table]++;
+
+	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "The rules of the graph \"%s\" are inserted in the table %d of the LSI-0",graphID.c_str(),table);
+
+	return table;
+}
+
+uint8_t LSI0Pipeline::getTable(string graphID)
+{
+	assert(tables.count(graphID) != 0);
+	return tables[graphID];
+}
+
+void LSI0Pipeline::releaseTable(string graphID)
+{
+	if(tables.count(graphID) == 0)
+		return;
+
+	if(tables[graphID] != LSI0_DISPATCH_TABLE)
+		graphsInTable[tables[graphID]]--;
+	tables.erase(graphID);
+}
+
+void LSI0Pipeline::addRules(list<lowlevel::Rule> rules)
+{
+	for(list<lowlevel::Rule>::iterator r = rules.begin(); r != rules.end(); r++)
+	{
+		if(r->getTable() == LSI0_DISPATCH_TABLE || classificationRules.count(r->getID()) != 0)
+			continue;
+
+		unsigned int port = r->getMatch().getInputPort();
+		classificationRules[r->getID()] = make_pair(port,r->getTable());
+		rulesOnPort[port][r->getTable()]++;
+	}
+}
+
+void LSI0Pipeline::removeRules(list<lowlevel::Rule> rules)
+{
+	for(list<lowlevel::Rule>::iterator r = rules.begin(); r != rules.end(); r++)
+		removeRuleFromID(r->getID());
+}
+
+void LSI0Pipeline::removeRuleFromID(string ID)
+{
+	map<string, pair<unsigned int, uint8_t> >::iterator rule = classificationRules.find(ID);
+	if(rule == classificationRules.end())
+		//The rule is not in the table of a graph
+		return;
+
+	unsigned int port = rule->second.first;
+	uint8_t table = rule->second.second;
+	classificationRules.erase(rule);
+
+	assert(rulesOnPort[port][table] != 0);
+	if(--rulesOnPort[port][table] == 0)
+	{
+		rulesOnPort[port].erase(table);
+		if(rulesOnPort[port].empty())
+			rulesOnPort.erase(port);
+	}
+}
+
+void LSI0Pipeline::dispatchingChanges(list<lowlevel::Rule> &toBeInstalled, list<lowlevel::Rule> &toBeRemoved)
+{
+	//The packets received from a port go through the tables with rules on that
+	//port, in increasing order
+	map<pair<uint8_t, unsigned int>, uint8_t> required;
+	for(map<unsigned int, map<uint8_t, unsigned int> >::iterator p = rulesOnPort.begin(); p != rulesOnPort.end(); p++)
+	{
+		uint8_t previous = LSI0_DISPATCH_TABLE;
+		for(map<uint8_t, unsigned int>::iterator t = p->second.begin(); t != p->second.end(); t++)
+		{
+			required[make_pair(previous,p->first)] = t->first;
+			previous = t->first;
+		}
+	}
+
+	for(map<pair<uint8_t, unsigned int>, uint8_t>::iterator d = required.begin(); d != required.end(); d++)
+	{
+		map<pair<uint8_t, unsigned int>, uint8_t>::iterator current = dispatching.find(d->first);
+		if(current == dispatching.end() || current->second != d->second)
+			toBeInstalled.push_back(dispatchRule(d->first.first,d->first.second,d->second));
+	}
+
+	for(map<pair<uint8_t, unsigned int>, uint8_t>::iterator d = dispatching.begin(); d != dispatching.end(); d++)
+	{
+		if(required.count(d->first) == 0)
+			toBeRemoved.push_back(dispatchRule(d->first.first,d->first.second,d->second));
+	}
+
+	dispatching = required;
+
+	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Dispatching rules of the LSI-0: %d to be inserted, %d to be removed (%d in the LSI-0)",toBeInstalled.size(),toBeRemoved.size(),dispatching.size());
+}
+
+lowlevel::Rule LSI0Pipeline::dispatchRule(uint8_t table, unsigned int port, uint8_t next)
+{
+	lowlevel::Match match;
+	match.setInputPort(port);
+
+	stringstream ruleID;
+	ruleID << LSI0_DISPATCH_RULE << "_" << (unsigned int)table << "_" << port;
+
+	return lowlevel::Rule(match,lowlevel::Action::gotoTable(next),ruleID.str(),LSI0_DISPATCH_PRIORITY,table);
+}
@@ -0,0 +1,152 @@
+#ifndef LSI0_PIPELINE_H_
+#define LSI0_PIPELINE_H_ 1
+
+#pragma once
+
+#include <map>
+#include <set>
+#include <list>
+#include <string>
+#include <sstream>
+#include <inttypes.h>
+#include <assert.h>
+
+#include "../graph/low_level_graph/rule.h"
+#include "../utils/logger.h"
+#include "../utils/constants.h"
+
+using namespace std;
+
+/**
+*	@brief: number of tables of the LSI-0. It must be equal to NUM_TABLES in the
+*		xDPd plugin, which creates the LSIs
+*/
+#define LSI0_NUM_TABLES			8
+
+/**
+*	@brief: table in which the LSI-0 receives the packets
+*/
+#define LSI0_DISPATCH_TABLE		0
+
+/**
+*	@brief: priority of the rules sending the packets from a table to the next one.
+*		In the LSI-0, the priority of the rules of the graphs is increased by
+*		LSI0_GRAPH_PRIORITY_OFFSET, so that a dispatching rule never has the same
+*		priority of a rule of a graph; hence, the rules of a graph cannot have a
+*		priority higher than LSI0_MAX_GRAPH_PRIORITY
+*/
+#define LSI0_DISPATCH_PRIORITY		0
+#define LSI0_GRAPH_PRIORITY_OFFSET	1
+#define LSI0_MAX_GRAPH_PRIORITY		(0xFFFF - LSI0_GRAPH_PRIORITY_OFFSET)
+
+/**
+*	@brief: prefix of the ID of the rules sending the packets from a table to the
+*		next one
+*/
+#define LSI0_DISPATCH_RULE		"lsi0-dispatch"
+
+/**
+*	@brief: multi-table pipeline of the LSI-0.
+*
+*		The table LSI0_DISPATCH_TABLE contains the rules matching only a virtual link
+*		connected to a tenant-LSI (each one is used by a single graph), and the rules
+*		dispatching the packets received from the other ports (physical ports and
+*		endpoints) to the tables of the graphs.
+*		Each graph is associated with one of the other tables, which contains only
+*		its rules matching a physical port or an endpoint (with their detailed match),
+*		so that changing a graph does not rewrite the table of another one. When all
+*		these tables are used, the rules of the new graphs are inserted in the table
+*		LSI0_DISPATCH_TABLE, above the dispatching rules: the graphs in that table
+*		share it, but they do not touch the tables of the other graphs. A graph
+*		does not move to a table released later.
+*
+*		The packets received from a port used by the graphs of many tables go through
+*		those tables in increasing order: each table has a rule, with the lowest
+*		priority, sending the packets received from that port to the next table.
+*
+*		This class only tracks the tables and the rules; the rules are inserted in the
+*		LSI-0 by the GraphManager.
+*/
+class LSI0Pipeline
+{
+private:
+	/**
+	*	@brief: table of each graph
+	*/
+	map<string, uint8_t> tables;
+
+	/**
+	*	@brief: number of graphs using each table
+	*/
+	map<uint8_t, unsigned int> graphsInTable;
+
+	/**
+	*	@brief: input port and table of each rule inserted in the table of a graph,
+	*		indexed by the ID of the rule
+	*/
+	map<string, pair<unsigned int, uint8_t> > classificationRules;
+
+	/**
+	*	@brief: number of rules in each table for each input port
+	*/
+	map<unsigned int, map<uint8_t, unsigned int> > rulesOnPort;
+
+	/**
+	*	@brief: dispatching rules currently in the LSI-0. The pair <table, port> is
+	*		associated with the table to which the packets are sent
+	*/
+	map<pair<uint8_t, unsigned int>, uint8_t> dispatching;
+
+	/**
+	*	@brief: create a rule sending the packets received from a port to another table
+	*/
+	lowlevel::Rule dispatchRule(uint8_t table, unsigned int port, uint8_t next);
+
+public:
+	LSI0Pipeline();
+
+	/**
+	*	@brief: associate a graph with a table not used by other graphs, or with
+	*		LSI0_DISPATCH_TABLE if all the tables are used
+	*
+	*	@param: graphID	Identifier of the graph
+	*/
+	uint8_t assignTable(string graphID);
+
+	/**
+	*	@brief: return the table associated with a graph
+	*/
+	uint8_t getTable(string graphID);
+
+	/**
+	*	@brief: the graph no longer uses its table
+	*/
+	void releaseTable(string graphID);
+
+	/**
+	*	@brief: account the rules inserted in the LSI-0
+	*/
+	void addRules(list<lowlevel::Rule> rules);
+
+	/**
+	*	@brief: account the rules removed from the LSI-0
+	*/
+	void removeRules(list<lowlevel::Rule> rules);
+
+	/**
+	*	@brief: account a rule removed from the LSI-0
+	*/
+	void removeRuleFromID(string ID);
+
+	/**
+	*	@brief: return the dispatching rules to be inserted (or replaced) and removed
+	*		in the LSI-0 after the rules have been added or removed
+	*
+	*	@param: toBeInstalled	Rules to be inserted, or to replace the rules with the
+	*							same ID
+	*	@param: toBeRemoved		Rules to be removed
+	*/
+	void dispatchingChanges(list<lowlevel::Rule> &toBeInstalled, list<lowlevel::Rule> &toBeRemoved);
+};
+
+#endif //LSI0_PIPELINE_H_
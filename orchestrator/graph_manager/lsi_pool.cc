@@ -0,0 +1,159 @@
+#include "lsi_pool.h"
+
+PooledLSI::PooledLSI() :
+	lsi(NULL), controller(NULL)
+{
+
+}
+
+LSIPool::LSIPool(unsigned int size) :
+	size(size), refilling(0), terminating(false), hits(0), misses(0), totalClaimTime(0), maxClaimTime(0)
+{
+	pthread_mutex_init(&pool_mutex, NULL);
+	pthread_cond_init(&refill_cond, NULL);
+}
+
+LSIPool::~LSIPool()
+{
+	pthread_cond_destroy(&refill_cond);
+	pthread_mutex_destroy(&pool_mutex);
+}
+
+bool LSIPool::isEnabled()
+{
+	return (size != 0);
+}
+
+bool LSIPool::claim(PooledLSI &pooled)
+{
+	pthread_mutex_lock(&pool_mutex);
+
+	if(ready.empty())
+	{
+		pthread_mutex_unlock(&pool_mutex);
+		return false;
+	}
+
+	pooled = ready.front();
+	ready.pop_front();
+
+	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "LSI claimed from the pool; %d LSIs still available",ready.size());
+
+	pthread_mutex_unlock(&pool_mutex);
+
+	return true;
+}
+
+unsigned int LSIPool::startRefill()
+{
+	pthread_mutex_lock(&pool_mutex);
+
+	unsigned int missing = 0;
+	if(!terminating && (ready.size() + refilling) < size)
+		missing = size - (ready.size() + refilling);
+	refilling += missing;
+
+	pthread_mutex_unlock(&pool_mutex);
+
+	return missing;
+}
+
+bool LSIPool::isTerminating()
+{
+	pthread_mutex_lock(&pool_mutex);
+	bool retVal = terminating;
+	pthread_mutex_unlock(&pool_mutex);
+	
+	return retVal;
+}
+
+void LSIPool::refillCompleted(PooledLSI pooled, bool ok)
+{
+	pthread_mutex_lock(&pool_mutex);
+
+	assert(refilling > 0);
+	refilling--;
+
+	//If the orchestrator is terminating, the LSI is inserted anyway, so that it is returned by drain()
+	if(ok)
+	{
+		ready.push_back(pooled);
+		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "New LSI inserted in the pool; %d LSIs available",ready.size());
+	}
+
+	pthread_cond_broadcast(&refill_cond);
+	pthread_mutex_unlock(&pool_mutex);
+}
+
+list<PooledLSI> LSIPool::drain()
+{
+	pthread_mutex_lock(&pool_mutex);
+
+	terminating = true;
+	while(refilling != 0)
+		pthread_cond_wait(&refill_cond, &pool_mutex);
+
+	list<PooledLSI> retVal = ready;
+	ready.clear();
+
+	pthread_mutex_unlock(&pool_mutex);
+
+	return retVal;
+}
+
+void LSIPool::recordClaim(bool hit, uint64_t usec)
+{
+	pthread_mutex_lock(&pool_mutex);
+
+	if(hit)
+		hits++;
+	else
+		misses++;
+
+	totalClaimTime += usec;
+	if(usec > maxClaimTime)
+		maxClaimTime = usec;
+
+	logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "LSI ready in %llu us (pool %s)",(unsigned long long)usec,(hit)? "hit" : "miss");
+
+	pthread_mutex_unlock(&pool_mutex);
+
+	printStatistics();
+}
+
+Object LSIPool::toJSON()
+{
+	Object json;
+
+	pthread_mutex_lock(&pool_mutex);
+
+	unsigned int claims = hits + misses;
+	json["enabled"] = (size != 0);
+	json["size"] = (uint64_t)size;
+	json["ready"] = (uint64_t)ready.size();
+	json["refilling"] = (uint64_t)refilling;
+	json["hits"] = (uint64_t)hits;
+	json["misses"] = (uint64_t)misses;
+	json["hit-rate"] = (claims != 0)? (double)hits / claims : 0.0;
+	json["average-claim-time"] = (claims != 0)? totalClaimTime / claims : (uint64_t)0;
+	json["max-claim-time"] = maxClaimTime;
+
+	pthread_mutex_unlock(&pool_mutex);
+
+	return json;
+}
+
+void LSIPool::printStatistics()
+{
+	pthread_mutex_lock(&pool_mutex);
+
+	unsigned int claims = hits + misses;
+	if(claims != 0)
+	{
+		logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "LSI pool statistics:");
+		logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "\thit rate: %.1f%% (%d hits, %d misses)",(100.0*hits)/claims,hits,misses);
+		logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "\tclaim latency: %llu us average, %llu us max",(unsigned long long)(totalClaimTime/claims),(unsigned long long)maxClaimTime);
+	}
+
+	pthread_mutex_unlock(&pool_mutex);
+}
@@ -0,0 +1,134 @@
+#ifndef LSI_POOL_H_
+#define LSI_POOL_H_ 1
+
+#pragma once
+
+#include <list>
+#include <inttypes.h>
+#include <pthread.h>
+
+#include "../controller/controller.h"
+#include "../xdpd_manager/lsi.h"
+#include "../utils/logger.h"
+#include "../utils/constants.h"
+
+#include <json_spirit/json_spirit.h>
+#include <json_spirit/value.h>
+#include <json_spirit/writer.h>
+
+using namespace std;
+using namespace json_spirit;
+
+class Controller;
+
+/**
+*	@brief: empty tenant-LSI, already connected to the LSI-0 through some spare virtual links
+*		and to its own (running) Openflow controller, waiting to be claimed by a new graph
+*/
+class PooledLSI
+{
+public:
+	LSI *lsi;
+	Controller *controller;
+
+	PooledLSI();
+};
+
+/**
+*	@brief: warm pool of tenant-LSIs. The pool itself only stores the LSIs and the statistics;
+*		the LSIs are created (in background) and customized by the GraphManager.
+*		All the methods are thread safe.
+*/
+class LSIPool
+{
+private:
+	/**
+	*	@brief: number of LSIs to be kept ready. The pool is disabled if it is 0
+	*/
+	unsigned int size;
+
+	/**
+	*	@brief: LSIs ready to be claimed
+	*/
+	list<PooledLSI> ready;
+
+	/**
+	*	@brief: number of LSIs currently being created in background
+	*/
+	unsigned int refilling;
+
+	/**
+	*	@brief: true when the orchestrator is terminating; in this case the pool
+	*		is no longer refilled
+	*/
+	bool terminating;
+
+	pthread_mutex_t pool_mutex;
+	pthread_cond_t refill_cond;
+
+	/**
+	*	@brief: statistics on the claims
+	*/
+	unsigned int hits;
+	unsigned int misses;
+	uint64_t totalClaimTime;
+	uint64_t maxClaimTime;
+
+public:
+	LSIPool(unsigned int size = 0);
+	~LSIPool();
+
+	bool isEnabled();
+
+	/**
+	*	@brief: remove an LSI from the pool, if available
+	*
+	*	@param: pooled	Filled with the claimed LSI
+	*	@return: false if the pool is empty (or disabled)
+	*/
+	bool claim(PooledLSI &pooled);
+
+	/**
+	*	@brief: return the number of LSIs that must be created to fill the pool. These
+	*		LSIs are considered as being created until refillCompleted is called
+	*/
+	unsigned int startRefill();
+
+	/**
+	*	@brief: return true if the orchestrator is terminating. In this case, the LSIs
+	*		whose creation has been started with startRefill should not be created
+	*/
+	bool isTerminating();
+
+	/**
+	*	@brief: notify that the creation of an LSI started with startRefill is over
+	*
+	*	@param: pooled	The new LSI
+	*	@param: ok		False if the LSI has not been created
+	*/
+	void refillCompleted(PooledLSI pooled, bool ok);
+
+	/**
+	*	@brief: wait for the LSIs being created, and return all the LSIs of the pool,
+	*		that must be destroyed by the caller
+	*/
+	list<PooledLSI> drain();
+
+	/**
+	*	@brief: account the time needed to provide a new graph with its LSI
+	*
+	*	@param: hit		True if the LSI has been taken from the pool
+	*	@param: usec	Time (in microseconds) needed to obtain a ready LSI
+	*/
+	void recordClaim(bool hit, uint64_t usec);
+
+	void printStatistics();
+
+	/**
+	*	@brief: create the JSON representation of the state of the pool, and of the
+	*		statistics on the claims (hit rate and time needed to obtain an LSI)
+	*/
+	Object toJSON();
+};
+
+#endif //LSI_POOL_H_
@@ -0,0 +1,102 @@
+#include "resource_tracker.h"
+
+VLinkEvent::VLinkEvent(vlink_event_t type, vlink_resource_t resource, string name) :
+	type(type), resource(resource), name(name)
+{
+
+}
+
+ResourceTracker::ResourceTracker()
+{
+
+}
+
+list<VLinkEvent> ResourceTracker::addRule(highlevel::Rule rule)
+{
+	return updateRule(rule,true);
+}
+
+list<VLinkEvent> ResourceTracker::removeRule(highlevel::Rule rule)
+{
+	return updateRule(rule,false);
+}
+
+list<VLinkEvent> ResourceTracker::updateRule(highlevel::Rule rule, bool added)
+{
+	list<VLinkEvent> events;
+
+	highlevel::Action *action = rule.getAction();
+	highlevel::Match match = rule.getMatch();
+
+	if(action->getType() == highlevel::ACTION_ON_NETWORK_FUNCTION)
+	{
+		if(match.matchOnPort() || match.matchOnEndPoint())
+		{
+			highlevel::ActionNetworkFunction *action_nf = (highlevel::ActionNetworkFunction*)action;
+			stringstream ss;
+			ss << action->getInfo() << "_" << action_nf->getPort();
+			update(nfPorts,VLINK_FOR_NF_PORT,ss.str(),added,events);
+		}
+	}
+	else if(action->getType() == highlevel::ACTION_ON_PORT)
+	{
+		//The virtual link of the port is counted whatever the match is
+		update(ports,VLINK_FOR_PORT,action->getInfo(),added,events);
+	}
+	else if(action->getType() == highlevel::ACTION_ON_ENDPOINT)
+	{
+		assert(match.matchOnNF());
+		update(endpoints,VLINK_FOR_ENDPOINT,action->toString(),added,events);
+	}
+
+	return events;
+}
+
+void ResourceTracker::update(map<string, unsigned int> &counters, vlink_resource_t resource, string name, bool increment, list<VLinkEvent> &events)
+{
+	if(increment)
+	{
+		counters[name]++;
+		if(counters[name] == 1)
+		{
+			logger(ORCH_DEBUG, MODULE_NAME, __FILE__, __LINE__, "A virtual link is needed for '%s'",name.c_str());
+			events.push_back(VLinkEvent(VLINK_NEEDED,resource,name));
+		}
+		return;
+	}
+
+	map<string, unsigned int>::iterator counter = counters.find(name);
+	assert(counter != counters.end() && counter->second > 0);
+
+	counter->second--;
+	if(counter->second == 0)
+	{
+		logger(ORCH_DEBUG, MODULE_NAME, __FILE__, __LINE__, "The virtual link is no longer needed for '%s'",name.c_str());
+		counters.erase(counter);
+		events.push_back(VLinkEvent(VLINK_NO_LONGER_NEEDED,resource,name));
+	}
+}
+
+set<string> ResourceTracker::getNFPorts()
+{
+	set<string> retval;
+	for(map<string, unsigned int>::iterator it = nfPorts.begin(); it != nfPorts.end(); it++)
+		retval.insert(it->first);
+	return retval;
+}
+
+set<string> ResourceTracker::getPorts()
+{
+	set<string> retval;
+	for(map<string, unsigned int>::iterator it = ports.begin(); it != ports.end(); it++)
+		retval.insert(it->first);
+	return retval;
+}
+
+set<string> ResourceTracker::getEndPoints()
+{
+	set<string> retval;
+	for(map<string, unsigned int>::iterator it = endpoints.begin(); it != endpoints.end(); it++)
+		retval.insert(it->first);
+	return retval;
+}
@@ -0,0 +1,122 @@
+#ifndef RESOURCE_TRACKER_H_
+#define RESOURCE_TRACKER_H_ 1
+
+#pragma once
+
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <sstream>
+
+#include "../graph/high_level_graph/high_level_rule.h"
+#include "../graph/high_level_graph/high_level_action_nf.h"
+#include "../graph/high_level_graph/high_level_action_port.h"
+#include "../graph/high_level_graph/high_level_action_endpoint.h"
+#include "../utils/logger.h"
+#include "../utils/constants.h"
+
+using namespace std;
+
+typedef enum{VLINK_NEEDED,VLINK_NO_LONGER_NEEDED}vlink_event_t;
+
+typedef enum{VLINK_FOR_NF_PORT,VLINK_FOR_PORT,VLINK_FOR_ENDPOINT}vlink_resource_t;
+
+/**
+*	@brief: notification generated by the resource tracker when the first rule requiring
+*		a virtual link for a resource appears in the graph, or when the last one disappears
+*/
+class VLinkEvent
+{
+public:
+	vlink_event_t type;
+
+	vlink_resource_t resource;
+
+	/**
+	*	Name of the resource: "NF_port" for a NF port, the name of the physical
+	*	port, or "graphID:endpoint" for an endpoint
+	*/
+	string name;
+
+	VLinkEvent(vlink_event_t type, vlink_resource_t resource, string name);
+};
+
+/**
+*	@brief: keeps track, for a tenant-LSI, of the rules that require a virtual link
+*		towards the LSI-0. In particular:
+*			- an action on a NF port associated with a match on a physical port or on
+*			  an endpoint requires a virtual link for the NF port
+*			- an action on a physical port requires a virtual link for the physical
+*			  port, whatever the match of the rule is
+*			- an action on an endpoint (whose match is on a NF) requires a virtual link
+*			  for the endpoint
+*		Many rules can share the same virtual link, hence each resource has a counter;
+*		an event is generated only when the counter moves from 0 to 1 and viceversa, so
+*		that the work done when a graph changes is proportional to the change itself.
+*/
+class ResourceTracker
+{
+private:
+	/**
+	*	@brief: number of rules requiring the virtual link of a NF port (in the form NF_port)
+	*/
+	map<string, unsigned int> nfPorts;
+
+	/**
+	*	@brief: number of rules requiring the virtual link of a physical port
+	*/
+	map<string, unsigned int> ports;
+
+	/**
+	*	@brief: number of rules requiring the virtual link of an endpoint (in the form graphID:endpoint)
+	*/
+	map<string, unsigned int> endpoints;
+
+	/**
+	*	@brief: increment or decrement the counter of a resource, and generate an event
+	*		if the resource starts or stops requiring a virtual link
+	*/
+	void update(map<string, unsigned int> &counters, vlink_resource_t resource, string name, bool increment, list<VLinkEvent> &events);
+
+	/**
+	*	@brief: update the counters with the resource (if any) used by a rule
+	*/
+	list<VLinkEvent> updateRule(highlevel::Rule rule, bool added);
+
+public:
+	ResourceTracker();
+
+	/**
+	*	@brief: account a rule that has been added to the graph
+	*
+	*	@param: rule	Rule added to the graph
+	*	@return: the virtual links that are needed because of the new rule
+	*/
+	list<VLinkEvent> addRule(highlevel::Rule rule);
+
+	/**
+	*	@brief: account a rule that has been removed from the graph
+	*
+	*	@param: rule	Rule removed from the graph
+	*	@return: the virtual links that are no longer needed because of the removal
+	*/
+	list<VLinkEvent> removeRule(highlevel::Rule rule);
+
+	/**
+	*	@brief: return the NF ports currently requiring a virtual link
+	*/
+	set<string> getNFPorts();
+
+	/**
+	*	@brief: return the physical ports currently requiring a virtual link
+	*/
+	set<string> getPorts();
+
+	/**
+	*	@brief: return the endpoints currently requiring a virtual link
+	*/
+	set<string> getEndPoints();
+};
+
+#endif //RESOURCE_TRACKER_H_
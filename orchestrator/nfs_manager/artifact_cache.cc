@@ -0,0 +1,268 @@
+#include "artifact_cache.h"
+
+pthread_mutex_t ArtifactCache::cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t ArtifactCache::fetched_cond = PTHREAD_COND_INITIALIZER;
+map<pair<nf_t, string>, artifact_t> ArtifactCache::artifacts;
+uint64_t ArtifactCache::hits = 0;
+uint64_t ArtifactCache::misses = 0;
+uint64_t ArtifactCache::coalesced = 0;
+uint64_t ArtifactCache::failures = 0;
+uint64_t ArtifactCache::prefetches = 0;
+
+void ArtifactCache::init()
+{
+	if(mkdir(ARTIFACT_CACHE_DIR, 0755) != 0 && errno != EEXIST)
+		logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "Cannot create the directory of the NF cache \"%s\"",ARTIFACT_CACHE_DIR);
+
+	pthread_mutex_lock(&cache_mutex);
+
+	//Each line of the index is: <type> <digest> <URI>
+	ifstream index(ARTIFACT_CACHE_INDEX);
+	string line;
+	unsigned int loaded = 0;
+	while(getline(index,line))
+	{
+		stringstream ss(line);
+		string type, digest, uri;
+		if(!(ss >> type >> digest >> uri))
+			continue;
+
+		artifact_t artifact;
+		artifact.state = ARTIFACT_READY;
+		artifact.digest = digest;
+		artifact.hits = 0;
+		if(type == "dpdk")
+		{
+			artifact.path = string(ARTIFACT_CACHE_DIR) + "/" + digest;
+			//The executable may have been removed
+			if(access(artifact.path.c_str(), X_OK) != 0)
+				continue;
+			artifacts[make_pair(DPDK,uri)] = artifact;
+		}
+		else if(type == "docker")
+		{
+			artifact.path = uri;
+			artifacts[make_pair(DOCKER,uri)] = artifact;
+		}
+		else
+			continue;
+		loaded++;
+	}
+
+	pthread_mutex_unlock(&cache_mutex);
+
+	logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "%u NF artifacts found in the cache",loaded);
+}
+
+bool ArtifactCache::isCacheable(nf_t type)
+{
+	return type == DPDK || type == DOCKER;
+}
+
+bool ArtifactCache::fetch(nf_t type, string uri, string &path)
+{
+	return get(type,uri,path,false);
+}
+
+bool ArtifactCache::get(nf_t type, string uri, string &path, bool prefetch)
+{
+	assert(isCacheable(type));
+
+	pair<nf_t, string> key = make_pair(type,uri);
+
+	pthread_mutex_lock(&cache_mutex);
+
+	map<pair<nf_t, string>, artifact_t>::iterator a = artifacts.find(key);
+	if(a != artifacts.end() && a->second.state == ARTIFACT_READY && type == DPDK && access(a->second.path.c_str(), X_OK) != 0)
+	{
+		logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "The executable \"%s\" has been removed from the cache",a->second.path.c_str());
+		artifacts.erase(a);
+		a = artifacts.end();
+	}
+
+	if(a != artifacts.end() && a->second.state == ARTIFACT_FETCHING)
+	{
+		//Someone else is retrieving the artifact
+		if(!prefetch)
+			coalesced++;
+		while(a->second.state == ARTIFACT_FETCHING)
+			pthread_cond_wait(&fetched_cond, &cache_mutex);
+		if(a->second.state == ARTIFACT_READY && !prefetch)
+			a->second.hits++;
+	}
+	else if(a != artifacts.end() && a->second.state == ARTIFACT_READY)
+	{
+		if(!prefetch)
+		{
+			hits++;
+			a->second.hits++;
+		}
+	}
+	else
+	{
+		//The artifact is not in the cache, or its last retrieval failed
+		if(prefetch)
+			prefetches++;
+		else
+			misses++;
+
+		artifact_t &artifact = artifacts[key];
+		artifact.state = ARTIFACT_FETCHING;
+		artifact.hits = 0;
+
+		//The script is executed without holding the lock
+		pthread_mutex_unlock(&cache_mutex);
+		string digest;
+		bool ok = runFetch(type,uri,digest);
+		pthread_mutex_lock(&cache_mutex);
+
+		a = artifacts.find(key);
+		assert(a != artifacts.end());
+		if(ok)
+		{
+			a->second.state = ARTIFACT_READY;
+			a->second.digest = digest;
+			a->second.path = (type == DPDK)? string(ARTIFACT_CACHE_DIR) + "/" + digest : uri;
+			if(!prefetch)
+				a->second.hits++;
+			saveIndex();
+		}
+		else
+		{
+			a->second.state = ARTIFACT_FAILED;
+			failures++;
+		}
+		pthread_cond_broadcast(&fetched_cond);
+	}
+
+	bool ready = (a->second.state == ARTIFACT_READY);
+	if(ready)
+		path = a->second.path;
+
+	pthread_mutex_unlock(&cache_mutex);
+
+	if(!ready)
+		logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "The %s artifact \"%s\" cannot be retrieved",NFType::toString(type).c_str(),uri.c_str());
+
+	return ready;
+}
+
+bool ArtifactCache::runFetch(nf_t type, string uri, string &digest)
+{
+	stringstream command;
+	if(type == DPDK)
+		command << FETCH_DPDK_NF << " " << uri << " " << ARTIFACT_CACHE_DIR;
+	else
+		command << FETCH_DOCKER_NF << " " << uri;
+
+	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Executing command \"%s\"",command.str().c_str());
+
+	FILE *output = popen(command.str().c_str(), "r");
+	if(output == NULL)
+	{
+		logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "Cannot execute \"%s\"",command.str().c_str());
+		return false;
+	}
+
+	//The last line printed by the script is the digest of the artifact
+	char line[BUFFER_SIZE];
+	string last;
+	while(fgets(line, sizeof(line), output) != NULL)
+	{
+		last = line;
+		while(!last.empty() && (last[last.size() - 1] == '\n' || last[last.size() - 1] == '\r'))
+			last.erase(last.size() - 1);
+		logger(ORCH_DEBUG, MODULE_NAME, __FILE__, __LINE__, "%s",last.c_str());
+	}
+
+	int retVal = pclose(output);
+	retVal = retVal >> 8;
+
+	//The scripts return 1 in case of success
+	if(retVal != 1 || last.empty() || last.find(' ') != string::npos)
+		return false;
+
+	digest = last;
+	return true;
+}
+
+void ArtifactCache::saveIndex()
+{
+	string tmp = string(ARTIFACT_CACHE_INDEX) + ".tmp";
+	ofstream index(tmp.c_str());
+
+	for(map<pair<nf_t, string>, artifact_t>::iterator a = artifacts.begin(); a != artifacts.end(); a++)
+	{
+		if(a->second.state == ARTIFACT_READY)
+			index << NFType::toString(a->first.first) << " " << a->second.digest << " " << a->first.second << endl;
+	}
+	index.close();
+
+	if(index.fail() || rename(tmp.c_str(), ARTIFACT_CACHE_INDEX) != 0)
+		logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "Cannot write the index of the NF cache \"%s\"",ARTIFACT_CACHE_INDEX);
+}
+
+bool ArtifactCache::prefetch(nf_t type, string uri)
+{
+	if(!isCacheable(type))
+		return false;
+
+	pthread_t thread;
+	pair<nf_t, string> *arg = new pair<nf_t, string>(type,uri);
+	if(pthread_create(&thread, NULL, &prefetchThread, (void*)arg) != 0)
+	{
+		logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "An error occurred while creating a new thread to prefetch \"%s\"",uri.c_str());
+		delete(arg);
+		return false;
+	}
+	pthread_detach(thread);
+
+	return true;
+}
+
+void *ArtifactCache::prefetchThread(void *arg)
+{
+	pair<nf_t, string> *artifact = (pair<nf_t, string>*)arg;
+	string path;
+
+	if(get(artifact->first,artifact->second,path,true))
+		logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "The %s artifact \"%s\" is in the cache",NFType::toString(artifact->first).c_str(),artifact->second.c_str());
+
+	delete(artifact);
+	return NULL;
+}
+
+Object ArtifactCache::toJSON()
+{
+	Object json;
+	Array artifacts_array;
+
+	pthread_mutex_lock(&cache_mutex);
+
+	for(map<pair<nf_t, string>, artifact_t>::iterator a = artifacts.begin(); a != artifacts.end(); a++)
+	{
+		Object artifact;
+		artifact["type"] = NFType::toString(a->first.first);
+		artifact["uri"] = a->first.second;
+		artifact["state"] = (a->second.state == ARTIFACT_READY)? "ready" : ((a->second.state == ARTIFACT_FETCHING)? "fetching" : "failed");
+		if(a->second.state == ARTIFACT_READY)
+			artifact["digest"] = a->second.digest;
+		artifact["hits"] = a->second.hits;
+		artifacts_array.push_back(artifact);
+	}
+
+	uint64_t requests = hits + misses + coalesced;
+	json["hits"] = hits;
+	json["misses"] = misses;
+	json["coalesced"] = coalesced;
+	json["failures"] = failures;
+	json["prefetches"] = prefetches;
+	//A request that waited for a retrieval in progress did not start a new one
+	json["hit-rate"] = (requests != 0)? (double)(hits + coalesced) / requests : 0.0;
+
+	pthread_mutex_unlock(&cache_mutex);
+
+	json["artifacts"] = artifacts_array;
+
+	return json;
+}
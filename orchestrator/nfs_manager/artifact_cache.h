@@ -0,0 +1,169 @@
+#ifndef ARTIFACT_CACHE_H_
+#define ARTIFACT_CACHE_H_ 1
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <inttypes.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <assert.h>
+
+#include "../utils/logger.h"
+#include "../utils/constants.h"
+#include "nf_type.h"
+
+#include <json_spirit/json_spirit.h>
+#include <json_spirit/value.h>
+#include <json_spirit/writer.h>
+
+using namespace std;
+using namespace json_spirit;
+
+/**
+*	@brief: directory of the cache, and file listing the artifacts in the cache
+*/
+#define ARTIFACT_CACHE_DIR		"./nfs_cache"
+#define ARTIFACT_CACHE_INDEX	"./nfs_cache/index"
+
+/**
+*	@brief: scripts retrieving an artifact. The last line printed by a script is
+*		the digest of the artifact
+*/
+#define FETCH_DPDK_NF			"./nfs_manager/scripts/dpdk/fetchNF.sh"
+#define FETCH_DOCKER_NF			"./nfs_manager/scripts/docker/fetchNF.sh"
+
+typedef enum{ARTIFACT_FETCHING,ARTIFACT_READY,ARTIFACT_FAILED}artifact_state_t;
+
+/**
+*	@brief: an artifact (executable of a DPDK NF, or Docker image) in the cache
+*/
+typedef struct
+{
+	artifact_state_t state;
+
+	/**
+	*	@brief: SHA-256 of the executable (DPDK), or ID of the image (Docker)
+	*/
+	string digest;
+
+	/**
+	*	@brief: what is given to the script starting an instance: the path of the
+	*		executable in the cache (DPDK), or the name of the image (Docker)
+	*/
+	string path;
+
+	/**
+	*	@brief: instances started from the cached artifact
+	*/
+	uint64_t hits;
+}artifact_t;
+
+/**
+*	@brief: local cache of the artifacts of the NFs, so that they are retrieved once
+*		and not for each instance started.
+*
+*		The executables of the DPDK NFs are stored in ARTIFACT_CACHE_DIR, named after
+*		the SHA-256 of their content: the same executable retrieved from different
+*		URIs is stored once. Each instance runs a hard link to the cached executable.
+*		The Docker images are stored by Docker itself; the cache keeps track of the
+*		images already pulled, and of their ID.
+*
+*		An artifact can be retrieved in advance (prefetch), before the graphs using it
+*		arrive. If an artifact is requested while it is being retrieved, the request
+*		waits for the retrieval in progress instead of starting a new one.
+*
+*		The artifacts in the cache are listed in ARTIFACT_CACHE_INDEX, so that the
+*		cache survives a restart of the node orchestrator.
+*
+*		All the methods are thread safe.
+*/
+class ArtifactCache
+{
+private:
+	static pthread_mutex_t cache_mutex;
+	static pthread_cond_t fetched_cond;
+
+	/**
+	*	@brief: the artifacts, indexed by <type, URI>
+	*/
+	static map<pair<nf_t, string>, artifact_t> artifacts;
+
+	/**
+	*	@brief: requests for an artifact already in the cache, requests that retrieved
+	*		the artifact, requests that waited for a retrieval already in progress,
+	*		retrievals failed, and prefetches
+	*/
+	static uint64_t hits;
+	static uint64_t misses;
+	static uint64_t coalesced;
+	static uint64_t failures;
+	static uint64_t prefetches;
+
+	/**
+	*	@brief: retrieve an artifact, and return its digest. Returns false in case of
+	*		error
+	*/
+	static bool runFetch(nf_t type, string uri, string &digest);
+
+	/**
+	*	@brief: retrieve an artifact, if it is not in the cache yet
+	*
+	*	@param:	prefetch	True if no instance is waiting for the artifact (the
+	*						counters of the cache are not updated)
+	*/
+	static bool get(nf_t type, string uri, string &path, bool prefetch);
+
+	/**
+	*	@brief: write the index of the cache (the lock must be held)
+	*/
+	static void saveIndex();
+
+	static void *prefetchThread(void *arg);
+
+public:
+	/**
+	*	@brief: create the directory of the cache, and read its index
+	*/
+	static void init();
+
+	/**
+	*	@brief: return true if the artifacts of the NFs of a given type are cached
+	*/
+	static bool isCacheable(nf_t type);
+
+	/**
+	*	@brief: return the artifact to be used to start an instance of an NF,
+	*		retrieving it if it is not in the cache. This function blocks until the
+	*		artifact is available
+	*
+	*	@param:	type	Type of the NF
+	*	@param:	uri		URI of the artifact (file:// for a local DPDK executable)
+	*	@param:	path	Artifact to be given to the script starting the instance
+	*
+	*	@return: false if the artifact cannot be retrieved
+	*/
+	static bool fetch(nf_t type, string uri, string &path);
+
+	/**
+	*	@brief: start retrieving an artifact in background, if it is not in the cache
+	*
+	*	@return: false if the retrieval cannot be started
+	*/
+	static bool prefetch(nf_t type, string uri);
+
+	/**
+	*	@brief: JSON representation of the artifacts in the cache, and of the counters
+	*		of the cache
+	*/
+	static Object toJSON();
+};
+
+#endif //ARTIFACT_CACHE_H_
@@ -0,0 +1,158 @@
+#include "capabilities.h"
+
+pthread_mutex_t Capabilities::capabilities_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t Capabilities::refresh_cond = PTHREAD_COND_INITIALIZER;
+pthread_t Capabilities::refreshThread;
+bool Capabilities::started = false;
+bool Capabilities::stopping = false;
+bool Capabilities::refreshNeeded = false;
+bool Capabilities::dockerAvailable = false;
+bool Capabilities::kvmAvailable = false;
+map<pair<nf_t, string>, start_time_t> Capabilities::startTimes;
+
+void Capabilities::start()
+{
+	probe();
+
+	pthread_mutex_lock(&capabilities_mutex);
+	if(!started)
+	{
+		stopping = false;
+		if(pthread_create(&refreshThread, NULL, &refreshLoop, NULL) != 0)
+			logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "An error occurred while creating the thread probing the execution environments. They will not be probed again");
+		else
+			started = true;
+	}
+	pthread_mutex_unlock(&capabilities_mutex);
+}
+
+void Capabilities::stop()
+{
+	pthread_mutex_lock(&capabilities_mutex);
+	if(!started)
+	{
+		pthread_mutex_unlock(&capabilities_mutex);
+		return;
+	}
+	stopping = true;
+	pthread_cond_signal(&refresh_cond);
+	pthread_mutex_unlock(&capabilities_mutex);
+
+	pthread_join(refreshThread, NULL);
+	started = false;
+}
+
+void *Capabilities::refreshLoop(void *arg)
+{
+	(void)arg;
+
+	pthread_mutex_lock(&capabilities_mutex);
+	while(!stopping)
+	{
+		struct timespec deadline;
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_sec += CAPABILITIES_REFRESH_INTERVAL;
+
+		int ret = 0;
+		while(!stopping && !refreshNeeded && ret != ETIMEDOUT)
+			ret = pthread_cond_timedwait(&refresh_cond, &capabilities_mutex, &deadline);
+		if(stopping)
+			break;
+		refreshNeeded = false;
+
+		//The scripts are executed without holding the lock
+		pthread_mutex_unlock(&capabilities_mutex);
+		probe();
+		pthread_mutex_lock(&capabilities_mutex);
+	}
+	pthread_mutex_unlock(&capabilities_mutex);
+
+	return NULL;
+}
+
+void Capabilities::probe()
+{
+	bool docker = false, kvm = false;
+
+#ifdef ENABLE_DOCKER
+	docker = runCheck(CHECK_DOCKER);
+#endif
+#ifdef ENABLE_KVM
+	kvm = runCheck(CHECK_KVM);
+#endif
+
+	pthread_mutex_lock(&capabilities_mutex);
+	if(docker != dockerAvailable)
+		logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, (docker)? "Docker deamon is running." : "Docker deamon is not running (at least, it is not running with the LXC implementation).");
+	if(kvm != kvmAvailable)
+		logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, (kvm)? "KVM is running." : "KVM is not running.");
+	dockerAvailable = docker;
+	kvmAvailable = kvm;
+	pthread_mutex_unlock(&capabilities_mutex);
+}
+
+bool Capabilities::runCheck(const char *script)
+{
+	int retVal = system(script);
+	retVal = retVal >> 8;
+
+	logger(ORCH_DEBUG, MODULE_NAME, __FILE__, __LINE__, "Script \"%s\" returned: %d",script,retVal);
+
+	return retVal > 0;
+}
+
+bool Capabilities::isAvailable(nf_t type)
+{
+	bool available = true;
+
+	pthread_mutex_lock(&capabilities_mutex);
+	if(type == DOCKER)
+		available = dockerAvailable;
+	else if(type == KVM)
+		available = kvmAvailable;
+	pthread_mutex_unlock(&capabilities_mutex);
+
+	return available;
+}
+
+void Capabilities::reportFailure(nf_t type)
+{
+	if(type == DPDK)
+		return;
+
+	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "A %s NF cannot be started: the execution environment will be probed again",NFType::toString(type).c_str());
+
+	pthread_mutex_lock(&capabilities_mutex);
+	refreshNeeded = true;
+	pthread_cond_signal(&refresh_cond);
+	pthread_mutex_unlock(&capabilities_mutex);
+}
+
+void Capabilities::recordStartTime(nf_t type, string uri, double seconds)
+{
+	pthread_mutex_lock(&capabilities_mutex);
+
+	start_time_t &time = startTimes[make_pair(type,uri)];
+	if(time.samples == 0)
+		time.average = seconds;
+	else
+		time.average = (1 - START_TIME_WEIGHT) * time.average + START_TIME_WEIGHT * seconds;
+	time.samples++;
+
+	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "%s implementation \"%s\" started in %.3f s (average: %.3f s)",NFType::toString(type).c_str(),uri.c_str(),seconds,time.average);
+
+	pthread_mutex_unlock(&capabilities_mutex);
+}
+
+double Capabilities::getStartTime(nf_t type, string uri)
+{
+	double seconds = -1;
+
+	pthread_mutex_lock(&capabilities_mutex);
+	map<pair<nf_t, string>, start_time_t>::iterator time = startTimes.find(make_pair(type,uri));
+	if(time != startTimes.end())
+		seconds = time->second.average;
+	pthread_mutex_unlock(&capabilities_mutex);
+
+	return seconds;
+}
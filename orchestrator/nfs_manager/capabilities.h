@@ -0,0 +1,132 @@
+#ifndef CAPABILITIES_H_
+#define CAPABILITIES_H_ 1
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+
+#include "../utils/logger.h"
+#include "../utils/constants.h"
+#include "nf_type.h"
+
+using namespace std;
+
+/**
+*	@brief: scripts used to check if the execution environments are running
+*/
+#define CHECK_DOCKER			"./nfs_manager/scripts/docker/checkDockerRun.sh"
+#define CHECK_KVM				"./nfs_manager/scripts/kvm/checkKvmRun.sh"
+
+/**
+*	@brief: seconds between two consecutive probes of the execution environments
+*/
+#define CAPABILITIES_REFRESH_INTERVAL	60
+
+/**
+*	@brief: weight of a new sample in the average start time of an implementation
+*/
+#define START_TIME_WEIGHT				0.25
+
+/**
+*	@brief: average time needed to start an implementation
+*/
+typedef struct
+{
+	double average;
+	unsigned int samples;
+}start_time_t;
+
+/**
+*	@brief: execution environments (Docker, KVM) available on the node, and time
+*		needed to start the implementations of the NFs.
+*
+*		The execution environments are probed (with the CHECK_* scripts) when the
+*		service is started, and then by a background thread every
+*		CAPABILITIES_REFRESH_INTERVAL seconds, or as soon as an NF of a given type
+*		cannot be started. Then, the implementation of the NFs is selected without
+*		executing any script.
+*
+*		The DPDK environment (i.e., xDPd) is always available.
+*
+*		All the methods are thread safe.
+*/
+class Capabilities
+{
+private:
+	static pthread_mutex_t capabilities_mutex;
+	static pthread_cond_t refresh_cond;
+
+	static pthread_t refreshThread;
+	static bool started;
+	static bool stopping;
+
+	/**
+	*	@brief: true if a probe is needed before the next periodic one
+	*/
+	static bool refreshNeeded;
+
+	static bool dockerAvailable;
+	static bool kvmAvailable;
+
+	/**
+	*	@brief: average start time of the implementations, indexed by <type, URI>
+	*/
+	static map<pair<nf_t, string>, start_time_t> startTimes;
+
+	/**
+	*	@brief: probe the execution environments
+	*/
+	static void probe();
+
+	/**
+	*	@brief: execute a CHECK_* script; returns true if the environment is running
+	*/
+	static bool runCheck(const char *script);
+
+	static void *refreshLoop(void *arg);
+
+public:
+	/**
+	*	@brief: probe the execution environments, and start the background thread
+	*		refreshing them
+	*/
+	static void start();
+
+	/**
+	*	@brief: stop the background thread
+	*/
+	static void stop();
+
+	/**
+	*	@brief: return true if the NFs of a given type can be executed
+	*/
+	static bool isAvailable(nf_t type);
+
+	/**
+	*	@brief: notify that an NF of a given type cannot be started, so that the
+	*		execution environment is probed again
+	*/
+	static void reportFailure(nf_t type);
+
+	/**
+	*	@brief: record the time needed to start an implementation
+	*
+	*	@param:	type	Type of the implementation
+	*	@param:	uri		URI of the implementation
+	*	@param:	seconds	Time needed to start the implementation
+	*/
+	static void recordStartTime(nf_t type, string uri, double seconds);
+
+	/**
+	*	@brief: average time needed to start an implementation. Returns a negative
+	*		value if the implementation has never been started
+	*/
+	static double getStartTime(nf_t type, string uri);
+};
+
+#endif //CAPABILITIES_H_
@@ -0,0 +1,300 @@
+#include "core_allocator.h"
+
+pthread_mutex_t CoreAllocator::allocator_mutex = PTHREAD_MUTEX_INITIALIZER;
+map<unsigned int, core_t> CoreAllocator::cores;
+int CoreAllocator::preferredNode = -1;
+map<string, uint64_t> CoreAllocator::allocations;
+
+void CoreAllocator::init(uint64_t coreMask, list<string> interfaces)
+{
+	map<unsigned int, int> nodeOfCPU = readNodesOfCPUs();
+
+	pthread_mutex_lock(&allocator_mutex);
+
+	cores.clear();
+	allocations.clear();
+	for(unsigned int i = 0; i < 64; i++)
+	{
+		if(!(coreMask & ((uint64_t)1 << i)))
+			continue;
+
+		core_t core;
+		core.id = i;
+		core.node = (nodeOfCPU.count(i) != 0)? nodeOfCPU[i] : -1;
+		cores[i] = core;
+	}
+
+	//The preferred node is the one of most of the physical interfaces
+	map<int, unsigned int> interfacesOnNode;
+	for(list<string>::iterator i = interfaces.begin(); i != interfaces.end(); i++)
+	{
+		int node = interfaceNode(*i);
+		if(node >= 0)
+			interfacesOnNode[node]++;
+	}
+
+	preferredNode = -1;
+	unsigned int max = 0;
+	for(map<int, unsigned int>::iterator n = interfacesOnNode.begin(); n != interfacesOnNode.end(); n++)
+	{
+		if(n->second > max)
+		{
+			preferredNode = n->first;
+			max = n->second;
+		}
+	}
+
+	if(preferredNode >= 0)
+		logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "The physical interfaces are on the NUMA node %d",preferredNode);
+	else
+	{
+		preferredNode = readXDPDNode(nodeOfCPU);
+		if(preferredNode >= 0)
+			logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "The NUMA node of the physical interfaces is unknown; xDPd is running on the NUMA node %d",preferredNode);
+		else
+			logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "No NUMA node is preferred for the NFs");
+	}
+
+	for(map<unsigned int, core_t>::iterator c = cores.begin(); c != cores.end(); c++)
+		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Available core: %u (NUMA node %d)",c->first,c->second.node);
+
+	pthread_mutex_unlock(&allocator_mutex);
+}
+
+uint64_t CoreAllocator::allocate(string owner, unsigned int required)
+{
+	pthread_mutex_lock(&allocator_mutex);
+
+	if(allocations.count(owner) != 0)
+	{
+		//The NF already has its cores
+		uint64_t mask = allocations[owner];
+		pthread_mutex_unlock(&allocator_mutex);
+		return mask;
+	}
+
+	if(required == 0)
+		required = 1;
+	if(required > cores.size())
+	{
+		logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "The NF \"%s\" requires %u cores, but only %u are available",owner.c_str(),required,cores.size());
+		required = cores.size();
+	}
+
+	int node = selectNode(required);
+
+	//The cores are ordered by number of NFs using them, then by NUMA node (the
+	//selected one first), and finally by identifier
+	set<pair<pair<unsigned int, unsigned int>, unsigned int> > candidates;
+	for(map<unsigned int, core_t>::iterator c = cores.begin(); c != cores.end(); c++)
+		candidates.insert(make_pair(make_pair(c->second.owners.size(),(c->second.node == node)? 0 : 1),c->first));
+
+	uint64_t mask = 0;
+	unsigned int shared = 0;
+	set<pair<pair<unsigned int, unsigned int>, unsigned int> >::iterator c = candidates.begin();
+	for(unsigned int i = 0; i < required; i++, c++)
+	{
+		core_t &core = cores[c->second];
+		if(!core.owners.empty())
+			shared++;
+		core.owners.insert(owner);
+		mask |= (uint64_t)1 << core.id;
+	}
+	if(mask != 0)
+		allocations[owner] = mask;
+
+	pthread_mutex_unlock(&allocator_mutex);
+
+	if(shared != 0)
+		logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "Not enough free cores: the NF \"%s\" shares %u cores with other NFs",owner.c_str(),shared);
+	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "The NF \"%s\" requires %u cores. Its core mask is \"%" PRIx64 "\"",owner.c_str(),required,mask);
+
+	return mask;
+}
+
+void CoreAllocator::release(string owner)
+{
+	pthread_mutex_lock(&allocator_mutex);
+
+	if(allocations.count(owner) != 0)
+	{
+		for(map<unsigned int, core_t>::iterator c = cores.begin(); c != cores.end(); c++)
+			c->second.owners.erase(owner);
+		allocations.erase(owner);
+
+		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "The cores of the NF \"%s\" have been released",owner.c_str());
+	}
+
+	pthread_mutex_unlock(&allocator_mutex);
+}
+
+int CoreAllocator::selectNode(unsigned int required)
+{
+	map<int, unsigned int> freeCores;
+	for(map<unsigned int, core_t>::iterator c = cores.begin(); c != cores.end(); c++)
+	{
+		if(c->second.owners.empty())
+			freeCores[c->second.node]++;
+	}
+
+	if(freeCores[preferredNode] >= required)
+		return preferredNode;
+
+	int node = preferredNode;
+	unsigned int max = 0;
+	for(map<int, unsigned int>::iterator n = freeCores.begin(); n != freeCores.end(); n++)
+	{
+		if(n->second >= required && n->second > max)
+		{
+			node = n->first;
+			max = n->second;
+		}
+	}
+
+	return node;
+}
+
+Object CoreAllocator::toJSON()
+{
+	Object json;
+	Array cores_array;
+
+	pthread_mutex_lock(&allocator_mutex);
+
+	for(map<unsigned int, core_t>::iterator c = cores.begin(); c != cores.end(); c++)
+	{
+		Object core;
+		core["core"] = (uint64_t)c->first;
+		if(c->second.node >= 0)
+			core["numa-node"] = c->second.node;
+		core["state"] = (c->second.owners.empty())? "free" : ((c->second.owners.size() == 1)? "exclusive" : "shared");
+
+		Array owners;
+		for(set<string>::iterator o = c->second.owners.begin(); o != c->second.owners.end(); o++)
+			owners.push_back(*o);
+		core["nfs"] = owners;
+
+		cores_array.push_back(core);
+	}
+	if(preferredNode >= 0)
+		json["preferred-numa-node"] = preferredNode;
+
+	pthread_mutex_unlock(&allocator_mutex);
+
+	json["cores"] = cores_array;
+
+	return json;
+}
+
+int CoreAllocator::interfaceNode(string ifname)
+{
+	stringstream path;
+	path << SYSFS_NET << "/" << ifname << "/device/numa_node";
+
+	ifstream file(path.str().c_str());
+	int node = -1;
+	if(!(file >> node))
+		return -1;
+
+	return node;
+}
+
+map<unsigned int, int> CoreAllocator::readNodesOfCPUs()
+{
+	map<unsigned int, int> nodeOfCPU;
+
+	DIR *dir = opendir(SYSFS_NODES);
+	if(dir == NULL)
+	{
+		logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "Cannot read the NUMA topology from \"%s\"",SYSFS_NODES);
+		return nodeOfCPU;
+	}
+
+	struct dirent *entry;
+	while((entry = readdir(dir)) != NULL)
+	{
+		int node;
+		char *end;
+		if(strncmp(entry->d_name,"node",4) != 0)
+			continue;
+		node = strtol(entry->d_name + 4,&end,10);
+		if(end == entry->d_name + 4 || *end != '\0')
+			continue;
+
+		stringstream path;
+		path << SYSFS_NODES << "/" << entry->d_name << "/cpulist";
+		ifstream file(path.str().c_str());
+		string cpuList;
+		if(!getline(file,cpuList))
+			continue;
+
+		set<unsigned int> cpus = parseCPUList(cpuList);
+		for(set<unsigned int>::iterator c = cpus.begin(); c != cpus.end(); c++)
+			nodeOfCPU[*c] = node;
+	}
+	closedir(dir);
+
+	return nodeOfCPU;
+}
+
+set<unsigned int> CoreAllocator::parseCPUList(string cpuList)
+{
+	set<unsigned int> cpus;
+	stringstream ss(cpuList);
+	string range;
+
+	while(getline(ss,range,','))
+	{
+		unsigned int first, last;
+		int n = sscanf(range.c_str(),"%u-%u",&first,&last);
+		if(n < 1)
+			continue;
+		if(n == 1)
+			last = first;
+		for(unsigned int c = first; c <= last; c++)
+			cpus.insert(c);
+	}
+
+	return cpus;
+}
+
+int CoreAllocator::readXDPDNode(map<unsigned int, int> &nodeOfCPU)
+{
+	DIR *dir = opendir(PROCFS);
+	if(dir == NULL)
+		return -1;
+
+	int node = -1;
+	struct dirent *entry;
+	while(node < 0 && (entry = readdir(dir)) != NULL)
+	{
+		char *end;
+		strtol(entry->d_name,&end,10);
+		if(*end != '\0')
+			continue;
+
+		stringstream path;
+		path << PROCFS << "/" << entry->d_name << "/stat";
+		ifstream file(path.str().c_str());
+		string stat;
+		if(!getline(file,stat))
+			continue;
+
+		//The second field is the name of the process in brackets, and the 39th is the
+		//CPU on which the process has been executed most recently
+		size_t open = stat.find('(');
+		size_t close = stat.rfind(')');
+		if(open == string::npos || close == string::npos || stat.substr(open + 1,close - open - 1) != XDPD_PROCESS_NAME)
+			continue;
+
+		stringstream fields(stat.substr(close + 2));
+		string field;
+		unsigned int cpu;
+		for(int i = 3; i < 39 && (fields >> field); i++);
+		if(fields >> cpu && nodeOfCPU.count(cpu) != 0)
+			node = nodeOfCPU[cpu];
+	}
+	closedir(dir);
+
+	return node;
+}
@@ -0,0 +1,151 @@
+#ifndef CORE_ALLOCATOR_H_
+#define CORE_ALLOCATOR_H_ 1
+
+#pragma once
+
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <inttypes.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../utils/logger.h"
+#include "../utils/constants.h"
+
+#include <json_spirit/json_spirit.h>
+#include <json_spirit/value.h>
+#include <json_spirit/writer.h>
+
+using namespace std;
+using namespace json_spirit;
+
+/**
+*	@brief: sysfs and procfs files used to discover the NUMA topology
+*/
+#define SYSFS_NODES			"/sys/devices/system/node"
+#define SYSFS_NET			"/sys/class/net"
+#define PROCFS				"/proc"
+#define XDPD_PROCESS_NAME	"xdpd"
+
+/**
+*	@brief: a CPU core that can be allocated to DPDK NFs
+*/
+typedef struct
+{
+	unsigned int id;
+
+	/**
+	*	@brief: NUMA node of the core (-1 if unknown)
+	*/
+	int node;
+
+	/**
+	*	@brief: NFs using the core. A core is free if it has no owner, exclusive if it
+	*		has one owner, shared otherwise
+	*/
+	set<string> owners;
+}core_t;
+
+/**
+*	@brief: allocator of the CPU cores (given with the option --c of the node
+*		orchestrator) to the DPDK NFs.
+*
+*		The NUMA node of each core is read from sysfs. The cores are preferably
+*		allocated on the NUMA node of the physical NICs (or, if it is unknown, e.g.
+*		because the NICs are bound to the DPDK, on the node where xDPd is running),
+*		so that the packets do not cross the NUMA nodes.
+*
+*		An NF receives free cores if possible, all on the same NUMA node. When there
+*		are not enough free cores, the NF shares the least loaded ones with other NFs
+*		(the DPDK NFs back off when they do not receive packets). The cores are given
+*		back when the NF is stopped.
+*
+*		All the methods are thread safe.
+*/
+class CoreAllocator
+{
+private:
+	static pthread_mutex_t allocator_mutex;
+
+	/**
+	*	@brief: the cores that can be allocated, indexed by their identifier
+	*/
+	static map<unsigned int, core_t> cores;
+
+	/**
+	*	@brief: NUMA node preferred for the NFs (-1 if there is no preference)
+	*/
+	static int preferredNode;
+
+	/**
+	*	@brief: core mask allocated to each NF
+	*/
+	static map<string, uint64_t> allocations;
+
+	/**
+	*	@brief: read the NUMA node of each CPU from sysfs. Returns an empty map if
+	*		the system does not expose its NUMA topology
+	*/
+	static map<unsigned int, int> readNodesOfCPUs();
+
+	/**
+	*	@brief: parse a list of CPUs in the sysfs format (e.g., "0-3,8-11")
+	*/
+	static set<unsigned int> parseCPUList(string cpuList);
+
+	/**
+	*	@brief: NUMA node of the CPU on which xDPd has been running most recently
+	*		(-1 if unknown)
+	*/
+	static int readXDPDNode(map<unsigned int, int> &nodeOfCPU);
+
+	/**
+	*	@brief: select the node on which the cores of an NF requiring a given number
+	*		of cores are allocated: the preferred node if it has enough free cores,
+	*		otherwise the node with most free cores, if they are enough
+	*/
+	static int selectNode(unsigned int required);
+
+public:
+	/**
+	*	@brief: set the cores that can be allocated, and the NUMA node preferred for
+	*		the NFs
+	*
+	*	@param:	coreMask	Mask of the cores that can be allocated to DPDK NFs
+	*	@param:	interfaces	Physical interfaces managed by xDPd
+	*/
+	static void init(uint64_t coreMask, list<string> interfaces);
+
+	/**
+	*	@brief: allocate cores to an NF
+	*
+	*	@param:	owner		Identifier of the NF (unique in the node)
+	*	@param:	required	Number of cores required by the NF
+	*
+	*	@return: the mask of the cores allocated (0 if no core can be allocated)
+	*/
+	static uint64_t allocate(string owner, unsigned int required);
+
+	/**
+	*	@brief: give back the cores allocated to an NF
+	*/
+	static void release(string owner);
+
+	/**
+	*	@brief: NUMA node of a network interface (-1 if unknown)
+	*/
+	static int interfaceNode(string ifname);
+
+	/**
+	*	@brief: JSON representation of the cores and of the NFs using them
+	*/
+	static Object toJSON();
+};
+
+#endif //CORE_ALLOCATOR_H_
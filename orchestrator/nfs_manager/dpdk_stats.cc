@@ -0,0 +1,181 @@
+#include "dpdk_stats.h"
+
+/**
+*	@brief: JSON representation of the counters of a port. The ports are numbered
+*		starting from 1, as in the graph
+*/
+static Object portToJSON(unsigned int port, struct nf_port_stats_t &stats)
+{
+	Object json;
+
+	json["port"] = (uint64_t)port;
+	json["rx-packets"] = stats.rx;
+	json["rx-bytes"] = stats.rx_bytes;
+	json["tx-packets"] = stats.tx;
+	json["tx-bytes"] = stats.tx_bytes;
+	json["dropped"] = stats.dropped;
+	json["tx-ring-full"] = stats.tx_dropped;
+	json["cycles-per-packet"] = (stats.rx != 0)? (double)stats.cycles / stats.rx : 0.0;
+
+	//Bucket i counts the bursts of 2^i to 2^(i+1)-1 packets
+	Array bursts;
+	for(unsigned int i = 0; i < NF_STATS_BURST_BUCKETS; i++)
+		bursts.push_back(stats.bursts[i]);
+	json["burst-histogram"] = bursts;
+
+	return json;
+}
+
+string DPDKStats::segmentName(uint64_t lsiID, string nf_name)
+{
+	stringstream name;
+	name << "/" << lsiID << "_" << nf_name;
+	return name.str();
+}
+
+/**
+*	@brief: map a statistics segment, and check that it is valid. Returns NULL if the
+*		segment does not exist or is not valid; otherwise, the segment must be
+*		unmapped by the caller
+*/
+static void *mapSegment(string segment, size_t &size)
+{
+	int fd = shm_open(segment.c_str(),O_RDONLY,0);
+	if(fd < 0)
+	{
+		logger(ORCH_DEBUG, MODULE_NAME, __FILE__, __LINE__, "The statistics segment \"%s\" does not exist",segment.c_str());
+		return NULL;
+	}
+
+	struct stat st;
+	if(fstat(fd,&st) < 0 || (size_t)st.st_size < sizeof(struct nf_stats_header_t))
+	{
+		logger(ORCH_DEBUG, MODULE_NAME, __FILE__, __LINE__, "The statistics segment \"%s\" is not initialized yet",segment.c_str());
+		close(fd);
+		return NULL;
+	}
+
+	size = st.st_size;
+	void *memory = mmap(NULL,size,PROT_READ,MAP_SHARED,fd,0);
+	close(fd);
+	if(memory == MAP_FAILED)
+	{
+		logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "Cannot map the statistics segment \"%s\"",segment.c_str());
+		return NULL;
+	}
+
+	struct nf_stats_header_t *header = (struct nf_stats_header_t*)memory;
+	uint32_t num_ports = header->num_ports;
+	uint32_t num_workers = header->num_workers;
+
+	if(header->magic != NF_STATS_MAGIC || header->version != NF_STATS_VERSION
+		|| header->workers_offset + (uint64_t)num_workers * sizeof(struct nf_stats_worker_t) > size
+		|| header->ports_offset + (uint64_t)num_workers * num_ports * sizeof(struct nf_port_stats_t) > size
+		|| header->rings_offset + (uint64_t)num_ports * sizeof(struct nf_ring_stats_t) > size)
+	{
+		logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "The statistics segment \"%s\" is not valid (version %d, expected %d)",segment.c_str(),header->version,NF_STATS_VERSION);
+		munmap(memory,size);
+		return NULL;
+	}
+
+	return memory;
+}
+
+bool DPDKStats::toJSON(string segment, Object &stats)
+{
+	size_t size;
+	void *memory = mapSegment(segment,size);
+	if(memory == NULL)
+		return false;
+
+	struct nf_stats_header_t *header = (struct nf_stats_header_t*)memory;
+	uint32_t num_ports = header->num_ports;
+	uint32_t num_workers = header->num_workers;
+
+	struct nf_stats_worker_t *workers = (struct nf_stats_worker_t*)((char*)memory + header->workers_offset);
+	struct nf_port_stats_t *ports = (struct nf_port_stats_t*)((char*)memory + header->ports_offset);
+	struct nf_ring_stats_t *rings = (struct nf_ring_stats_t*)((char*)memory + header->rings_offset);
+
+	Array lcores;
+	Array totals;
+	for(uint32_t p = 0; p < num_ports; p++)
+	{
+		struct nf_port_stats_t total;
+		memset(&total,0,sizeof(total));
+
+		for(uint32_t w = 0; w < num_workers; w++)
+		{
+			struct nf_port_stats_t &current = ports[w * num_ports + p];
+			total.rx += current.rx;
+			total.rx_bytes += current.rx_bytes;
+			total.tx += current.tx;
+			total.tx_bytes += current.tx_bytes;
+			total.dropped += current.dropped;
+			total.tx_dropped += current.tx_dropped;
+			total.cycles += current.cycles;
+			for(unsigned int i = 0; i < NF_STATS_BURST_BUCKETS; i++)
+				total.bursts[i] += current.bursts[i];
+		}
+		Object port = portToJSON(p + 1,total);
+		port["rx-ring-capacity"] = (uint64_t)rings[p].capacity;
+		port["rx-ring-occupancy"] = (uint64_t)rings[p].occupancy;
+		port["rx-ring-average-occupancy"] = (rings[p].polls != 0)? (double)rings[p].occupancy_sum / rings[p].polls : 0.0;
+		totals.push_back(port);
+	}
+
+	for(uint32_t w = 0; w < num_workers; w++)
+	{
+		Object lcore;
+		lcore["lcore"] = (uint64_t)workers[w].lcore_id;
+		if(header->dispatcher)
+			lcore["dispatch-ring-full"] = workers[w].dispatch_dropped;
+
+		Array lcore_ports;
+		for(uint32_t p = 0; p < num_ports; p++)
+			lcore_ports.push_back(portToJSON(p + 1,ports[w * num_ports + p]));
+		lcore["ports"] = lcore_ports;
+
+		lcores.push_back(lcore);
+	}
+
+	stats["tsc-hz"] = header->tsc_hz;
+	stats["dispatcher"] = (header->dispatcher != 0);
+	stats["ports"] = totals;
+	stats["lcores"] = lcores;
+
+	munmap(memory,size);
+
+	return true;
+}
+
+bool DPDKStats::readLoad(string segment, nf_load_t &load)
+{
+	size_t size;
+	void *memory = mapSegment(segment,size);
+	if(memory == NULL)
+		return false;
+
+	struct nf_stats_header_t *header = (struct nf_stats_header_t*)memory;
+	struct nf_stats_worker_t *workers = (struct nf_stats_worker_t*)((char*)memory + header->workers_offset);
+	struct nf_port_stats_t *ports = (struct nf_port_stats_t*)((char*)memory + header->ports_offset);
+	struct nf_ring_stats_t *rings = (struct nf_ring_stats_t*)((char*)memory + header->rings_offset);
+
+	load.rings.assign(rings,rings + header->num_ports);
+	load.received = 0;
+	load.overload_dropped = 0;
+	//The packets dropped by the dispatcher are not received by any worker
+	for(uint32_t w = 0; w < header->num_workers; w++)
+	{
+		load.received += workers[w].dispatch_dropped;
+		load.overload_dropped += workers[w].dispatch_dropped;
+	}
+	for(uint32_t i = 0; i < header->num_workers * header->num_ports; i++)
+	{
+		load.received += ports[i].rx;
+		load.overload_dropped += ports[i].tx_dropped;
+	}
+
+	munmap(memory,size);
+
+	return true;
+}
@@ -0,0 +1,125 @@
+#ifndef DPDK_STATS_H_
+#define DPDK_STATS_H_ 1
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "../utils/logger.h"
+#include "../utils/constants.h"
+
+#include <json_spirit/json_spirit.h>
+#include <json_spirit/value.h>
+#include <json_spirit/writer.h>
+
+using namespace std;
+using namespace json_spirit;
+
+/**
+*	@brief: layout of the shared memory segment where a DPDK NF exports its statistics.
+*		It must be kept aligned with NFs/dpdk/framework/nf_stats.h; NF_STATS_VERSION
+*		changes each time the layout changes
+*/
+#define NF_STATS_MAGIC			0x4E465354
+#define NF_STATS_VERSION		2
+#define NF_STATS_BURST_BUCKETS	8
+#define NF_STATS_ALIGN			64
+
+struct nf_stats_header_t
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t num_ports;
+	uint32_t num_workers;
+	uint64_t tsc_hz;
+	uint64_t workers_offset;
+	uint64_t ports_offset;
+	uint64_t rings_offset;
+	uint32_t dispatcher;
+} __attribute__((aligned(NF_STATS_ALIGN)));
+
+struct nf_stats_worker_t
+{
+	uint32_t lcore_id;
+	uint64_t dispatch_dropped;
+} __attribute__((aligned(NF_STATS_ALIGN)));
+
+struct nf_port_stats_t
+{
+	uint64_t rx;
+	uint64_t rx_bytes;
+	uint64_t tx;
+	uint64_t tx_bytes;
+	uint64_t dropped;
+	uint64_t tx_dropped;
+	uint64_t cycles;
+	uint64_t bursts[NF_STATS_BURST_BUCKETS];
+} __attribute__((aligned(NF_STATS_ALIGN)));
+
+struct nf_ring_stats_t
+{
+	uint32_t capacity;
+	uint32_t occupancy;
+	uint64_t polls;
+	uint64_t occupancy_sum;
+} __attribute__((aligned(NF_STATS_ALIGN)));
+
+/**
+*	@brief: counters of a DPDK NF measuring its load: for each port, the occupancy
+*		of the ring from xDPd sampled at each poll, the packets taken from the rings
+*		from xDPd, and the packets dropped because the NF could not keep up (ring
+*		towards xDPd full, or rings towards the workers full). The packets dropped
+*		by the NF itself are not included
+*/
+typedef struct
+{
+	vector<struct nf_ring_stats_t> rings;
+	uint64_t received;
+	uint64_t overload_dropped;
+}nf_load_t;
+
+/**
+*	@brief: reader of the statistics exported by the DPDK NFs. The segment is mapped
+*		read-only and copied, without any interaction with the NF; since the counters
+*		are updated while they are read, the values of different counters may refer
+*		to slightly different instants
+*/
+class DPDKStats
+{
+public:
+	/**
+	*	@brief: name of the segment of the NF with a given name, attached to a given LSI
+	*		(the name is given to the NF by the script starting it)
+	*/
+	static string segmentName(uint64_t lsiID, string nf_name);
+
+	/**
+	*	@brief: read the statistics of a NF, and create their JSON representation. Returns
+	*		false if the segment does not exist (e.g., the NF is still starting) or is not
+	*		valid
+	*
+	*	@param:	segment	Name of the shared memory segment
+	*	@param:	stats	JSON representation of the statistics
+	*/
+	static bool toJSON(string segment, Object &stats);
+
+	/**
+	*	@brief: read the counters measuring the load of a NF. Returns false if the
+	*		segment does not exist or is not valid
+	*
+	*	@param:	segment	Name of the shared memory segment
+	*	@param:	load	Counters read from the segment
+	*/
+	static bool readLoad(string segment, nf_load_t &load);
+};
+
+#endif //DPDK_STATS_H_
@@ -1,27 +1,8 @@
 #include "nfs_manager.h"
 
-pthread_mutex_t NFsManager::nfs_manager_mutex = PTHREAD_MUTEX_INITIALIZER;
-
-map<int,uint64_t> NFsManager::cores;
-int NFsManager::nextCore = 0;
-
-void NFsManager::setCoreMask(uint64_t core_mask)
+void NFsManager::setCoreMask(uint64_t core_mask, list<string> interfaces)
 {
-	uint64_t mask = 1;
-	for(uint64_t i = 0; i < 64; i++)
-	{
-		if(core_mask & mask)
-		{
-			cores[nextCore] = mask;
-			nextCore++;
-		}
-			
-		mask = mask << 1;
-	}
-	nextCore = 0;
-	
-	for(unsigned int i = 0; i < cores.size(); i++)
-		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Mask of an available core: \"%d\"",cores[i]);
+	CoreAllocator::init(core_mask,interfaces);
 }
 
 nf_manager_ret_t NFsManager::retrieveDescription(string nf)
@@ -274,78 +255,56 @@ bool NFsManager::parseAnswer(string answer, string nf)
 
 bool NFsManager::selectImplementation()
 {
-#if defined(ENABLE_DOCKER) || defined(ENABLE_KNI)
-	int retVal;
-#endif
-
-#ifdef ENABLE_DOCKER
-	//Check if Docker is running with the LXC implementation
-	
-	retVal = system(CHECK_DOCKER);
-	retVal = retVal >> 8;
-
-	logger(ORCH_DEBUG, MODULE_NAME, __FILE__, __LINE__, "Script returned: %d\n",retVal);
-
-	if(retVal > 0)
-	{
-		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Docker deamon is running. Select Docker implementation if exists.");
-		selectImplementation(DOCKER);
-		
-		if(allSelected(false))
-			return true;
-	}
-	else
-		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Docker deamon is not running (at least, it is not running with the LXC implementation).");
-#endif
-
-	selectImplementation(DPDK);
-	if(allSelected(false))
-		return true;
-
-#ifdef ENABLE_KVM
-	//Check if KVM is running
-	retVal = system(CHECK_KVM);
-	retVal = retVal >> 8;
-
-	logger(ORCH_DEBUG, MODULE_NAME, __FILE__, __LINE__, "Script returned: %d\n",retVal);
-
-	if(retVal > 0)
-	{
-		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "KVM is running. Select KVM implementation if exists.");
-		selectImplementation(KVM);
-		return allSelected(true);
-	}
-	else
-		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "KVM  is not running.");
-#endif
-
-	return false;
-}
-
-void NFsManager::selectImplementation(nf_t desiredType)
-{
-	//Select an implmentation of the NF
 	for(map<string, NF*>::iterator nf = nfs.begin(); nf != nfs.end(); nf++)
 	{
 		NF *current = nf->second;
 		
 		//An implementation is selected only for those functions that do not have an implementation yet
-		if(current->getSelectedImplementation() == NULL)
+		if(current->getSelectedImplementation() != NULL)
+			continue;
+
+		Implementation *selected = NULL;
+		double selectedTime = -1;
+
+		list<Implementation*> implementations = current->getAvailableImplementations();
+		for(list<Implementation*>::iterator impl = implementations.begin(); impl != implementations.end(); impl++)
 		{
-			list<Implementation*> implementations = current->getAvailableImplementations();
+			if(!Capabilities::isAvailable((*impl)->getType()))
+				continue;
 
-			list<Implementation*>::iterator impl;
-			for(impl = implementations.begin(); impl != implementations.end(); impl++)
+			double time = Capabilities::getStartTime((*impl)->getType(),(*impl)->getURI());
+
+			//An implementation already started is preferred to one never started; the priority
+			//is used only among the implementations never started
+			if(selected == NULL
+				|| (time >= 0 && (selectedTime < 0 || time < selectedTime))
+				|| (time < 0 && selectedTime < 0 && priority((*impl)->getType()) < priority(selected->getType())))
 			{
-				if((*impl)->getType() == desiredType)
-				{
-					current->setSelectedImplementation(*impl);
-					logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "%s implementation has been selected for NF \"%s\".",NFType::toString(desiredType).c_str(),nf->first.c_str());
-					break;
-				}
+				selected = *impl;
+				selectedTime = time;
 			}
 		}
+
+		if(selected == NULL)
+			continue;
+
+		current->setSelectedImplementation(selected);
+		if(selectedTime >= 0)
+			logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "%s implementation has been selected for NF \"%s\" (average start time: %.3f s).",NFType::toString(selected->getType()).c_str(),nf->first.c_str(),selectedTime);
+		else
+			logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "%s implementation has been selected for NF \"%s\".",NFType::toString(selected->getType()).c_str(),nf->first.c_str());
 	}
+
+	return allSelected(true);
+}
+
+unsigned int NFsManager::priority(nf_t type)
+{
+	if(type == DOCKER)
+		return 0;
+	else if(type == DPDK)
+		return 1;
+	return 2;
 }
 
 bool NFsManager::allSelected(bool lastCall)
@@ -377,11 +336,80 @@ nf_t NFsManager::getNFType(string name)
 	return impl->getType();
 }
 
+bool NFsManager::addReplica(string nf_name, string replica)
+{
+	assert(nfs.count(nf_name) != 0 && nfs[nf_name]->getSelectedImplementation() != NULL);
+
+	if(nfs.count(replica) != 0)
+	{
+		logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "The replica \"%s\" of NF \"%s\" already exists",replica.c_str(),nf_name.c_str());
+		return false;
+	}
+
+	nfs[replica] = nfs[nf_name];
+	replicas[replica] = nf_name;
+	
+	return true;
+}
+
+void NFsManager::removeReplica(string replica)
+{
+	assert(replicas.count(replica) != 0);
+
+	nfs.erase(replica);
+	replicas.erase(replica);
+}
+
+string NFsManager::replicatedNF(string name)
+{
+	if(replicas.count(name) != 0)
+		return replicas[name];
+	
+	return name;
+}
+
+string NFsManager::replicaName(string nf_name, unsigned int replica)
+{
+	if(replica == 0)
+		return nf_name;
+
+	stringstream name;
+	name << nf_name << "-" << replica;
+	return name.str();
+}
+
 void NFsManager::setLsiID(uint64_t lsiID)
 {
 	this->lsiID = lsiID;
 }
 
+Object NFsManager::statsToJSON()
+{
+	Object json;
+	Array nfs_array;
+
+	for(map<string, NF*>::iterator nf = nfs.begin(); nf != nfs.end(); nf++)
+	{
+		Implementation *impl = nf->second->getSelectedImplementation();
+		if(impl == NULL)
+			continue;
+
+		Object current;
+		current[_ID] = nf->first.c_str();
+		current["type"] = NFType::toString(impl->getType()).c_str();
+
+		Object stats;
+		if(impl->getType() == DPDK && DPDKStats::toJSON(DPDKStats::segmentName(lsiID,nf->first),stats))
+			current["stats"] = stats;
+
+		nfs_array.push_back(current);
+	}
+
+	json[VNFS] = nfs_array;
+
+	return json;
+}
+
 //TODO: the number of ports is bad. I should pass the name of the ports!
 //Now I'm assuming that, if the functions NF requires two ports, they are identified with
 //NF:1 and NF:2, but this could not be true.
@@ -403,12 +431,25 @@ bool NFsManager::startNF(string nf_name, unsigned int number_of_ports, map<unsig
 	NF *nf = nfs[nf_name];
 	Implementation *impl = nf->getSelectedImplementation();
 
+	//The start time does not include the download of the artifact, which only
+	//happens the first time the implementation is used
+	struct timespec start;
+
 	if(impl->getType() == DOCKER)
 	{
 		//The NF is a Docker container
 
+		//The image is pulled if it is not in the cache yet
+		string image;
+		if(!ArtifactCache::fetch(DOCKER,impl->getURI(),image))
+		{
+			Capabilities::reportFailure(DOCKER);
+			return false;
+		}
+		clock_gettime(CLOCK_MONOTONIC, &start);
+
 		stringstream command;
-		command << PULL_AND_RUN_DOCKER_NF << " " << lsiID << " " << nf_name << " " << impl->getURI() << " " << number_of_ports;
+		command << PULL_AND_RUN_DOCKER_NF << " " << lsiID << " " << nf_name << " " << image << " " << number_of_ports;
 		
 		//create the names of the ports
 		for(unsigned int i = 1; i <= number_of_ports; i++)
@@ -443,13 +484,24 @@ bool NFsManager::startNF(string nf_name, unsigned int number_of_ports, map<unsig
 	{
 		//The NF is a DPDK process
 
-		stringstream uri;
-		if(impl->getLocation() == "local")
-			uri << "file://";
-		uri << impl->getURI();
+		//The executable is retrieved if it is not in the cache yet
+		string executable;
+		if(!ArtifactCache::fetch(DPDK,artifactURI(impl),executable))
+		{
+			Capabilities::reportFailure(DPDK);
+			return false;
+		}
+		clock_gettime(CLOCK_MONOTONIC, &start);
+
+		uint64_t coreMask = calculateCoreMask(nf_name,impl->getCores());
+		if(coreMask == 0)
+		{
+			logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "No core can be allocated to the NF \"%s\"",nf_name.c_str());
+			return false;
+		}
 
 		stringstream command;
-		command << PULL_AND_RUN_DPDK_NF << " " << lsiID << " " << nf_name << " " << uri.str() << " " << calculateCoreMask(impl->getCores()) <<  " " << NUM_MEMORY_CHANNELS << " " << number_of_ports;
+		command << PULL_AND_RUN_DPDK_NF << " " << lsiID << " " << nf_name << " " << executable << " " << coreMask <<  " " << NUM_MEMORY_CHANNELS << " " << number_of_ports;
 
 		for(unsigned int i = 1; i <= number_of_ports; i++)
 			command << " " << lsiID << "_" << nf_name << "_" << i;
@@ -463,6 +515,7 @@ bool NFsManager::startNF(string nf_name, unsigned int number_of_ports, map<unsig
 	{
 		//FIXME: is it possible to configure some interface? Ask this to Zsolt
 		//The NF is a KVM virtual machine
+		clock_gettime(CLOCK_MONOTONIC, &start);
 		
 		stringstream command;
 		command << PULL_AND_RUN_KVM_NF << " " << lsiID << " " << nf_name << " " << impl->getURI() << " " << number_of_ports;
@@ -480,16 +533,51 @@ bool NFsManager::startNF(string nf_name, unsigned int number_of_ports, map<unsig
 	if(retVal == 0)
 	{
 		logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "An error occurred while starting the NF \"%s\"",nf_name.c_str());
+		if(impl->getType() == DPDK)
+			CoreAllocator::release(coreOwner(nf_name));
+		Capabilities::reportFailure(impl->getType());
 		return false;
 	}
 
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	Capabilities::recordStartTime(impl->getType(),impl->getURI(),(end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+
 	return true;
 }
 
+void *stopNFThread(void *arguments)
+{
+	to_stop_thread_t *args = (to_stop_thread_t *)arguments;
+	assert(args->nfsManager != NULL);
+
+	if(!args->nfsManager->stopNF(args->nf_name))
+		return (void*) 0;
+	else
+		return (void*) 1;
+}
+
 void NFsManager::stopAll()
 {
+	pthread_t some_thread[nfs.size()];
+	to_stop_thread_t thr[nfs.size()];
+	int i = 0;
 	for(map<string, NF*>::iterator nf = nfs.begin(); nf != nfs.end(); nf++)
-		stopNF(nf->first);
+	{
+		thr[i].nf_name = nf->first;
+		thr[i].nfsManager = this;
+		
+		if (pthread_create(&some_thread[i], NULL, &stopNFThread, (void *)&thr[i]) != 0)
+		{
+			logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "An error occurred while creating a new thread. The NF \"%s\" is stopped sequentially",nf->first.c_str());
+			stopNF(nf->first);
+			continue;
+		}
+		i++;
+	}
+	
+	for(int j = 0; j < i; j++)
+		pthread_join(some_thread[j], NULL);
 }
 
 bool NFsManager::stopNF(string nf_name)
@@ -526,6 +614,11 @@ bool NFsManager::stopNF(string nf_name)
 	retVal = system(command.str().c_str());
 	retVal = retVal >> 8;
 
+	//The NF is no longer part of the graph, hence its cores are given back even if it
+	//cannot be stopped
+	if(impl->getType() == DPDK)
+		CoreAllocator::release(coreOwner(nf_name));
+
 	if(retVal == 0)
 	{
 		logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "An error occurred while stopping the NF \"%s\"",nf_name.c_str());
@@ -535,23 +628,56 @@ bool NFsManager::stopNF(string nf_name)
 	return true;
 }
 
-uint64_t NFsManager::calculateCoreMask(string coresRequried)
+uint64_t NFsManager::calculateCoreMask(string nf_name, string coresRequried)
 {
-	int requiredCores;
+	int requiredCores = 1;
 	sscanf(coresRequried.c_str(),"%d",&requiredCores);
 
-	pthread_mutex_lock(&nfs_manager_mutex);
-	uint64_t mask = 0;
-	for(int i = 0; i < requiredCores; i++)
+	return CoreAllocator::allocate(coreOwner(nf_name),(requiredCores > 0)? requiredCores : 1);
+}
+
+string NFsManager::artifactURI(Implementation *impl)
+{
+	stringstream uri;
+	if(impl->getType() == DPDK && impl->getLocation() == "local")
+		uri << "file://";
+	uri << impl->getURI();
+	return uri.str();
+}
+
+nf_manager_ret_t NFsManager::prefetchNF(string nf_name, Array &artifacts)
+{
+	nf_manager_ret_t retVal = retrieveDescription(nf_name);
+	if(retVal != NFManager_OK)
+		return retVal;
+
+	assert(nfs.count(nf_name) != 0);
+
+	list<Implementation*> implementations = nfs[nf_name]->getAvailableImplementations();
+	for(list<Implementation*>::iterator impl = implementations.begin(); impl != implementations.end(); impl++)
 	{
-		mask |= cores[nextCore];
-		nextCore = (nextCore+1)%cores.size();
+		nf_t type = (*impl)->getType();
+		if(!ArtifactCache::isCacheable(type) || !Capabilities::isAvailable(type))
+			continue;
+
+		string uri = artifactURI(*impl);
+		if(!ArtifactCache::prefetch(type,uri))
+			return NFManager_SERVER_ERROR;
+
+		Object artifact;
+		artifact["type"] = NFType::toString(type);
+		artifact["uri"] = uri;
+		artifacts.push_back(artifact);
 	}
-	pthread_mutex_unlock(&nfs_manager_mutex);
 
-	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "The NF requires %d cores. Its core mask is  \"%x\"",requiredCores,mask);
+	return NFManager_OK;
+}
 
-	return mask;
+string NFsManager::coreOwner(string nf_name)
+{
+	stringstream owner;
+	owner << lsiID << "_" << nf_name;
+	return owner.str();
 }
 
 unsigned int NFsManager::convertNetmask(string netmask)
@@ -16,6 +16,10 @@
 #include "../utils/constants.h"
 #include "../utils/sockutils.h"
 #include "nf.h"
+#include "dpdk_stats.h"
+#include "core_allocator.h"
+#include "capabilities.h"
+#include "artifact_cache.h"
 
 #include <json_spirit/json_spirit.h>
 #include <json_spirit/value.h>
@@ -35,7 +39,6 @@ using namespace json_spirit;
 /**
 *	@brief: constants related to Docker NFs
 */
-#define CHECK_DOCKER			"./nfs_manager/scripts/docker/checkDockerRun.sh"
 #define PULL_AND_RUN_DOCKER_NF	"./nfs_manager/scripts/docker/pullAndRunNF.sh"
 #define STOP_DOCKER_NF			"./nfs_manager/scripts/docker/stopNF.sh"
 
@@ -49,7 +52,6 @@ using namespace json_spirit;
 /**
 *	@brief: constants related to KVM NFs
 */
-#define CHECK_KVM				"./nfs_manager/scripts/kvm/checkKvmRun.sh"
 #define PULL_AND_RUN_KVM_NF		"./nfs_manager/scripts/kvm/pullAndRunNF.sh"
 #define STOP_KVM_NF				"./nfs_manager/scripts/kvm/stopNF.sh"
 
@@ -60,28 +62,19 @@ typedef enum{NFManager_OK,NFManager_SERVER_ERROR, NFManager_NO_NF}nf_manager_ret
 class NFsManager
 {
 private:
-	
-	/**
-	*	@brief: mutex used to select the core to be allocated to a (DPDK) NF
-	*/
-	static pthread_mutex_t nfs_manager_mutex;
-	
-	/**
-	*	@brief: the CPU cores that can be allocated to DPDK NFs
-	*/
-	static map<int,uint64_t> cores;
-	
-	/**
-	*	@brief: position, in the vector above, of the next CPU core to be
-	*	allocated to a DPDK NF
-	*/
-	static int nextCore;
 
 	/**
 	* 	@brief: the pair is <network function name, network function>
 	**/
 	map<string, NF*> nfs;
 	
+	/**
+	*	@brief: replicas of the NFs. The pair is <replica name, network function name>.
+	*		A replica shares the description (and the selected implementation) of its
+	*		network function, and it is started and stopped as any other NF
+	**/
+	map<string, string> replicas;
+	
 	/**
 	*	@brief: identifier of the LSI attached to the NFs
 	**/
@@ -96,11 +89,27 @@ private:
 	bool parseAnswer(string answer, string nf);
 	
 	/**
-	*	@brief: calculate the core mask for a DPDK NF
+	*	@brief: calculate the core mask for a DPDK NF, by allocating its cores
+	*		(see CoreAllocator)
 	*
+	*	@param:	nf_name			Name of the network function
 	*	@param:	coresRequired	Number of cores required
 	*/
-	uint64_t calculateCoreMask(string coresRequired);
+	uint64_t calculateCoreMask(string nf_name, string coresRequired);
+	
+	/**
+	*	@brief: identifier of a NF in the core allocator
+	*
+	*	@param:	nf_name	Name of the network function
+	*/
+	string coreOwner(string nf_name);
+	
+	/**
+	*	@brief: URI of the artifact of an implementation, as expected by the ArtifactCache
+	*
+	*	@param:	impl	An implementation of a network function
+	*/
+	string artifactURI(Implementation *impl);
 	
 	/**
 	*	@brief: starting from a netmask, returns the /
@@ -110,13 +119,12 @@ private:
 	unsigned int convertNetmask(string netmask);
 	
 	/**
-	*	@brief: For all the NF without an alredy selected implementation, select 
-	*	an implementation of the desired type, if at least one implementation
-	*	of such a type is availabled
+	*	@brief: priority of the implementations of a given type, used when the start
+	*	time of the implementations is unknown (0 is the highest priority)
 	*
-	*	@param:	desiredType	Type of the implementation to be selected
+	*	@param:	type	Type of the implementation
 	*/
-	void selectImplementation(nf_t desiredType);
+	static unsigned int priority(nf_t type);
 	
 	/**
 	*	@brief: Check if an implementation for all the NFs has been selected. In this
@@ -137,12 +145,14 @@ public:
 	nf_manager_ret_t retrieveDescription(string nf);
 	
 	/**
-	*	@brief: For each NF, select an implementation. Currently, if a Docker implementation 
-	*	is available and Docker is running with the LXC engine, Docker is selected.
+	*	@brief: For each NF, select an implementation among those whose execution environment
+	*	is running (see Capabilities; no script is executed). If some of them have already been
+	*	started, the one that started faster on average is selected. Otherwise, if a Docker
+	*	implementation is available and Docker is running with the LXC engine, Docker is selected.
 	*	Otherwise, a DPDK implementation is selected. Only in case Docker and DPDK
 	*	implementations are not available, it selects a KVM implementation (if KVM is
 	*	running and a KVM implementation is available).
-	*	Summarizing, the priority of the implementations is the following 
+	*	Summarizing, the priority of the implementations never started is the following 
 	*		- Docker
 	*		- DPDK
 	*		- KVM
@@ -156,6 +166,39 @@ public:
 	*/
 	nf_t getNFType(string name);
 	
+	/**
+	*	@brief: Add a replica of a NF, whose implementation has already been selected.
+	*	The replica can then be started with startNF, using its name
+	*
+	*	@param:	nf_name	Name of the network function
+	*	@param:	replica	Name of the replica (see replicaName)
+	*/
+	bool addReplica(string nf_name, string replica);
+	
+	/**
+	*	@brief: Remove a replica of a NF. The replica must have been stopped
+	*
+	*	@param:	replica	Name of the replica
+	*/
+	void removeReplica(string replica);
+	
+	/**
+	*	@brief: Return the name of the NF replicated by a replica, or the name itself
+	*	if it is not a replica
+	*
+	*	@param:	name	Name of a network function or of a replica
+	*/
+	string replicatedNF(string name);
+	
+	/**
+	*	@brief: Return the name of a replica of a NF. The replica 0 is the NF itself,
+	*	so that the name of a NF with a single instance does not change
+	*
+	*	@param:	nf_name	Name of the network function
+	*	@param:	replica	Index of the replica
+	*/
+	static string replicaName(string nf_name, unsigned int replica);
+	
 	/**
 	*	@brief: Set the identifier of the identifier of the LSI attached to the NFs 
 	*
@@ -177,7 +220,7 @@ public:
 	bool startNF(string nf_name, unsigned int number_of_ports, map<unsigned int,pair<string,string> > ipv4PortsRequirements,map<unsigned int,string> ethPortsRequirements);
 	
 	/**
-	*	@brief: Stop all the running NFs
+	*	@brief: Stop all the running NFs. The NFs are stopped in parallel
 	*/
 	void stopAll();
 	
@@ -188,14 +231,38 @@ public:
 	*/
 	bool stopNF(string nf_name);
 	
+	/**
+	*	@brief: Create the JSON representation of the statistics of the NFs. The statistics
+	*		are currently available only for the DPDK NFs, which export them in shared
+	*		memory (see DPDKStats)
+	*/
+	Object statsToJSON();
+	
+	/**
+	*	@brief: Retrieve the description of a NF, and start retrieving in background the
+	*	artifacts of its implementations (see ArtifactCache), so that the NF starts faster
+	*	when a graph uses it
+	*
+	*	@param:	nf_name		Name of the network function
+	*	@param:	artifacts	The artifacts being retrieved
+	*/
+	nf_manager_ret_t prefetchNF(string nf_name, Array &artifacts);
+	
 	/**
 	*	@brief: Set the core mask representing the cores to be used for DPDK processes. The available cores will
-	*	be allocated to DPDK NFs in a round robin fashion, and each DPDK network functions will have just one
-	*	core
+	*	be allocated to DPDK NFs by the CoreAllocator, preferring the NUMA node of the physical interfaces
 	*
 	*	@param:	core_mask	Mask representing the cores to be allocated to DPDK network functions
+	*	@param:	interfaces	Physical interfaces managed by xDPd
 	*/
-	static void setCoreMask(uint64_t core_mask);
+	static void setCoreMask(uint64_t core_mask, list<string> interfaces);
 };
 
+typedef struct
+	{
+		string nf_name;
+		NFsManager *nfsManager;
+	}to_stop_thread_t;
+
+
 #endif //NFS_MANAGER_H_
@@ -0,0 +1,37 @@
+#!/bin/bash
+
+#Brief: pull the image of a NF from a docker repository. The ID of the image is printed
+#	as the last line of the output.
+
+#command line: sudo ./fetchNF.sh $1
+
+#$1 registry/nf[:tag] 	(e.g., localhost:5000/pcap:latest)
+
+if (( $EUID != 0 )) 
+then
+    echo "[fetchNF] This script must be executed with ROOT privileges"
+    exit 0
+fi
+
+sudo docker pull $1
+#docker pull returns 0 in case of success
+ret=`echo $?`
+
+if [ $ret -eq 0 ]
+then
+	echo "[fetchNF] Image '"$1"' retrieved"
+else
+	echo "[fetchNF] Impossible to retrieve image '"$1"'"
+	exit 0
+fi
+
+ID=`sudo docker inspect --format '{{.Id}}' $1`
+if [ $? -ne 0 ] || [ -z "$ID" ]
+then
+	echo "[fetchNF] Impossible to inspect image '"$1"'"
+	exit 0
+fi
+
+echo $ID
+
+exit 1
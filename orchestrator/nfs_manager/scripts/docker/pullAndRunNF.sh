@@ -24,13 +24,13 @@ then
     exit 0
 fi
 
-echo -ne "" >> downloaded
+sudo docker inspect $3 > /dev/null 2>&1
+find=`echo $?`
 
-find=`cat downloaded | grep $3 | wc -l`
-
-if [ $find -eq 0 ]
+if [ $find -ne 0 ]
 then 
-	#The image must be downloaded from the ropository
+	#The image must be downloaded from the ropository (it is usually already
+	#pulled by fetchNF.sh)
 
 	sudo docker pull $3
 	#docker pull returns 0 in case of success
@@ -43,8 +43,6 @@ then
 		echo "[pullAndRunNF] Impossible to retrieve image '"$3"'"
 		exit 0
 	fi
-	
-	echo $3 >> downloaded
 fi
 
 #prepare the command
@@ -0,0 +1,68 @@
+#!/bin/bash
+
+#Brief: retrieve the executable of a NF from a remote repository or a folder on this
+#	system, and store it in the cache of the NFs. The executable is named after its
+#	SHA-256, which is printed as the last line of the output.
+
+#command line:
+#	sudo ./nfs_manager/scripts/dpdk/fetchNF.sh https://dl.dropboxusercontent.com/u/26069382/nf ./nfs_cache
+
+#$1 URL							(e.g., https://dl.dropboxusercontent.com/u/26069382/nf)
+#$2 cache directory				(e.g., ./nfs_cache)
+
+if (( $EUID != 0 )) 
+then
+    echo "[fetchNF] This script must be executed with ROOT privileges"
+    exit 0
+fi
+
+mkdir -p $2
+
+tmp_file=`mktemp $2/fetch.XXXXXX`
+if [ $? -ne 0 ]
+then
+	echo "[fetchNF] Impossible to create a file in '"$2"'"
+	exit 0
+fi
+
+tmp=$1
+
+begin=${tmp:0:7}
+# file:// means that the NF is local
+if [ $begin == "file://" ]
+then
+	#The NF is in the local file system
+	path=${tmp:7:${#tmp}}
+	
+	cp $path $tmp_file
+else
+	#The NF must be retrieved from a remote url
+	wget -q -O $tmp_file $1
+	#wget returns 0 in case of success
+fi
+
+ret=`echo $?`
+
+if [ $ret -eq 0 ]
+then
+	echo "[fetchNF] Image '"$1"' retrieved"
+else
+	echo "[fetchNF] Impossible to retrieve image '"$1"'"
+	rm -f $tmp_file
+	exit 0
+fi
+
+digest=`sha256sum $tmp_file | awk {'print $1'}`
+
+#The same executable may have been retrieved from another URL
+if [ -f $2/$digest ]
+then
+	rm -f $tmp_file
+else
+	chmod 755 $tmp_file
+	mv $tmp_file $2/$digest
+fi
+
+echo $digest
+
+exit 1
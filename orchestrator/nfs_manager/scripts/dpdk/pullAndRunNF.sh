@@ -3,6 +3,8 @@
 #Author: Ivano Cerrato
 #Date: June 26th 2014
 #Brief: pull a NF from a remote repository or a folder on this system, and run it. 
+#	If the NF is in the cache of the NFs (see fetchNF.sh), $3 is the path of the
+#	cached executable, which is linked instead of being retrieved again.
 
 #command line: 
 #	sudo ./nfs_manager/scripts/dpdk/pullAndRunNF.sh 2 example https://dl.dropboxusercontent.com/u/26069382/nf 2 2 2 2_example_1 2_example_2
@@ -10,7 +12,7 @@
 
 #$1 LSI ID						(e.g., 2)
 #$2 NF name						(e.g., firewall)
-#$3 URL							(e.g., https://dl.dropboxusercontent.com/u/26069382/nf)
+#$3 URL or cached executable	(e.g., https://dl.dropboxusercontent.com/u/26069382/nf, ./nfs_cache/<sha256>)
 #$4 core mask					(e.g., 2) XXX: it must be in decimal. The conversion in exadecimal is done in this script
 #$5 number of memory channels	(e.g., 2)
 #$6 number_of_ports				(e.g., 2)
@@ -32,8 +34,12 @@ exec_name=`echo $1"_"$tmp_file"_"$2`
 tmp=$3
 
 begin=${tmp:0:7}
+if [ -f $3 ]
+then
+	#The NF is in the cache
+	ln -f $3 $exec_name 2>/dev/null || cp $3 $exec_name
 # file:// means that the NF is local
-if [ $begin == "file://" ]
+elif [ $begin == "file://" ]
 then
 	#The NF is in the local file system
 	path=${tmp:7:${#tmp}}
@@ -68,7 +74,7 @@ do
 	current=`expr $current + 1` 
 done 
 
-echo `echo --s $1_$2 --l $1_$2.log` >> $tmp_file
+echo `echo --s $1_$2 --m $1_$2 --l $1_$2.log` >> $tmp_file
 
 echo "[pullAndRunNF] Executing command: '"`cat $tmp_file`"'"
 
@@ -18,7 +18,7 @@
 *	Private prototypes
 */
 #ifndef READ_JSON_FROM_FILE
-bool parse_command_line(int argc, char *argv[],int *rest_port,int *core_mask, char **wirelessName);
+bool parse_command_line(int argc, char *argv[],int *rest_port,int *core_mask, unsigned int *lsi_pool_size, bool *autoscaling, char **wirelessName);
 #else
 bool parse_command_line(int argc, char *argv[], char **file_name,int *core_mask, char **wirelessName);
 #endif
@@ -73,7 +73,9 @@ int main(int argc, char *argv[])
 	if(!parse_command_line(argc,argv,&file_name,&core_mask,&wirelessName))
 #else
 	int rest_port;
-	if(!parse_command_line(argc,argv,&rest_port,&core_mask,&wirelessName))
+	unsigned int lsi_pool_size;
+	bool autoscaling;
+	if(!parse_command_line(argc,argv,&rest_port,&core_mask,&lsi_pool_size,&autoscaling,&wirelessName))
 #endif
 		exit(EXIT_FAILURE);	
 
@@ -85,7 +87,7 @@ int main(int argc, char *argv[])
 #ifdef READ_JSON_FROM_FILE
 	if(!RestServer::init(file_name,core_mask,(wirelessName == NULL)? false : true, wirelessName))
 #else
-	if(!RestServer::init(core_mask,(wirelessName == NULL)? false : true, wirelessName))
+	if(!RestServer::init(core_mask,lsi_pool_size,autoscaling,(wirelessName == NULL)? false : true, wirelessName))
 #endif
 	{
 		logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "Cannot start the %s",MODULE_NAME);
@@ -111,7 +113,7 @@ int main(int argc, char *argv[])
 }
 
 #ifndef READ_JSON_FROM_FILE
-bool parse_command_line(int argc, char *argv[], int *rest_port, int *core_mask, char **wirelessName)
+bool parse_command_line(int argc, char *argv[], int *rest_port, int *core_mask, unsigned int *lsi_pool_size, bool *autoscaling, char **wirelessName)
 #else
 bool parse_command_line(int argc, char *argv[], char **file_name, int *core_mask, char **wirelessName)
 #endif
@@ -132,6 +134,8 @@ bool parse_command_line(int argc, char *argv[], char **file_name, int *core_mask
 static struct option lgopts[] = {
 		{"p", 1, 0, 0},
 		{"c", 1, 0, 0},
+		{"l", 1, 0, 0},
+		{"a", 0, 0, 0},
 		{"w", 1, 0, 0},
 		{"h", 0, 0, 0},
 		{NULL, 0, 0, 0}
@@ -143,7 +147,7 @@ static struct option lgopts[] = {
 #ifdef READ_JSON_FROM_FILE
 	uint32_t arg_f = 0;
 #else
-	uint32_t arg_p = 0;
+	uint32_t arg_p = 0, arg_l = 0;
 #endif
 
 	*core_mask = CORE_MASK;
@@ -152,6 +156,8 @@ static struct option lgopts[] = {
 	file_name[0] = '\0';
 #else
 	*rest_port = REST_PORT;
+	*lsi_pool_size = 0;
+	*autoscaling = false;
 #endif
 
 	while ((opt = getopt_long(argc, argvopt, "", lgopts, &option_index)) != EOF)
@@ -202,6 +208,22 @@ static struct option lgopts[] = {
 	   				
 	   				arg_p++;
 	   			}
+				else if (!strcmp(lgopts[option_index].name, "l"))/* size of the LSI pool */
+				{
+					if(arg_l > 0)
+	   				{
+		   				logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "Argument \"--l\" can appear only once in the command line");
+	   					return usage();
+	   				}
+	   				
+	   				sscanf(optarg,"%u",lsi_pool_size);
+	   				
+	   				arg_l++;
+	   			}
+				else if (!strcmp(lgopts[option_index].name, "a"))/* autoscaler */
+	   			{
+	   				*autoscaling = true;
+	   			}
 #endif
 				else if (!strcmp(lgopts[option_index].name, "h"))/* help */
 	   			{
@@ -245,8 +267,14 @@ bool usage(void)
 	"        TCP port used by the REST server to receive commands (default is 8080)           \n" \
 	"  --c core_mask                                                                          \n" \
 	"        Mask that specifies which cores must be used for DPDK network functions. These   \n" \
-	"        cores will be allocated to the DPDK network functions in a round robin fashion   \n" \
-	"        (default is 0x2)                                                                 \n" \
+	"        cores will be allocated to the DPDK network functions, preferring free cores on  \n" \
+	"        the NUMA node of the physical interfaces (default is 0x2)                        \n" \
+	"  --l lsi_pool_size                                                                      \n" \
+	"        Number of empty tenant-LSIs to be created in advance, so that new graphs can be  \n" \
+	"        deployed faster (default is 0, i.e., no LSI is created in advance)               \n" \
+	"  --a                                                                                    \n" \
+	"        Change the number of replicas of the DPDK network functions according to the     \n" \
+	"        occupancy of their rings and to the packets they drop (default is disabled)      \n" \
 	"  --w                                                                                    \n" \
 	"        name of a wireless interface (existing on the node) to be attached to the system \n" \
 	"  --h                                                                                    \n" \
@@ -265,8 +293,8 @@ bool usage(void)
 	"Options:                                                                                 \n" \
 	"  --c core_mask                                                                          \n" \
 	"        Mask that specifies which cores must be used for DPDK network functions. These   \n" \
-	"        cores will be allocated to the DPDK network functions in a round robin fashion   \n" \
-	"        (default is 0x2)                                                                 \n" \
+	"        cores will be allocated to the DPDK network functions, preferring free cores on  \n" \
+	"        the NUMA node of the physical interfaces (default is 0x2)                        \n" \
 	"  --w                                                                                    \n" \
 	"        name of a wireless interface (existing on the node) to be attached to the system \n" \
 	"  --h                                                                                    \n" \
@@ -5,12 +5,16 @@ GraphManager *RestServer::gm = NULL;
 #ifdef READ_JSON_FROM_FILE
 	bool RestServer::init(char *filename, int core_mask, bool wireless, char *wirelessName)
 #else
-	bool RestServer::init(int core_mask, bool wireless, char *wirelessName)
+	bool RestServer::init(int core_mask, unsigned int lsi_pool_size, bool autoscaling, bool wireless, char *wirelessName)
 #endif
 {	
 	try
 	{
+#ifdef READ_JSON_FROM_FILE
 		gm = new GraphManager(core_mask, wireless, wirelessName);
+#else
+		gm = new GraphManager(core_mask, wireless, wirelessName, lsi_pool_size, autoscaling);
+#endif
 		
 	}catch (...)
 	{
@@ -34,7 +38,10 @@ GraphManager *RestServer::gm = NULL;
     while (std::getline(file, str))
         stream << str << endl;
             
-    if(doPut(stream.str()) == 0)
+	GraphManager::mutexLock();
+	int ret = doPut(stream.str());
+	GraphManager::mutexUnlock();
+    if(ret == 0)
 		return false;
 #endif
 		
@@ -102,7 +109,12 @@ int RestServer::answer_to_connection (void *cls, struct MHD_Connection *connecti
 	}
 
 	if (0 == strcmp (method, GET))
-		return doGet(connection,url);
+	{
+		GraphManager::mutexLock();
+		int ret = doGet(connection,url);
+		GraphManager::mutexUnlock();
+		return ret;
+	}
 	else if( (0 == strcmp (method, PUT)) || (0 == strcmp (method, DELETE)) )
 	{	
 		struct connection_info_struct *con_info = (struct connection_info_struct *)(*con_cls);
@@ -117,7 +129,10 @@ int RestServer::answer_to_connection (void *cls, struct MHD_Connection *connecti
 		else if (NULL != con_info->message)
 		{
 			con_info->message[con_info->length] = '\0';
-			return (0 == strcmp (method, PUT))? doPut(connection,url,con_cls) : doDelete(connection,url,con_cls);
+			GraphManager::mutexLock();
+			int ret = (0 == strcmp (method, PUT))? doPut(connection,url,con_cls) : doDelete(connection,url,con_cls);
+			GraphManager::mutexUnlock();
+			return ret;
 		}
 	}
 	else
@@ -172,6 +187,7 @@ int RestServer::doPut(string toBeCreated)
  	char * pnt;
 
 	char graphID[BUFFER_SIZE];
+	bool cache = false; //true->the artifacts of a NF must be cached
 	
 	char tmp[BUFFER_SIZE];
 	strcpy(tmp,url);
@@ -182,7 +198,9 @@ int RestServer::doPut(string toBeCreated)
 		switch(i)
 		{
 			case 0:
-				if(strcmp(pnt,BASE_URL_GRAPH) != 0)
+				if(strcmp(pnt,BASE_URL_CACHE) == 0)
+					cache = true;
+				else if(strcmp(pnt,BASE_URL_GRAPH) != 0)
 				{
 put_malformed_url:
 					logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "Resource \"%s\" does not exist", url);
@@ -205,10 +223,6 @@ put_malformed_url:
 		goto put_malformed_url;
 	}
 	
-	logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "Resource to be created/updated: %s",graphID);
-	logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "Content:");
-	logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "%s",con_info->message);
-	
 	if(MHD_lookup_connection_value (connection,MHD_HEADER_KIND, "Host") == NULL)
 	{
 		logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "\"Host\" header not present in the request");
@@ -218,6 +232,14 @@ put_malformed_url:
 		return ret;
 	}
 	
+	if(cache)
+		//request to cache the artifacts of a NF
+		return doPutCache(connection,graphID);
+	
+	logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "Resource to be created/updated: %s",graphID);
+	logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "Content:");
+	logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "%s",con_info->message);
+	
 	const char *c_type = MHD_lookup_connection_value (connection,MHD_HEADER_KIND, "Content-Type");
 	if(strcmp(c_type,JSON_C_TYPE) != 0)
 	{
@@ -293,6 +315,24 @@ put_malformed_url:
 				return ret;		
 			}	
 		}
+#endif
+	}catch (GraphConflictException e)
+	{
+		delete(graph);
+		logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "The graph conflicts with another graph deployed on the node!");
+#ifndef READ_JSON_FROM_FILE
+		stringstream ssj;
+		write_formatted(e.toJSON(), ssj );
+		string sssj = ssj.str();
+		char *aux = (char*)malloc(sizeof(char) * (sssj.length()+1));
+		strcpy(aux,sssj.c_str());
+		response = MHD_create_response_from_buffer (strlen(aux),(void*) aux, MHD_RESPMEM_MUST_FREE);
+		MHD_add_response_header (response, "Content-Type",JSON_C_TYPE);
+		int ret = MHD_queue_response (connection, MHD_HTTP_CONFLICT, response);
+		MHD_destroy_response (response);
+		return ret;
+#else
+		return 0;
 #endif
 	}catch (...)
 	{
@@ -389,6 +429,10 @@ bool RestServer::parsePutBody(string toBeCreated,highlevel::Graph &graph, bool n
 							bool foundTemplate = false;
 #endif					
 							bool foundID = false;
+							string nfID;
+							
+							//Number of instances of the VNF (0 if not specified)
+							unsigned int replicas = 0;
 							
 							map<string,string> ipv4_addresses; 	//port name,ipv4 address
 							map<string,string> ipv4_masks;				//port name, ipv4 address
@@ -403,6 +447,7 @@ bool RestServer::parsePutBody(string toBeCreated,highlevel::Graph &graph, bool n
 								{
 									logger(ORCH_DEBUG, MODULE_NAME, __FILE__, __LINE__, "\"%s\"->\"%s\": \"%s\"",VNFS,_ID,nf_value.getString().c_str());
 									foundID = true;
+									nfID = nf_value.getString();
 									if(!graph.addNetworkFunction(nf_value.getString()))
 									{
 										logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Two VNFs with the same ID \"%s\" in \"%s\"",nf_value.getString().c_str(),VNFS);
@@ -417,6 +462,15 @@ bool RestServer::parsePutBody(string toBeCreated,highlevel::Graph &graph, bool n
 									//XXX: currently, this information is ignored
 #endif
 								}
+								else if(nf_name == REPLICAS)
+								{
+									logger(ORCH_DEBUG, MODULE_NAME, __FILE__, __LINE__, "\"%s\"->\"%s\": \"%s\"",VNFS,REPLICAS,nf_value.getString().c_str());
+									if(sscanf(nf_value.getString().c_str(),"%u",&replicas) != 1 || replicas == 0 || replicas > MAX_NF_REPLICAS)
+									{
+										logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Key \"%s\" with wrong value \"%s\" (at most %d replicas)",REPLICAS,nf_value.getString().c_str(),MAX_NF_REPLICAS);
+										return false;
+									}
+								}
 								else if(nf_name == PORTS_WITH_REQ)
 								{
 									const Array& ports_requirements_array = nf_value.getArray();
@@ -587,6 +641,8 @@ bool RestServer::parsePutBody(string toBeCreated,highlevel::Graph &graph, bool n
 								logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Key \"%s\", or key \"%s\", or both not found in an elmenet of \"%s\"",_ID,TEMPLATE,VNFS);
 								return false;
 							}
+							if(replicas != 0)
+								graph.setNetworkFunctionReplicas(nfID,replicas);
 						}					
 
 				    }//end if(fg_name == VNFS)
@@ -633,6 +689,12 @@ bool RestServer::parsePutBody(string toBeCreated,highlevel::Graph &graph, bool n
 										logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Key \"%s\" with wrong value \"%s\"",PRIORITY,value.getString().c_str());
 										return false;
 									}
+									if(priority > LSI0_MAX_GRAPH_PRIORITY)
+									{
+										//The LSI-0 keeps the priorities above the rules dispatching the packets among its tables
+										logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Key \"%s\" with value \"%s\" higher than %d",PRIORITY,fr_value.getString().c_str(),LSI0_MAX_GRAPH_PRIORITY);
+										return false;
+									}
 								}
 								else if(fr_name == MATCH)
 								{
@@ -751,6 +813,62 @@ bool RestServer::parsePutBody(string toBeCreated,highlevel::Graph &graph, bool n
 					
 						}//for( unsigned int fr = 0; fr < flow_rules_array.size(); ++fr )
 				    }// end  if (fg_name == FLOW_RULES)
+				    else if (fg_name == RATE_LIMIT)
+				    {
+				    	//Either the bandwidth (kbit/s) or the packets per second, and the optional burst
+				    	Object rate_limit = fg_value.getObject();
+				    	highlevel::rate_limit_t rateLimit;
+				    	rateLimit.burst = 0;
+				    	bool foundRate = false;
+
+				    	for(Object::const_iterator rl = rate_limit.begin(); rl != rate_limit.end(); rl++)
+				    	{
+				    		const string& rl_name  = rl->first;
+				    		const Value&  rl_value = rl->second;
+
+				    		if(rl_name == BANDWIDTH || rl_name == PPS || rl_name == BURST)
+				    		{
+				    			//strtoul would accept a sign and leading spaces, and wrap negative numbers
+				    			const char *value = rl_value.getString().c_str();
+				    			char *end;
+				    			errno = 0;
+				    			unsigned long number = (isdigit(value[0]))? strtoul(value,&end,10) : 0;
+				    			if(number == 0 || *end != '\0' || errno == ERANGE || number > 0xFFFFFFFFUL)
+				    			{
+				    				logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Key \"%s\" with wrong value \"%s\"",rl_name.c_str(),rl_value.getString().c_str());
+				    				return false;
+				    			}
+
+				    			if(rl_name == BURST)
+				    			{
+				    				rateLimit.burst = number;
+				    				continue;
+				    			}
+
+				    			if(foundRate)
+				    			{
+				    				logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Only one between \"%s\" and \"%s\" can be specified in \"%s\"",BANDWIDTH,PPS,RATE_LIMIT);
+				    				return false;
+				    			}
+				    			foundRate = true;
+				    			rateLimit.rate = number;
+				    			rateLimit.pps = (rl_name == PPS);
+				    			logger(ORCH_DEBUG, MODULE_NAME, __FILE__, __LINE__, "\"%s\"->\"%s\": \"%lu\"",RATE_LIMIT,rl_name.c_str(),number);
+				    		}
+				    		else
+				    		{
+				    			logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Invalid key \"%s\" in \"%s\"",rl_name.c_str(),RATE_LIMIT);
+				    			return false;
+				    		}
+				    	}
+
+				    	if(!foundRate)
+				    	{
+				    		logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Key \"%s\", or key \"%s\" not found in \"%s\"",BANDWIDTH,PPS,RATE_LIMIT);
+				    		return false;
+				    	}
+				    	graph.setRateLimit(rateLimit);
+				    }// end  if (fg_name == RATE_LIMIT)
 				    else
 					{
 					    logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "Invalid key \"%s\" in \"%s\"",fg_name.c_str(),FLOW_GRAPH);
@@ -876,6 +994,12 @@ int RestServer::doGet(struct MHD_Connection *connection, const char *url)
 	int ret;
 	
 	bool request = false; //false->graph - true->interfaces
+	bool stats = false; //true->statistics of the NFs of the graph
+	bool cores = false; //true->cores allocated to the NFs
+	bool cache = false; //true->artifacts of the NFs in the cache
+	bool tables = false; //true->flow entries of the LSIs
+	bool autoscaler = false; //true->policy and events of the autoscaler
+	bool pool = false; //true->state and statistics of the LSI pool
 	
 	//Check the URL
 	char delimiter[] = "/";
@@ -895,6 +1019,16 @@ int RestServer::doGet(struct MHD_Connection *connection, const char *url)
 					request = false;
 				else if(strcmp(pnt,BASE_URL_IFACES) == 0)
 					request = true;
+				else if(strcmp(pnt,BASE_URL_CORES) == 0)
+					cores = true;
+				else if(strcmp(pnt,BASE_URL_CACHE) == 0)
+					cache = true;
+				else if(strcmp(pnt,BASE_URL_TABLES) == 0)
+					tables = true;
+				else if(strcmp(pnt,BASE_URL_AUTOSCALER) == 0)
+					autoscaler = true;
+				else if(strcmp(pnt,BASE_URL_POOL) == 0)
+					pool = true;
 				else
 				{
 get_malformed_url:
@@ -906,13 +1040,20 @@ get_malformed_url:
 				}
 				break;
 			case 1:
+				if(cores || cache || tables || autoscaler || pool)
+					goto get_malformed_url;
 				strcpy(graphID,pnt);
+				break;
+			case 2:
+				if(request || strcmp(pnt,URL_STATS) != 0)
+					goto get_malformed_url;
+				stats = true;
 		}
 		
 		pnt = strtok( NULL, delimiter );
 		i++;
 	}
-	if( (!request && i != 2) || (request && i != 1) )
+	if( (!request && !stats && !cores && !cache && !tables && !autoscaler && !pool && i != 2) || (stats && i != 3) || ((request || cores || cache || tables || autoscaler || pool) && i != 1) )
 	{
 		//the URL is malformed
 		goto get_malformed_url; 
@@ -927,7 +1068,25 @@ get_malformed_url:
 		return ret;
 	}
 	
-	if(!request)
+	if(cores)
+		//request for the cores allocated to the NFs
+		return doGetCores(connection);
+	else if(cache)
+		//request for the artifacts of the NFs in the cache
+		return doGetCache(connection);
+	else if(tables)
+		//request for the flow entries of the LSIs
+		return doGetTables(connection);
+	else if(autoscaler)
+		//request for the policy and the events of the autoscaler
+		return doGetAutoscaler(connection);
+	else if(pool)
+		//request for the state and the statistics of the LSI pool
+		return doGetPool(connection);
+	else if(stats)
+		//request for the statistics of the NFs of a graph
+		return doGetGraphStats(connection,graphID);
+	else if(!request)
 		//request for a graph description
 		return doGetGraph(connection,graphID);
 	else
@@ -976,6 +1135,46 @@ int RestServer::doGetGraph(struct MHD_Connection *connection,char *graphID)
 	}
 }
 
+int RestServer::doGetGraphStats(struct MHD_Connection *connection,char *graphID)
+{
+	struct MHD_Response *response;
+	int ret;
+	
+	logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "Required statistics of: %s",graphID);
+	
+	if(!gm->graphExists(graphID))
+	{	
+		logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "The graph \"%s\" does not exist",graphID);
+		response = MHD_create_response_from_buffer (0,(void*) "", MHD_RESPMEM_PERSISTENT);
+		ret = MHD_queue_response (connection, MHD_HTTP_NOT_FOUND, response);
+		MHD_destroy_response (response);
+		return ret;
+	}
+	
+	try
+	{
+		Object json = gm->statsToJSON(graphID);
+		stringstream ssj;
+ 		write_formatted(json, ssj );
+ 		string sssj = ssj.str();
+ 		char *aux = (char*)malloc(sizeof(char) * (sssj.length()+1));
+ 		strcpy(aux,sssj.c_str());
+		response = MHD_create_response_from_buffer (strlen(aux),(void*) aux, MHD_RESPMEM_MUST_FREE);		
+		MHD_add_response_header (response, "Content-Type",JSON_C_TYPE);
+		MHD_add_response_header (response, "Cache-Control",NO_CACHE);
+		ret = MHD_queue_response (connection, MHD_HTTP_OK, response);
+		MHD_destroy_response (response);
+		return ret;
+	}catch(...)
+	{
+		logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "An error occurred while retrieving the statistics of the graph!");
+		response = MHD_create_response_from_buffer (0,(void*) "", MHD_RESPMEM_PERSISTENT);
+		ret = MHD_queue_response (connection, MHD_HTTP_INTERNAL_SERVER_ERROR, response);
+		MHD_destroy_response (response);
+		return ret;
+	}
+}
+
 int RestServer::doGetInterfaces(struct MHD_Connection *connection)
 {
 	struct MHD_Response *response;
@@ -1005,6 +1204,201 @@ int RestServer::doGetInterfaces(struct MHD_Connection *connection)
 	}
 }
 
+int RestServer::doGetTables(struct MHD_Connection *connection)
+{
+	struct MHD_Response *response;
+	int ret;
+	
+	try
+	{
+		Object json = gm->toJSONTables();
+		stringstream ssj;
+ 		write_formatted(json, ssj );
+ 		string sssj = ssj.str();
+ 		char *aux = (char*)malloc(sizeof(char) * (sssj.length()+1));
+ 		strcpy(aux,sssj.c_str());
+		response = MHD_create_response_from_buffer (strlen(aux),(void*) aux, MHD_RESPMEM_MUST_FREE);		
+		MHD_add_response_header (response, "Content-Type",JSON_C_TYPE);
+		MHD_add_response_header (response, "Cache-Control",NO_CACHE);
+		ret = MHD_queue_response (connection, MHD_HTTP_OK, response);
+		MHD_destroy_response (response);
+		return ret;
+	}catch(...)
+	{
+		logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "An error occurred while retrieving the flow entries of the LSIs!");
+		response = MHD_create_response_from_buffer (0,(void*) "", MHD_RESPMEM_PERSISTENT);
+		ret = MHD_queue_response (connection, MHD_HTTP_INTERNAL_SERVER_ERROR, response);
+		MHD_destroy_response (response);
+		return ret;
+	}
+}
+
+int RestServer::doGetCores(struct MHD_Connection *connection)
+{
+	struct MHD_Response *response;
+	int ret;
+	
+	try
+	{
+		Object json = gm->toJSONCores();
+		stringstream ssj;
+ 		write_formatted(json, ssj );
+ 		string sssj = ssj.str();
+ 		char *aux = (char*)malloc(sizeof(char) * (sssj.length()+1));
+ 		strcpy(aux,sssj.c_str());
+		response = MHD_create_response_from_buffer (strlen(aux),(void*) aux, MHD_RESPMEM_MUST_FREE);		
+		MHD_add_response_header (response, "Content-Type",JSON_C_TYPE);
+		MHD_add_response_header (response, "Cache-Control",NO_CACHE);
+		ret = MHD_queue_response (connection, MHD_HTTP_OK, response);
+		MHD_destroy_response (response);
+		return ret;
+	}catch(...)
+	{
+		logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "An error occurred while retrieving the description of the cores!");
+		response = MHD_create_response_from_buffer (0,(void*) "", MHD_RESPMEM_PERSISTENT);
+		ret = MHD_queue_response (connection, MHD_HTTP_INTERNAL_SERVER_ERROR, response);
+		MHD_destroy_response (response);
+		return ret;
+	}
+}
+
+int RestServer::doGetAutoscaler(struct MHD_Connection *connection)
+{
+	struct MHD_Response *response;
+	int ret;
+	
+	try
+	{
+		Object json = gm->toJSONAutoscaler();
+		stringstream ssj;
+ 		write_formatted(json, ssj );
+ 		string sssj = ssj.str();
+ 		char *aux = (char*)malloc(sizeof(char) * (sssj.length()+1));
+ 		strcpy(aux,sssj.c_str());
+		response = MHD_create_response_from_buffer (strlen(aux),(void*) aux, MHD_RESPMEM_MUST_FREE);		
+		MHD_add_response_header (response, "Content-Type",JSON_C_TYPE);
+		MHD_add_response_header (response, "Cache-Control",NO_CACHE);
+		ret = MHD_queue_response (connection, MHD_HTTP_OK, response);
+		MHD_destroy_response (response);
+		return ret;
+	}catch(...)
+	{
+		logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "An error occurred while retrieving the description of the autoscaler!");
+		response = MHD_create_response_from_buffer (0,(void*) "", MHD_RESPMEM_PERSISTENT);
+		ret = MHD_queue_response (connection, MHD_HTTP_INTERNAL_SERVER_ERROR, response);
+		MHD_destroy_response (response);
+		return ret;
+	}
+}
+
+int RestServer::doGetPool(struct MHD_Connection *connection)
+{
+	struct MHD_Response *response;
+	int ret;
+	
+	try
+	{
+		Object json = gm->toJSONPool();
+		stringstream ssj;
+ 		write_formatted(json, ssj );
+ 		string sssj = ssj.str();
+ 		char *aux = (char*)malloc(sizeof(char) * (sssj.length()+1));
+ 		strcpy(aux,sssj.c_str());
+		response = MHD_create_response_from_buffer (strlen(aux),(void*) aux, MHD_RESPMEM_MUST_FREE);		
+		MHD_add_response_header (response, "Content-Type",JSON_C_TYPE);
+		MHD_add_response_header (response, "Cache-Control",NO_CACHE);
+		ret = MHD_queue_response (connection, MHD_HTTP_OK, response);
+		MHD_destroy_response (response);
+		return ret;
+	}catch(...)
+	{
+		logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "An error occurred while retrieving the description of the LSI pool!");
+		response = MHD_create_response_from_buffer (0,(void*) "", MHD_RESPMEM_PERSISTENT);
+		ret = MHD_queue_response (connection, MHD_HTTP_INTERNAL_SERVER_ERROR, response);
+		MHD_destroy_response (response);
+		return ret;
+	}
+}
+
+int RestServer::doGetCache(struct MHD_Connection *connection)
+{
+	struct MHD_Response *response;
+	int ret;
+	
+	try
+	{
+		Object json = gm->toJSONCache();
+		stringstream ssj;
+ 		write_formatted(json, ssj );
+ 		string sssj = ssj.str();
+ 		char *aux = (char*)malloc(sizeof(char) * (sssj.length()+1));
+ 		strcpy(aux,sssj.c_str());
+		response = MHD_create_response_from_buffer (strlen(aux),(void*) aux, MHD_RESPMEM_MUST_FREE);		
+		MHD_add_response_header (response, "Content-Type",JSON_C_TYPE);
+		MHD_add_response_header (response, "Cache-Control",NO_CACHE);
+		ret = MHD_queue_response (connection, MHD_HTTP_OK, response);
+		MHD_destroy_response (response);
+		return ret;
+	}catch(...)
+	{
+		logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "An error occurred while retrieving the description of the NF cache!");
+		response = MHD_create_response_from_buffer (0,(void*) "", MHD_RESPMEM_PERSISTENT);
+		ret = MHD_queue_response (connection, MHD_HTTP_INTERNAL_SERVER_ERROR, response);
+		MHD_destroy_response (response);
+		return ret;
+	}
+}
+
+int RestServer::doPutCache(struct MHD_Connection *connection,char *nf)
+{
+	struct MHD_Response *response;
+	int ret;
+	
+	logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "The artifacts of the NF \"%s\" must be cached",nf);
+	
+	try
+	{
+		Object json;
+		nf_manager_ret_t retVal = gm->prefetchNF(nf,json);
+		if(retVal == NFManager_NO_NF)
+		{
+			logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "The NF \"%s\" does not exist",nf);
+			response = MHD_create_response_from_buffer (0,(void*) "", MHD_RESPMEM_PERSISTENT);
+			ret = MHD_queue_response (connection, MHD_HTTP_NOT_FOUND, response);
+			MHD_destroy_response (response);
+			return ret;
+		}
+		else if(retVal != NFManager_OK)
+		{
+			logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "An error occurred while caching the artifacts of the NF \"%s\"!",nf);
+			response = MHD_create_response_from_buffer (0,(void*) "", MHD_RESPMEM_PERSISTENT);
+			ret = MHD_queue_response (connection, MHD_HTTP_INTERNAL_SERVER_ERROR, response);
+			MHD_destroy_response (response);
+			return ret;
+		}
+		
+		//The artifacts are retrieved in background
+		stringstream ssj;
+ 		write_formatted(json, ssj );
+ 		string sssj = ssj.str();
+ 		char *aux = (char*)malloc(sizeof(char) * (sssj.length()+1));
+ 		strcpy(aux,sssj.c_str());
+		response = MHD_create_response_from_buffer (strlen(aux),(void*) aux, MHD_RESPMEM_MUST_FREE);		
+		MHD_add_response_header (response, "Content-Type",JSON_C_TYPE);
+		MHD_add_response_header (response, "Cache-Control",NO_CACHE);
+		ret = MHD_queue_response (connection, MHD_HTTP_ACCEPTED, response);
+		MHD_destroy_response (response);
+		return ret;
+	}catch(...)
+	{
+		logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "An error occurred while caching the artifacts of the NF \"%s\"!",nf);
+		response = MHD_create_response_from_buffer (0,(void*) "", MHD_RESPMEM_PERSISTENT);
+		ret = MHD_queue_response (connection, MHD_HTTP_INTERNAL_SERVER_ERROR, response);
+		MHD_destroy_response (response);
+		return ret;
+	}
+}
+
 int RestServer::doDelete(struct MHD_Connection *connection, const char *url, void **con_cls)
 {
 	struct MHD_Response *response;
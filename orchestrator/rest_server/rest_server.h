@@ -18,6 +18,8 @@
 *			The graph is described into the body of the message.
 *		GET /graph/graph_id
 *			Retrieve the description of the graph with ID graph_id
+*		GET /graph/graph_id/stats
+*			Retrieve the statistics of the NFs of the graph with ID graph_id
 *		DELETE /graph/graph_id
 *			Delete the graph with ID graph_id
 *		DELETE /garph/graph_id/flow_id
@@ -26,6 +28,12 @@
 *		GET /interfaces
 *			Retrieve information on the physical interfaces available on the
 *			node
+*		GET /autoscaler
+*			Retrieve the policy of the autoscaler of the DPDK NFs, and the last
+*			changes of the number of replicas it decided
+*		GET /pool
+*			Retrieve the state of the pool of tenant-LSIs, its hit rate and the
+*			time needed to provide the new graphs with their LSI
 */
 
 
@@ -39,6 +47,8 @@
 #include <string.h>
 #include <assert.h>
 #include <stdlib.h>
+#include <ctype.h>
+#include <errno.h>
 #include <inttypes.h>
 #include <sstream>
 
@@ -73,9 +83,20 @@ private:
 
 	static int doGet(struct MHD_Connection *connection,const char *url);
 	static int doGetGraph(struct MHD_Connection *connection,char *graphID);
+	static int doGetGraphStats(struct MHD_Connection *connection,char *graphID);
 	static int doGetInterfaces(struct MHD_Connection *connection);
+	static int doGetCores(struct MHD_Connection *connection);
+	static int doGetCache(struct MHD_Connection *connection);
+	static int doGetTables(struct MHD_Connection *connection);
+	static int doGetAutoscaler(struct MHD_Connection *connection);
+	static int doGetPool(struct MHD_Connection *connection);
 	static int doPut(struct MHD_Connection *connection, const char *url, void **con_cls);
 	
+	/**
+	*	Start retrieving in background the artifacts of a NF
+	*/
+	static int doPutCache(struct MHD_Connection *connection,char *nf);
+	
 	/**
 	*	Delete either an entire graph, or a specific flow
 	*/
@@ -93,7 +114,7 @@ public:
 #ifdef READ_JSON_FROM_FILE
 	static bool init(char *filename,int core_mask, bool wireless = false, char *wirelessName = "wlan0");
 #else
-	static bool init(int core_mask, bool wireless = false, char *wirelessName = "wlan0");
+	static bool init(int core_mask, unsigned int lsi_pool_size, bool autoscaling, bool wireless = false, char *wirelessName = "wlan0");
 #endif
 	
 	static void terminate();
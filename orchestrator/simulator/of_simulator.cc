@@ -0,0 +1,458 @@
+#include "of_simulator.h"
+
+void OFSimulator::addLSI(string name, list<lowlevel::Rule> entries)
+{
+	sim_lsi_t &lsi = lsis[name];
+
+	for(list<lowlevel::Rule>::iterator e = entries.begin(); e != entries.end(); e++)
+	{
+		//The entries with the same priority are kept in insertion order
+		list<lowlevel::Rule> &table = lsi.tables[e->getTable()];
+		list<lowlevel::Rule>::iterator position = table.begin();
+		while(position != table.end() && position->getPriority() >= e->getPriority())
+			position++;
+		table.insert(position,*e);
+	}
+
+	logger(ORCH_DEBUG_INFO, MODULE_NAME, __FILE__, __LINE__, "LSI \"%s\": %d flow entries in %d tables",name.c_str(),entries.size(),lsi.tables.size());
+}
+
+void OFSimulator::addLSI(string name, lowlevel::Graph graph)
+{
+	addLSI(name,graph.getRules());
+}
+
+void OFSimulator::addPort(string lsi, string name, unsigned int port)
+{
+	lsis[lsi].ports[port] = name;
+}
+
+void OFSimulator::addGroup(string lsi, lowlevel::Group group)
+{
+	lsis[lsi].groups[group.getID()] = group.getPorts();
+}
+
+void OFSimulator::addVirtualLink(string lsi, unsigned int port, string remoteLSI, unsigned int remotePort)
+{
+	vlinks[make_pair(lsi,port)] = make_pair(remoteLSI,remotePort);
+	vlinks[make_pair(remoteLSI,remotePort)] = make_pair(lsi,port);
+}
+
+bool OFSimulator::getPort(string lsi, string name, unsigned int &port)
+{
+	map<string, sim_lsi_t>::iterator l = lsis.find(lsi);
+	if(l == lsis.end())
+		return false;
+
+	for(map<unsigned int, string>::iterator p = l->second.ports.begin(); p != l->second.ports.end(); p++)
+	{
+		if(p->second == name)
+		{
+			port = p->first;
+			return true;
+		}
+	}
+
+	//The port can be given through its ID (e.g., a virtual link)
+	char *end;
+	port = strtoul(name.c_str(),&end,10);
+	return name != "" && *end == '\0';
+}
+
+sim_lookup_t OFSimulator::lookup(list<lowlevel::Rule> &table, lowlevel::Match &packet, lowlevel::Action &action)
+{
+	sim_lookup_t result;
+	result.entry = "";
+	result.ambiguous = false;
+	result.entries = table.size();
+	result.examined = 0;
+
+	for(list<lowlevel::Rule>::iterator e = table.begin(); e != table.end(); e++)
+	{
+		result.examined++;
+		if(!e->getMatch().covers(packet))
+			continue;
+
+		result.entry = e->getID();
+		action = e->getAction();
+
+		//Other entries with the same priority may match the packet
+		list<lowlevel::Rule>::iterator other = e;
+		for(other++; other != table.end() && other->getPriority() == e->getPriority() && !result.ambiguous; other++)
+			result.ambiguous = other->getMatch().covers(packet);
+		break;
+	}
+
+	return result;
+}
+
+sim_trace_t OFSimulator::trace(string lsi, unsigned int port, lowlevel::Match packet)
+{
+	sim_trace_t trace;
+	trace.result = SIM_LOOP;
+	trace.lsi = lsi;
+	trace.port = 0;
+	trace.traversed = 1;
+	trace.examined = 0;
+
+	string current = lsi;
+	unsigned int inPort = port;
+	uint8_t table = 0;
+
+	for(unsigned int i = 0; i < SIM_MAX_LOOKUPS; i++)
+	{
+		map<string, sim_lsi_t>::iterator l = lsis.find(current);
+		if(l == lsis.end())
+		{
+			logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "LSI \"%s\" does not exist",current.c_str());
+			trace.result = SIM_NO_LSI;
+			trace.lsi = current;
+			return trace;
+		}
+
+		packet.setInputPort(inPort);
+		lowlevel::Action action(0);
+		list<lowlevel::Rule> empty;
+		map<uint8_t, list<lowlevel::Rule> >::iterator t = l->second.tables.find(table);
+		sim_lookup_t result = lookup((t != l->second.tables.end())? t->second : empty,packet,action);
+		result.lsi = current;
+		result.in_port = inPort;
+		result.table = table;
+		trace.lookups.push_back(result);
+		trace.examined += result.examined;
+
+		if(result.entry == "")
+		{
+			trace.result = SIM_TABLE_MISS;
+			trace.lsi = current;
+			return trace;
+		}
+
+		if(action.isGotoTable())
+		{
+			table = action.getTable();
+			continue;
+		}
+		
+		unsigned int outPort = action.getPortID();
+		if(action.isGroup())
+		{
+			map<uint32_t, list<uint32_t> >::iterator group = l->second.groups.find(action.getGroup());
+			if(group == l->second.groups.end() || group->second.empty())
+			{
+				//The datapath drops the packet, as in case of table miss
+				logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "Group %d of LSI \"%s\" does not exist",action.getGroup(),current.c_str());
+				trace.result = SIM_TABLE_MISS;
+				trace.lsi = current;
+				return trace;
+			}
+			outPort = group->second.front();
+		}
+
+		map<pair<string, unsigned int>, pair<string, unsigned int> >::iterator vlink = vlinks.find(make_pair(current,outPort));
+		if(vlink == vlinks.end())
+		{
+			//The packet leaves the node
+			trace.result = SIM_OUTPUT;
+			trace.lsi = current;
+			trace.port = outPort;
+			trace.portName = (l->second.ports.count(trace.port) != 0)? l->second.ports[trace.port] : "";
+			return trace;
+		}
+
+		//The packet crosses a virtual link
+		current = vlink->second.first;
+		inPort = vlink->second.second;
+		table = 0;
+		trace.traversed++;
+	}
+
+	logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "The packet is still in the LSIs after %d lookups",SIM_MAX_LOOKUPS);
+	return trace;
+}
+
+/**
+*	@brief: parse a decimal (or hexadecimal) number not larger than max
+*/
+static bool parseNumber(string value, int base, uint32_t max, uint32_t &number)
+{
+	char *end;
+	unsigned long n = strtoul(value.c_str(),&end,base);
+	if(value == "" || *end != '\0' || n > max)
+		return false;
+	number = n;
+	return true;
+}
+
+typedef void (graph::Match::*string_setter_t)(char *);
+
+bool OFSimulator::parseMatch(Object object, lowlevel::Match &match)
+{
+	static const struct
+	{
+		const char *name;
+		string_setter_t setter;
+	}stringFields[] = {
+		{ETH_SRC, &graph::Match::setEthSrc}, {ETH_SRC_MASK, &graph::Match::setEthSrcMask},
+		{ETH_DST, &graph::Match::setEthDst}, {ETH_DST_MASK, &graph::Match::setEthDstMask},
+		{IPv4_SRC, &graph::Match::setIpv4Src}, {IPv4_SRC_MASK, &graph::Match::setIpv4SrcMask},
+		{IPv4_DST, &graph::Match::setIpv4Dst}, {IPv4_DST_MASK, &graph::Match::setIpv4DstMask},
+		{ARP_SPA, &graph::Match::setArpSpa}, {ARP_SPA_MASK, &graph::Match::setArpSpaMask},
+		{ARP_TPA, &graph::Match::setArpTpa}, {ARP_TPA_MASK, &graph::Match::setArpTpaMask},
+		{ARP_SHA, &graph::Match::setArpSha}, {ARP_THA, &graph::Match::setArpTha},
+		{IPv6_SRC, &graph::Match::setIpv6Src}, {IPv6_SRC_MASK, &graph::Match::setIpv6SrcMask},
+		{IPv6_DST, &graph::Match::setIpv6Dst}, {IPv6_DST_MASK, &graph::Match::setIpv6DstMask},
+		{IPv6_ND_TARGET, &graph::Match::setIpv6NdTarget}, {IPv6_ND_SLL, &graph::Match::setIpv6NdSll},
+		{IPv6_ND_TLL, &graph::Match::setIpv6NdTll}
+	};
+
+	for(Object::const_iterator f = object.begin(); f != object.end(); f++)
+	{
+		const string &name = f->first;
+		string value = f->second.getString();
+		uint32_t n = 0;
+		bool valid = true;
+
+		unsigned int s = 0;
+		for(; s < sizeof(stringFields)/sizeof(stringFields[0]); s++)
+		{
+			if(name == stringFields[s].name)
+				break;
+		}
+		if(s < sizeof(stringFields)/sizeof(stringFields[0]))
+		{
+			(match.*(stringFields[s].setter))((char*)value.c_str());
+			continue;
+		}
+
+		if(name == IN_PORT && (valid = parseNumber(value,10,0xFFFFFFFF,n)))
+			match.setInputPort(n);
+		else if(name == ETH_TYPE && (valid = parseNumber(value,16,0xFFFF,n)))
+			match.setEthType(n);
+		else if(name == VLAN_ID && value == ANY_VLAN)
+			match.setVlanIDAnyVlan();
+		else if(name == VLAN_ID && value == NO_VLAN)
+			match.setVlanIDNoVlan();
+		else if(name == VLAN_ID && (valid = parseNumber(value,10,4095,n)))
+			match.setVlanID(n);
+		else if(name == VLAN_PCP && (valid = parseNumber(value,10,7,n)))
+			match.setVlanPCP(n);
+		else if(name == IP_DSCP && (valid = parseNumber(value,10,63,n)))
+			match.setIpDSCP(n);
+		else if(name == IP_ECN && (valid = parseNumber(value,10,3,n)))
+			match.setIpECN(n);
+		else if(name == IP_PROTO && (valid = parseNumber(value,10,255,n)))
+			match.setIpProto(n);
+		else if(name == TCP_SRC && (valid = parseNumber(value,10,0xFFFF,n)))
+			match.setTcpSrc(n);
+		else if(name == TCP_DST && (valid = parseNumber(value,10,0xFFFF,n)))
+			match.setTcpDst(n);
+		else if(name == UDP_SRC && (valid = parseNumber(value,10,0xFFFF,n)))
+			match.setUdpSrc(n);
+		else if(name == UDP_DST && (valid = parseNumber(value,10,0xFFFF,n)))
+			match.setUdpDst(n);
+		else if(name == SCTP_SRC && (valid = parseNumber(value,10,0xFFFF,n)))
+			match.setSctpSrc(n);
+		else if(name == SCTP_DST && (valid = parseNumber(value,10,0xFFFF,n)))
+			match.setSctpDst(n);
+		else if(name == ICMPv4_TYPE && (valid = parseNumber(value,10,255,n)))
+			match.setIcmpv4Type(n);
+		else if(name == ICMPv4_CODE && (valid = parseNumber(value,10,255,n)))
+			match.setIcmpv4Code(n);
+		else if(name == ARP_OPCODE && (valid = parseNumber(value,10,0xFFFF,n)))
+			match.setArpOpCode(n);
+		else if(name == IPv6_FLABEL && (valid = parseNumber(value,10,0xFFFFF,n)))
+			match.setIpv6Flabel(n);
+		else if(name == ICMPv6_TYPE && (valid = parseNumber(value,10,255,n)))
+			match.setIcmpv6Type(n);
+		else if(name == ICMPv6_CODE && (valid = parseNumber(value,10,255,n)))
+			match.setIcmpv6Code(n);
+		else if(name == MPLS_LABEL && (valid = parseNumber(value,10,0xFFFFF,n)))
+			match.setMplsLabel(n);
+		else if(name == MPLS_TC && (valid = parseNumber(value,10,7,n)))
+			match.setMplsTC(n);
+		else if(valid)
+		{
+			logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "Invalid key \"%s\" in \"%s\"",name.c_str(),MATCH);
+			return false;
+		}
+
+		if(!valid)
+		{
+			logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "Key \"%s\" with wrong value \"%s\"",name.c_str(),value.c_str());
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool OFSimulator::parseEntry(Object object, list<lowlevel::Rule> &entries)
+{
+	string ID;
+	uint64_t priority = 0;
+	uint8_t table = 0;
+	lowlevel::Match match;
+	lowlevel::Action action(0);
+	bool foundAction = false;
+
+	for(Object::const_iterator f = object.begin(); f != object.end(); f++)
+	{
+		if(f->first == _ID)
+			ID = f->second.getString();
+		else if(f->first == TABLE_ID)
+			table = f->second.getUInt64();
+		else if(f->first == PRIORITY)
+			priority = f->second.getUInt64();
+		else if(f->first == MATCH)
+		{
+			if(!parseMatch(f->second.getObject(),match))
+				return false;
+		}
+		else if(f->first == ACTION)
+		{
+			Object a = f->second.getObject();
+			if(a.count(OUTPUT_PORT) != 0)
+				action = lowlevel::Action(a[OUTPUT_PORT].getUInt64());
+			else if(a.count(GOTO_TABLE) != 0)
+				action = lowlevel::Action::gotoTable(a[GOTO_TABLE].getUInt64());
+			else if(a.count(GROUP) != 0)
+				action = lowlevel::Action::outputGroup(a[GROUP].getUInt64());
+			else
+				return false;
+			foundAction = true;
+		}
+	}
+
+	if(!foundAction)
+	{
+		logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "Flow entry \"%s\" without \"%s\"",ID.c_str(),ACTION);
+		return false;
+	}
+
+	entries.push_back(lowlevel::Rule(match,action,ID,priority,table));
+	return true;
+}
+
+bool OFSimulator::load(Object tables)
+{
+	try
+	{
+		Array jsonLSIs = tables[LSIS].getArray();
+		for(Array::iterator l = jsonLSIs.begin(); l != jsonLSIs.end(); l++)
+		{
+			Object jsonLSI = l->getObject();
+			string name = jsonLSI[PORT_NAME].getString();
+
+			Object ports = jsonLSI[LSI_PORTS].getObject();
+			for(Object::iterator p = ports.begin(); p != ports.end(); p++)
+				addPort(name,p->first,p->second.getUInt64());
+
+			list<lowlevel::Rule> entries;
+			Array jsonEntries = jsonLSI[FLOW_ENTRIES].getArray();
+			for(Array::iterator e = jsonEntries.begin(); e != jsonEntries.end(); e++)
+			{
+				if(!parseEntry(e->getObject(),entries))
+					return false;
+			}
+			addLSI(name,entries);
+			
+			if(jsonLSI.count(GROUPS) != 0)
+			{
+				Array jsonGroups = jsonLSI[GROUPS].getArray();
+				for(Array::iterator g = jsonGroups.begin(); g != jsonGroups.end(); g++)
+				{
+					Object group = g->getObject();
+					list<uint32_t> buckets;
+					Array jsonBuckets = group[BUCKETS].getArray();
+					for(Array::iterator b = jsonBuckets.begin(); b != jsonBuckets.end(); b++)
+						buckets.push_back(b->getUInt64());
+					addGroup(name,lowlevel::Group(group[_ID].getUInt64(),buckets));
+				}
+			}
+		}
+
+		Array jsonVLinks = tables[VIRTUAL_LINKS].getArray();
+		for(Array::iterator v = jsonVLinks.begin(); v != jsonVLinks.end(); v++)
+		{
+			Object vlink = v->getObject();
+			addVirtualLink(vlink[LSI_NAME].getString(),vlink[PORT].getUInt64(),vlink[REMOTE_LSI].getString(),vlink[REMOTE_PORT].getUInt64());
+		}
+	}catch(...)
+	{
+		logger(ORCH_WARNING, MODULE_NAME, __FILE__, __LINE__, "The description of the flow tables is malformed");
+		return false;
+	}
+
+	return true;
+}
+
+Object OFSimulator::tablesToJSON()
+{
+	Object json;
+
+	for(map<string, sim_lsi_t>::iterator l = lsis.begin(); l != lsis.end(); l++)
+	{
+		Object tables;
+		uint64_t total = 0;
+		for(map<uint8_t, list<lowlevel::Rule> >::iterator t = l->second.tables.begin(); t != l->second.tables.end(); t++)
+		{
+			stringstream table;
+			table << (unsigned int)t->first;
+			tables[table.str()] = (uint64_t)t->second.size();
+			total += t->second.size();
+		}
+
+		Object lsi;
+		lsi["tables"] = tables;
+		lsi[FLOW_ENTRIES] = total;
+		json[l->first] = lsi;
+	}
+
+	return json;
+}
+
+Object OFSimulator::traceToJSON(sim_trace_t trace)
+{
+	static const char *results[] = {"output", "table-miss", "loop", "unknown-lsi"};
+
+	Object json;
+	json["result"] = results[trace.result];
+
+	Array lookups;
+	for(list<sim_lookup_t>::iterator l = trace.lookups.begin(); l != trace.lookups.end(); l++)
+	{
+		Object lookup;
+		lookup[LSI_NAME] = l->lsi;
+		lookup[IN_PORT] = (uint64_t)l->in_port;
+		lookup[TABLE_ID] = (uint64_t)l->table;
+		if(l->entry != "")
+			lookup["entry"] = l->entry;
+		if(l->ambiguous)
+			lookup["ambiguous"] = true;
+		lookup[FLOW_ENTRIES] = (uint64_t)l->entries;
+		lookup["examined"] = (uint64_t)l->examined;
+		lookups.push_back(lookup);
+	}
+	json["lookups"] = lookups;
+
+	if(trace.result == SIM_OUTPUT)
+	{
+		Object output;
+		output[LSI_NAME] = trace.lsi;
+		output[PORT] = (uint64_t)trace.port;
+		if(trace.portName != "")
+			output[PORT_NAME] = trace.portName;
+		json[OUTPUT_PORT] = output;
+	}
+	else
+		json[LSI_NAME] = trace.lsi;
+
+	Object cost;
+	cost["lsis"] = (uint64_t)trace.traversed;
+	cost["lookups"] = (uint64_t)trace.lookups.size();
+	cost["examined"] = (uint64_t)trace.examined;
+	json["cost"] = cost;
+
+	return json;
+}
@@ -0,0 +1,202 @@
+#ifndef OF_SIMULATOR_H_
+#define OF_SIMULATOR_H_ 1
+
+#pragma once
+
+#include <map>
+#include <list>
+#include <string>
+#include <sstream>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include "../graph/low_level_graph/graph.h"
+#include "../graph/low_level_graph/group.h"
+#include "../utils/logger.h"
+#include "../utils/constants.h"
+
+#include <json_spirit/json_spirit.h>
+#include <json_spirit/value.h>
+#include <json_spirit/writer.h>
+
+using namespace std;
+using namespace json_spirit;
+
+/**
+*	@brief: number of lookups after which a packet is considered in a loop
+*/
+#define SIM_MAX_LOOKUPS		64
+
+typedef enum{SIM_OUTPUT,SIM_TABLE_MISS,SIM_LOOP,SIM_NO_LSI}sim_result_t;
+
+/**
+*	@brief: a lookup in a flow table
+*/
+typedef struct
+{
+	string lsi;
+	unsigned int in_port;
+	uint8_t table;
+
+	/**
+	*	@brief: flow entry matched (empty in case of table miss), and true if other
+	*		entries with the same priority match the packet as well (the datapath
+	*		can pick any of them)
+	*/
+	string entry;
+	bool ambiguous;
+
+	/**
+	*	@brief: entries in the table, and entries compared with the packet before
+	*		finding the matching one (all of them in case of table miss)
+	*/
+	unsigned int entries;
+	unsigned int examined;
+}sim_lookup_t;
+
+/**
+*	@brief: path of a packet through the LSIs
+*/
+typedef struct
+{
+	sim_result_t result;
+	list<sim_lookup_t> lookups;
+
+	/**
+	*	@brief: LSI and port on which the packet leaves the node (SIM_OUTPUT)
+	*/
+	string lsi;
+	unsigned int port;
+	string portName;
+
+	/**
+	*	@brief: LSIs traversed, and entries compared with the packet in all the
+	*		lookups
+	*/
+	unsigned int traversed;
+	unsigned int examined;
+}sim_trace_t;
+
+/**
+*	@brief: offline model of the OpenFlow 1.2 flow tables of the LSI-0 and of
+*		the tenant-LSIs, connected by the virtual links. It traces synthetic
+*		packets through the LSIs without running xDPd, and then it can be used
+*		to check the rules created by the GraphTranslator, and to compare
+*		different table layouts.
+*
+*		Each lookup selects the entry with the highest priority whose match
+*		covers the packet (see lowlevel::Match::covers), and applies its action:
+*		goto table, or output on a port or on a select group. A select group
+*		always sends the packet on its first bucket, since the hash used by the
+*		datapath is not known. A packet sent on a virtual link continues
+*		in the table 0 of the LSI on the other side; a table miss sends the packet
+*		to the controller, which drops it.
+*
+*		The cost of a lookup is estimated as the number of entries compared with
+*		the packet, in decreasing priority, before finding the matching one (i.e.,
+*		the cost of a linear classifier, as the one of the software datapath).
+*
+*		Limitations: the packets are not modified by the LSIs (the only actions
+*		are output and goto table), and masked Ethernet addresses are not
+*		supported.
+*/
+class OFSimulator
+{
+private:
+	typedef struct
+	{
+		/**
+		*	@brief: entries of each table, in decreasing priority
+		*/
+		map<uint8_t, list<lowlevel::Rule> > tables;
+
+		/**
+		*	@brief: names of the ports, indexed by ID
+		*/
+		map<unsigned int, string> ports;
+		
+		/**
+		*	@brief: ports of the buckets of the groups, indexed by group ID
+		*/
+		map<uint32_t, list<uint32_t> > groups;
+	}sim_lsi_t;
+
+	map<string, sim_lsi_t> lsis;
+
+	/**
+	*	@brief: virtual links, in both directions. <LSI, port> -> <LSI, port>
+	*/
+	map<pair<string, unsigned int>, pair<string, unsigned int> > vlinks;
+
+	/**
+	*	@brief: look for the entry matching a packet in a table
+	*/
+	static sim_lookup_t lookup(list<lowlevel::Rule> &table, lowlevel::Match &packet, lowlevel::Action &action);
+
+	/**
+	*	@brief: parse a flow entry, as provided by GET /tables, and append it to
+	*		a list of entries
+	*/
+	static bool parseEntry(Object object, list<lowlevel::Rule> &entries);
+
+public:
+	/**
+	*	@brief: add an LSI with the given flow entries (e.g., the rules of a graph
+	*		created by the GraphTranslator, or its entries created by the
+	*		GraphOptimizer)
+	*/
+	void addLSI(string name, list<lowlevel::Rule> entries);
+	void addLSI(string name, lowlevel::Graph graph);
+
+	/**
+	*	@brief: give a name to a port of an LSI
+	*/
+	void addPort(string lsi, string name, unsigned int port);
+
+	/**
+	*	@brief: add a select group to an LSI
+	*/
+	void addGroup(string lsi, lowlevel::Group group);
+
+	/**
+	*	@brief: connect two ports of two LSIs with a virtual link
+	*/
+	void addVirtualLink(string lsi, unsigned int port, string remoteLSI, unsigned int remotePort);
+
+	/**
+	*	@brief: load the LSIs and the virtual links provided by GET /tables.
+	*		Returns false if the description is malformed
+	*/
+	bool load(Object tables);
+
+	/**
+	*	@brief: return the ID of a port of an LSI, given its name (or its ID).
+	*		Returns false if the port does not exist
+	*/
+	bool getPort(string lsi, string name, unsigned int &port);
+
+	/**
+	*	@brief: trace a packet received by an LSI from a port
+	*
+	*	@param: lsi		LSI receiving the packet
+	*	@param: port	Port on which the packet is received
+	*	@param: packet	Header fields of the packet (the input port is ignored)
+	*/
+	sim_trace_t trace(string lsi, unsigned int port, lowlevel::Match packet);
+
+	/**
+	*	@brief: number of entries in each table of each LSI
+	*/
+	Object tablesToJSON();
+
+	/**
+	*	@brief: parse a match with the syntax used in the NF-FG (plus IN_PORT, i.e.,
+	*		the ID of the input port). All the values are strings.
+	*		Returns false if the match is malformed
+	*/
+	static bool parseMatch(Object object, lowlevel::Match &match);
+
+	static Object traceToJSON(sim_trace_t trace);
+};
+
+#endif //OF_SIMULATOR_H_
@@ -0,0 +1,92 @@
+#include "of_simulator.h"
+
+#include <fstream>
+#include <string.h>
+
+/**
+*	Offline tracing of a packet through the flow tables of the LSIs, as provided
+*	by GET /tables. Example:
+*
+*		of-simulator tables.json LSI-0 eth1 ethertype=0x0800 ipv4_dst=10.0.0.1
+*/
+
+bool usage(void)
+{
+	logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "Usage:\n" \
+	"  of-simulator <tables> <lsi> <port> [<field>=<value> ...]\n\n" \
+	"Parameters:\n" \
+	"  <tables>\n" \
+	"        File containing the flow tables (GET /tables)\n" \
+	"  <lsi>\n" \
+	"        LSI receiving the packet (e.g., LSI-0, or the ID of a graph)\n" \
+	"  <port>\n" \
+	"        Name (or ID) of the port on which the packet is received\n" \
+	"  <field>=<value>\n" \
+	"        Header field of the packet, with the syntax of the NF-FG match\n" \
+	"        (e.g., ipv4_dst=10.0.0.1). Without vlan_id, the packet is untagged\n\n" \
+	"Description:\n" \
+	"  Traces the packet through the LSIs, and prints the flow entries matched and\n" \
+	"  the number of entries compared with the packet in each lookup\n\n");
+
+	return false;
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc < 4)
+	{
+		usage();
+		exit(EXIT_FAILURE);
+	}
+
+	ifstream file(argv[1]);
+	if(!file.good())
+	{
+		logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "Cannot open file \"%s\"",argv[1]);
+		exit(EXIT_FAILURE);
+	}
+	Value value;
+	OFSimulator simulator;
+	if(!read(file,value) || value.type() != obj_type || !simulator.load(value.getObject()))
+	{
+		logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "File \"%s\" does not contain valid flow tables",argv[1]);
+		exit(EXIT_FAILURE);
+	}
+
+	unsigned int port;
+	if(!simulator.getPort(argv[2],argv[3],port))
+	{
+		logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "Port \"%s\" of LSI \"%s\" does not exist",argv[3],argv[2]);
+		exit(EXIT_FAILURE);
+	}
+
+	Object fields;
+	fields[VLAN_ID] = NO_VLAN;
+	for(int i = 4; i < argc; i++)
+	{
+		char *separator = strchr(argv[i],'=');
+		if(separator == NULL)
+		{
+			usage();
+			exit(EXIT_FAILURE);
+		}
+		fields[string(argv[i],separator - argv[i])] = string(separator + 1);
+	}
+
+	lowlevel::Match packet;
+	if(!OFSimulator::parseMatch(fields,packet))
+	{
+		logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "The packet is malformed");
+		exit(EXIT_FAILURE);
+	}
+
+	Object json;
+	json["trace"] = OFSimulator::traceToJSON(simulator.trace(argv[2],port,packet));
+	json["tables"] = simulator.tablesToJSON();
+
+	stringstream ss;
+	write_formatted(json, ss);
+	cout << ss.str() << endl;
+
+	return 0;
+}
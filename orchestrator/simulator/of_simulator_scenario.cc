@@ -0,0 +1,151 @@
+#include "of_simulator.h"
+
+#include <fstream>
+
+/**
+*	Regression scenarios of the flow tables. A scenario is a file containing a
+*	snapshot of the flow tables ("tables", as provided by GET /tables) and some
+*	packets, each one with the verdict expected from the simulator ("result",
+*	and "output" as "<lsi>:<port name>"). Example:
+*
+*		of-simulator-scenario simulator/scenarios/qos_fields.json
+*
+*	The matches of the snapshot are also written again as the node-orchestrator
+*	does, and they must not change. The program fails if a check fails.
+*/
+
+/**
+*	@brief: check that the match of each flow entry of the snapshot is written
+*		again as it is in the snapshot
+*/
+bool checkMatches(Object tables)
+{
+	bool ok = true;
+
+	Array lsis = tables[LSIS].getArray();
+	for(Array::iterator l = lsis.begin(); l != lsis.end(); l++)
+	{
+		Object lsi = l->getObject();
+		Array entries = lsi[FLOW_ENTRIES].getArray();
+		for(Array::iterator e = entries.begin(); e != entries.end(); e++)
+		{
+			Object entry = e->getObject();
+			Object original = entry[MATCH].getObject();
+
+			lowlevel::Match match;
+			if(!OFSimulator::parseMatch(original,match))
+				return false;
+			Object written;
+			match.toJSON(written);
+
+			for(Object::iterator f = original.begin(); f != original.end(); f++)
+			{
+				if(written.count(f->first) == 0 || written[f->first].getString() != f->second.getString())
+				{
+					logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "Flow entry \"%s\": \"%s\" is \"%s\" instead of \"%s\"",entry[_ID].getString().c_str(),f->first.c_str(),(written.count(f->first) != 0)? written[f->first].getString().c_str() : "",f->second.getString().c_str());
+					ok = false;
+				}
+			}
+			if(written.size() != original.size())
+			{
+				logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "Flow entry \"%s\": %d fields written instead of %d",entry[_ID].getString().c_str(),written.size(),original.size());
+				ok = false;
+			}
+		}
+	}
+
+	return ok;
+}
+
+/**
+*	@brief: trace a packet of the scenario, and compare the verdict with the
+*		expected one
+*/
+bool checkPacket(OFSimulator &simulator, Object packet, unsigned int index)
+{
+	static const char *results[] = {"output", "table-miss", "loop", "unknown-lsi"};
+
+	string lsi = packet[LSI_NAME].getString();
+	unsigned int port;
+	if(!simulator.getPort(lsi,packet[PORT].getString(),port))
+	{
+		logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "Packet %d: port \"%s\" of LSI \"%s\" does not exist",index,packet[PORT].getString().c_str(),lsi.c_str());
+		return false;
+	}
+
+	lowlevel::Match header;
+	if(!OFSimulator::parseMatch(packet["fields"].getObject(),header))
+	{
+		logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "Packet %d is malformed",index);
+		return false;
+	}
+
+	sim_trace_t trace = simulator.trace(lsi,port,header);
+
+	string expected = packet["result"].getString();
+	if(expected != results[trace.result])
+	{
+		logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "Packet %d: \"%s\" instead of \"%s\"",index,results[trace.result],expected.c_str());
+		return false;
+	}
+
+	if(packet.count(OUTPUT_PORT) != 0)
+	{
+		string output = trace.lsi + ":" + trace.portName;
+		if(output != packet[OUTPUT_PORT].getString())
+		{
+			logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "Packet %d: sent on \"%s\" instead of \"%s\"",index,output.c_str(),packet[OUTPUT_PORT].getString().c_str());
+			return false;
+		}
+	}
+
+	logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "Packet %d: %s",index,expected.c_str());
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc < 2)
+	{
+		logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "Usage: of-simulator-scenario <scenario> [<scenario> ...]");
+		exit(EXIT_FAILURE);
+	}
+
+	bool ok = true;
+	for(int i = 1; i < argc; i++)
+	{
+		logger(ORCH_INFO, MODULE_NAME, __FILE__, __LINE__, "Scenario \"%s\"",argv[i]);
+
+		ifstream file(argv[i]);
+		Value value;
+		if(!file.good() || !read(file,value) || value.type() != obj_type)
+		{
+			logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "Cannot read the scenario \"%s\"",argv[i]);
+			ok = false;
+			continue;
+		}
+
+		try
+		{
+			Object scenario = value.getObject();
+			OFSimulator simulator;
+			if(!simulator.load(scenario["tables"].getObject()) || !checkMatches(scenario["tables"].getObject()))
+			{
+				logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "Scenario \"%s\": wrong flow tables",argv[i]);
+				ok = false;
+				continue;
+			}
+
+			Array packets = scenario["packets"].getArray();
+			unsigned int index = 0;
+			for(Array::iterator p = packets.begin(); p != packets.end(); p++, index++)
+				ok = checkPacket(simulator,p->getObject(),index) && ok;
+		}catch(...)
+		{
+			logger(ORCH_ERROR, MODULE_NAME, __FILE__, __LINE__, "The scenario \"%s\" is malformed",argv[i]);
+			ok = false;
+		}
+	}
+
+	return (ok)? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -22,10 +22,22 @@
 #define	XDPD_ADDRESS				"127.0.0.1"
 #define OF_CONTROLLER_ADDRESS 		"127.0.0.1"
 #define FIRTS_OF_CONTROLLER_PORT	6653
+#define NUMBER_OF_CONTROLLER_PORTS	(65536 - FIRTS_OF_CONTROLLER_PORT)
+#define CONTROLLER_PORT_REUSE_DELAY	120 //(s) longer than the TIME_WAIT of the connections with the LSIs
+#define FIRST_METER_ID				1
+#define NUMBER_OF_METERS			1024 //Meters of the LSI-0, used to limit the rate of the graphs
+#define MAX_NF_REPLICAS				16 //Instances of a NF of a graph, balanced with a select group
+#define NF_GROUP_BUCKETS			64 //Buckets of the select groups, shared among the replicas of a NF
 
 #define REST_PORT 				8080
 #define BASE_URL_GRAPH			"graph"
 #define BASE_URL_IFACES			"interfaces"
+#define BASE_URL_CORES			"cores"
+#define BASE_URL_CACHE			"cache"
+#define BASE_URL_TABLES			"tables"
+#define BASE_URL_AUTOSCALER		"autoscaler"
+#define BASE_URL_POOL			"pool"
+#define URL_STATS				"stats"
 #define REST_URL 				"http://localhost"
 #define REQ_SIZE 				2*1024*1024
 
@@ -50,6 +62,7 @@
 	#define VNFS 			"VNFs"
 		//#define _ID			"id"
 		#define	TEMPLATE		"template"
+		#define REPLICAS		"replicas"
 		#define PORTS_WITH_REQ	"ports_with_requirements"
 			#define PORT_NAME	"name"
 			#define ETHERNET	"ethernet"
@@ -111,7 +124,39 @@
 			#define	PORT			"port"
 			#define	VNF_ID			"VNF_id"
 			#define ENDPOINT_ID		"endpoint_id"
+	#define RATE_LIMIT		"rate-limit"
+		#define BANDWIDTH		"bandwidth"
+		#define PPS				"pps"
+		#define BURST			"burst"
 			
+/*
+*	Flow tables of the LSIs (see GET /tables, and the OpenFlow simulator)
+*/
+#define LSI0_NAME			"LSI-0"
+#define LSIS				"lsis"
+	//#define PORT_NAME		"name"
+	#define LSI_DPID		"dpid"
+	#define LSI_PORTS		"ports"
+	#define FLOW_ENTRIES	"flow-entries"
+		//#define _ID			"id"
+		#define TABLE_ID		"table"
+		//#define PRIORITY		"priority"
+		//#define MATCH			"match"
+			#define IN_PORT			"in_port"
+		//#define ACTION		"action"
+			#define OUTPUT_PORT		"output"
+			#define GOTO_TABLE		"goto_table"
+			#define METER			"meter"
+			#define GROUP			"group"
+	#define GROUPS			"groups"
+		//#define _ID			"id"
+		#define BUCKETS			"buckets"
+#define VIRTUAL_LINKS		"virtual-links"
+	#define LSI_NAME		"lsi"
+	//#define PORT			"port"
+	#define REMOTE_LSI		"remote-lsi"
+	#define REMOTE_PORT		"remote-port"
+
 /*
 *	Misc
 */
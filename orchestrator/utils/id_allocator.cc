@@ -0,0 +1,131 @@
+#include "id_allocator.h"
+#include <sstream>
+
+IDAllocator::IDAllocator(string name, uint64_t first, uint64_t size, time_t reuseDelay) :
+	name(name), first(first), size(size), reuseDelay(reuseDelay), bitmap((size + 31) / 32, 0), watermark(0), allocated(0)
+{
+	pthread_mutex_init(&allocator_mutex, NULL);
+}
+
+IDAllocator::~IDAllocator()
+{
+	pthread_mutex_destroy(&allocator_mutex);
+}
+
+uint64_t IDAllocator::allocate()
+{
+	pthread_mutex_lock(&allocator_mutex);
+
+	releaseQuarantine(now());
+
+	uint64_t index;
+	if(!freeList.empty())
+	{
+		//Reuse the lowest identifier already released
+		index = *(freeList.begin());
+		freeList.erase(freeList.begin());
+	}
+	else if(watermark < size)
+	{
+		//Use an identifier never allocated before
+		index = watermark;
+		watermark++;
+	}
+	else
+	{
+		//The identifiers in quarantine may still be in use (e.g., by a connection
+		//in TIME_WAIT), hence they are not taken before the end of the quarantine
+		ostringstream message;
+		message << "No " << name << " available: " << allocated << " allocated and " << quarantine.size() << " in quarantine, out of " << size;
+		pthread_mutex_unlock(&allocator_mutex);
+		throw IDAllocatorException(message.str());
+	}
+
+	assert(!getBit(index));
+	setBit(index,true);
+	allocated++;
+
+	pthread_mutex_unlock(&allocator_mutex);
+
+	return first + index;
+}
+
+void IDAllocator::release(uint64_t id)
+{
+	assert(id >= first && id < first + size);
+	uint64_t index = id - first;
+
+	pthread_mutex_lock(&allocator_mutex);
+
+	assert(getBit(index));
+	setBit(index,false);
+	allocated--;
+
+	if(reuseDelay == 0)
+		freeList.insert(index);
+	else
+		quarantine.push_back(make_pair(index,now() + reuseDelay));
+
+	pthread_mutex_unlock(&allocator_mutex);
+}
+
+bool IDAllocator::isAllocated(uint64_t id)
+{
+	if(id < first || id >= first + size)
+		return false;
+
+	pthread_mutex_lock(&allocator_mutex);
+	bool retVal = getBit(id - first);
+	pthread_mutex_unlock(&allocator_mutex);
+
+	return retVal;
+}
+
+bool IDAllocator::isAvailable()
+{
+	pthread_mutex_lock(&allocator_mutex);
+	releaseQuarantine(now());
+	bool retVal = (!freeList.empty() || watermark < size);
+	pthread_mutex_unlock(&allocator_mutex);
+
+	return retVal;
+}
+
+uint64_t IDAllocator::getAllocated()
+{
+	pthread_mutex_lock(&allocator_mutex);
+	uint64_t retVal = allocated;
+	pthread_mutex_unlock(&allocator_mutex);
+
+	return retVal;
+}
+
+void IDAllocator::releaseQuarantine(time_t now)
+{
+	//The quarantine is ordered by expiration time, since the delay is the same for all the identifiers
+	while(!quarantine.empty() && quarantine.front().second <= now)
+	{
+		freeList.insert(quarantine.front().first);
+		quarantine.pop_front();
+	}
+}
+
+void IDAllocator::setBit(uint64_t index, bool value)
+{
+	if(value)
+		bitmap[index / 32] |= (1U << (index % 32));
+	else
+		bitmap[index / 32] &= ~(1U << (index % 32));
+}
+
+bool IDAllocator::getBit(uint64_t index)
+{
+	return (bitmap[index / 32] & (1U << (index % 32))) != 0;
+}
+
+time_t IDAllocator::now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec;
+}
@@ -0,0 +1,149 @@
+#ifndef ID_ALLOCATOR_H_
+#define ID_ALLOCATOR_H_ 1
+
+#pragma once
+
+#include <list>
+#include <set>
+#include <vector>
+#include <string>
+#include <inttypes.h>
+#include <pthread.h>
+#include <time.h>
+#include <assert.h>
+
+#include <stdexcept>
+
+using namespace std;
+
+/**
+*	@brief: allocator of the identifiers in the range [first, first + size), e.g.,
+*		TCP ports of the Openflow controllers.
+*
+*		An identifier released is not immediately reused, but it is put in quarantine
+*		for reuseDelay seconds (e.g., to let the connections towards a controller port
+*		leave the TIME_WAIT state). After the quarantine, it is moved in the free list,
+*		and the free list is always preferred to identifiers never used before. Then,
+*		the state of the allocator does not grow with the number of allocations, but
+*		only with the number of identifiers used at the same time.
+*
+*		The identifiers currently allocated are stored in a bitmap.
+*		All the methods are thread safe.
+*
+*		The allocator does not log anything, and reports the errors only through
+*		IDAllocatorException, since it is shared with the xDPd plugin, which
+*		allocates the datapath IDs of the LSIs (xDPd_plugins/node_orchestrator
+*		ships a copy of this file, to be kept in sync).
+*/
+class IDAllocator
+{
+private:
+	/**
+	*	@brief: name of the resource, used in the exception messages
+	*/
+	string name;
+
+	uint64_t first;
+	uint64_t size;
+
+	/**
+	*	@brief: seconds an identifier must spend in quarantine before being reused
+	*/
+	time_t reuseDelay;
+
+	/**
+	*	@brief: bit i is set if the identifier first + i is currently allocated
+	*/
+	vector<uint32_t> bitmap;
+
+	/**
+	*	@brief: identifiers in [first, first + watermark) have been allocated at
+	*		least once
+	*/
+	uint64_t watermark;
+
+	/**
+	*	@brief: identifiers released, whose quarantine is over. The lowest one is
+	*		allocated first, so that the identifiers remain dense
+	*/
+	set<uint64_t> freeList;
+
+	/**
+	*	@brief: identifiers released, with the time in which their quarantine is over
+	*/
+	list<pair<uint64_t, time_t> > quarantine;
+
+	/**
+	*	@brief: number of identifiers currently allocated
+	*/
+	uint64_t allocated;
+
+	pthread_mutex_t allocator_mutex;
+
+	/**
+	*	@brief: move in the free list the identifiers whose quarantine is over
+	*/
+	void releaseQuarantine(time_t now);
+
+	void setBit(uint64_t index, bool value);
+	bool getBit(uint64_t index);
+
+	/**
+	*	@brief: return the current time (in seconds) from a monotonic clock
+	*/
+	static time_t now();
+
+public:
+	IDAllocator(string name, uint64_t first, uint64_t size, time_t reuseDelay = 0);
+	~IDAllocator();
+
+	/**
+	*	@brief: allocate a new identifier. An identifier in quarantine is never
+	*		allocated before the end of its quarantine.
+	*
+	*	@return: the identifier allocated. An IDAllocatorException is raised if all the
+	*		identifiers are either allocated or in quarantine
+	*/
+	uint64_t allocate();
+
+	/**
+	*	@brief: release an identifier previously allocated
+	*/
+	void release(uint64_t id);
+
+	bool isAllocated(uint64_t id);
+
+	/**
+	*	@brief: return true if allocate would succeed now, i.e., if an identifier is
+	*		neither allocated nor in quarantine
+	*/
+	bool isAvailable();
+
+	/**
+	*	@brief: return the number of identifiers currently allocated
+	*/
+	uint64_t getAllocated();
+};
+
+class IDAllocatorException: public exception
+{
+private:
+	string message;
+
+public:
+	IDAllocatorException(string message) :
+		message(message)
+	{
+	}
+
+	virtual ~IDAllocatorException() throw()
+	{
+	}
+
+	virtual const char* what() const throw()
+	{
+		return message.c_str();
+	}
+};
+
+#endif //ID_ALLOCATOR_H_
@@ -268,7 +268,7 @@ void LSI::removeEndPointvlink(string endpoint)
 	endpoints_vlinks.erase(it);
 }
 
-void LSI::addNF(string name, list< unsigned int> ports)
+void LSI::addNF(string name, list< unsigned int> ports, nf_t type)
 {
 	//FIXME: save the the content of nf->second, and not just its size
 	//FIXME: don't use _1, _2 ecc for the name, but the ID specified by the user
@@ -284,6 +284,7 @@ void LSI::addNF(string name, list< unsigned int> ports)
 		nf_ports[ss.str()] = 0;
 	}
 	network_functions[name] = nf_ports;
+	nf_types[name] = type;
 }
 
 int LSI::addVlink(VLink vlink)
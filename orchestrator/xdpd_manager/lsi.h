@@ -153,7 +153,7 @@ protected:
 	int addVlink(VLink vlink);
 	void removeVlink(uint64_t ID);
 	
-	void addNF(string name, list< unsigned int> ports);
+	void addNF(string name, list< unsigned int> ports, nf_t type);
 	void removeNF(string nf);
 };
 
@@ -13,7 +13,7 @@ class VLink
 friend class LSI;
 
 private:
-	//FIXME: protect it with a mutex?
+	//Atomically incremented, since the LSIs of the pool are created in background
 	static uint64_t nextID;
 
 	uint64_t ID;
@@ -539,7 +539,7 @@ bool XDPDManager::findStatus(Object message)
 
 void XDPDManager::addNFPorts(LSI &lsi,pair<string, list<unsigned int> > nf, nf_t type)
 {
-	lsi.addNF(nf.first, nf.second);
+	lsi.addNF(nf.first, nf.second, type);
 
 	string answer = sendMessage(prepareCreateNFPortsRequest(lsi,type,nf.first));
 	
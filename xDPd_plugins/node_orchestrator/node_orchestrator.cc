@@ -3,8 +3,7 @@
 
 using namespace xdpd;
 
-//FIXME: protect this variable with a mutex?
-uint64_t NodeOrchestrator::nextDpid = 0x1;
+IDAllocator NodeOrchestrator::dpids("datapath ID",FIRST_DPID,NUMBER_OF_DPIDS,DPID_REUSE_DELAY);
 
 NodeOrchestrator::NodeOrchestrator() :
 		socket(NULL)
@@ -117,8 +116,14 @@ LSI NodeOrchestrator::createLSI(list<string> phyPorts, string controllerAddress,
 {
 	map<string,unsigned int> ports;
 
-	uint64_t dpid = nextDpid;	
-	nextDpid++;
+	uint64_t dpid;
+	try
+	{
+		dpid = dpids.allocate();
+	} catch (IDAllocatorException &e) {
+		ROFL_ERR("[xdpd]["PLUGIN_NAME"] Unable to create the LSI: %s\n",e.what());
+		throw;
+	}
 		
 	stringstream lsiName_ss;
 	lsiName_ss << dpid;
@@ -135,6 +140,7 @@ LSI NodeOrchestrator::createLSI(list<string> phyPorts, string controllerAddress,
 		switch_manager::create_switch(OFVERSION, dpid,lsiName,NUM_TABLES,ma_list,RECONNECT_TIME,rofl::csocket::SOCKET_TYPE_PLAIN,socket_params);
 	} catch (...) {
 		ROFL_ERR("[xdpd]["PLUGIN_NAME"] Unable to create the LSI\n");
+		dpids.release(dpid);
 		throw;
 	}	
 
@@ -263,6 +269,7 @@ void NodeOrchestrator::destroyLSI(uint64_t dpid)
 		ROFL_ERR("[xdpd]["PLUGIN_NAME"] Unable to destroy LSI\n");
 		throw;
 	}	
+	dpids.release(dpid);
 	ROFL_ERR("[xdpd]["PLUGIN_NAME"] LSI %d destroyed\n",dpid);
 }
 
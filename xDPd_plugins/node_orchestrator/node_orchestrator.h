@@ -13,6 +13,7 @@
 #include <rofl/datapath/pipeline/openflow/of_switch.h>
 #include "../../../openflow/openflow_switch.h"
 #include "LSI.h"
+#include "id_allocator.h"
 #include "orchestrator_constants.h"
 #include "message_handler.h"
 
@@ -84,7 +85,7 @@ protected:
 	
 	static set<string> discoverPhyPorts();
 	
-	static uint64_t nextDpid;
+	static IDAllocator dpids;
 
 protected:
 
@@ -12,9 +12,18 @@
 /*
 *	Openflow stuffs
 */
-#define NUM_TABLES			8
+#define NUM_TABLES			8	//The LSI-0 uses all of them (LSI0_NUM_TABLES in the node orchestrator)
 #define RECONNECT_TIME 		1	//1s
-#define OFVERSION 			OF_VERSION_12
+#define OFVERSION 			OF_VERSION_13	//Required by the meters limiting the rate of the graphs on the LSI-0
+
+/*
+*	Datapath IDs of the LSIs. A DPID released is not reused for DPID_REUSE_DELAY
+*	seconds, since it names the rings and the statistics segments (<lsiID>_<nf>)
+*	of the DPDK NFs of the LSI, which are torn down after the LSI is destroyed
+*/
+#define FIRST_DPID			0x1
+#define NUMBER_OF_DPIDS		65535
+#define DPID_REUSE_DELAY	60	//60s
 
 /*
 *	Connection from the node orchestrator